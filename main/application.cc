@@ -7,11 +7,14 @@
 #include "websocket_protocol.h"
 #include "assets/lang_config.h"
 #include "mcp_server.h"
+#include "local_intent.h"
 #include "assets.h"
 #include "esp_sntp.h"
 #include "time.h"
 #include "settings.h"
 #include "weather_service.h"
+#include "progress_channel.h"
+#include "runtime_metrics.h"
 
 #include <cstring>
 #include <esp_log.h>
@@ -19,9 +22,24 @@
 #include <driver/gpio.h>
 #include <arpa/inet.h>
 #include <font_awesome.h>
+#include <freertos/semphr.h>
 
 #define TAG "Application"
 
+// Time slice for scheduled callbacks per loop iteration, so audio and state events are not held back
+#define MAIN_TASK_SLICE_US 20000
+
+// Coalescing keys for UI callbacks
+// One chat key per role, a pending user message must not be replaced by the assistant reply
+static const char* const kChatMessageUserKey = "chat_message.user";
+static const char* const kChatMessageAssistantKey = "chat_message.assistant";
+static const char* const kChatMessageSystemKey = "chat_message.system";
+static const char* const kEmotionKey = "emotion";
+// Indexed by ProgressSlot, a finished update must not be replaced by another job's progress
+static const char* const kProgressKeys[kProgressSlotCount] = {
+    "progress.firmware", "progress.assets", "progress.model", "progress.tool",
+};
+
 
 Application::Application() {
     event_group_ = xEventGroupCreate();
@@ -47,6 +65,19 @@ Application::Application() {
         .skip_unhandled_events = true
     };
     esp_timer_create(&clock_timer_args, &clock_timer_handle_);
+
+    esp_timer_create_args_t minute_timer_args = {
+        .callback = [](void* arg) {
+            Application* app = (Application*)arg;
+            app->InvalidateStatusBar(kStatusBarClock);
+            app->ArmMinuteTimer(0);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "minute_timer",
+        .skip_unhandled_events = true
+    };
+    esp_timer_create(&minute_timer_args, &minute_timer_handle_);
 }
 
 Application::~Application() {
@@ -54,6 +85,10 @@ Application::~Application() {
         esp_timer_stop(clock_timer_handle_);
         esp_timer_delete(clock_timer_handle_);
     }
+    if (minute_timer_handle_ != nullptr) {
+        esp_timer_stop(minute_timer_handle_);
+        esp_timer_delete(minute_timer_handle_);
+    }
     vEventGroupDelete(event_group_);
 }
 
@@ -73,6 +108,9 @@ void Application::Initialize() {
 
     // Setup the audio service
     auto codec = board.GetAudioCodec();
+    codec->OnMuteChanged([this](bool muted) {
+        InvalidateStatusBar(kStatusBarMute);
+    });
     audio_service_.Initialize(codec);
     audio_service_.Start();
 
@@ -86,15 +124,38 @@ void Application::Initialize() {
     callbacks.on_vad_change = [this](bool speaking) {
         xEventGroupSetBits(event_group_, MAIN_EVENT_VAD_CHANGE);
     };
+    callbacks.on_command_detected = [](const std::string& text, const std::string& action, const std::string& arguments) {
+        // 本地命令词直接在设备上执行，不需要打开服务器会话
+        LocalIntent::GetInstance().Execute(text, action, arguments);
+    };
     audio_service_.SetCallbacks(callbacks);
 
+    // 预先解码常用提示音，播放时无需等待 Opus 解码
+    audio_service_.PreloadSound(Lang::Sounds::OGG_POPUP);
+    audio_service_.PreloadSound(Lang::Sounds::OGG_SUCCESS);
+    audio_service_.PreloadSound(Lang::Sounds::OGG_VIBRATION);
+    audio_service_.PreloadSound(Lang::Sounds::OGG_EXCLAMATION);
+
+    // Download progress is drawn on its own cadence, producers never touch the display.
+    // The consumer runs in the esp_timer task, drawing takes the LVGL lock so it is handed to the main loop
+    ProgressChannel::GetInstance().SetConsumer([this](const ProgressUpdate& update) {
+        ScheduleCoalesced(kProgressKeys[update.slot], [this, update]() {
+            ShowProgress(update);
+        });
+    });
+
     // Add state change listeners
     state_machine_.AddStateChangeListener([this](DeviceState old_state, DeviceState new_state) {
         xEventGroupSetBits(event_group_, MAIN_EVENT_STATE_CHANGED);
     });
 
-    // Start the clock timer to update the status bar
-    esp_timer_start_periodic(clock_timer_handle_, 1000000);
+    // Task CPU windows are sampled on the clock timer below
+    RuntimeMetrics::GetInstance().Initialize();
+
+    // Battery and network are polled by the clock timer, its period follows the power save level.
+    // The clock only changes on minute boundaries.
+    esp_timer_start_periodic(clock_timer_handle_, status_poll_interval_s_ * 1000000LL);
+    ArmMinuteTimer(0);
 
     // Add MCP common tools (only once during initialization)
     auto& mcp_server = McpServer::GetInstance();
@@ -133,6 +194,10 @@ void Application::Initialize() {
             case NetworkEvent::Disconnected:
                 xEventGroupSetBits(event_group_, MAIN_EVENT_NETWORK_DISCONNECTED);
                 break;
+            case NetworkEvent::Handover:
+                display->ShowNotification(Lang::Strings::SWITCH_TO_4G_NETWORK);
+                xEventGroupSetBits(event_group_, MAIN_EVENT_NETWORK_HANDOVER);
+                break;
             case NetworkEvent::WifiConfigModeEnter:
                 // WiFi config mode enter is handled by WifiBoard internally
                 break;
@@ -163,6 +228,7 @@ void Application::Initialize() {
 
     // Update the status bar immediately to show the network state
     display->UpdateStatusBar(true);
+    MarkBootPhase("init");
 }
 
 void Application::Run() {
@@ -178,11 +244,13 @@ void Application::Run() {
         MAIN_EVENT_ERROR |
         MAIN_EVENT_NETWORK_CONNECTED |
         MAIN_EVENT_NETWORK_DISCONNECTED |
+        MAIN_EVENT_NETWORK_HANDOVER |
         MAIN_EVENT_TOGGLE_CHAT |
         MAIN_EVENT_START_LISTENING |
         MAIN_EVENT_STOP_LISTENING |
         MAIN_EVENT_ACTIVATION_DONE |
-        MAIN_EVENT_STATE_CHANGED;
+        MAIN_EVENT_STATE_CHANGED |
+        MAIN_EVENT_STATUS_BAR;
 
     while (true) {
         auto bits = xEventGroupWaitBits(event_group_, ALL_EVENTS, pdTRUE, pdFALSE, portMAX_DELAY);
@@ -200,6 +268,10 @@ void Application::Run() {
             HandleNetworkDisconnectedEvent();
         }
 
+        if (bits & MAIN_EVENT_NETWORK_HANDOVER) {
+            HandleNetworkHandoverEvent();
+        }
+
         if (bits & MAIN_EVENT_ACTIVATION_DONE) {
             HandleActivationDoneEvent();
         }
@@ -240,39 +312,90 @@ void Application::Run() {
         }
 
         if (bits & MAIN_EVENT_SCHEDULE) {
-            std::unique_lock<std::mutex> lock(mutex_);
-            auto tasks = std::move(main_tasks_);
-            lock.unlock();
-            for (auto& task : tasks) {
-                task();
+            if (main_tasks_.RunPending(MAIN_TASK_SLICE_US)) {
+                // Leftovers run after the other pending events
+                xEventGroupSetBits(event_group_, MAIN_EVENT_SCHEDULE);
             }
         }
 
+        bool update_status_bar = (bits & MAIN_EVENT_STATUS_BAR) != 0;
         if (bits & MAIN_EVENT_CLOCK_TICK) {
-            clock_ticks_++;
-            if (clock_ticks_ > 0 && clock_ticks_ % 1800 == 0) {
-                {
-                    ESP_LOGI(TAG, "Time to update weather...");
-                    WeatherService::GetInstance().UpdateWeatherAsync();
-
-                }
+            int64_t now_us = esp_timer_get_time();
+            if (last_weather_update_us_ != 0 && now_us - last_weather_update_us_ >= 1800LL * 1000000) {
+                ESP_LOGI(TAG, "Time to update weather...");
+                UpdateWeather();
             }
-            auto display = Board::GetInstance().GetDisplay();
-            display->UpdateStatusBar();
-        
+            // Battery and network have no change events, sample them; the display only redraws what changed
+            Board::GetInstance().GetDisplay()->InvalidateStatusBar(kStatusBarBattery | kStatusBarNetwork);
+            update_status_bar = true;
+
+            RuntimeMetrics::GetInstance().Sample();
+#if CONFIG_REPORT_RUNTIME_METRICS
+            // 会话期间定期上报，服务器主动关闭的会话也有最近一次的指标
+            if (protocol_ && protocol_->IsAudioChannelOpened() &&
+                now_us - last_runtime_metrics_us_ >= CONFIG_RUNTIME_METRICS_REPORT_INTERVAL * 1000000LL) {
+                last_runtime_metrics_us_ = now_us;
+                protocol_->SendRuntimeMetrics(RuntimeMetrics::GetInstance().GetJson());
+            }
+#endif
+
             // Print debug info every 10 seconds
-            if (clock_ticks_ % 10 == 0) {
+            if (now_us - last_heap_stats_us_ >= 10 * 1000000) {
+                last_heap_stats_us_ = now_us;
                 SystemInfo::PrintHeapStats();
             }
+            if (now_us - last_task_stats_us_ >= 60 * 1000000) {
+                last_task_stats_us_ = now_us;
+                SystemInfo::PrintMainTaskStats(main_tasks_);
+            }
+        }
+
+        if (update_status_bar) {
+            Board::GetInstance().GetDisplay()->UpdateStatusBar();
         }
     }
 }
 
+void Application::InvalidateStatusBar(uint32_t fields) {
+    Board::GetInstance().GetDisplay()->InvalidateStatusBar(fields);
+    xEventGroupSetBits(event_group_, MAIN_EVENT_STATUS_BAR);
+}
+
+void Application::ArmMinuteTimer(int delay_s) {
+    if (delay_s <= 0) {
+        // Fire right after the next minute boundary
+        delay_s = 60 - static_cast<int>(time(nullptr) % 60);
+    }
+    esp_timer_stop(minute_timer_handle_);
+    esp_timer_start_once(minute_timer_handle_, delay_s * 1000000LL);
+}
+
+void Application::SetPowerSaveLevel(PowerSaveLevel level) {
+    Board::GetInstance().SetPowerSaveLevel(level);
+
+    int interval_s = 30;
+    if (level == PowerSaveLevel::PERFORMANCE) {
+        interval_s = 5;
+    } else if (level == PowerSaveLevel::BALANCED) {
+        interval_s = 10;
+    }
+    if (status_poll_interval_s_.exchange(interval_s) != interval_s) {
+        esp_timer_stop(clock_timer_handle_);
+        esp_timer_start_periodic(clock_timer_handle_, interval_s * 1000000LL);
+    }
+}
+
+void Application::UpdateWeather() {
+    last_weather_update_us_ = esp_timer_get_time();
+    WeatherService::GetInstance().UpdateWeatherAsync();
+}
+
 void Application::HandleNetworkConnectedEvent() {
     ESP_LOGI(TAG, "Network connected");
     auto state = GetDeviceState();
 
     if (state == kDeviceStateStarting || state == kDeviceStateWifiConfiguring) {
+        MarkBootPhase("network");
         // Network is ready, start activation
         SetDeviceState(kDeviceStateActivating);
         if (activation_task_handle_ != nullptr) {
@@ -288,42 +411,104 @@ void Application::HandleNetworkConnectedEvent() {
         }, "activation", 4096 * 2, this, 2, &activation_task_handle_);
     }
 
+    // SNTP runs in the background, the main loop must not wait for it
+    StartTimeSync();
+
+    // Weather is fetched once the clock is valid, right away after a reconnect
+    time_t now = time(nullptr);
+    struct tm timeinfo = {};
+    localtime_r(&now, &timeinfo);
+    if (timeinfo.tm_year >= (2020 - 1900)) {
+        ESP_LOGI(TAG, "Triggering first weather update...");
+        UpdateWeather();
+    } else {
+        weather_pending_ = true;
+    }
+
+    // Update the status bar immediately to show the network state
+    auto display = Board::GetInstance().GetDisplay();
+    display->UpdateStatusBar(true);
+}
+
+void Application::StartTimeSync() {
+    if (esp_sntp_enabled()) {
+        // Already running after a reconnect, request an immediate sync
+        esp_sntp_restart();
+        return;
+    }
+
     setenv("TZ", "CST-8", 1);
     tzset();
     esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
-    esp_sntp_setservername(0, "ntp.aliyun.com"); 
-    esp_sntp_setservername(1, "pool.ntp.org"); 
+    esp_sntp_setservername(0, "ntp.aliyun.com");
+    esp_sntp_setservername(1, "pool.ntp.org");
+    // Called from the lwIP task, hand the result over to the main task
+    sntp_set_time_sync_notification_cb([](struct timeval* tv) {
+        auto& app = Application::GetInstance();
+        app.MarkBootPhase("time_sync");
+        app.Schedule([&app]() {
+            time_t now = time(nullptr);
+            struct tm timeinfo = {};
+            localtime_r(&now, &timeinfo);
+            char strftime_buf[64];
+            strftime(strftime_buf, sizeof(strftime_buf), "%Y-%m-%d %H:%M:%S", &timeinfo);
+            ESP_LOGI(TAG, "当前系统时间: %s", strftime_buf);
+
+            if (app.weather_pending_) {
+                app.weather_pending_ = false;
+                ESP_LOGI(TAG, "Triggering first weather update...");
+                app.UpdateWeather();
+            }
+            Board::GetInstance().GetDisplay()->UpdateStatusBar(true);
+        });
+    });
     esp_sntp_init();
-    
-    time_t now = 0;
-    struct tm timeinfo = { 0 };
-    int retry = 0;
-    const int retry_count = 10;
+}
 
-    time(&now);
-    localtime_r(&now, &timeinfo);
-    
-    while (timeinfo.tm_year < (2020 - 1900) && ++retry < retry_count) {
-        ESP_LOGI(TAG, "Waiting for system time to be set... (%d/%d)", retry, retry_count);
-        vTaskDelay(pdMS_TO_TICKS(2000)); // 每次等 2 秒
-        time(&now);
-        localtime_r(&now, &timeinfo);
+void Application::MarkBootPhase(const char* phase) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (boot_completed_) {
+        return;
     }
+    int64_t now_ms = esp_timer_get_time() / 1000;
+    int64_t delta_ms = boot_phases_.empty() ? now_ms : now_ms - boot_phases_.back().second;
+    boot_phases_.emplace_back(phase, now_ms);
+    ESP_LOGI(TAG, "Boot phase %s at %lld ms (+%lld ms)", phase, now_ms, delta_ms);
+}
 
-    if (retry == retry_count) {
-        ESP_LOGE(TAG, "SNTP 同步超时！");
-    } else {
-        char strftime_buf[64];
-        strftime(strftime_buf, sizeof(strftime_buf), "%Y-%m-%d %H:%M:%S", &timeinfo);
-        ESP_LOGI(TAG, "当前系统时间: %s", strftime_buf);
+void Application::PrintBootTimeline() {
+    std::string timeline;
+    int64_t network_ms = -1;
+    int64_t ready_ms = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        boot_completed_ = true;
+        for (const auto& [phase, time_ms] : boot_phases_) {
+            if (!timeline.empty()) {
+                timeline += ", ";
+            }
+            timeline += phase;
+            timeline += "=" + std::to_string(time_ms);
+            if (strcmp(phase, "network") == 0) {
+                network_ms = time_ms;
+            } else if (strcmp(phase, "ready") == 0) {
+                ready_ms = time_ms;
+            }
+        }
+        boot_phases_.clear();
+        boot_phases_.shrink_to_fit();
     }
 
-    // Update the status bar immediately to show the network state
-    auto display = Board::GetInstance().GetDisplay();
-    ESP_LOGI(TAG, "Triggering first weather update...");
-    WeatherService::GetInstance().UpdateWeatherAsync();
-    
-    display->UpdateStatusBar(true);
+    // One line per boot, easy to grep and compare between firmware versions
+    ESP_LOGI(TAG, "Boot timeline (%s, ms): %s", SystemInfo::GetUserAgent().c_str(), timeline.c_str());
+    if (network_ms >= 0 && ready_ms >= 0) {
+        int64_t ready_after_network = ready_ms - network_ms;
+        if (ready_after_network > 3000) {
+            ESP_LOGW(TAG, "Ready %lld ms after network up (target 3000 ms)", ready_after_network);
+        } else {
+            ESP_LOGI(TAG, "Ready %lld ms after network up", ready_after_network);
+        }
+    }
 }
 
 void Application::HandleNetworkDisconnectedEvent() {
@@ -339,11 +524,55 @@ void Application::HandleNetworkDisconnectedEvent() {
     display->UpdateStatusBar(true);
 }
 
+void Application::HandleNetworkHandoverEvent() {
+    // The previous network is still up, move the session before releasing it.
+    // Uplink audio queues in the send queue meanwhile and is flushed on the new connection,
+    // reconnecting and the resumed hello are bounded by SERVER_RECONNECT_TIMEOUT_MS and
+    // SERVER_RESUME_TIMEOUT_MS to keep within it.
+    auto state = GetDeviceState();
+    if (state == kDeviceStateConnecting || state == kDeviceStateActivating) {
+        // Opening the channel or the activation request may still use the previous network,
+        // the handover is repeated once the state changes
+        ESP_LOGI(TAG, "Network handover deferred in state %s", DeviceStateMachine::GetStateName(state));
+        handover_pending_ = true;
+        Board::GetInstance().GetDisplay()->UpdateStatusBar(true);
+        return;
+    }
+    handover_pending_ = false;
+    if (protocol_ && (state == kDeviceStateListening || state == kDeviceStateSpeaking || state == kDeviceStateIdle)) {
+        bool opened = protocol_->IsAudioChannelOpened();
+        std::string session_id = protocol_->session_id();
+        int64_t start_time = esp_timer_get_time();
+        if (!protocol_->MigrateAudioChannel()) {
+            ESP_LOGW(TAG, "Failed to move the session to the new network");
+            if (opened) {
+                protocol_->CloseAudioChannel();
+            }
+        } else if (opened) {
+            ESP_LOGI(TAG, "Session moved to the new network in %lld ms", (esp_timer_get_time() - start_time) / 1000);
+            if (protocol_->session_id() != session_id) {
+                // The server did not resume the session, continue the conversation in the new one
+                ESP_LOGW(TAG, "Server started a new session %s", protocol_->session_id().c_str());
+                if (state == kDeviceStateListening) {
+                    protocol_->SendStartListening(listening_mode_);
+                } else if (state == kDeviceStateSpeaking) {
+                    SetDeviceState(kDeviceStateIdle);
+                }
+            }
+        }
+    }
+
+    Board::GetInstance().ReleasePreviousNetwork();
+    Board::GetInstance().GetDisplay()->UpdateStatusBar(true);
+}
+
 void Application::HandleActivationDoneEvent() {
     ESP_LOGI(TAG, "Activation done");
 
     SystemInfo::PrintHeapStats();
     SetDeviceState(kDeviceStateIdle);
+    MarkBootPhase("ready");
+    PrintBootTimeline();
 
     has_server_time_ = ota_->HasServerTime();
 
@@ -357,22 +586,57 @@ void Application::HandleActivationDoneEvent() {
 
     // Release OTA object after activation is complete
     ota_.reset();
-    auto& board = Board::GetInstance();
-    board.SetPowerSaveLevel(PowerSaveLevel::LOW_POWER);
+    SetPowerSaveLevel(PowerSaveLevel::LOW_POWER);
 }
 
 void Application::ActivationTask() {
     // Create OTA object for activation process
     ota_ = std::make_unique<Ota>();
 
-    // Check for new assets version
-    CheckAssetsVersion();
+    // Startup graph:
+    //   assets (apply partition, load srmodels)  ─┐
+    //   OTA version check ──> protocol init ──────┴─> activation done
+    // A pending assets download switches to the upgrading state, so it runs alone first.
+    SemaphoreHandle_t assets_done = nullptr;
+    {
+        Settings settings("assets", false);
+        if (!settings.GetString("download_url").empty()) {
+            CheckAssetsVersion();
+            MarkBootPhase("assets");
+        } else {
+            assets_done = xSemaphoreCreateBinary();
+        }
+    }
+    if (assets_done != nullptr) {
+        auto ret = xTaskCreate([](void* arg) {
+            auto done = static_cast<SemaphoreHandle_t>(arg);
+            auto& app = Application::GetInstance();
+            app.CheckAssetsVersion();
+            app.MarkBootPhase("assets");
+            xSemaphoreGive(done);
+            vTaskDelete(NULL);
+        }, "assets", 4096 * 2, assets_done, 2, nullptr);
+        if (ret != pdPASS) {
+            ESP_LOGW(TAG, "Failed to create assets task, applying assets inline");
+            CheckAssetsVersion();
+            MarkBootPhase("assets");
+            xSemaphoreGive(assets_done);
+        }
+    }
 
     // Check for new firmware version
     CheckNewVersion();
+    MarkBootPhase("ota");
 
     // Initialize the protocol
     InitializeProtocol();
+    MarkBootPhase("protocol");
+
+    // Wake word models must be loaded before entering idle
+    if (assets_done != nullptr) {
+        xSemaphoreTake(assets_done, portMAX_DELAY);
+        vSemaphoreDelete(assets_done);
+    }
 
     // Signal completion to main loop
     xEventGroupSetBits(event_group_, MAIN_EVENT_ACTIVATION_DONE);
@@ -408,18 +672,16 @@ void Application::CheckAssetsVersion() {
         // Wait for the audio service to be idle for 3 seconds
         vTaskDelay(pdMS_TO_TICKS(3000));
         SetDeviceState(kDeviceStateUpgrading);
-        board.SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
+        SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
         display->SetChatMessage("system", Lang::Strings::PLEASE_WAIT);
 
-        bool success = assets.Download(download_url, [display](int progress, size_t speed) -> void {
-            std::thread([display, progress, speed]() {
-                char buffer[32];
-                snprintf(buffer, sizeof(buffer), "%d%% %uKB/s", progress, speed / 1024);
-                display->SetChatMessage("system", buffer);
-            }).detach();
-        });
+        bool success;
+        {
+            ProgressScope progress(kProgressAssets);
+            success = assets.Download(download_url, progress.Callback());
+        }
 
-        board.SetPowerSaveLevel(PowerSaveLevel::LOW_POWER);
+        SetPowerSaveLevel(PowerSaveLevel::LOW_POWER);
         vTaskDelay(pdMS_TO_TICKS(1000));
 
         if (!success) {
@@ -542,21 +804,26 @@ void Application::InitializeProtocol() {
         }
     });
     
-    protocol_->OnAudioChannelOpened([this, codec, &board]() {
-        board.SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
+    protocol_->OnAudioChannelOpened([this, codec]() {
+        SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
+        last_runtime_metrics_us_ = esp_timer_get_time();
         if (protocol_->server_sample_rate() != codec->output_sample_rate()) {
             ESP_LOGW(TAG, "Server sample rate %d does not match device output sample rate %d, resampling may cause distortion",
                 protocol_->server_sample_rate(), codec->output_sample_rate());
         }
     });
     
-    protocol_->OnAudioChannelClosed([this, &board]() {
-        board.SetPowerSaveLevel(PowerSaveLevel::LOW_POWER);
+    protocol_->OnAudioChannelClosed([this]() {
+        SetPowerSaveLevel(PowerSaveLevel::LOW_POWER);
         Schedule([this]() {
+            // Messages of the closed session must not show up afterwards
+            main_tasks_.Cancel(kChatMessageUserKey);
+            main_tasks_.Cancel(kChatMessageAssistantKey);
+            main_tasks_.Cancel(kChatMessageSystemKey);
             auto display = Board::GetInstance().GetDisplay();
             display->SetChatMessage("system", "");
             SetDeviceState(kDeviceStateIdle);
-        });
+        }, kMainTaskPriorityHigh, "audio_channel_closed");
     });
     
     protocol_->OnIncomingJson([this, display](const cJSON* root) {
@@ -568,7 +835,7 @@ void Application::InitializeProtocol() {
                 Schedule([this]() {
                     aborted_ = false;
                     SetDeviceState(kDeviceStateSpeaking);
-                });
+                }, kMainTaskPriorityHigh, "tts_start");
             } else if (strcmp(state->valuestring, "stop") == 0) {
                 Schedule([this]() {
                     if (GetDeviceState() == kDeviceStateSpeaking) {
@@ -578,12 +845,12 @@ void Application::InitializeProtocol() {
                             SetDeviceState(kDeviceStateListening);
                         }
                     }
-                });
+                }, kMainTaskPriorityHigh, "tts_stop");
             } else if (strcmp(state->valuestring, "sentence_start") == 0) {
                 auto text = cJSON_GetObjectItem(root, "text");
                 if (cJSON_IsString(text)) {
                     ESP_LOGI(TAG, "<< %s", text->valuestring);
-                    Schedule([display, message = std::string(text->valuestring)]() {
+                    ScheduleCoalesced(kChatMessageAssistantKey, [display, message = std::string(text->valuestring)]() {
                         display->SetChatMessage("assistant", message.c_str());
                     });
                 }
@@ -592,14 +859,14 @@ void Application::InitializeProtocol() {
             auto text = cJSON_GetObjectItem(root, "text");
             if (cJSON_IsString(text)) {
                 ESP_LOGI(TAG, ">> %s", text->valuestring);
-                Schedule([display, message = std::string(text->valuestring)]() {
+                ScheduleCoalesced(kChatMessageUserKey, [display, message = std::string(text->valuestring)]() {
                     display->SetChatMessage("user", message.c_str());
                 });
             }
         } else if (strcmp(type->valuestring, "llm") == 0) {
             auto emotion = cJSON_GetObjectItem(root, "emotion");
             if (cJSON_IsString(emotion)) {
-                Schedule([display, emotion_str = std::string(emotion->valuestring)]() {
+                ScheduleCoalesced(kEmotionKey, [display, emotion_str = std::string(emotion->valuestring)]() {
                     display->SetEmotion(emotion_str.c_str());
                 });
             }
@@ -616,7 +883,7 @@ void Application::InitializeProtocol() {
                     // Do a reboot if user requests a OTA update
                     Schedule([this]() {
                         Reboot();
-                    });
+                    }, kMainTaskPriorityHigh, "reboot");
                 } else {
                     ESP_LOGW(TAG, "Unknown system command: %s", command->valuestring);
                 }
@@ -635,7 +902,7 @@ void Application::InitializeProtocol() {
             auto payload = cJSON_GetObjectItem(root, "payload");
             ESP_LOGI(TAG, "Received custom message: %s", cJSON_PrintUnformatted(root));
             if (cJSON_IsObject(payload)) {
-                Schedule([this, display, payload_str = std::string(cJSON_PrintUnformatted(payload))]() {
+                ScheduleCoalesced(kChatMessageSystemKey, [display, payload_str = std::string(cJSON_PrintUnformatted(payload))]() {
                     display->SetChatMessage("system", payload_str.c_str());
                 });
             } else {
@@ -687,7 +954,8 @@ void Application::Alert(const char* status, const char* message, const char* emo
     display->SetEmotion(emotion);
     display->SetChatMessage("system", message);
     if (!sound.empty()) {
-        audio_service_.PlaySound(sound);
+        // 告警音与 TTS 混音播放，不打断正在进行的对话
+        audio_service_.PlaySound(sound, kAudioStreamAlarm);
     }
 }
 
@@ -745,7 +1013,7 @@ void Application::HandleToggleChatEvent() {
     } else if (state == kDeviceStateSpeaking) {
         AbortSpeaking(kAbortReasonNone);
     } else if (state == kDeviceStateListening) {
-        protocol_->CloseAudioChannel();
+        CloseAudioChannel();
     }
 }
 
@@ -840,7 +1108,9 @@ void Application::HandleWakeWordDetectedEvent() {
 
 void Application::HandleStateChangedEvent() {
     DeviceState new_state = state_machine_.GetState();
-    clock_ticks_ = 0;
+    if (handover_pending_ && new_state != kDeviceStateConnecting && new_state != kDeviceStateActivating) {
+        xEventGroupSetBits(event_group_, MAIN_EVENT_NETWORK_HANDOVER);
+    }
 
     auto& board = Board::GetInstance();
     auto display = board.GetDisplay();
@@ -854,6 +1124,8 @@ void Application::HandleStateChangedEvent() {
             // display->SetEmotion("neutral");
             audio_service_.EnableVoiceProcessing(false);
             audio_service_.EnableWakeWordDetection(true);
+            // The status text is kept for 10 seconds, then the clock takes over
+            ArmMinuteTimer(11);
             break;
         case kDeviceStateConnecting:
             display->SetStatus(Lang::Strings::CONNECTING);
@@ -886,6 +1158,10 @@ void Application::HandleStateChangedEvent() {
             break;
         case kDeviceStateSpeaking:
             display->SetStatus(Lang::Strings::SPEAKING);
+#if CONFIG_REPORT_AUDIO_METRICS
+            // 上报本轮聆听期间的音频质量统计
+            protocol_->SendAudioMetrics(audio_service_.GetAudioMetricsJson(true));
+#endif
 
             if (listening_mode_ != kListeningModeRealtime) {
                 audio_service_.EnableVoiceProcessing(false);
@@ -904,14 +1180,53 @@ void Application::HandleStateChangedEvent() {
     }
 }
 
-void Application::Schedule(std::function<void()>&& callback) {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        main_tasks_.push_back(std::move(callback));
-    }
+void Application::Schedule(MainTask&& callback, MainTaskPriority priority, const char* name) {
+    main_tasks_.Push(std::move(callback), priority, name);
     xEventGroupSetBits(event_group_, MAIN_EVENT_SCHEDULE);
 }
 
+void Application::ScheduleCoalesced(const char* key, MainTask&& callback, int deadline_ms) {
+    if (main_tasks_.Push(std::move(callback), kMainTaskPriorityLow, key, key, deadline_ms)) {
+        xEventGroupSetBits(event_group_, MAIN_EVENT_SCHEDULE);
+    }
+}
+
+void Application::ShowProgress(const ProgressUpdate& update) {
+    auto display = Board::GetInstance().GetDisplay();
+    if (update.active) {
+        char buffer[32];
+        if (update.speed > 0) {
+            snprintf(buffer, sizeof(buffer), "%d%% %uKB/s", update.progress, static_cast<unsigned>(update.speed / 1024));
+        } else {
+            snprintf(buffer, sizeof(buffer), "%d%%", update.progress);
+        }
+        // Firmware and assets run in the upgrading state, where the chat message belongs to them.
+        // Tool downloads happen mid-conversation, so they only borrow the status line
+        if (update.slot == kProgressTool) {
+            display->SetStatus(buffer);
+        } else {
+            display->SetChatMessage("system", buffer);
+        }
+        return;
+    }
+
+    if (update.slot == kProgressTool) {
+        switch (GetDeviceState()) {
+            case kDeviceStateIdle:
+                display->SetStatus(Lang::Strings::STANDBY);
+                break;
+            case kDeviceStateListening:
+                display->SetStatus(Lang::Strings::LISTENING);
+                break;
+            case kDeviceStateSpeaking:
+                display->SetStatus(Lang::Strings::SPEAKING);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
 void Application::AbortSpeaking(AbortReason reason) {
     ESP_LOGI(TAG, "Abort speaking");
     aborted_ = true;
@@ -925,6 +1240,17 @@ void Application::SetListeningMode(ListeningMode mode) {
     SetDeviceState(kDeviceStateListening);
 }
 
+void Application::CloseAudioChannel() {
+#if CONFIG_REPORT_RUNTIME_METRICS
+    // 设备主动结束会话时上报运行时指标，通道关闭后 WebSocket 无法再发送
+    if (protocol_->IsAudioChannelOpened()) {
+        last_runtime_metrics_us_ = esp_timer_get_time();
+        protocol_->SendRuntimeMetrics(RuntimeMetrics::GetInstance().GetJson());
+    }
+#endif
+    protocol_->CloseAudioChannel();
+}
+
 void Application::Reboot() {
     ESP_LOGI(TAG, "Rebooting...");
     // Disconnect the audio channel
@@ -960,23 +1286,21 @@ bool Application::UpgradeFirmware(const std::string& url, const std::string& ver
     std::string message = std::string(Lang::Strings::NEW_VERSION) + version_info;
     display->SetChatMessage("system", message.c_str());
 
-    board.SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
+    SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
     audio_service_.Stop();
     vTaskDelay(pdMS_TO_TICKS(1000));
 
-    bool upgrade_success = Ota::Upgrade(upgrade_url, [display](int progress, size_t speed) {
-        std::thread([display, progress, speed]() {
-            char buffer[32];
-            snprintf(buffer, sizeof(buffer), "%d%% %uKB/s", progress, speed / 1024);
-            display->SetChatMessage("system", buffer);
-        }).detach();
-    });
+    bool upgrade_success;
+    {
+        ProgressScope progress(kProgressFirmware);
+        upgrade_success = Ota::Upgrade(upgrade_url, progress.Callback());
+    }
 
     if (!upgrade_success) {
         // Upgrade failed, restart audio service and continue running
         ESP_LOGE(TAG, "Firmware upgrade failed, restarting audio service and continuing operation...");
         audio_service_.Start(); // Restart audio service
-        board.SetPowerSaveLevel(PowerSaveLevel::LOW_POWER); // Restore power save level
+        SetPowerSaveLevel(PowerSaveLevel::LOW_POWER); // Restore power save level
         Alert(Lang::Strings::ERROR, Lang::Strings::UPGRADE_FAILED, "circle_xmark", Lang::Sounds::OGG_EXCLAMATION);
         vTaskDelay(pdMS_TO_TICKS(3000));
         return false;
@@ -1030,7 +1354,7 @@ void Application::WakeWordInvoke(const std::string& wake_word) {
     } else if (state == kDeviceStateListening) {   
         Schedule([this]() {
             if (protocol_) {
-                protocol_->CloseAudioChannel();
+                CloseAudioChannel();
             }
         });
     }
@@ -1059,7 +1383,7 @@ void Application::SendMcpMessage(const std::string& payload) {
         if (protocol_) {
             protocol_->SendMcpMessage(payload);
         }
-    });
+    }, kMainTaskPriorityNormal, "send_mcp_message");
 }
 
 void Application::SetAecMode(AecMode mode) {
@@ -10,12 +10,19 @@
 #include <mutex>
 #include <deque>
 #include <memory>
+#include <vector>
+#include <utility>
+#include <atomic>
 
 #include "protocol.h"
 #include "ota.h"
 #include "audio_service.h"
 #include "device_state.h"
 #include "device_state_machine.h"
+#include "main_task_queue.h"
+#include "progress_channel.h"
+
+enum class PowerSaveLevel;
 
 // Main event bits
 #define MAIN_EVENT_SCHEDULE             (1 << 0)
@@ -31,6 +38,8 @@
 #define MAIN_EVENT_START_LISTENING      (1 << 10)
 #define MAIN_EVENT_STOP_LISTENING       (1 << 11)
 #define MAIN_EVENT_STATE_CHANGED        (1 << 12)
+#define MAIN_EVENT_STATUS_BAR           (1 << 13)
+#define MAIN_EVENT_NETWORK_HANDOVER     (1 << 14)
 
 
 enum AecMode {
@@ -74,8 +83,15 @@ public:
 
     /**
      * Schedule a callback to be executed in the main task
+     * Higher priorities run first, small captures are stored without heap allocation
      */
-    void Schedule(std::function<void()>&& callback);
+    void Schedule(MainTask&& callback, MainTaskPriority priority = kMainTaskPriorityNormal, const char* name = nullptr);
+
+    /**
+     * Schedule a low priority UI callback that replaces any pending one with the same key
+     * It runs ahead of other priorities once deadline_ms has passed
+     */
+    void ScheduleCoalesced(const char* key, MainTask&& callback, int deadline_ms = 200);
 
     /**
      * Alert with status, message, emotion and optional sound
@@ -113,6 +129,16 @@ public:
     void PlaySound(const std::string_view& sound);
     AudioService& GetAudioService() { return audio_service_; }
     
+    /**
+     * Mark status bar fields (StatusBarField) as changed, they are rendered by the main task (thread-safe)
+     */
+    void InvalidateStatusBar(uint32_t fields);
+    /**
+     * Apply a power save level to the board and retune the status poll timer.
+     * All power save changes go through here instead of Board::SetPowerSaveLevel.
+     */
+    void SetPowerSaveLevel(PowerSaveLevel level);
+
     /**
      * Reset protocol resources (thread-safe)
      * Can be called from any task to release resources allocated after network connected
@@ -125,10 +151,12 @@ private:
     ~Application();
 
     std::mutex mutex_;
-    std::deque<std::function<void()>> main_tasks_;
+    MainTaskQueue main_tasks_;
     std::unique_ptr<Protocol> protocol_;
     EventGroupHandle_t event_group_ = nullptr;
-    esp_timer_handle_t clock_timer_handle_ = nullptr;
+    esp_timer_handle_t clock_timer_handle_ = nullptr;     // Polls battery and network
+    esp_timer_handle_t minute_timer_handle_ = nullptr;    // Clock minute rollover
+    std::atomic<int> status_poll_interval_s_ = 10;
     DeviceStateMachine state_machine_;
     ListeningMode listening_mode_ = kListeningModeAutoStop;
     AecMode aec_mode_ = kAecOff;
@@ -140,8 +168,17 @@ private:
     bool aborted_ = false;
     bool assets_version_checked_ = false;
     bool play_popup_on_listening_ = false;  // Flag to play popup sound after state changes to listening
-    int clock_ticks_ = 0;
+    bool weather_pending_ = false;          // Fetch weather once the system time is valid
+    int64_t last_weather_update_us_ = 0;
+    int64_t last_heap_stats_us_ = 0;
+    int64_t last_task_stats_us_ = 0;
+    std::atomic<int64_t> last_runtime_metrics_us_ = 0;  // Last runtime metrics report, reset when the audio channel opens
     TaskHandle_t activation_task_handle_ = nullptr;
+    bool handover_pending_ = false;         // Handover waits for Connecting / Activating to finish on the old network
+
+    // Boot timeline, milliseconds since power on, protected by mutex_
+    std::vector<std::pair<const char*, int64_t>> boot_phases_;
+    bool boot_completed_ = false;
 
 
     // Event handlers
@@ -151,6 +188,7 @@ private:
     void HandleStopListeningEvent();
     void HandleNetworkConnectedEvent();
     void HandleNetworkDisconnectedEvent();
+    void HandleNetworkHandoverEvent();
     void HandleActivationDoneEvent();
     void HandleWakeWordDetectedEvent();
 
@@ -161,8 +199,15 @@ private:
     void CheckAssetsVersion();
     void CheckNewVersion();
     void InitializeProtocol();
+    void StartTimeSync();
+    void UpdateWeather();
+    void ArmMinuteTimer(int delay_s);
+    void CloseAudioChannel();
+    void MarkBootPhase(const char* phase);
+    void PrintBootTimeline();
     void ShowActivationCode(const std::string& code, const std::string& message);
     void SetListeningMode(ListeningMode mode);
+    void ShowProgress(const ProgressUpdate& update);
     
     // State change handler called by state machine
     void OnStateChanged(DeviceState old_state, DeviceState new_state);
@@ -48,11 +48,20 @@ void AudioCodec::Start() {
 }
 
 void AudioCodec::SetOutputVolume(int volume) {
+    bool mute_changed = (volume == 0) != (output_volume_ == 0);
     output_volume_ = volume;
     ESP_LOGI(TAG, "Set output volume to %d", output_volume_);
     
     Settings settings("audio", true);
     settings.SetInt("output_volume", output_volume_);
+
+    if (mute_changed && mute_changed_callback_) {
+        mute_changed_callback_(output_volume_ == 0);
+    }
+}
+
+void AudioCodec::OnMuteChanged(std::function<void(bool muted)> callback) {
+    mute_changed_callback_ = callback;
 }
 
 void AudioCodec::SetInputGain(float gain) {
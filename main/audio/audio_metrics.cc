@@ -0,0 +1,173 @@
+#include "audio_metrics.h"
+
+#include <esp_timer.h>
+#include <cJSON.h>
+#include <algorithm>
+
+// 统计窗口长度
+#define AUDIO_METRICS_WINDOW_MS 10000
+// 采样绝对值达到该值视为削波
+#define AUDIO_METRICS_CLIP_THRESHOLD 32000
+// 噪声底上升速度，每帧 0.1 dB
+#define AUDIO_METRICS_NOISE_FLOOR_RISE 1
+// 输出电平高于该值 (0.1 dBFS) 时才统计回声损耗
+#define AUDIO_METRICS_ECHO_MIN_OUTPUT_DB -500
+#define AUDIO_METRICS_SILENCE_DB -1000
+
+// log2(x) in Q8, linear interpolation on the mantissa (error < 0.09)
+static int32_t log2_q8(uint64_t x) {
+    int msb = 63 - __builtin_clzll(x);
+    uint32_t frac = msb >= 8 ? (uint32_t)(x >> (msb - 8)) & 0xFF : (uint32_t)(x << (8 - msb)) & 0xFF;
+    return (msb << 8) + frac;
+}
+
+int AudioMetrics::MeanSquareToDb(uint64_t sum_squares, uint32_t samples) {
+    if (samples == 0 || sum_squares < samples) {
+        return AUDIO_METRICS_SILENCE_DB;
+    }
+    // 10 * log10(ms / 32768^2) = 3.0103 * log2(ms) - 90.309 dB
+    int32_t db = (int32_t)((int64_t)log2_q8(sum_squares / samples) * 30103 / (256 * 1000)) - 903;
+    return std::max(db, AUDIO_METRICS_SILENCE_DB);
+}
+
+static int peak_to_db(int32_t peak) {
+    if (peak <= 0) {
+        return AUDIO_METRICS_SILENCE_DB;
+    }
+    // 20 * log10(peak / 32768) = 6.0206 * log2(peak) - 90.309 dB
+    return (int32_t)((int64_t)log2_q8(peak) * 60206 / (256 * 1000)) - 903;
+}
+
+AudioMetrics::AudioMetrics() {
+    current_.start_time_us = esp_timer_get_time();
+}
+
+int AudioMetrics::Accumulate(Level& level, const int16_t* data, size_t samples, int stride) {
+    uint64_t sum = 0;
+    int32_t peak = 0;
+    uint32_t clipped = 0;
+    for (size_t i = 0; i < samples; i++) {
+        int32_t s = data[i * stride];
+        int32_t a = s < 0 ? -s : s;
+        sum += (uint32_t)(s * s);
+        peak = std::max(peak, a);
+        clipped += a >= AUDIO_METRICS_CLIP_THRESHOLD;
+    }
+    level.sum_squares += sum;
+    level.samples += samples;
+    level.peak = std::max(level.peak, peak);
+    level.clipped += clipped;
+    return MeanSquareToDb(sum, samples);
+}
+
+void AudioMetrics::RollWindow(int64_t now) {
+    current_.end_time_us = now;
+    current_.noise_floor_db = noise_floor_db_;
+    last_ = current_;
+    has_last_ = true;
+    current_ = Summary();
+    current_.start_time_us = now;
+}
+
+void AudioMetrics::FeedInput(const int16_t* data, size_t frames, int channels, bool voice_detected) {
+    if (frames == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = esp_timer_get_time();
+    if (now - current_.start_time_us >= AUDIO_METRICS_WINDOW_MS * 1000LL) {
+        RollWindow(now);
+    }
+
+    int db = Accumulate(current_.input, data, frames, channels);
+    // 噪声底：下降立即跟随，上升缓慢
+    if (db < noise_floor_db_) {
+        noise_floor_db_ = db;
+    } else {
+        noise_floor_db_ += AUDIO_METRICS_NOISE_FLOOR_RISE;
+    }
+    if (voice_detected) {
+        current_.speech_db_sum += db;
+        current_.speech_frames++;
+    }
+}
+
+void AudioMetrics::FeedProcessed(const int16_t* data, size_t samples) {
+    if (samples == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    int db = Accumulate(current_.processed, data, samples, 1);
+
+    // 播放期间，扬声器输出与 AEC 之后残余电平之差即回声损耗估计
+    int64_t now = esp_timer_get_time();
+    if (aec_enabled_ && now - last_output_time_us_ < 200 * 1000 &&
+        last_output_db_ > AUDIO_METRICS_ECHO_MIN_OUTPUT_DB) {
+        current_.echo_loss_db_sum += last_output_db_ - db;
+        current_.echo_frames++;
+    }
+}
+
+void AudioMetrics::FeedOutput(const int16_t* data, size_t samples) {
+    if (samples == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_output_db_ = Accumulate(current_.output, data, samples, 1);
+    last_output_time_us_ = esp_timer_get_time();
+}
+
+void AudioMetrics::SetAecEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    aec_enabled_ = enabled;
+}
+
+static cJSON* LevelToJson(const AudioMetrics::Level& level) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "rms_dbfs", AudioMetrics::MeanSquareToDb(level.sum_squares, level.samples) / 10.0);
+    cJSON_AddNumberToObject(json, "peak_dbfs", peak_to_db(level.peak) / 10.0);
+    cJSON_AddNumberToObject(json, "clipped", level.clipped);
+    cJSON_AddNumberToObject(json, "samples", level.samples);
+    return json;
+}
+
+static cJSON* SummaryToJson(const AudioMetrics::Summary& summary) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "duration_ms", (summary.end_time_us - summary.start_time_us) / 1000);
+    cJSON_AddItemToObject(json, "input", LevelToJson(summary.input));
+    cJSON_AddItemToObject(json, "processed", LevelToJson(summary.processed));
+    cJSON_AddItemToObject(json, "output", LevelToJson(summary.output));
+    cJSON_AddNumberToObject(json, "noise_floor_dbfs", summary.noise_floor_db / 10.0);
+    if (summary.speech_frames > 0) {
+        int speech_db = summary.speech_db_sum / summary.speech_frames;
+        cJSON_AddNumberToObject(json, "speech_dbfs", speech_db / 10.0);
+        cJSON_AddNumberToObject(json, "snr_db", (speech_db - summary.noise_floor_db) / 10.0);
+    }
+    if (summary.echo_frames > 0) {
+        cJSON_AddNumberToObject(json, "echo_return_loss_db", summary.echo_loss_db_sum / summary.echo_frames / 10.0);
+    }
+    return json;
+}
+
+std::string AudioMetrics::GetSummaryJson(bool reset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = esp_timer_get_time();
+    current_.end_time_us = now;
+    current_.noise_floor_db = noise_floor_db_;
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "aec", aec_enabled_);
+    cJSON_AddItemToObject(root, "current", SummaryToJson(current_));
+    if (has_last_) {
+        cJSON_AddItemToObject(root, "last", SummaryToJson(last_));
+    }
+    if (reset) {
+        RollWindow(now);
+    }
+
+    auto str = cJSON_PrintUnformatted(root);
+    std::string json(str);
+    cJSON_free(str);
+    cJSON_Delete(root);
+    return json;
+}
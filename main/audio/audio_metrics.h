@@ -0,0 +1,68 @@
+#ifndef AUDIO_METRICS_H
+#define AUDIO_METRICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/*
+ * 音频质量统计
+ *
+ * 在麦克风原始输入、音频处理器 (AFE) 输出和扬声器输出三处按帧统计
+ * RMS / 峰值 / 削波次数，并估计噪声底、信噪比和回声损耗。
+ * 所有计算均为整数运算，电平单位为 0.1 dBFS。
+ */
+class AudioMetrics {
+public:
+    struct Level {
+        uint64_t sum_squares = 0;
+        uint32_t samples = 0;
+        int32_t peak = 0;
+        uint32_t clipped = 0;
+    };
+
+    struct Summary {
+        int64_t start_time_us = 0;
+        int64_t end_time_us = 0;
+        Level input;
+        Level processed;
+        Level output;
+        int noise_floor_db = 0;         // 噪声底 (0.1 dBFS)
+        int64_t speech_db_sum = 0;      // 有人声帧的输入电平累加
+        uint32_t speech_frames = 0;
+        int64_t echo_loss_db_sum = 0;   // 播放期间输出与处理后电平之差的累加
+        uint32_t echo_frames = 0;
+    };
+
+    AudioMetrics();
+
+    // 原始麦克风数据，只统计第 0 通道
+    void FeedInput(const int16_t* data, size_t frames, int channels, bool voice_detected);
+    // 音频处理器输出，即发送给服务器的数据
+    void FeedProcessed(const int16_t* data, size_t samples);
+    // 写入 I2S 的数据 (混音之后)
+    void FeedOutput(const int16_t* data, size_t samples);
+    void SetAecEnabled(bool enabled);
+
+    // 返回当前窗口与上一个完整窗口的统计；reset 为 true 时结束当前窗口
+    std::string GetSummaryJson(bool reset = false);
+
+    // Mean square to 0.1 dBFS, -1000 for silence
+    static int MeanSquareToDb(uint64_t sum_squares, uint32_t samples);
+
+private:
+    std::mutex mutex_;
+    Summary current_;
+    Summary last_;
+    bool has_last_ = false;
+    bool aec_enabled_ = false;
+    int noise_floor_db_ = 0;
+    int last_output_db_ = -1000;
+    int64_t last_output_time_us_ = 0;
+
+    static int Accumulate(Level& level, const int16_t* data, size_t samples, int stride);
+    void RollWindow(int64_t now);
+};
+
+#endif // AUDIO_METRICS_H
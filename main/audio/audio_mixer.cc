@@ -0,0 +1,58 @@
+#include "audio_mixer.h"
+#include "pcm_convert.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define MIXER_UNITY_GAIN 16384
+
+static int32_t gain_to_q14(float gain) {
+    return (int32_t)(std::clamp(gain, 0.0f, 1.0f) * MIXER_UNITY_GAIN + 0.5f);
+}
+
+AudioMixer::AudioMixer() {
+    for (int i = 0; i < kAudioStreamCount; i++) {
+        gains_[i] = MIXER_UNITY_GAIN;
+        current_gains_[i] = MIXER_UNITY_GAIN;
+    }
+    ducking_gain_ = gain_to_q14(AUDIO_MIXER_DUCKING_GAIN);
+}
+
+void AudioMixer::SetGain(AudioStreamType stream, float gain) {
+    gains_[stream] = gain_to_q14(gain);
+}
+
+void AudioMixer::SetDuckingGain(float gain) {
+    ducking_gain_ = gain_to_q14(gain);
+}
+
+bool AudioMixer::IsPassthrough(AudioStreamType stream) const {
+    return gains_[stream].load() == MIXER_UNITY_GAIN && current_gains_[stream] == MIXER_UNITY_GAIN;
+}
+
+void AudioMixer::Mix(const int16_t* const sources[kAudioStreamCount], const size_t samples[kAudioStreamCount],
+                     size_t frame_samples, std::vector<int16_t>& output) {
+    // 提示音或告警播放时压低 TTS
+    bool duck = sources[kAudioStreamSound] != nullptr || sources[kAudioStreamAlarm] != nullptr;
+
+    accumulator_.resize(frame_samples);
+    std::memset(accumulator_.data(), 0, frame_samples * sizeof(int32_t));
+
+    for (int i = 0; i < kAudioStreamCount; i++) {
+        int32_t target = gains_[i].load();
+        if (i == kAudioStreamVoice && duck) {
+            target = target * ducking_gain_.load() / MIXER_UNITY_GAIN;
+        }
+        if (sources[i] == nullptr) {
+            // 空闲的流直接跳到目标增益，下次开始播放时不需要斜坡
+            current_gains_[i] = target;
+            continue;
+        }
+        size_t n = std::min(samples[i], frame_samples);
+        pcm_s16_mac_q14(sources[i], accumulator_.data(), n, current_gains_[i], target);
+        current_gains_[i] = target;
+    }
+
+    output.resize(frame_samples);
+    pcm_s32_to_s16(accumulator_.data(), output.data(), frame_samples, 14);
+}
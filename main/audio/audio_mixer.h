@@ -0,0 +1,51 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 输出混音的各路音频流
+enum AudioStreamType {
+    kAudioStreamVoice = 0,  // 服务器下发的 TTS
+    kAudioStreamSound,      // 界面提示音
+    kAudioStreamAlarm,      // 告警 / 闹钟
+    kAudioStreamCount,
+};
+
+// TTS 在提示音或告警播放期间的闪避增益
+#define AUDIO_MIXER_DUCKING_GAIN 0.3f
+
+/*
+ * 多路输出混音器
+ *
+ * 每路有独立增益，提示音或告警播放时自动压低 TTS。增益变化在一帧内
+ * 线性过渡以避免爆音，混音在 Q14 定点累加器中完成并饱和到 16 位。
+ * 混音结果就是写入 I2S 的数据，因此硬件回采通道得到的也是混音后的参考信号。
+ */
+class AudioMixer {
+public:
+    AudioMixer();
+
+    // gain: 0.0 - 1.0，下一帧开始生效
+    void SetGain(AudioStreamType stream, float gain);
+    void SetDuckingGain(float gain);
+
+    // 当只有 stream 在播放且增益已稳定在 1.0 时可直接输出原始数据，无需混音
+    bool IsPassthrough(AudioStreamType stream) const;
+
+    // sources[i] 为 nullptr 表示该路空闲；长度不足 frame_samples 的部分按静音处理
+    void Mix(const int16_t* const sources[kAudioStreamCount], const size_t samples[kAudioStreamCount],
+             size_t frame_samples, std::vector<int16_t>& output);
+
+private:
+    // 目标增益 (Q14)，可在任意任务中修改
+    std::atomic<int32_t> gains_[kAudioStreamCount];
+    std::atomic<int32_t> ducking_gain_;
+    // 当前实际增益 (Q14)，含闪避，仅由输出任务访问
+    int32_t current_gains_[kAudioStreamCount];
+    std::vector<int32_t> accumulator_;
+};
+
+#endif // AUDIO_MIXER_H
@@ -1,17 +1,8 @@
 #include "audio_service.h"
+#include "pcm_convert.h"
 #include <esp_log.h>
 #include <cstring>
-
-#define RATE_CVT_CFG(_src_rate, _dest_rate, _channel)        \
-    (esp_ae_rate_cvt_cfg_t)                                  \
-    {                                                        \
-        .src_rate        = (uint32_t)(_src_rate),            \
-        .dest_rate       = (uint32_t)(_dest_rate),           \
-        .channel         = (uint8_t)(_channel),              \
-        .bits_per_sample = ESP_AUDIO_BIT16,                  \
-        .complexity      = 2,                                \
-        .perf_type       = ESP_AE_RATE_CVT_PERF_TYPE_SPEED,  \
-    }
+#include <algorithm>
 
 #define OPUS_DEC_CFG(_sample_rate, _frame_duration_ms)                                                    \
     (esp_opus_dec_cfg_t)                                                                                  \
@@ -31,6 +22,7 @@
 #if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
 #include "wake_words/afe_wake_word.h"
 #include "wake_words/custom_wake_word.h"
+#include "wake_words/multi_wake_word.h"
 #else
 #include "wake_words/esp_wake_word.h"
 #endif
@@ -51,12 +43,6 @@ AudioService::~AudioService() {
     if (opus_decoder_ != nullptr) {
         esp_opus_dec_close(opus_decoder_);
     }
-    if (input_resampler_ != nullptr) {
-        esp_ae_rate_cvt_close(input_resampler_);
-    }
-    if (output_resampler_ != nullptr) {
-        esp_ae_rate_cvt_close(output_resampler_);
-    }
 }
 
 void AudioService::Initialize(AudioCodec* codec) {
@@ -84,14 +70,13 @@ void AudioService::Initialize(AudioCodec* codec) {
     }
 
     if (codec->input_sample_rate() != 16000) {
-        esp_ae_rate_cvt_cfg_t input_resampler_cfg = RATE_CVT_CFG(
-            codec->input_sample_rate(), ESP_AUDIO_SAMPLE_RATE_16K, codec->input_channels());
-        auto resampler_ret = esp_ae_rate_cvt_open(&input_resampler_cfg, &input_resampler_);
-        if (input_resampler_ == nullptr) {
-            ESP_LOGE(TAG, "Failed to create input resampler, error code: %d", resampler_ret);
-        }
+        input_resampler_.Configure(codec->input_sample_rate(), 16000, codec->input_channels());
     }
 
+#if CONFIG_USE_AUDIO_DEBUGGER
+    audio_debugger_ = std::make_unique<AudioDebugger>();
+#endif
+
 #if CONFIG_USE_AUDIO_PROCESSOR
     audio_processor_ = std::make_unique<AfeAudioProcessor>();
 #else
@@ -99,6 +84,10 @@ void AudioService::Initialize(AudioCodec* codec) {
 #endif
 
     audio_processor_->OnOutput([this](std::vector<int16_t>&& data) {
+        metrics_.FeedProcessed(data.data(), data.size());
+#if CONFIG_USE_AUDIO_DEBUGGER
+        audio_debugger_->Feed(kAudioDebugTapProcessed, data.data(), data.size(), 1, 16000);
+#endif
         PushTaskToEncodeQueue(kAudioTaskTypeEncodeToSendQueue, std::move(data));
     });
 
@@ -177,6 +166,9 @@ void AudioService::Stop() {
     audio_encode_queue_.clear();
     audio_decode_queue_.clear();
     audio_playback_queue_.clear();
+    for (auto& pending : pending_sounds_) {
+        pending.clear();
+    }
     audio_testing_queue_.clear();
     audio_queue_cv_.notify_all();
 }
@@ -189,21 +181,19 @@ bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, in
     }
 
     if (codec_->input_sample_rate() != sample_rate) {
-        data.resize(samples * codec_->input_sample_rate() / sample_rate * codec_->input_channels());
-        if (!codec_->InputData(data)) {
+        std::lock_guard<std::mutex> lock(input_resampler_mutex_);
+        // 原始数据读入复用的缓冲区，再直接重采样到调用者的 data 中
+        input_buffer_.resize(samples * codec_->input_sample_rate() / sample_rate * codec_->input_channels());
+        if (!codec_->InputData(input_buffer_)) {
             return false;
         }
-        if (input_resampler_ != nullptr) {
-            std::lock_guard<std::mutex> lock(input_resampler_mutex_);
-            uint32_t in_sample_num = data.size() / codec_->input_channels();
-            uint32_t output_samples = 0;
-            esp_ae_rate_cvt_get_max_out_sample_num(input_resampler_, in_sample_num, &output_samples);
-            auto resampled = std::vector<int16_t>(output_samples * codec_->input_channels());
-            uint32_t actual_output = output_samples;
-            esp_ae_rate_cvt_process(input_resampler_, (esp_ae_sample_t)data.data(), in_sample_num,
-                                   (esp_ae_sample_t)resampled.data(), &actual_output);
-            resampled.resize(actual_output * codec_->input_channels());
-            data = std::move(resampled);
+        if (input_resampler_.configured()) {
+            size_t in_frames = input_buffer_.size() / codec_->input_channels();
+            data.resize(input_resampler_.GetMaxOutputFrames(in_frames) * codec_->input_channels());
+            size_t out_frames = input_resampler_.Process(input_buffer_.data(), in_frames, data.data());
+            data.resize(out_frames * codec_->input_channels());
+        } else {
+            data = input_buffer_;
         }
     } else {
         data.resize(samples * codec_->input_channels());
@@ -217,11 +207,16 @@ bool AudioService::ReadAudioData(std::vector<int16_t>& data, int sample_rate, in
     debug_statistics_.input_count++;
 
 #if CONFIG_USE_AUDIO_DEBUGGER
-    // 音频调试：发送原始音频数据
-    if (audio_debugger_ == nullptr) {
-        audio_debugger_ = std::make_unique<AudioDebugger>();
+    // 音频调试：麦克风与 AEC 参考通道分别发送 (参考通道总是最后一个)
+    int channels = codec_->input_channels();
+    size_t frames = data.size() / channels;
+    if (codec_->input_reference() && channels > 1) {
+        uint32_t reference_mask = 1u << (channels - 1);
+        audio_debugger_->Feed(kAudioDebugTapMic, data.data(), frames, channels, sample_rate, reference_mask - 1);
+        audio_debugger_->Feed(kAudioDebugTapReference, data.data(), frames, channels, sample_rate, reference_mask);
+    } else {
+        audio_debugger_->Feed(kAudioDebugTapMic, data.data(), frames, channels, sample_rate);
     }
-    audio_debugger_->Feed(data);
 #endif
 
     return true;
@@ -254,11 +249,9 @@ void AudioService::AudioInputTask() {
             if (ReadAudioData(data, 16000, samples)) {
                 // If input channels is 2, we need to fetch the left channel data
                 if (codec_->input_channels() == 2) {
-                    auto mono_data = std::vector<int16_t>(data.size() / 2);
-                    for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-                        mono_data[i] = data[j];
-                    }
-                    data = std::move(mono_data);
+                    size_t frames = data.size() / 2;
+                    pcm_s16_extract_channel(data.data(), data.data(), frames, 2, 0);
+                    data.resize(frames);
                 }
                 PushTaskToEncodeQueue(kAudioTaskTypeEncodeToTestingQueue, std::move(data));
                 continue;
@@ -283,6 +276,8 @@ void AudioService::AudioInputTask() {
             int samples = audio_processor_->GetFeedSize();
             if (samples > 0) {
                 if (ReadAudioData(data, 16000, samples)) {
+                    metrics_.FeedInput(data.data(), data.size() / codec_->input_channels(),
+                        codec_->input_channels(), voice_detected_);
                     audio_processor_->Feed(std::move(data));
                     continue;
                 }
@@ -299,22 +294,70 @@ void AudioService::AudioInputTask() {
 void AudioService::AudioOutputTask() {
     while (true) {
         std::unique_lock<std::mutex> lock(audio_queue_mutex_);
-        audio_queue_cv_.wait(lock, [this]() { return !audio_playback_queue_.empty() || service_stopped_; });
+        audio_queue_cv_.wait(lock, [this]() {
+            return !audio_playback_queue_.empty() || HasPendingSounds() || service_stopped_;
+        });
         if (service_stopped_) {
             break;
         }
 
-        auto task = std::move(audio_playback_queue_.front());
-        audio_playback_queue_.pop_front();
+        const int16_t* sources[kAudioStreamCount] = {};
+        size_t samples[kAudioStreamCount] = {};
+        std::unique_ptr<AudioTask> task;
+        if (!audio_playback_queue_.empty()) {
+            task = std::move(audio_playback_queue_.front());
+            audio_playback_queue_.pop_front();
+            sources[kAudioStreamVoice] = task->pcm.data();
+            samples[kAudioStreamVoice] = task->pcm.size();
+        }
+
+        // 有 TTS 时按 TTS 帧长混音，否则按固定帧长输出提示音
+        size_t frame_size = task ? task->pcm.size() : codec_->output_sample_rate() / 1000 * OPUS_FRAME_DURATION_MS;
+        bool has_sound = false;
+        int64_t sound_request_time = 0;
+        for (int i = kAudioStreamSound; i < kAudioStreamCount; i++) {
+            if (pending_sounds_[i].empty()) {
+                continue;
+            }
+            // 缓存的 PCM 在服务生命周期内不会释放，可以在锁外直接引用
+            auto& pending = pending_sounds_[i].front();
+            sources[i] = pending.sound->pcm + pending.offset;
+            samples[i] = std::min(frame_size, pending.sound->pcm_samples - pending.offset);
+            if (pending.offset == 0) {
+                sound_request_time = pending.request_time_us;
+            }
+            pending.offset += samples[i];
+            if (pending.offset >= pending.sound->pcm_samples) {
+                pending_sounds_[i].pop_front();
+            }
+            has_sound = true;
+        }
         audio_queue_cv_.notify_all();
         lock.unlock();
 
+        // 只有 TTS 且增益为 1.0 时直接输出解码数据
+        std::vector<int16_t>* output = task ? &task->pcm : &mix_frame_;
+        if (has_sound || !mixer_.IsPassthrough(kAudioStreamVoice)) {
+            mixer_.Mix(sources, samples, frame_size, mix_frame_);
+            output = &mix_frame_;
+        }
+
         if (!codec_->output_enabled()) {
             esp_timer_stop(audio_power_timer_);
             esp_timer_start_periodic(audio_power_timer_, AUDIO_POWER_CHECK_INTERVAL_MS * 1000);
             codec_->EnableOutput(true);
         }
-        codec_->OutputData(task->pcm);
+        if (sound_request_time > 0) {
+            // 写入 I2S 之后声音还要经过 DMA 描述符队列才到达功放
+            int dma_latency_ms = AUDIO_CODEC_DMA_DESC_NUM * AUDIO_CODEC_DMA_FRAME_NUM * 1000 / codec_->output_sample_rate();
+            ESP_LOGI(TAG, "Sound started in %lld ms (+%d ms DMA)",
+                (esp_timer_get_time() - sound_request_time) / 1000, dma_latency_ms);
+        }
+        metrics_.FeedOutput(output->data(), output->size());
+#if CONFIG_USE_AUDIO_DEBUGGER
+        audio_debugger_->Feed(kAudioDebugTapPlayback, output->data(), output->size(), 1, codec_->output_sample_rate());
+#endif
+        codec_->OutputData(*output);
 
         /* Update the last output time */
         last_output_time_ = std::chrono::steady_clock::now();
@@ -322,7 +365,7 @@ void AudioService::AudioOutputTask() {
 
 #if CONFIG_USE_SERVER_AEC
         /* Record the timestamp for server AEC */
-        if (task->timestamp > 0) {
+        if (task && task->timestamp > 0) {
             lock.lock();
             timestamp_queue_.push_back(task->timestamp);
         }
@@ -375,15 +418,12 @@ void AudioService::OpusCodecTask() {
                 decoder_lock.unlock();
                 if (ret == ESP_AUDIO_ERR_OK) {
                     task->pcm.resize(out_frame.decoded_size / sizeof(int16_t));
-                    if (decoder_sample_rate_ != codec_->output_sample_rate() && output_resampler_ != nullptr) {
-                        uint32_t target_size = 0;
-                        esp_ae_rate_cvt_get_max_out_sample_num(output_resampler_, task->pcm.size(), &target_size);
-                        std::vector<int16_t> resampled(target_size);
-                        uint32_t actual_output = target_size;
-                        esp_ae_rate_cvt_process(output_resampler_, (esp_ae_sample_t)task->pcm.data(), task->pcm.size(),
-                                                (esp_ae_sample_t)resampled.data(), &actual_output);
-                        resampled.resize(actual_output);
-                        task->pcm = std::move(resampled);
+                    if (decoder_sample_rate_ != codec_->output_sample_rate() && output_resampler_.configured()) {
+                        // 解码结果留在复用的缓冲区，重采样直接写入任务的 PCM
+                        decode_buffer_.swap(task->pcm);
+                        task->pcm.resize(output_resampler_.GetMaxOutputFrames(decode_buffer_.size()));
+                        size_t out_frames = output_resampler_.Process(decode_buffer_.data(), decode_buffer_.size(), task->pcm.data());
+                        task->pcm.resize(out_frames);
                     }
                     lock.lock();
                     audio_playback_queue_.push_back(std::move(task));
@@ -475,17 +515,9 @@ void AudioService::SetDecodeSampleRate(int sample_rate, int frame_duration) {
 
     auto codec = Board::GetInstance().GetAudioCodec();
     if (decoder_sample_rate_ != codec->output_sample_rate()) {
+        // 采样率不变时保留滤波器状态，只有比例变化才重新计算系数
         ESP_LOGI(TAG, "Resampling audio from %d to %d", decoder_sample_rate_, codec->output_sample_rate());
-        if (output_resampler_ != nullptr) {
-            esp_ae_rate_cvt_close(output_resampler_);
-            output_resampler_ = nullptr;
-        }
-        esp_ae_rate_cvt_cfg_t output_resampler_cfg = RATE_CVT_CFG(
-            decoder_sample_rate_, codec->output_sample_rate(), ESP_AUDIO_MONO);
-        auto resampler_ret = esp_ae_rate_cvt_open(&output_resampler_cfg, &output_resampler_);
-        if (output_resampler_ == nullptr) {
-            ESP_LOGE(TAG, "Failed to create output resampler, error code: %d", resampler_ret);
-        }
+        output_resampler_.Configure(decoder_sample_rate_, codec->output_sample_rate(), 1);
     }
 }
 
@@ -572,9 +604,7 @@ void AudioService::EnableWakeWordDetection(bool enable) {
         // This prevents buffer overflow when switching between different feed sizes
         {
             std::lock_guard<std::mutex> lock(input_resampler_mutex_);
-            if (input_resampler_ != nullptr) {
-                esp_ae_rate_cvt_reset(input_resampler_);
-            }
+            input_resampler_.Reset();
         }
         wake_word_->Start();
         xEventGroupSetBits(event_group_, AS_EVENT_WAKE_WORD_RUNNING);
@@ -599,9 +629,7 @@ void AudioService::EnableVoiceProcessing(bool enable) {
         // This prevents buffer overflow when switching between different feed sizes
         {
             std::lock_guard<std::mutex> lock(input_resampler_mutex_);
-            if (input_resampler_ != nullptr) {
-                esp_ae_rate_cvt_reset(input_resampler_);
-            }
+            input_resampler_.Reset();
         }
         audio_processor_->Start();
         xEventGroupSetBits(event_group_, AS_EVENT_AUDIO_PROCESSOR_RUNNING);
@@ -632,118 +660,74 @@ void AudioService::EnableDeviceAec(bool enable) {
     }
 
     audio_processor_->EnableDeviceAec(enable);
+    metrics_.SetAecEnabled(enable);
 }
 
 void AudioService::SetCallbacks(AudioServiceCallbacks& callbacks) {
     callbacks_ = callbacks;
 }
 
-void AudioService::PlaySound(const std::string_view& ogg) {
+void AudioService::PlaySound(const std::string_view& ogg, AudioStreamType stream) {
+    int64_t request_time = esp_timer_get_time();
     if (!codec_->output_enabled()) {
         esp_timer_stop(audio_power_timer_);
         esp_timer_start_periodic(audio_power_timer_, AUDIO_POWER_CHECK_INTERVAL_MS * 1000);
         codec_->EnableOutput(true);
     }
 
-    const uint8_t* buf = reinterpret_cast<const uint8_t*>(ogg.data());
-    size_t size = ogg.size();
-    size_t offset = 0;
+    // 页表只解析一次；未预加载的提示音不在此处解码，避免阻塞调用者
+    auto sound = sound_bank_.Load(ogg, codec_->output_sample_rate(), false);
+    if (sound == nullptr) {
+        return;
+    }
 
-    auto find_page = [&](size_t start)->size_t {
-        for (size_t i = start; i + 4 <= size; ++i) {
-            if (buf[i] == 'O' && buf[i+1] == 'g' && buf[i+2] == 'g' && buf[i+3] == 'S') return i;
+    if (sound->pcm != nullptr) {
+        // 已缓存的 PCM 由输出任务直接读取并与 TTS 混音，不受 ResetDecoder 影响
+        if (stream == kAudioStreamVoice) {
+            stream = kAudioStreamSound;
         }
-        return static_cast<size_t>(-1);
-    };
+        std::lock_guard<std::mutex> lock(audio_queue_mutex_);
+        pending_sounds_[stream].push_back({sound, 0, request_time});
+        audio_queue_cv_.notify_all();
+        return;
+    }
 
-    bool seen_head = false;
-    bool seen_tags = false;
-    int sample_rate = 16000; // 默认值
+    for (auto& item : sound->packets) {
+        auto packet = std::make_unique<AudioStreamPacket>();
+        packet->sample_rate = sound->sample_rate;
+        packet->frame_duration = 60;
+        packet->payload.assign(sound->data + item.offset, sound->data + item.offset + item.length);
+        PushPacketToDecodeQueue(std::move(packet), true);
+    }
+}
 
-    while (true) {
-        size_t pos = find_page(offset);
-        if (pos == static_cast<size_t>(-1)) break;
-        offset = pos;
-        if (offset + 27 > size) break;
-
-        const uint8_t* page = buf + offset;
-        uint8_t page_segments = page[26];
-        size_t seg_table_off = offset + 27;
-        if (seg_table_off + page_segments > size) break;
-
-        size_t body_size = 0;
-        for (size_t i = 0; i < page_segments; ++i) body_size += page[27 + i];
-
-        size_t body_off = seg_table_off + page_segments;
-        if (body_off + body_size > size) break;
-
-        // Parse packets using lacing
-        size_t cur = body_off;
-        size_t seg_idx = 0;
-        while (seg_idx < page_segments) {
-            size_t pkt_len = 0;
-            size_t pkt_start = cur;
-            bool continued = false;
-            do {
-                uint8_t l = page[27 + seg_idx++];
-                pkt_len += l;
-                cur += l;
-                continued = (l == 255);
-            } while (continued && seg_idx < page_segments);
-
-            if (pkt_len == 0) continue;
-            const uint8_t* pkt_ptr = buf + pkt_start;
-
-            if (!seen_head) {
-                // 解析OpusHead包
-                if (pkt_len >= 19 && std::memcmp(pkt_ptr, "OpusHead", 8) == 0) {
-                    seen_head = true;
-                    // OpusHead结构：[0-7] "OpusHead", [8] version, [9] channel_count, [10-11] pre_skip
-                    // [12-15] input_sample_rate, [16-17] output_gain, [18] mapping_family
-                    if (pkt_len >= 12) {
-                        uint8_t version = pkt_ptr[8];
-                        uint8_t channel_count = pkt_ptr[9];
-                        if (pkt_len >= 16) {
-                            // 读取输入采样率 (little-endian)
-                            sample_rate = pkt_ptr[12] | (pkt_ptr[13] << 8) |
-                                        (pkt_ptr[14] << 16) | (pkt_ptr[15] << 24);
-                            ESP_LOGI(TAG, "OpusHead: version=%d, channels=%d, sample_rate=%d",
-                                   version, channel_count, sample_rate);
-                        }
-                    }
-                }
-                continue;
-            }
-            if (!seen_tags) {
-                // Expect OpusTags in second packet
-                if (pkt_len >= 8 && std::memcmp(pkt_ptr, "OpusTags", 8) == 0) {
-                    seen_tags = true;
-                }
-                continue;
-            }
+void AudioService::PreloadSound(const std::string_view& ogg) {
+    sound_bank_.Load(ogg, codec_->output_sample_rate(), true);
+}
 
-            // Audio packet (Opus)
-            auto packet = std::make_unique<AudioStreamPacket>();
-            packet->sample_rate = sample_rate;
-            packet->frame_duration = 60;
-            packet->payload.resize(pkt_len);
-            std::memcpy(packet->payload.data(), pkt_ptr, pkt_len);
-            PushPacketToDecodeQueue(std::move(packet), true);
-        }
+void AudioService::SetStreamGain(AudioStreamType stream, float gain) {
+    mixer_.SetGain(stream, gain);
+}
 
-        offset = body_off + body_size;
+bool AudioService::HasPendingSounds() const {
+    for (int i = kAudioStreamSound; i < kAudioStreamCount; i++) {
+        if (!pending_sounds_[i].empty()) {
+            return true;
+        }
     }
+    return false;
 }
 
 bool AudioService::IsIdle() {
     std::lock_guard<std::mutex> lock(audio_queue_mutex_);
-    return audio_encode_queue_.empty() && audio_decode_queue_.empty() && audio_playback_queue_.empty() && audio_testing_queue_.empty();
+    return audio_encode_queue_.empty() && audio_decode_queue_.empty() && audio_playback_queue_.empty() && audio_testing_queue_.empty() &&
+        !HasPendingSounds();
 }
 
 void AudioService::WaitForPlaybackQueueEmpty() {
     std::unique_lock<std::mutex> lock(audio_queue_mutex_);
     audio_queue_cv_.wait(lock, [this]() { 
-        return service_stopped_ || (audio_decode_queue_.empty() && audio_playback_queue_.empty()); 
+        return service_stopped_ || (audio_decode_queue_.empty() && audio_playback_queue_.empty() && !HasPendingSounds());
     });
 }
 
@@ -780,9 +764,14 @@ void AudioService::SetModelsList(srmodel_list_t* models_list) {
     models_list_ = models_list;
 
 #if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
-    if (esp_srmodel_filter(models_list_, ESP_MN_PREFIX, NULL) != nullptr) {
+    bool has_multinet = esp_srmodel_filter(models_list_, ESP_MN_PREFIX, NULL) != nullptr;
+    bool has_wakenet = esp_srmodel_filter(models_list_, ESP_WN_PREFIX, NULL) != nullptr;
+    if (has_multinet && has_wakenet) {
+        // wakenet 唤醒词与 multinet 命令词同时启用，共用一个 AFE 前端
+        wake_word_ = std::make_unique<MultiWakeWord>();
+    } else if (has_multinet) {
         wake_word_ = std::make_unique<CustomWakeWord>();
-    } else if (esp_srmodel_filter(models_list_, ESP_WN_PREFIX, NULL) != nullptr) {
+    } else if (has_wakenet) {
         wake_word_ = std::make_unique<AfeWakeWord>();
     } else {
         wake_word_ = nullptr;
@@ -801,6 +790,11 @@ void AudioService::SetModelsList(srmodel_list_t* models_list) {
                 callbacks_.on_wake_word_detected(wake_word);
             }
         });
+        wake_word_->OnCommandDetected([this](const std::string& text, const std::string& action, const std::string& arguments) {
+            if (callbacks_.on_command_detected) {
+                callbacks_.on_command_detected(text, action, arguments);
+            }
+        });
     }
 }
 
@@ -2,6 +2,7 @@
 #define AUDIO_SERVICE_H
 
 #include <memory>
+#include <atomic>
 #include <deque>
 #include <condition_variable>
 #include <chrono>
@@ -15,11 +16,14 @@
 #include "esp_audio_enc.h"
 #include "esp_opus_enc.h"
 #include "esp_opus_dec.h"
-#include "esp_ae_rate_cvt.h"
 #include "esp_audio_types.h"
 
 #include "audio_codec.h"
 #include "audio_processor.h"
+#include "sound_bank.h"
+#include "audio_mixer.h"
+#include "resampler.h"
+#include "audio_metrics.h"
 #include "processors/audio_debugger.h"
 #include "wake_word.h"
 #include "protocol.h"
@@ -78,6 +82,7 @@
 struct AudioServiceCallbacks {
     std::function<void(void)> on_send_queue_available;
     std::function<void(const std::string&)> on_wake_word_detected;
+    std::function<void(const std::string& text, const std::string& action, const std::string& arguments)> on_command_detected;
     std::function<void(bool)> on_vad_change;
     std::function<void(void)> on_audio_testing_queue_full;
 };
@@ -95,6 +100,13 @@ struct AudioTask {
     uint32_t timestamp;
 };
 
+// 已缓存 PCM 的提示音，由输出任务直接读取
+struct PendingSound {
+    const SoundBank::Sound* sound;
+    size_t offset;
+    int64_t request_time_us;    // PlaySound 调用时间，用于统计提示音启动延迟
+};
+
 struct DebugStatistics {
     uint32_t input_count = 0;
     uint32_t decode_count = 0;
@@ -129,7 +141,10 @@ public:
 
     bool PushPacketToDecodeQueue(std::unique_ptr<AudioStreamPacket> packet, bool wait = false);
     std::unique_ptr<AudioStreamPacket> PopPacketFromSendQueue();
-    void PlaySound(const std::string_view& sound);
+    void PlaySound(const std::string_view& sound, AudioStreamType stream = kAudioStreamSound);
+    void PreloadSound(const std::string_view& sound);
+    void SetStreamGain(AudioStreamType stream, float gain);
+    std::string GetAudioMetricsJson(bool reset = false) { return metrics_.GetSummaryJson(reset); }
     bool ReadAudioData(std::vector<int16_t>& data, int sample_rate, int samples);
     void ResetDecoder();
     void SetModelsList(srmodel_list_t* models_list);
@@ -144,8 +159,10 @@ private:
     void* opus_decoder_ = nullptr;
     std::mutex decoder_mutex_;
     std::mutex input_resampler_mutex_;
-    esp_ae_rate_cvt_handle_t input_resampler_ = nullptr;
-    esp_ae_rate_cvt_handle_t output_resampler_ = nullptr;
+    Resampler input_resampler_;
+    Resampler output_resampler_;
+    std::vector<int16_t> input_buffer_;
+    std::vector<int16_t> decode_buffer_;
     
     // Encoder/Decoder state
     int encoder_sample_rate_ = 16000;
@@ -157,6 +174,8 @@ private:
     int decoder_frame_size_ = 0;
     DebugStatistics debug_statistics_;
     srmodel_list_t* models_list_ = nullptr;
+    SoundBank sound_bank_;
+    AudioMetrics metrics_;
 
     EventGroupHandle_t event_group_;
 
@@ -171,13 +190,18 @@ private:
     std::deque<std::unique_ptr<AudioStreamPacket>> audio_testing_queue_;
     std::deque<std::unique_ptr<AudioTask>> audio_encode_queue_;
     std::deque<std::unique_ptr<AudioTask>> audio_playback_queue_;
+    // 每路一个队列，同一路内的提示音依次播放，不同路之间混音 (kAudioStreamVoice 不使用)
+    std::deque<PendingSound> pending_sounds_[kAudioStreamCount];
+    AudioMixer mixer_;
+    std::vector<int16_t> mix_frame_;
     // For server AEC
     std::deque<uint32_t> timestamp_queue_;
 
     bool wake_word_initialized_ = false;
     bool audio_processor_initialized_ = false;
     bool voice_detected_ = false;
-    bool service_stopped_ = true;
+    // 输入、输出和编解码任务在锁外读取
+    std::atomic<bool> service_stopped_{true};
     bool audio_input_need_warmup_ = false;
 
     esp_timer_handle_t audio_power_timer_ = nullptr;
@@ -190,6 +214,7 @@ private:
     void PushTaskToEncodeQueue(AudioTaskType type, std::vector<int16_t>&& pcm);
     void SetDecodeSampleRate(int sample_rate, int frame_duration);
     void CheckAndUpdateAudioPowerState();
+    bool HasPendingSounds() const;
 };
 
 #endif
\ No newline at end of file
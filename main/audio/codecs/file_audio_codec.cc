@@ -0,0 +1,177 @@
+#include "file_audio_codec.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+
+#include <cstring>
+
+#define TAG "FileAudioCodec"
+
+// Rewrite the output WAV header about once per second so an interrupted run still leaves a valid file
+#define OUTPUT_HEADER_UPDATE_BYTES (32 * 1024)
+
+// Resynchronize the sample clock after a stall instead of bursting to catch up
+#define MAX_CLOCK_LAG_US (200 * 1000)
+
+struct WavFormat {
+    uint16_t format;
+    uint16_t channels;
+    uint32_t sample_rate;
+    uint32_t byte_rate;
+    uint16_t block_align;
+    uint16_t bits_per_sample;
+};
+
+FileAudioCodec::FileAudioCodec(const std::string& input_path, const std::string& output_path, int output_sample_rate, bool realtime)
+    : realtime_(realtime) {
+    duplex_ = true;
+    input_reference_ = false;
+    input_channels_ = 1;
+    input_sample_rate_ = 16000;
+    output_sample_rate_ = output_sample_rate;
+
+    if (!input_path.empty() && !OpenInput(input_path)) {
+        input_finished_ = true;
+    }
+    if (!output_path.empty()) {
+        output_file_ = fopen(output_path.c_str(), "wb");
+        if (output_file_ == nullptr) {
+            ESP_LOGE(TAG, "Failed to create %s", output_path.c_str());
+        } else {
+            WriteOutputHeader();
+        }
+    }
+}
+
+FileAudioCodec::~FileAudioCodec() {
+    if (input_file_ != nullptr) {
+        fclose(input_file_);
+    }
+    if (output_file_ != nullptr) {
+        WriteOutputHeader();
+        fclose(output_file_);
+    }
+}
+
+bool FileAudioCodec::OpenInput(const std::string& path) {
+    input_file_ = fopen(path.c_str(), "rb");
+    if (input_file_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to open %s", path.c_str());
+        return false;
+    }
+
+    char riff[12];
+    if (fread(riff, 1, sizeof(riff), input_file_) != sizeof(riff) || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        ESP_LOGE(TAG, "%s is not a WAV file", path.c_str());
+        fclose(input_file_);
+        input_file_ = nullptr;
+        return false;
+    }
+
+    // Walk the chunks until the data chunk, the file position is left at the first sample
+    WavFormat format = {};
+    bool has_format = false;
+    char chunk_id[4];
+    uint32_t chunk_size;
+    while (fread(chunk_id, 1, 4, input_file_) == 4 && fread(&chunk_size, 4, 1, input_file_) == 1) {
+        if (memcmp(chunk_id, "fmt ", 4) == 0 && chunk_size >= sizeof(WavFormat)) {
+            has_format = fread(&format, sizeof(format), 1, input_file_) == 1;
+            chunk_size -= sizeof(format);
+        } else if (memcmp(chunk_id, "data", 4) == 0) {
+            if (!has_format || format.format != 1 || format.bits_per_sample != 16 || format.channels < 1 || format.channels > 2) {
+                ESP_LOGE(TAG, "%s must be 16-bit PCM with 1 or 2 channels", path.c_str());
+                break;
+            }
+            input_channels_ = format.channels;
+            input_reference_ = format.channels == 2;
+            input_sample_rate_ = format.sample_rate;
+            ESP_LOGI(TAG, "Replaying %s: %lu Hz, %d channels, %lu ms", path.c_str(), (unsigned long)format.sample_rate,
+                format.channels, (unsigned long)((uint64_t)chunk_size * 1000 / format.byte_rate));
+            return true;
+        }
+        // Chunks are padded to an even size
+        fseek(input_file_, chunk_size + (chunk_size & 1), SEEK_CUR);
+    }
+
+    ESP_LOGE(TAG, "No usable audio in %s", path.c_str());
+    fclose(input_file_);
+    input_file_ = nullptr;
+    return false;
+}
+
+void FileAudioCodec::WriteOutputHeader() {
+    WavFormat format = {
+        .format = 1,
+        .channels = 1,
+        .sample_rate = static_cast<uint32_t>(output_sample_rate_),
+        .byte_rate = static_cast<uint32_t>(output_sample_rate_) * 2,
+        .block_align = 2,
+        .bits_per_sample = 16,
+    };
+    uint32_t riff_size = 36 + output_bytes_;
+    uint32_t format_size = sizeof(format);
+
+    long position = ftell(output_file_);
+    fseek(output_file_, 0, SEEK_SET);
+    fwrite("RIFF", 1, 4, output_file_);
+    fwrite(&riff_size, 4, 1, output_file_);
+    fwrite("WAVEfmt ", 1, 8, output_file_);
+    fwrite(&format_size, 4, 1, output_file_);
+    fwrite(&format, sizeof(format), 1, output_file_);
+    fwrite("data", 1, 4, output_file_);
+    fwrite(&output_bytes_, 4, 1, output_file_);
+    if (position > 0) {
+        fseek(output_file_, position, SEEK_SET);
+    }
+    fflush(output_file_);
+    header_bytes_ = output_bytes_;
+}
+
+void FileAudioCodec::Pace(SampleClock& clock, int frames, int sample_rate) {
+    if (!realtime_ || sample_rate <= 0) {
+        return;
+    }
+    int64_t now_us = esp_timer_get_time();
+    int64_t due_us = clock.start_us + clock.frames * 1000000 / sample_rate;
+    if (clock.start_us == 0 || now_us - due_us > MAX_CLOCK_LAG_US) {
+        clock.start_us = now_us;
+        clock.frames = 0;
+    }
+    clock.frames += frames;
+    // Block until the end of this buffer, like a DMA read or write would
+    int64_t end_us = clock.start_us + clock.frames * 1000000 / sample_rate;
+    if (end_us > now_us) {
+        vTaskDelay(pdMS_TO_TICKS((end_us - now_us + 999) / 1000));
+    }
+}
+
+int FileAudioCodec::Read(int16_t* dest, int samples) {
+    Pace(input_clock_, samples / input_channels_, input_sample_rate_);
+    size_t count = 0;
+    if (input_file_ != nullptr) {
+        count = fread(dest, sizeof(int16_t), samples, input_file_);
+        if (count < static_cast<size_t>(samples)) {
+            ESP_LOGI(TAG, "Input finished");
+            fclose(input_file_);
+            input_file_ = nullptr;
+            input_finished_ = true;
+        }
+    }
+    // Silence after the end of the recording, so VAD and wake word see the speech end
+    memset(dest + count, 0, (samples - count) * sizeof(int16_t));
+    return samples;
+}
+
+int FileAudioCodec::Write(const int16_t* data, int samples) {
+    Pace(output_clock_, samples, output_sample_rate_);
+    if (output_file_ == nullptr || !output_enabled_) {
+        return samples;
+    }
+    fwrite(data, sizeof(int16_t), samples, output_file_);
+    output_bytes_ += samples * sizeof(int16_t);
+    if (output_bytes_ - header_bytes_ >= OUTPUT_HEADER_UPDATE_BYTES) {
+        WriteOutputHeader();
+    }
+    return samples;
+}
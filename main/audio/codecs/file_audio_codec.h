@@ -0,0 +1,53 @@
+#ifndef _FILE_AUDIO_CODEC_H
+#define _FILE_AUDIO_CODEC_H
+
+#include "audio_codec.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+/*
+ * 文件音频编解码器
+ *
+ * 用 WAV 文件代替麦克风和扬声器，用于可复现的回归和性能测试：
+ * - 输入文件按采样率实时回放给 InputData，播放结束后输出静音。双声道文件作为 麦克风 + 回采 参考
+ * - OutputData 写入的 PCM 保存为单声道 WAV
+ * - realtime 为 true 时按采样时钟节拍阻塞，和 I2S 的时序一致
+ *
+ * 路径可以是 SD 卡或 SPIFFS 上的文件，例如 /sdcard/session1.wav，也用于 test/host 下的主机管线测试
+ * Read 和 Write 分别只在输入、输出任务中调用，两边的状态互不共享
+ */
+class FileAudioCodec : public AudioCodec {
+public:
+    FileAudioCodec(const std::string& input_path, const std::string& output_path, int output_sample_rate, bool realtime = true);
+    virtual ~FileAudioCodec();
+
+    // True once the whole input file has been played
+    bool input_finished() const { return input_finished_; }
+
+protected:
+    virtual int Read(int16_t* dest, int samples) override;
+    virtual int Write(const int16_t* data, int samples) override;
+
+private:
+    struct SampleClock {
+        int64_t start_us = 0;
+        int64_t frames = 0;
+    };
+
+    FILE* input_file_ = nullptr;
+    FILE* output_file_ = nullptr;
+    bool realtime_;
+    std::atomic<bool> input_finished_{false};
+    uint32_t output_bytes_ = 0;
+    uint32_t header_bytes_ = 0;         // Output size already written to the WAV header
+    SampleClock input_clock_;
+    SampleClock output_clock_;
+
+    bool OpenInput(const std::string& path);
+    void WriteOutputHeader();
+    void Pace(SampleClock& clock, int frames, int sample_rate);
+};
+
+#endif // _FILE_AUDIO_CODEC_H
@@ -1,7 +1,8 @@
 #include "no_audio_codec.h"
+#include "pcm_convert.h"
 
 #include <esp_log.h>
-#include <cmath>
+#include <algorithm>
 #include <cstring>
 
 #define TAG "NoAudioCodec"
@@ -216,42 +217,42 @@ NoAudioCodecSimplex::NoAudioCodecSimplex(int input_sample_rate, int output_sampl
 
 int NoAudioCodec::Write(const int16_t* data, int samples) {
     std::lock_guard<std::mutex> lock(data_if_mutex_);
-    std::vector<int32_t> buffer(samples);
-
-    // output_volume_: 0-100
-    // volume_factor_: 0-65536
-    int32_t volume_factor = pow(double(output_volume_) / 100.0, 2) * 65536;
-    for (int i = 0; i < samples; i++) {
-        int64_t temp = int64_t(data[i]) * volume_factor; // 使用 int64_t 进行乘法运算
-        if (temp > INT32_MAX) {
-            buffer[i] = INT32_MAX;
-        } else if (temp < INT32_MIN) {
-            buffer[i] = INT32_MIN;
-        } else {
-            buffer[i] = static_cast<int32_t>(temp);
+
+    // output_volume_: 0-100 -> Q16 gain 0-65536
+    int32_t gain = pcm_volume_to_gain_q16(output_volume_);
+    int written = 0;
+    while (written < samples) {
+        int chunk = std::min(samples - written, (int)AUDIO_CODEC_DMA_FRAME_NUM);
+        pcm_s16_to_s32(data + written, tx_buffer_, chunk, gain);
+
+        size_t bytes_written;
+        ESP_ERROR_CHECK(i2s_channel_write(tx_handle_, tx_buffer_, chunk * sizeof(int32_t), &bytes_written, portMAX_DELAY));
+        written += bytes_written / sizeof(int32_t);
+        if (bytes_written < chunk * sizeof(int32_t)) {
+            break;
         }
     }
-
-    size_t bytes_written;
-    ESP_ERROR_CHECK(i2s_channel_write(tx_handle_, buffer.data(), samples * sizeof(int32_t), &bytes_written, portMAX_DELAY));
-    return bytes_written / sizeof(int32_t);
+    return written;
 }
 
 int NoAudioCodec::Read(int16_t* dest, int samples) {
-    size_t bytes_read;
-
-    std::vector<int32_t> bit32_buffer(samples);
-    if (i2s_channel_read(rx_handle_, bit32_buffer.data(), samples * sizeof(int32_t), &bytes_read, portMAX_DELAY) != ESP_OK) {
-        ESP_LOGE(TAG, "Read Failed!");
-        return 0;
-    }
+    int total = 0;
+    while (total < samples) {
+        int chunk = std::min(samples - total, (int)AUDIO_CODEC_DMA_FRAME_NUM);
+        size_t bytes_read;
+        if (i2s_channel_read(rx_handle_, rx_buffer_, chunk * sizeof(int32_t), &bytes_read, portMAX_DELAY) != ESP_OK) {
+            ESP_LOGE(TAG, "Read Failed!");
+            return total;
+        }
 
-    samples = bytes_read / sizeof(int32_t);
-    for (int i = 0; i < samples; i++) {
-        int32_t value = bit32_buffer[i] >> 12;
-        dest[i] = (value > INT16_MAX) ? INT16_MAX : (value < -INT16_MAX) ? -INT16_MAX : (int16_t)value;
+        int got = bytes_read / sizeof(int32_t);
+        pcm_s32_to_s16(rx_buffer_, dest + total, got, 12);
+        total += got;
+        if (got < chunk) {
+            break;
+        }
     }
-    return samples;
+    return total;
 }
 
 // Delegating constructor: calls the main constructor with default slot mask
@@ -349,11 +350,7 @@ int NoAudioCodecSimplexPdm::Read(int16_t* dest, int samples) {
 
     samples = bytes_read / sizeof(int16_t);
     if (input_gain_ > 0) {
-        int gain_factor = (int)input_gain_;
-        for (int i = 0; i < samples; i++) {
-            int32_t amplified = dest[i] * gain_factor;
-            dest[i] = (amplified > INT16_MAX) ? INT16_MAX : (amplified < -INT16_MAX) ? -INT16_MAX : (int16_t)amplified;
-        }
+        pcm_s16_apply_gain(dest, samples, (int)input_gain_);
     }
     return samples;
 }
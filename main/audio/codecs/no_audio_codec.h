@@ -10,6 +10,9 @@
 class NoAudioCodec : public AudioCodec {
 protected:
     std::mutex data_if_mutex_;
+    // 32 位 I2S 中转缓冲区，按块复用，避免每帧分配内存
+    int32_t tx_buffer_[AUDIO_CODEC_DMA_FRAME_NUM];
+    int32_t rx_buffer_[AUDIO_CODEC_DMA_FRAME_NUM];
 
     virtual int Write(const int16_t* data, int samples) override;
     virtual int Read(int16_t* dest, int samples) override;
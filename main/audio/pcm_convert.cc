@@ -0,0 +1,123 @@
+#include "pcm_convert.h"
+
+#include <algorithm>
+
+static inline int32_t clamp_s16(int32_t value) {
+    return std::min<int32_t>(std::max<int32_t>(value, -INT16_MAX), INT16_MAX);
+}
+
+int32_t pcm_volume_to_gain_q16(int volume) {
+    volume = std::clamp(volume, 0, 100);
+    // 整数运算，与 pow(volume / 100.0, 2) * 65536 的截断结果一致
+    return (int32_t)((int64_t)volume * volume * 65536 / 10000);
+}
+
+void pcm_s16_to_s32(const int16_t* src, int32_t* dst, size_t samples, int32_t gain_q16) {
+    const int32_t gain = std::clamp<int32_t>(gain_q16, 0, 65536);
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        int32_t a = src[i], b = src[i + 1], c = src[i + 2], d = src[i + 3];
+        dst[i] = a * gain;
+        dst[i + 1] = b * gain;
+        dst[i + 2] = c * gain;
+        dst[i + 3] = d * gain;
+    }
+    for (; i < samples; i++) {
+        dst[i] = (int32_t)src[i] * gain;
+    }
+}
+
+void pcm_s16_to_s32_stereo(const int16_t* src, int32_t* dst, size_t frames, int32_t gain_q16) {
+    const int32_t gain = std::clamp<int32_t>(gain_q16, 0, 65536);
+    size_t i = 0;
+    for (; i + 2 <= frames; i += 2) {
+        int32_t a = (int32_t)src[i] * gain;
+        int32_t b = (int32_t)src[i + 1] * gain;
+        dst[2 * i] = a;
+        dst[2 * i + 1] = a;
+        dst[2 * i + 2] = b;
+        dst[2 * i + 3] = b;
+    }
+    for (; i < frames; i++) {
+        int32_t a = (int32_t)src[i] * gain;
+        dst[2 * i] = a;
+        dst[2 * i + 1] = a;
+    }
+}
+
+void pcm_s32_to_s16(const int32_t* src, int16_t* dst, size_t samples, int shift) {
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        int32_t a = src[i] >> shift, b = src[i + 1] >> shift;
+        int32_t c = src[i + 2] >> shift, d = src[i + 3] >> shift;
+        dst[i] = (int16_t)clamp_s16(a);
+        dst[i + 1] = (int16_t)clamp_s16(b);
+        dst[i + 2] = (int16_t)clamp_s16(c);
+        dst[i + 3] = (int16_t)clamp_s16(d);
+    }
+    for (; i < samples; i++) {
+        dst[i] = (int16_t)clamp_s16(src[i] >> shift);
+    }
+}
+
+void pcm_s16_apply_gain(int16_t* data, size_t samples, int gain) {
+    // |int16| * gain 在 gain <= 65535 时不会溢出 int32
+    const int32_t g = std::clamp(gain, 0, 65535);
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        int32_t a = data[i] * g, b = data[i + 1] * g;
+        int32_t c = data[i + 2] * g, d = data[i + 3] * g;
+        data[i] = (int16_t)clamp_s16(a);
+        data[i + 1] = (int16_t)clamp_s16(b);
+        data[i + 2] = (int16_t)clamp_s16(c);
+        data[i + 3] = (int16_t)clamp_s16(d);
+    }
+    for (; i < samples; i++) {
+        data[i] = (int16_t)clamp_s16(data[i] * g);
+    }
+}
+
+void pcm_s16_mac_q14(const int16_t* src, int32_t* acc, size_t samples, int32_t gain_from, int32_t gain_to) {
+    gain_from = std::clamp<int32_t>(gain_from, 0, 16384);
+    gain_to = std::clamp<int32_t>(gain_to, 0, 16384);
+    size_t i = 0;
+    if (gain_from == gain_to) {
+        const int32_t g = gain_from;
+        for (; i + 4 <= samples; i += 4) {
+            int32_t a = src[i] * g, b = src[i + 1] * g;
+            int32_t c = src[i + 2] * g, d = src[i + 3] * g;
+            acc[i] += a;
+            acc[i + 1] += b;
+            acc[i + 2] += c;
+            acc[i + 3] += d;
+        }
+        for (; i < samples; i++) {
+            acc[i] += src[i] * g;
+        }
+        return;
+    }
+    if (samples == 0) {
+        return;
+    }
+    // 增益以 Q14.16 递增，|gain_to - gain_from| << 16 不超过 2^30
+    const int32_t step = (int32_t)(((int64_t)(gain_to - gain_from) << 16) / (int64_t)samples);
+    int32_t g = gain_from << 16;
+    for (; i < samples; i++) {
+        acc[i] += src[i] * (g >> 16);
+        g += step;
+    }
+}
+
+void pcm_s16_extract_channel(const int16_t* src, int16_t* dst, size_t frames, int channels, int channel) {
+    // 前向遍历时读位置始终不小于写位置，因此允许原地操作
+    const int16_t* p = src + channel;
+    if (channels == 2) {
+        for (size_t i = 0; i < frames; i++) {
+            dst[i] = p[2 * i];
+        }
+        return;
+    }
+    for (size_t i = 0; i < frames; i++) {
+        dst[i] = p[i * channels];
+    }
+}
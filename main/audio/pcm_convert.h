@@ -0,0 +1,44 @@
+#ifndef PCM_CONVERT_H
+#define PCM_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * PCM 采样格式转换工具
+ *
+ * 所有函数均不分配内存，可在音频输入/输出任务中直接调用。
+ * 内核采用无分支的饱和运算，每次循环处理 4 个采样，便于编译器在
+ * Xtensa (MIN/MAX) 和 RISC-V 上生成紧凑的指令序列。
+ */
+
+// Q16 fixed-point gain for the 16-bit to 32-bit I2S output path.
+// 音量 0-100 映射为 (volume / 100)^2 * 65536，结果范围 [0, 65536]
+int32_t pcm_volume_to_gain_q16(int volume);
+
+// Widen 16-bit samples to 32-bit with a Q16 gain.
+// gain_q16 is clamped to [0, 65536], so the product always fits in int32 and
+// no per-sample saturation is needed.
+void pcm_s16_to_s32(const int16_t* src, int32_t* dst, size_t samples, int32_t gain_q16);
+
+// Same as pcm_s16_to_s32 but duplicates each mono sample into an L/R pair.
+// dst must hold 2 * frames samples.
+void pcm_s16_to_s32_stereo(const int16_t* src, int32_t* dst, size_t frames, int32_t gain_q16);
+
+// Narrow 32-bit samples to 16-bit: arithmetic shift right, then saturate to [-32767, 32767].
+// src and dst may not overlap.
+void pcm_s32_to_s16(const int32_t* src, int16_t* dst, size_t samples, int shift);
+
+// In-place integer gain with saturation to [-32767, 32767].
+void pcm_s16_apply_gain(int16_t* data, size_t samples, int gain);
+
+// Multiply-accumulate 16-bit samples into a Q14 accumulator: acc[i] += src[i] * gain.
+// The gain ramps linearly from gain_from to gain_to across the block (equal values give a
+// constant gain). Gains are clamped to [0, 16384] (0.0 - 1.0), so up to 4 full-scale
+// sources can be summed without overflowing int32. Narrow with pcm_s32_to_s16(..., 14).
+void pcm_s16_mac_q14(const int16_t* src, int32_t* acc, size_t samples, int32_t gain_from, int32_t gain_to);
+
+// Extract one channel from interleaved samples. dst may alias src (in-place compaction).
+void pcm_s16_extract_channel(const int16_t* src, int16_t* dst, size_t frames, int channels, int channel);
+
+#endif // PCM_CONVERT_H
@@ -3,18 +3,83 @@
 
 #if CONFIG_USE_AUDIO_DEBUGGER
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <errno.h>
 #include <cstring>
 #include <string>
+#include <algorithm>
 #endif
 
 #define TAG "AudioDebugger"
 
+// 单个 UDP 包的最大负载，避免 IP 分片
+#define AUDIO_DEBUG_MAX_PAYLOAD 1400
+#define AUDIO_DEBUG_MAX_CHANNELS 4
+
+#if CONFIG_USE_AUDIO_DEBUGGER
+static const int16_t kImaStepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t kImaIndexTable[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+static uint8_t ima_encode(int16_t sample, int16_t& predictor, uint8_t& step_index) {
+    int32_t step = kImaStepTable[step_index];
+    int32_t diff = sample - predictor;
+    uint8_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    int32_t vpdiff = step >> 3;
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 2;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 1;
+        vpdiff += step;
+    }
+    int32_t p = (code & 8) ? predictor - vpdiff : predictor + vpdiff;
+    predictor = (int16_t)std::clamp<int32_t>(p, INT16_MIN, INT16_MAX);
+    step_index = (uint8_t)std::clamp<int>(step_index + kImaIndexTable[code & 7], 0, 88);
+    return code;
+}
+#endif
 
 AudioDebugger::AudioDebugger() {
 #if CONFIG_USE_AUDIO_DEBUGGER
+#if CONFIG_AUDIO_DEBUG_TAP_MIC
+    tap_mask_ |= 1 << kAudioDebugTapMic;
+#endif
+#if CONFIG_AUDIO_DEBUG_TAP_REFERENCE
+    tap_mask_ |= 1 << kAudioDebugTapReference;
+#endif
+#if CONFIG_AUDIO_DEBUG_TAP_PROCESSED
+    tap_mask_ |= 1 << kAudioDebugTapProcessed;
+#endif
+#if CONFIG_AUDIO_DEBUG_TAP_PLAYBACK
+    tap_mask_ |= 1 << kAudioDebugTapPlayback;
+#endif
+#if CONFIG_AUDIO_DEBUG_ADPCM
+    encoding_ = kAudioDebugEncodingImaAdpcm;
+#endif
+
     udp_sockfd_ = socket(AF_INET, SOCK_DGRAM, 0);
     if (udp_sockfd_ >= 0) {
         // 解析配置的服务器地址 "IP:PORT"
@@ -30,7 +95,8 @@ AudioDebugger::AudioDebugger() {
             udp_server_addr_.sin_port = htons(port);
             inet_pton(AF_INET, ip.c_str(), &udp_server_addr_.sin_addr);
             
-            ESP_LOGI(TAG, "Initialized server address: %s", CONFIG_AUDIO_DEBUG_UDP_SERVER);
+            ESP_LOGI(TAG, "Initialized server address: %s, taps: 0x%lx, encoding: %s", CONFIG_AUDIO_DEBUG_UDP_SERVER,
+                tap_mask_, encoding_ == kAudioDebugEncodingImaAdpcm ? "IMA ADPCM" : "PCM16");
         } else {
             ESP_LOGW(TAG, "Invalid server address: %s, should be IP:PORT", CONFIG_AUDIO_DEBUG_UDP_SERVER);
             close(udp_sockfd_);
@@ -51,18 +117,102 @@ AudioDebugger::~AudioDebugger() {
 #endif
 }
 
-void AudioDebugger::Feed(const std::vector<int16_t>& data) {
+void AudioDebugger::Feed(AudioDebugTap tap, const int16_t* data, size_t frames, int channels, int sample_rate,
+                         uint32_t channel_mask) {
 #if CONFIG_USE_AUDIO_DEBUGGER
-    if (udp_sockfd_ >= 0) {
-        ssize_t sent = sendto(udp_sockfd_, data.data(), data.size() * sizeof(int16_t), 0,
-                             (struct sockaddr*)&udp_server_addr_, sizeof(udp_server_addr_));
-        if (sent < 0) {
-            ESP_LOGW(TAG, "Failed to send audio data to %s: %d", CONFIG_AUDIO_DEBUG_UDP_SERVER, errno);
-        } else {
-            ESP_LOGD(TAG, "Sent %d bytes audio data to %s", sent, CONFIG_AUDIO_DEBUG_UDP_SERVER);
+    if (udp_sockfd_ < 0 || (tap_mask_ & (1 << tap)) == 0 || frames == 0) {
+        return;
+    }
+    int64_t timestamp_us = esp_timer_get_time();
+    auto& state = taps_[tap];
+
+    // 取出选中的通道
+    int selected[AUDIO_DEBUG_MAX_CHANNELS];
+    int out_channels = 0;
+    for (int ch = 0; ch < channels && out_channels < AUDIO_DEBUG_MAX_CHANNELS; ch++) {
+        if (channel_mask & (1 << ch)) {
+            selected[out_channels++] = ch;
         }
     }
+    if (out_channels == 0) {
+        return;
+    }
+    const int16_t* samples = data;
+    if (out_channels != channels) {
+        state.samples.resize(frames * out_channels);
+        for (size_t i = 0; i < frames; i++) {
+            for (int c = 0; c < out_channels; c++) {
+                state.samples[i * out_channels + c] = data[i * channels + selected[c]];
+            }
+        }
+        samples = state.samples.data();
+    }
+
+    size_t max_frames;
+    if (encoding_ == kAudioDebugEncodingImaAdpcm) {
+        max_frames = (AUDIO_DEBUG_MAX_PAYLOAD - 4 * out_channels) * 2 / out_channels;
+    } else {
+        max_frames = AUDIO_DEBUG_MAX_PAYLOAD / (sizeof(int16_t) * out_channels);
+    }
+    for (size_t offset = 0; offset < frames; offset += max_frames) {
+        size_t n = std::min(max_frames, frames - offset);
+        SendPacket(tap, state, samples + offset * out_channels, n, out_channels, sample_rate,
+            timestamp_us + (int64_t)offset * 1000000 / sample_rate);
+    }
 #endif
 }
 
- 
\ No newline at end of file
+void AudioDebugger::SendPacket(AudioDebugTap tap, TapState& state, const int16_t* data, size_t frames, int channels,
+                               int sample_rate, int64_t timestamp_us) {
+#if CONFIG_USE_AUDIO_DEBUGGER
+    AudioDebugHeader header = {
+        .magic = {'A', 'D'},
+        .version = 1,
+        .tap = (uint8_t)tap,
+        .encoding = (uint8_t)encoding_,
+        .channels = (uint8_t)channels,
+        .samples = (uint16_t)frames,
+        .sequence = state.sequence++,
+        .sample_rate = (uint32_t)sample_rate,
+        .sample_index = state.sample_index,
+        .timestamp_us = (uint64_t)timestamp_us,
+    };
+    state.sample_index += frames;
+
+    auto& packet = state.packet;
+    packet.resize(sizeof(header));
+    memcpy(packet.data(), &header, sizeof(header));
+
+    if (encoding_ == kAudioDebugEncodingImaAdpcm) {
+        for (int ch = 0; ch < channels; ch++) {
+            int16_t predictor = state.predictor[ch];
+            packet.push_back(predictor & 0xFF);
+            packet.push_back((predictor >> 8) & 0xFF);
+            packet.push_back(state.step_index[ch]);
+            packet.push_back(0);
+        }
+        size_t total = frames * channels;
+        size_t base = packet.size();
+        packet.resize(base + (total + 1) / 2, 0);
+        for (size_t i = 0; i < total; i++) {
+            int ch = i % channels;
+            uint8_t code = ima_encode(data[i], state.predictor[ch], state.step_index[ch]);
+            packet[base + i / 2] |= (i & 1) ? (code << 4) : code;
+        }
+    } else {
+        size_t base = packet.size();
+        packet.resize(base + frames * channels * sizeof(int16_t));
+        memcpy(packet.data() + base, data, frames * channels * sizeof(int16_t));
+    }
+
+    // 不阻塞音频任务，网络拥塞时直接丢弃，由接收端根据序号统计丢包
+    ssize_t sent = sendto(udp_sockfd_, packet.data(), packet.size(), MSG_DONTWAIT,
+                         (struct sockaddr*)&udp_server_addr_, sizeof(udp_server_addr_));
+    if (sent < 0) {
+        if (++dropped_packets_ % 100 == 1) {
+            ESP_LOGW(TAG, "Failed to send audio data to %s: %d, dropped %lu packets",
+                CONFIG_AUDIO_DEBUG_UDP_SERVER, errno, dropped_packets_.load());
+        }
+    }
+#endif
+}
@@ -2,21 +2,76 @@
 #define AUDIO_DEBUGGER_H
 
 #include <vector>
+#include <atomic>
 #include <cstdint>
+#include <cstddef>
 
 #include <sys/socket.h>
 #include <netinet/in.h>
 
+// 音频调试数据的采集点
+enum AudioDebugTap {
+    kAudioDebugTapMic = 0,          // 麦克风原始数据 (重采样后，不含参考通道)
+    kAudioDebugTapReference = 1,    // AEC 参考通道
+    kAudioDebugTapProcessed = 2,    // 音频处理器 (AFE) 输出
+    kAudioDebugTapPlayback = 3,     // 写入 I2S 的播放数据
+    kAudioDebugTapCount,
+};
+
+enum AudioDebugEncoding {
+    kAudioDebugEncodingPcm16 = 0,
+    kAudioDebugEncodingImaAdpcm = 1,
+};
+
+/*
+ * UDP 包格式 (小端)：
+ *   AudioDebugHeader
+ *   [IMA ADPCM] 每通道 4 字节初始状态：int16 predictor, uint8 step_index, uint8 reserved
+ *   payload: PCM16 交织采样，或按采样顺序交织的 4 位 ADPCM 码 (低半字节在前)
+ * 每个包都带有解码所需的状态，丢包不会影响后续包的解码。
+ */
+struct __attribute__((packed)) AudioDebugHeader {
+    char magic[2];          // "AD"
+    uint8_t version;        // 1
+    uint8_t tap;            // AudioDebugTap
+    uint8_t encoding;       // AudioDebugEncoding
+    uint8_t channels;
+    uint16_t samples;       // 每通道采样数
+    uint32_t sequence;      // 每个采集点独立递增
+    uint32_t sample_rate;
+    uint64_t sample_index;  // 本包第一个采样在该采集点中的序号
+    uint64_t timestamp_us;  // 本包第一个采样的采集时间，用于多路对齐
+};
+
 class AudioDebugger {
 public:
     AudioDebugger();
     ~AudioDebugger();
 
-    void Feed(const std::vector<int16_t>& data);
+    // data: 交织的 channels 通道数据。只发送 channel_mask 选中的通道 (默认全部)
+    void Feed(AudioDebugTap tap, const int16_t* data, size_t frames, int channels, int sample_rate,
+              uint32_t channel_mask = 0xFFFFFFFF);
+    void SetTapMask(uint32_t mask) { tap_mask_ = mask; }
 
 private:
+    struct TapState {
+        uint32_t sequence = 0;
+        uint64_t sample_index = 0;
+        int16_t predictor[4] = {};
+        uint8_t step_index[4] = {};
+        std::vector<int16_t> samples;   // 选中通道的交织数据
+        std::vector<uint8_t> packet;
+    };
+
     int udp_sockfd_ = -1;
     struct sockaddr_in udp_server_addr_;
+    uint32_t tap_mask_ = 0;
+    AudioDebugEncoding encoding_ = kAudioDebugEncodingPcm16;
+    TapState taps_[kAudioDebugTapCount];
+    std::atomic<uint32_t> dropped_packets_ = 0;
+
+    void SendPacket(AudioDebugTap tap, TapState& state, const int16_t* data, size_t frames, int channels,
+                    int sample_rate, int64_t timestamp_us);
 };
 
-#endif 
\ No newline at end of file
+#endif 
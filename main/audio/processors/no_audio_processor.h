@@ -1,6 +1,7 @@
 #ifndef DUMMY_AUDIO_PROCESSOR_H
 #define DUMMY_AUDIO_PROCESSOR_H
 
+#include <atomic>
 #include <vector>
 #include <functional>
 
@@ -27,7 +28,7 @@ private:
     int frame_samples_ = 0;
     std::function<void(std::vector<int16_t>&& data)> output_callback_;
     std::function<void(bool speaking)> vad_state_change_callback_;
-    bool is_running_ = false;
+    std::atomic<bool> is_running_{false};    // Feed 在输入任务中调用
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "resampler.h"
+
+#include <esp_log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#define TAG "Resampler"
+
+// 每侧过零点数，决定过渡带宽度与每个输出样本的乘加次数
+#define RESAMPLER_ZERO_CROSSINGS 8
+// 截止频率相对于较低一侧奈奎斯特频率的比例
+#define RESAMPLER_CUTOFF 0.9
+// Kaiser 窗参数，约 70dB 阻带衰减
+#define RESAMPLER_KAISER_BETA 7.0
+
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+static inline int16_t saturate_q14(int32_t acc) {
+    acc = (acc + (1 << 13)) >> 14;
+    return (int16_t)std::min<int32_t>(std::max<int32_t>(acc, -INT16_MAX), INT16_MAX);
+}
+
+Resampler::~Resampler() {
+    Release();
+}
+
+void Resampler::Release() {
+    if (fallback_ != nullptr) {
+        esp_ae_rate_cvt_close(fallback_);
+        fallback_ = nullptr;
+    }
+    coefficients_.clear();
+    work_.clear();
+    channels_ = 0;
+}
+
+bool Resampler::Configure(int src_rate, int dest_rate, int channels) {
+    if (configured() && src_rate == src_rate_ && dest_rate == dest_rate_ && channels == channels_) {
+        return true;
+    }
+    Release();
+    src_rate_ = src_rate;
+    dest_rate_ = dest_rate;
+
+    int g = std::gcd(src_rate, dest_rate);
+    up_ = dest_rate / g;
+    down_ = src_rate / g;
+    if (up_ <= RESAMPLER_MAX_FACTOR && down_ <= RESAMPLER_MAX_FACTOR) {
+        channels_ = channels;
+        DesignFilter();
+        Reset();
+        ESP_LOGI(TAG, "Polyphase %d -> %d (L=%d M=%d, %d taps/phase)", src_rate, dest_rate, up_, down_, taps_);
+        return true;
+    }
+
+    esp_ae_rate_cvt_cfg_t cfg = {
+        .src_rate = (uint32_t)src_rate,
+        .dest_rate = (uint32_t)dest_rate,
+        .channel = (uint8_t)channels,
+        .bits_per_sample = ESP_AUDIO_BIT16,
+        .complexity = 2,
+        .perf_type = ESP_AE_RATE_CVT_PERF_TYPE_SPEED,
+    };
+    auto ret = esp_ae_rate_cvt_open(&cfg, &fallback_);
+    if (fallback_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to create resampler %d -> %d, error code: %d", src_rate, dest_rate, ret);
+        return false;
+    }
+    channels_ = channels;
+    ESP_LOGI(TAG, "Generic resampler %d -> %d", src_rate, dest_rate);
+    return true;
+}
+
+void Resampler::DesignFilter() {
+    // 以上采样后的速率设计原型低通，长度 N = L * taps
+    int factor = std::max(up_, down_);
+    taps_ = (2 * RESAMPLER_ZERO_CROSSINGS * factor + up_ - 1) / up_;
+    taps_ = (taps_ + 3) & ~3;
+    const int n = taps_ * up_;
+    const double fc = 0.5 / factor * RESAMPLER_CUTOFF;
+    const double center = (n - 1) / 2.0;
+    const double i0_beta = bessel_i0(RESAMPLER_KAISER_BETA);
+
+    std::vector<double> h(n);
+    for (int k = 0; k < n; k++) {
+        double t = k - center;
+        double x = 2.0 * fc * t;
+        double sinc = (t == 0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+        double r = t / (center + 0.5);
+        double w = bessel_i0(RESAMPLER_KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0_beta;
+        h[k] = 2.0 * fc * sinc * w;
+    }
+
+    // 每相单独归一化到单位直流增益，避免相间直流纹波
+    coefficients_.assign(up_ * taps_, 0);
+    for (int p = 0; p < up_; p++) {
+        double sum = 0;
+        for (int j = 0; j < taps_; j++) {
+            sum += h[p + j * up_];
+        }
+        for (int j = 0; j < taps_; j++) {
+            double c = h[p + j * up_] / sum * 16384.0;
+            coefficients_[p * taps_ + (taps_ - 1 - j)] = (int16_t)std::lround(c);
+        }
+    }
+}
+
+void Resampler::Reset() {
+    if (fallback_ != nullptr) {
+        esp_ae_rate_cvt_reset(fallback_);
+        return;
+    }
+    if (polyphase()) {
+        work_.assign((taps_ - 1) * channels_, 0);
+        phase_ = 0;
+        position_ = 0;
+    }
+}
+
+size_t Resampler::GetMaxOutputFrames(size_t in_frames) const {
+    if (fallback_ != nullptr) {
+        uint32_t out = 0;
+        esp_ae_rate_cvt_get_max_out_sample_num(fallback_, in_frames, &out);
+        return out;
+    }
+    return (in_frames * up_ + down_ - 1) / down_ + 1;
+}
+
+size_t Resampler::Process(const int16_t* in, size_t in_frames, int16_t* out) {
+    if (fallback_ != nullptr) {
+        uint32_t out_frames = GetMaxOutputFrames(in_frames);
+        esp_ae_rate_cvt_process(fallback_, (esp_ae_sample_t)in, in_frames, (esp_ae_sample_t)out, &out_frames);
+        return out_frames;
+    }
+    if (!polyphase()) {
+        return 0;
+    }
+
+    // 历史样本之后追加本次输入，首次处理最大帧长后不再扩容
+    const size_t history = (taps_ - 1) * channels_;
+    work_.resize(history + in_frames * channels_);
+    std::memcpy(work_.data() + history, in, in_frames * channels_ * sizeof(int16_t));
+
+    size_t produced = 0;
+    const int16_t* x = work_.data();
+    if (channels_ == 1) {
+        while (position_ < in_frames) {
+            const int16_t* c = coefficients_.data() + phase_ * taps_;
+            const int16_t* s = x + position_;
+            int32_t acc0 = 0, acc1 = 0;
+            for (int k = 0; k < taps_; k += 4) {
+                acc0 += c[k] * s[k] + c[k + 1] * s[k + 1];
+                acc1 += c[k + 2] * s[k + 2] + c[k + 3] * s[k + 3];
+            }
+            out[produced++] = saturate_q14(acc0 + acc1);
+            phase_ += down_;
+            position_ += phase_ / up_;
+            phase_ %= up_;
+        }
+    } else {
+        while (position_ < in_frames) {
+            const int16_t* c = coefficients_.data() + phase_ * taps_;
+            for (int ch = 0; ch < channels_; ch++) {
+                const int16_t* s = x + position_ * channels_ + ch;
+                int32_t acc = 0;
+                for (int k = 0; k < taps_; k++) {
+                    acc += c[k] * s[k * channels_];
+                }
+                out[produced * channels_ + ch] = saturate_q14(acc);
+            }
+            produced++;
+            phase_ += down_;
+            position_ += phase_ / up_;
+            phase_ %= up_;
+        }
+    }
+    position_ -= in_frames;
+
+    // 保留最后 taps_ - 1 帧作为下一次的历史样本
+    std::memmove(work_.data(), work_.data() + in_frames * channels_, history * sizeof(int16_t));
+    return produced;
+}
@@ -0,0 +1,63 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "esp_ae_rate_cvt.h"
+
+/*
+ * 采样率转换
+ *
+ * 对 24k->16k、16k->48k、48k->16k 这类小整数比 (L/M 均不超过 RESAMPLER_MAX_FACTOR)
+ * 使用多相 FIR：滤波器系数在 Configure 时计算一次 (Kaiser 窗 sinc，Q14)，
+ * 历史样本跨帧保存，帧边界连续，不会因为重建而产生爆音。
+ * 其它比例回退到 esp_ae_rate_cvt。
+ *
+ * 输入输出均为交织的 16 位 PCM，Process 在首次使用后不再分配内存。
+ */
+#define RESAMPLER_MAX_FACTOR 8
+
+class Resampler {
+public:
+    Resampler() = default;
+    ~Resampler();
+    Resampler(const Resampler&) = delete;
+    Resampler& operator=(const Resampler&) = delete;
+
+    // 参数与当前相同时直接返回，保留滤波器状态
+    bool Configure(int src_rate, int dest_rate, int channels);
+    // 清除历史样本，用于音频流不连续的场合
+    void Reset();
+
+    // 处理 in_frames 帧输入，返回输出帧数。out 至少能容纳 GetMaxOutputFrames(in_frames) 帧
+    size_t Process(const int16_t* in, size_t in_frames, int16_t* out);
+    size_t GetMaxOutputFrames(size_t in_frames) const;
+
+    inline bool configured() const { return channels_ > 0; }
+    inline bool polyphase() const { return !coefficients_.empty(); }
+    inline int src_rate() const { return src_rate_; }
+    inline int dest_rate() const { return dest_rate_; }
+
+private:
+    int src_rate_ = 0;
+    int dest_rate_ = 0;
+    int channels_ = 0;
+
+    // Polyphase state
+    int up_ = 1;                        // L
+    int down_ = 1;                      // M
+    int taps_ = 0;                      // 每相抽头数，4 的倍数
+    std::vector<int16_t> coefficients_; // [phase][tap]，按时间倒序存放以便顺序点积
+    std::vector<int16_t> work_;         // (taps_ - 1) 帧历史样本 + 本次输入
+    int phase_ = 0;
+    size_t position_ = 0;               // 下一个输出对应的输入帧 (相对本次输入)
+
+    esp_ae_rate_cvt_handle_t fallback_ = nullptr;
+
+    void Release();
+    void DesignFilter();
+};
+
+#endif // RESAMPLER_H
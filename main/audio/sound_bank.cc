@@ -0,0 +1,218 @@
+#include "sound_bank.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <cstring>
+
+#include "esp_opus_dec.h"
+#include "esp_audio_types.h"
+#include "resampler.h"
+
+#define TAG "SoundBank"
+
+// 只缓存不超过该时长的提示音，较长的音频仍然走 Opus 解码队列
+#define SOUND_BANK_MAX_CACHED_MS 3000
+// 系统提示音固定以 60ms 帧编码
+#define SOUND_BANK_FRAME_DURATION_MS 60
+
+SoundBank::~SoundBank() {
+    for (auto& sound : sounds_) {
+        if (sound->pcm != nullptr) {
+            heap_caps_free(sound->pcm);
+        }
+    }
+}
+
+const SoundBank::Sound* SoundBank::Load(const std::string_view& ogg, int output_sample_rate, bool decode) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto data = reinterpret_cast<const uint8_t*>(ogg.data());
+
+    Sound* sound = nullptr;
+    for (auto& item : sounds_) {
+        if (item->data == data && item->size == ogg.size()) {
+            sound = item.get();
+            break;
+        }
+    }
+
+    if (sound == nullptr) {
+        auto item = std::make_unique<Sound>();
+        item->data = data;
+        item->size = ogg.size();
+        if (!ParseOgg(*item)) {
+            ESP_LOGE(TAG, "Failed to parse OGG sound (%u bytes)", (unsigned)ogg.size());
+            return nullptr;
+        }
+        sound = item.get();
+        sounds_.push_back(std::move(item));
+    }
+
+    if (decode && sound->pcm == nullptr) {
+        Decode(*sound, output_sample_rate);
+    }
+    return sound;
+}
+
+bool SoundBank::ParseOgg(Sound& sound) {
+    const uint8_t* buf = sound.data;
+    const size_t size = sound.size;
+    size_t offset = 0;
+    bool seen_head = false;
+    bool seen_tags = false;
+
+    while (offset + 27 <= size) {
+        // 正常情况下下一页紧跟在上一页之后，只有不匹配时才向后搜索同步字
+        if (std::memcmp(buf + offset, "OggS", 4) != 0) {
+            auto next = static_cast<const uint8_t*>(std::memchr(buf + offset + 1, 'O', size - offset - 1));
+            if (next == nullptr) {
+                break;
+            }
+            offset = next - buf;
+            continue;
+        }
+
+        const uint8_t* page = buf + offset;
+        uint8_t page_segments = page[26];
+        size_t body_off = offset + 27 + page_segments;
+        if (body_off > size) {
+            break;
+        }
+
+        size_t body_size = 0;
+        for (size_t i = 0; i < page_segments; ++i) {
+            body_size += page[27 + i];
+        }
+        if (body_off + body_size > size) {
+            break;
+        }
+
+        // Parse packets using lacing
+        size_t cur = body_off;
+        size_t seg_idx = 0;
+        while (seg_idx < page_segments) {
+            size_t pkt_len = 0;
+            size_t pkt_start = cur;
+            uint8_t l;
+            do {
+                l = page[27 + seg_idx++];
+                pkt_len += l;
+                cur += l;
+            } while (l == 255 && seg_idx < page_segments);
+
+            if (pkt_len == 0) {
+                continue;
+            }
+            const uint8_t* pkt_ptr = buf + pkt_start;
+
+            if (!seen_head) {
+                // OpusHead: [0-7] "OpusHead", [8] version, [9] channel_count, [10-11] pre_skip
+                // [12-15] input_sample_rate (little-endian)
+                if (pkt_len >= 19 && std::memcmp(pkt_ptr, "OpusHead", 8) == 0) {
+                    seen_head = true;
+                    sound.sample_rate = pkt_ptr[12] | (pkt_ptr[13] << 8) |
+                                        (pkt_ptr[14] << 16) | (pkt_ptr[15] << 24);
+                }
+                continue;
+            }
+            if (!seen_tags) {
+                if (pkt_len >= 8 && std::memcmp(pkt_ptr, "OpusTags", 8) == 0) {
+                    seen_tags = true;
+                }
+                continue;
+            }
+
+            sound.packets.push_back({(uint32_t)pkt_start, (uint32_t)pkt_len});
+        }
+
+        offset = body_off + body_size;
+    }
+
+    return seen_head && !sound.packets.empty();
+}
+
+bool SoundBank::Decode(Sound& sound, int output_sample_rate) {
+#if CONFIG_SPIRAM
+    if ((int)sound.packets.size() * SOUND_BANK_FRAME_DURATION_MS > SOUND_BANK_MAX_CACHED_MS) {
+        ESP_LOGI(TAG, "Sound too long to cache: %u packets", (unsigned)sound.packets.size());
+        return false;
+    }
+
+    int64_t start_time = esp_timer_get_time();
+
+    esp_opus_dec_cfg_t dec_cfg = {
+        .sample_rate = (uint32_t)sound.sample_rate,
+        .channel = ESP_AUDIO_MONO,
+        .frame_duration = ESP_OPUS_DEC_FRAME_DURATION_60_MS,
+        .self_delimited = false,
+    };
+    void* decoder = nullptr;
+    esp_opus_dec_open(&dec_cfg, sizeof(dec_cfg), &decoder);
+    if (decoder == nullptr) {
+        ESP_LOGE(TAG, "Failed to create sound decoder");
+        return false;
+    }
+
+    Resampler resampler;
+    if (sound.sample_rate != output_sample_rate && !resampler.Configure(sound.sample_rate, output_sample_rate, 1)) {
+        esp_opus_dec_close(decoder);
+        return false;
+    }
+
+    std::vector<int16_t> frame(sound.sample_rate / 1000 * SOUND_BANK_FRAME_DURATION_MS);
+    std::vector<int16_t> resampled;
+    std::vector<int16_t> pcm;
+    pcm.reserve((size_t)output_sample_rate / 1000 * SOUND_BANK_FRAME_DURATION_MS * sound.packets.size());
+
+    bool ok = true;
+    for (auto& packet : sound.packets) {
+        esp_audio_dec_in_raw_t raw = {
+            .buffer = const_cast<uint8_t*>(sound.data + packet.offset),
+            .len = packet.length,
+            .consumed = 0,
+            .frame_recover = ESP_AUDIO_DEC_RECOVERY_NONE,
+        };
+        esp_audio_dec_out_frame_t out_frame = {
+            .buffer = (uint8_t*)frame.data(),
+            .len = (uint32_t)(frame.size() * sizeof(int16_t)),
+            .decoded_size = 0,
+        };
+        esp_audio_dec_info_t dec_info = {};
+        if (esp_opus_dec_decode(decoder, &raw, &out_frame, &dec_info) != ESP_AUDIO_ERR_OK) {
+            ok = false;
+            break;
+        }
+        uint32_t samples = out_frame.decoded_size / sizeof(int16_t);
+        if (resampler.configured()) {
+            resampled.resize(resampler.GetMaxOutputFrames(samples));
+            size_t out_frames = resampler.Process(frame.data(), samples, resampled.data());
+            pcm.insert(pcm.end(), resampled.begin(), resampled.begin() + out_frames);
+        } else {
+            pcm.insert(pcm.end(), frame.begin(), frame.begin() + samples);
+        }
+    }
+
+    esp_opus_dec_close(decoder);
+
+    if (!ok || pcm.empty()) {
+        ESP_LOGE(TAG, "Failed to decode sound");
+        return false;
+    }
+
+    sound.pcm = (int16_t*)heap_caps_malloc(pcm.size() * sizeof(int16_t), MALLOC_CAP_SPIRAM);
+    if (sound.pcm == nullptr) {
+        ESP_LOGW(TAG, "No PSRAM for sound cache (%u samples)", (unsigned)pcm.size());
+        return false;
+    }
+    std::memcpy(sound.pcm, pcm.data(), pcm.size() * sizeof(int16_t));
+    sound.pcm_samples = pcm.size();
+
+    ESP_LOGI(TAG, "Cached sound: %u packets, %u samples @ %dHz, %lld us",
+        (unsigned)sound.packets.size(), (unsigned)sound.pcm_samples, output_sample_rate,
+        esp_timer_get_time() - start_time);
+    return true;
+#else
+    // 没有 PSRAM 时不占用内部 RAM，仅使用预解析的包表
+    return false;
+#endif
+}
@@ -0,0 +1,49 @@
+#ifndef SOUND_BANK_H
+#define SOUND_BANK_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+/*
+ * 系统提示音缓存
+ *
+ * 每个 OGG/Opus 提示音只解析一次页表，记录各个 Opus 包的位置。
+ * 较短的提示音还会预先解码并重采样到输出采样率，PCM 存放在 PSRAM 中，
+ * 播放时直接进入播放队列，不再经过 Opus 解码。
+ */
+class SoundBank {
+public:
+    struct OpusPacket {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Sound {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        int sample_rate = 16000;
+        std::vector<OpusPacket> packets;
+        // Decoded PCM at the output sample rate, nullptr if not cached
+        int16_t* pcm = nullptr;
+        size_t pcm_samples = 0;
+    };
+
+    SoundBank() = default;
+    ~SoundBank();
+
+    // Parse the OGG page table once; when decode is set, also cache the decoded PCM
+    // for sounds no longer than SOUND_BANK_MAX_CACHED_MS.
+    const Sound* Load(const std::string_view& ogg, int output_sample_rate, bool decode);
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Sound>> sounds_;
+
+    static bool ParseOgg(Sound& sound);
+    static bool Decode(Sound& sound, int output_sample_rate);
+};
+
+#endif // SOUND_BANK_H
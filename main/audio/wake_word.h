@@ -15,6 +15,8 @@ public:
     virtual bool Initialize(AudioCodec* codec, srmodel_list_t* models_list) = 0;
     virtual void Feed(const std::vector<int16_t>& data) = 0;
     virtual void OnWakeWordDetected(std::function<void(const std::string& wake_word)> callback) = 0;
+    // 本地命令词 (action 不是 "wake")，仅 multinet 引擎支持
+    virtual void OnCommandDetected(std::function<void(const std::string& text, const std::string& action, const std::string& arguments)> callback) {}
     virtual void Start() = 0;
     virtual void Stop() = 0;
     virtual size_t GetFeedSize() = 0;
@@ -22,7 +22,7 @@
 class AfeWakeWord : public WakeWord {
 public:
     AfeWakeWord();
-    ~AfeWakeWord();
+    virtual ~AfeWakeWord();
 
     bool Initialize(AudioCodec* codec, srmodel_list_t* models_list);
     void Feed(const std::vector<int16_t>& data);
@@ -34,7 +34,7 @@ public:
     bool GetWakeWordOpus(std::vector<uint8_t>& opus);
     const std::string& GetLastDetectedWakeWord() const { return last_detected_wake_word_; }
 
-private:
+protected:
     srmodel_list_t *models_ = nullptr;
     const esp_afe_sr_iface_t* afe_iface_ = nullptr;
     esp_afe_sr_data_t* afe_data_ = nullptr;
@@ -55,6 +55,8 @@ private:
 
     void StoreWakeWordData(const int16_t* data, size_t size);
     void AudioDetectionTask();
+    // Called on the detection task for every AFE fetch result
+    virtual void HandleFetchResult(afe_fetch_result_t* res);
 };
 
 #endif
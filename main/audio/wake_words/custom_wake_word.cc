@@ -1,24 +1,29 @@
 #include "custom_wake_word.h"
 #include "audio_service.h"
+#include "pcm_convert.h"
 #include "system_info.h"
 #include "assets.h"
 
 #include <esp_log.h>
-#include <esp_mn_iface.h>
-#include <esp_mn_models.h>
-#include <esp_mn_speech_commands.h>
-#include <cJSON.h>
+#include <esp_timer.h>
+#include <cstring>
 
 #define TAG "CustomWakeWord"
 
+// 环形缓冲区可容纳的检测块数 (每块约 32ms)
+#define DETECTION_RING_SLOTS 4
+
+#ifndef CONFIG_CUSTOM_WAKE_WORD_DETECT_CORE
+#define CONFIG_CUSTOM_WAKE_WORD_DETECT_CORE 1
+#endif
+
 CustomWakeWord::CustomWakeWord()
     : wake_word_pcm_(), wake_word_opus_() {
 }
 
 CustomWakeWord::~CustomWakeWord() {
-    if (multinet_model_data_ != nullptr && multinet_ != nullptr) {
-        multinet_->destroy(multinet_model_data_);
-        multinet_model_data_ = nullptr;
+    if (detection_task_ != nullptr) {
+        vTaskDelete(detection_task_);
     }
 
     if (wake_word_encode_task_stack_ != nullptr) {
@@ -34,68 +39,13 @@ CustomWakeWord::~CustomWakeWord() {
     }
 }
 
-void CustomWakeWord::ParseWakenetModelConfig() {
-    // Read index.json
-    auto& assets = Assets::GetInstance();
-    void* ptr = nullptr;
-    size_t size = 0;
-    if (!assets.GetAssetData("index.json", ptr, size)) {
-        ESP_LOGE(TAG, "Failed to read index.json");
-        return;
-    }
-    cJSON* root = cJSON_ParseWithLength(static_cast<char*>(ptr), size);
-    if (root == nullptr) {
-        ESP_LOGE(TAG, "Failed to parse index.json");
-        return;
-    }
-    cJSON* multinet_model = cJSON_GetObjectItem(root, "multinet_model");
-    if (cJSON_IsObject(multinet_model)) {
-        cJSON* language = cJSON_GetObjectItem(multinet_model, "language");
-        cJSON* duration = cJSON_GetObjectItem(multinet_model, "duration");
-        cJSON* threshold = cJSON_GetObjectItem(multinet_model, "threshold");
-        cJSON* commands = cJSON_GetObjectItem(multinet_model, "commands");
-        if (cJSON_IsString(language)) {
-            language_ = language->valuestring;
-        }
-        if (cJSON_IsNumber(duration)) {
-            duration_ = duration->valueint;
-        }
-        if (cJSON_IsNumber(threshold)) {
-            threshold_ = threshold->valuedouble;
-        }
-        if (cJSON_IsArray(commands)) {
-            for (int i = 0; i < cJSON_GetArraySize(commands); i++) {
-                cJSON* command = cJSON_GetArrayItem(commands, i);
-                if (cJSON_IsObject(command)) {
-                    cJSON* command_name = cJSON_GetObjectItem(command, "command");
-                    cJSON* text = cJSON_GetObjectItem(command, "text");
-                    cJSON* action = cJSON_GetObjectItem(command, "action");
-                    if (cJSON_IsString(command_name) && cJSON_IsString(text) && cJSON_IsString(action)) {
-                        commands_.push_back({command_name->valuestring, text->valuestring, action->valuestring});
-                        ESP_LOGI(TAG, "Command: %s, Text: %s, Action: %s", command_name->valuestring, text->valuestring, action->valuestring);
-                    }
-                }
-            }
-        }
-    }
-    cJSON_Delete(root);
-}
-
-
 bool CustomWakeWord::Initialize(AudioCodec* codec, srmodel_list_t* models_list) {
     codec_ = codec;
-    commands_.clear();
 
     if (models_list == nullptr) {
-        language_ = "cn";
         models_ = esp_srmodel_init("model");
-#ifdef CONFIG_CUSTOM_WAKE_WORD
-        threshold_ = CONFIG_CUSTOM_WAKE_WORD_THRESHOLD / 100.0f;
-        commands_.push_back({CONFIG_CUSTOM_WAKE_WORD, CONFIG_CUSTOM_WAKE_WORD_DISPLAY, "wake"});
-#endif
     } else {
         models_ = models_list;
-        ParseWakenetModelConfig();
     }
 
     if (models_ == nullptr || models_->num == -1) {
@@ -103,28 +53,21 @@ bool CustomWakeWord::Initialize(AudioCodec* codec, srmodel_list_t* models_list)
         return false;
     }
 
-    // 初始化 multinet (命令词识别)
-    mn_name_ = esp_srmodel_filter(models_, ESP_MN_PREFIX, language_.c_str());
-    if (mn_name_ == nullptr) {
-        ESP_LOGW(TAG, "Language '%s' multinet not found, falling back to any multinet model", language_.c_str());
-        mn_name_ = esp_srmodel_filter(models_, ESP_MN_PREFIX, NULL);
-    }
-    if (mn_name_ == nullptr) {
-        ESP_LOGE(TAG, "Failed to initialize multinet, mn_name is nullptr");
-        ESP_LOGI(TAG, "Please refer to https://pcn7cs20v8cr.feishu.cn/wiki/CpQjwQsCJiQSWSkYEvrcxcbVnwh to add custom wake word");
+    if (!multinet_.Initialize(models_, models_list != nullptr)) {
         return false;
     }
 
-    multinet_ = esp_mn_handle_from_name(mn_name_);
-    multinet_model_data_ = multinet_->create(mn_name_, duration_);
-    multinet_->set_det_threshold(multinet_model_data_, threshold_);
-    esp_mn_commands_clear();
-    for (int i = 0; i < commands_.size(); i++) {
-        esp_mn_commands_add(i + 1, commands_[i].command.c_str());
-    }
-    esp_mn_commands_update();
-    
-    multinet_->print_active_speech_commands(multinet_model_data_);
+    chunk_samples_ = multinet_.chunk_size();
+    ring_.assign(chunk_samples_ * DETECTION_RING_SLOTS, 0);
+    ring_head_ = 0;
+    ring_tail_ = 0;
+
+    BaseType_t core_id = CONFIG_CUSTOM_WAKE_WORD_DETECT_CORE < 0 ? tskNO_AFFINITY : CONFIG_CUSTOM_WAKE_WORD_DETECT_CORE;
+    xTaskCreatePinnedToCore([](void* arg) {
+        auto this_ = (CustomWakeWord*)arg;
+        this_->AudioDetectionTask();
+        vTaskDelete(NULL);
+    }, "audio_detection", 4096 * 2, this, 3, &detection_task_, core_id);
     return true;
 }
 
@@ -132,6 +75,10 @@ void CustomWakeWord::OnWakeWordDetected(std::function<void(const std::string& wa
     wake_word_detected_callback_ = callback;
 }
 
+void CustomWakeWord::OnCommandDetected(std::function<void(const std::string& text, const std::string& action, const std::string& arguments)> callback) {
+    command_detected_callback_ = callback;
+}
+
 void CustomWakeWord::Start() {
     running_ = true;
 }
@@ -141,63 +88,96 @@ void CustomWakeWord::Stop() {
 }
 
 void CustomWakeWord::Feed(const std::vector<int16_t>& data) {
-    if (multinet_model_data_ == nullptr || !running_) {
+    if (!multinet_.initialized() || !running_) {
         return;
     }
 
-    esp_mn_state_t mn_state;
-    // If input channels is 2, we need to fetch the left channel data
-    if (codec_->input_channels() == 2) {
-        auto mono_data = std::vector<int16_t>(data.size() / 2);
-        for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-            mono_data[i] = data[j];
-        }
+    // 单生产者/单消费者环形缓冲区，音频输入任务从不等待检测任务
+    uint32_t head = ring_head_.load(std::memory_order_relaxed);
+    uint32_t tail = ring_tail_.load(std::memory_order_acquire);
+    if (head - tail >= DETECTION_RING_SLOTS) {
+        overrun_count_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
 
-        StoreWakeWordData(mono_data);
-        mn_state = multinet_->detect(multinet_model_data_, const_cast<int16_t*>(mono_data.data()));
+    int16_t* slot = &ring_[(head % DETECTION_RING_SLOTS) * chunk_samples_];
+    // If input channels is 2, we need to fetch the left channel data
+    int channels = codec_->input_channels();
+    size_t frames = std::min(data.size() / channels, chunk_samples_);
+    if (channels == 1) {
+        memcpy(slot, data.data(), frames * sizeof(int16_t));
     } else {
-        StoreWakeWordData(data);
-        mn_state = multinet_->detect(multinet_model_data_, const_cast<int16_t*>(data.data()));
+        pcm_s16_extract_channel(data.data(), slot, frames, channels, 0);
     }
-    
-    if (mn_state == ESP_MN_STATE_DETECTING) {
-        return;
-    } else if (mn_state == ESP_MN_STATE_DETECTED) {
-        esp_mn_results_t *mn_result = multinet_->get_results(multinet_model_data_);
-        for (int i = 0; i < mn_result->num && running_; i++) {
-            ESP_LOGI(TAG, "Custom wake word detected: command_id=%d, string=%s, prob=%f", 
-                    mn_result->command_id[i], mn_result->string, mn_result->prob[i]);
-            auto& command = commands_[mn_result->command_id[i] - 1];
-            if (command.action == "wake") {
-                last_detected_wake_word_ = command.text;
-                running_ = false;
-                
-                if (wake_word_detected_callback_) {
-                    wake_word_detected_callback_(last_detected_wake_word_);
-                }
+    if (frames < chunk_samples_) {
+        memset(slot + frames, 0, (chunk_samples_ - frames) * sizeof(int16_t));
+    }
+
+    ring_head_.store(head + 1, std::memory_order_release);
+    xTaskNotifyGive(detection_task_);
+}
+
+void CustomWakeWord::AudioDetectionTask() {
+    ESP_LOGI(TAG, "Audio detection task started, chunk size: %u, core: %d",
+        (unsigned)chunk_samples_, CONFIG_CUSTOM_WAKE_WORD_DETECT_CORE);
+
+    uint32_t reported_overruns = 0;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        uint32_t tail = ring_tail_.load(std::memory_order_relaxed);
+        while (tail != ring_head_.load(std::memory_order_acquire)) {
+            // 停止后残留的数据直接丢弃
+            if (running_) {
+                DetectChunk(&ring_[(tail % DETECTION_RING_SLOTS) * chunk_samples_]);
             }
+            tail++;
+            ring_tail_.store(tail, std::memory_order_release);
+        }
+
+        uint32_t overruns = overrun_count_.load(std::memory_order_relaxed);
+        if (overruns != reported_overruns) {
+            ESP_LOGW(TAG, "Detection fell behind, %lu chunks dropped in total", (unsigned long)overruns);
+            reported_overruns = overruns;
         }
-        multinet_->clean(multinet_model_data_);
-    } else if (mn_state == ESP_MN_STATE_TIMEOUT) {
-        ESP_LOGD(TAG, "Command word detection timeout, cleaning state");
-        multinet_->clean(multinet_model_data_);
     }
 }
 
+void CustomWakeWord::DetectChunk(const int16_t* data) {
+    StoreWakeWordData(data, chunk_samples_);
+
+    multinet_.Detect(data, [this](const MultinetCommand& command, float prob) {
+        if (!running_) {
+            return;
+        }
+        if (command.action == "wake") {
+            last_detected_wake_word_ = command.text;
+            running_ = false;
+
+            if (wake_word_detected_callback_) {
+                wake_word_detected_callback_(last_detected_wake_word_);
+            }
+        } else if (command_detected_callback_) {
+            // 本地命令，不唤醒也不打开服务器会话
+            command_detected_callback_(command.text, command.action, command.arguments);
+        }
+    });
+}
+
 size_t CustomWakeWord::GetFeedSize() {
-    if (multinet_model_data_ == nullptr) {
-        return 0;
-    }
-    return multinet_->get_samp_chunksize(multinet_model_data_);
+    return multinet_.chunk_size();
 }
 
-void CustomWakeWord::StoreWakeWordData(const std::vector<int16_t>& data) {
-    // store audio data to wake_word_pcm_
-    wake_word_pcm_.push_back(data);
+void CustomWakeWord::StoreWakeWordData(const int16_t* data, size_t samples) {
     // keep about 2 seconds of data, detect duration is 30ms (sample_rate == 16000, chunksize == 512)
-    while (wake_word_pcm_.size() > 2000 / 30) {
+    // 缓存满时复用最旧一块的内存，避免每块都分配
+    std::vector<int16_t> pcm;
+    if (wake_word_pcm_.size() >= 2000 / 30) {
+        pcm = std::move(wake_word_pcm_.front());
         wake_word_pcm_.pop_front();
     }
+    pcm.assign(data, data + samples);
+    wake_word_pcm_.push_back(std::move(pcm));
 }
 
 void CustomWakeWord::EncodeWakeWordData() {
@@ -16,6 +16,7 @@
 
 #include "audio_codec.h"
 #include "wake_word.h"
+#include "multinet_detector.h"
 
 class CustomWakeWord : public WakeWord {
 public:
@@ -25,6 +26,7 @@ public:
     bool Initialize(AudioCodec* codec, srmodel_list_t* models_list);
     void Feed(const std::vector<int16_t>& data);
     void OnWakeWordDetected(std::function<void(const std::string& wake_word)> callback);
+    void OnCommandDetected(std::function<void(const std::string& text, const std::string& action, const std::string& arguments)> callback) override;
     void Start();
     void Stop();
     size_t GetFeedSize();
@@ -33,27 +35,24 @@ public:
     const std::string& GetLastDetectedWakeWord() const { return last_detected_wake_word_; }
 
 private:
-    struct Command {
-        std::string command;
-        std::string text;
-        std::string action;
-    };
-
-    // multinet 相关成员变量
-    esp_mn_iface_t* multinet_ = nullptr;
-    model_iface_data_t* multinet_model_data_ = nullptr;
+    MultinetDetector multinet_;
     srmodel_list_t *models_ = nullptr;
-    char* mn_name_ = nullptr;
-    std::string language_ = "cn";
-    int duration_ = 3000;
-    float threshold_ = 0.2;
-    std::deque<Command> commands_;
  
     std::function<void(const std::string& wake_word)> wake_word_detected_callback_;
+    std::function<void(const std::string& text, const std::string& action, const std::string& arguments)> command_detected_callback_;
     AudioCodec* codec_ = nullptr;
     std::string last_detected_wake_word_;
     std::atomic<bool> running_ = false;
 
+    // Feed() 只把单声道数据写入环形缓冲区，multinet 推理在独立的检测任务中执行，
+    // 避免阻塞音频输入任务读取 I2S
+    TaskHandle_t detection_task_ = nullptr;
+    std::vector<int16_t> ring_;
+    size_t chunk_samples_ = 0;
+    std::atomic<uint32_t> ring_head_ = 0;       // 仅由 Feed() 写入
+    std::atomic<uint32_t> ring_tail_ = 0;       // 仅由检测任务写入
+    std::atomic<uint32_t> overrun_count_ = 0;   // 检测任务跟不上时丢弃的块数
+
     TaskHandle_t wake_word_encode_task_ = nullptr;
     StaticTask_t* wake_word_encode_task_buffer_ = nullptr;
     StackType_t* wake_word_encode_task_stack_ = nullptr;
@@ -62,8 +61,9 @@ private:
     std::mutex wake_word_mutex_;
     std::condition_variable wake_word_cv_;
 
-    void StoreWakeWordData(const std::vector<int16_t>& data);
-    void ParseWakenetModelConfig();
+    void StoreWakeWordData(const int16_t* data, size_t samples);
+    void AudioDetectionTask();
+    void DetectChunk(const int16_t* data);
 };
 
 #endif
@@ -0,0 +1,190 @@
+#include "multi_wake_word.h"
+#include "assets.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <cJSON.h>
+#include <algorithm>
+
+#define TAG "MultiWakeWord"
+
+// 同一检测器两次触发的默认最小间隔，可在 index.json 中按检测器/命令覆盖
+#define WAKENET_COOLDOWN_MS         2000
+#define COMMAND_COOLDOWN_MS         1500
+// 两个检测器在该窗口内先后唤醒视为同一次唤醒
+#define WAKE_FUSION_WINDOW_MS       1500
+
+MultiWakeWord::MultiWakeWord()
+    : wakenet_state_{"wakenet", WAKENET_COOLDOWN_MS} {
+}
+
+MultiWakeWord::~MultiWakeWord() {
+}
+
+void MultiWakeWord::ParseWakenetConfig() {
+    auto& assets = Assets::GetInstance();
+    void* ptr = nullptr;
+    size_t size = 0;
+    if (!assets.GetAssetData("index.json", ptr, size)) {
+        return;
+    }
+    cJSON* root = cJSON_ParseWithLength(static_cast<char*>(ptr), size);
+    if (root == nullptr) {
+        return;
+    }
+    cJSON* wakenet_model = cJSON_GetObjectItem(root, "wakenet_model");
+    if (cJSON_IsObject(wakenet_model)) {
+        cJSON* threshold = cJSON_GetObjectItem(wakenet_model, "threshold");
+        cJSON* cooldown_ms = cJSON_GetObjectItem(wakenet_model, "cooldown_ms");
+        if (cJSON_IsNumber(threshold)) {
+            wakenet_threshold_ = threshold->valuedouble;
+        }
+        if (cJSON_IsNumber(cooldown_ms)) {
+            wakenet_state_.cooldown_ms = cooldown_ms->valueint;
+        }
+    }
+    cJSON_Delete(root);
+}
+
+bool MultiWakeWord::Initialize(AudioCodec* codec, srmodel_list_t* models_list) {
+    size_t internal_before = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    size_t spiram_before = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+
+    // multinet 必须在 AFE 检测任务启动前就绪
+    if (!multinet_.Initialize(models_list, models_list != nullptr)) {
+        return false;
+    }
+    multinet_buffer_.assign(multinet_.chunk_size(), 0);
+    multinet_buffer_len_ = 0;
+    command_states_.clear();
+    for (const auto& command : multinet_.commands()) {
+        int cooldown_ms = command.cooldown_ms;
+        if (cooldown_ms < 0) {
+            cooldown_ms = command.action == "wake" ? WAKENET_COOLDOWN_MS : COMMAND_COOLDOWN_MS;
+        }
+        command_states_[command.command] = DetectorState{command.command, cooldown_ms};
+    }
+    if (models_list != nullptr) {
+        ParseWakenetConfig();
+    }
+
+    size_t internal_multinet = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    size_t spiram_multinet = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+
+    if (!AfeWakeWord::Initialize(codec, models_list)) {
+        return false;
+    }
+    // wakenet 的判定在 AFE 内部完成，阈值需要设置到 AFE 中才生效
+    if (wakenet_threshold_ > 0) {
+        for (size_t i = 0; i < wake_words_.size(); i++) {
+            afe_iface_->set_wakenet_threshold(afe_data_, i + 1, wakenet_threshold_);
+        }
+        ESP_LOGI(TAG, "Wakenet threshold set to %.2f", wakenet_threshold_);
+    }
+
+    size_t internal_after = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    size_t spiram_after = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    ESP_LOGI(TAG, "Memory: multinet %u KB internal / %u KB PSRAM, AFE+wakenet %u KB internal / %u KB PSRAM",
+        (unsigned)((internal_before - internal_multinet) / 1024), (unsigned)((spiram_before - spiram_multinet) / 1024),
+        (unsigned)((internal_multinet - internal_after) / 1024), (unsigned)((spiram_multinet - spiram_after) / 1024));
+    return true;
+}
+
+void MultiWakeWord::OnCommandDetected(std::function<void(const std::string& text, const std::string& action, const std::string& arguments)> callback) {
+    command_detected_callback_ = callback;
+}
+
+void MultiWakeWord::Start() {
+    // multinet 状态只在检测任务中访问，这里只做标记
+    reset_pending_ = true;
+    AfeWakeWord::Start();
+}
+
+bool MultiWakeWord::Accept(DetectorState& detector, int64_t now) {
+    if (detector.last_trigger_us != 0 && now - detector.last_trigger_us < detector.cooldown_ms * 1000LL) {
+        detector.suppressed++;
+        ESP_LOGI(TAG, "%s suppressed by cooldown (%lu accepted, %lu suppressed)", detector.name.c_str(),
+            (unsigned long)detector.accepted, (unsigned long)detector.suppressed);
+        return false;
+    }
+    detector.last_trigger_us = now;
+    detector.accepted++;
+    return true;
+}
+
+void MultiWakeWord::TriggerWake(const std::string& wake_word, int64_t now) {
+    // 另一个检测器刚刚唤醒过，视为同一次唤醒
+    if (last_wake_us_ != 0 && now - last_wake_us_ < WAKE_FUSION_WINDOW_MS * 1000LL) {
+        ESP_LOGI(TAG, "Wake word %s fused with previous wake", wake_word.c_str());
+        return;
+    }
+    last_wake_us_ = now;
+
+    Stop();
+    multinet_.Reset();
+    multinet_buffer_len_ = 0;
+    last_detected_wake_word_ = wake_word;
+    if (wake_word_detected_callback_) {
+        wake_word_detected_callback_(last_detected_wake_word_);
+    }
+}
+
+void MultiWakeWord::FeedMultinet(const int16_t* data, size_t samples, int64_t now) {
+    size_t chunk = multinet_buffer_.size();
+    while (samples > 0) {
+        size_t n = std::min(samples, chunk - multinet_buffer_len_);
+        std::copy(data, data + n, multinet_buffer_.begin() + multinet_buffer_len_);
+        multinet_buffer_len_ += n;
+        data += n;
+        samples -= n;
+        if (multinet_buffer_len_ < chunk) {
+            break;
+        }
+        multinet_buffer_len_ = 0;
+
+        bool woke = false;
+        multinet_.Detect(multinet_buffer_.data(), [this, now, &woke](const MultinetCommand& command, float prob) {
+            if (woke) {
+                return;
+            }
+            // 低于该命令阈值的结果已在 MultinetDetector 中过滤，这里只做冷却
+            auto it = command_states_.find(command.command);
+            if (it == command_states_.end() || !Accept(it->second, now)) {
+                return;
+            }
+            if (command.action == "wake") {
+                TriggerWake(command.text, now);
+                woke = true;
+            } else if (command_detected_callback_) {
+                command_detected_callback_(command.text, command.action, command.arguments);
+            }
+        });
+        if (woke) {
+            break;
+        }
+    }
+}
+
+void MultiWakeWord::HandleFetchResult(afe_fetch_result_t* res) {
+    if (reset_pending_.exchange(false)) {
+        multinet_.Reset();
+        multinet_buffer_len_ = 0;
+    }
+
+    // Store the wake word data for voice recognition, like who is speaking
+    size_t samples = res->data_size / sizeof(int16_t);
+    StoreWakeWordData(res->data, samples);
+
+    int64_t now = esp_timer_get_time();
+    if (res->wakeup_state == WAKENET_DETECTED) {
+        // wakenet 的阈值已在 Initialize 中设置到 AFE，这里只做冷却与融合
+        if (Accept(wakenet_state_, now)) {
+            TriggerWake(wake_words_[res->wakenet_model_index - 1], now);
+            return;
+        }
+    }
+
+    // 同一路 AFE 输出送给 multinet，不再重复做前端处理
+    FeedMultinet(res->data, samples, now);
+}
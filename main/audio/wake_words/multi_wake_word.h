@@ -0,0 +1,62 @@
+#ifndef MULTI_WAKE_WORD_H
+#define MULTI_WAKE_WORD_H
+
+#include "afe_wake_word.h"
+#include "multinet_detector.h"
+
+#include <atomic>
+#include <map>
+#include <string>
+
+/*
+ * 组合唤醒引擎：共用一个 AFE 前端，处理后的音频同时送给 wakenet (AFE 内置)
+ * 与 multinet 命令词识别，按检测器的阈值与冷却时间融合结果：
+ * wakenet 阈值与冷却来自 index.json 的 wakenet_model，multinet 每个命令词
+ * 可在 commands 中单独配置 threshold 与 cooldown_ms。
+ * action 为 "wake" 的命令与 wakenet 一样触发唤醒，其余命令通过
+ * OnCommandDetected 交给本地执行，不打开服务器会话。
+ */
+class MultiWakeWord : public AfeWakeWord {
+public:
+    MultiWakeWord();
+    ~MultiWakeWord();
+
+    bool Initialize(AudioCodec* codec, srmodel_list_t* models_list) override;
+    void OnCommandDetected(std::function<void(const std::string& text, const std::string& action, const std::string& arguments)> callback) override;
+    void Start() override;
+
+protected:
+    void HandleFetchResult(afe_fetch_result_t* res) override;
+
+private:
+    // 单个检测器 (或单个命令词) 的冷却参数与统计
+    struct DetectorState {
+        std::string name;
+        int cooldown_ms;
+        int64_t last_trigger_us = 0;
+        uint32_t accepted = 0;
+        uint32_t suppressed = 0;
+    };
+
+    MultinetDetector multinet_;
+    DetectorState wakenet_state_;
+    // 以命令词为键，每个命令各自冷却
+    std::map<std::string, DetectorState> command_states_;
+    // 从 index.json 的 wakenet_model.threshold 读取，0 表示使用模型默认阈值
+    float wakenet_threshold_ = 0;
+    int64_t last_wake_us_ = 0;
+
+    // AFE 输出块与 multinet 输入块大小不一定相同，先拼满一块再识别
+    std::vector<int16_t> multinet_buffer_;
+    size_t multinet_buffer_len_ = 0;
+    std::atomic<bool> reset_pending_ = false;
+
+    std::function<void(const std::string& text, const std::string& action, const std::string& arguments)> command_detected_callback_;
+
+    void ParseWakenetConfig();
+    bool Accept(DetectorState& detector, int64_t now);
+    void TriggerWake(const std::string& wake_word, int64_t now);
+    void FeedMultinet(const int16_t* data, size_t samples, int64_t now);
+};
+
+#endif // MULTI_WAKE_WORD_H
@@ -0,0 +1,183 @@
+#include "multinet_detector.h"
+#include "assets.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_mn_speech_commands.h>
+#include <cJSON.h>
+
+#define TAG "MultinetDetector"
+
+// 每检测多少块输出一次推理耗时统计
+#define DETECTION_STATS_INTERVAL 200
+
+MultinetDetector::~MultinetDetector() {
+    if (model_data_ != nullptr && multinet_ != nullptr) {
+        multinet_->destroy(model_data_);
+        model_data_ = nullptr;
+    }
+}
+
+void MultinetDetector::ParseAssetsConfig() {
+    // Read index.json
+    auto& assets = Assets::GetInstance();
+    void* ptr = nullptr;
+    size_t size = 0;
+    if (!assets.GetAssetData("index.json", ptr, size)) {
+        ESP_LOGE(TAG, "Failed to read index.json");
+        return;
+    }
+    cJSON* root = cJSON_ParseWithLength(static_cast<char*>(ptr), size);
+    if (root == nullptr) {
+        ESP_LOGE(TAG, "Failed to parse index.json");
+        return;
+    }
+    cJSON* multinet_model = cJSON_GetObjectItem(root, "multinet_model");
+    if (cJSON_IsObject(multinet_model)) {
+        cJSON* language = cJSON_GetObjectItem(multinet_model, "language");
+        cJSON* duration = cJSON_GetObjectItem(multinet_model, "duration");
+        cJSON* threshold = cJSON_GetObjectItem(multinet_model, "threshold");
+        cJSON* commands = cJSON_GetObjectItem(multinet_model, "commands");
+        if (cJSON_IsString(language)) {
+            language_ = language->valuestring;
+        }
+        if (cJSON_IsNumber(duration)) {
+            duration_ = duration->valueint;
+        }
+        if (cJSON_IsNumber(threshold)) {
+            threshold_ = threshold->valuedouble;
+        }
+        if (cJSON_IsArray(commands)) {
+            for (int i = 0; i < cJSON_GetArraySize(commands); i++) {
+                cJSON* command = cJSON_GetArrayItem(commands, i);
+                if (cJSON_IsObject(command)) {
+                    cJSON* command_name = cJSON_GetObjectItem(command, "command");
+                    cJSON* text = cJSON_GetObjectItem(command, "text");
+                    cJSON* action = cJSON_GetObjectItem(command, "action");
+                    cJSON* arguments = cJSON_GetObjectItem(command, "arguments");
+                    cJSON* command_threshold = cJSON_GetObjectItem(command, "threshold");
+                    cJSON* cooldown_ms = cJSON_GetObjectItem(command, "cooldown_ms");
+                    if (cJSON_IsString(command_name) && cJSON_IsString(text) && cJSON_IsString(action)) {
+                        std::string args;
+                        if (cJSON_IsObject(arguments)) {
+                            char* json_str = cJSON_PrintUnformatted(arguments);
+                            args = json_str;
+                            cJSON_free(json_str);
+                        }
+                        MultinetCommand item{command_name->valuestring, text->valuestring, action->valuestring, args};
+                        if (cJSON_IsNumber(command_threshold)) {
+                            item.threshold = command_threshold->valuedouble;
+                        }
+                        if (cJSON_IsNumber(cooldown_ms)) {
+                            item.cooldown_ms = cooldown_ms->valueint;
+                        }
+                        commands_.push_back(item);
+                        ESP_LOGI(TAG, "Command: %s, Text: %s, Action: %s, Threshold: %.2f, Cooldown: %d ms", command_name->valuestring,
+                            text->valuestring, action->valuestring, item.threshold, item.cooldown_ms);
+                    }
+                }
+            }
+        }
+    }
+    cJSON_Delete(root);
+}
+
+bool MultinetDetector::Initialize(srmodel_list_t* models, bool load_assets_config) {
+    commands_.clear();
+
+    if (load_assets_config) {
+        ParseAssetsConfig();
+    } else {
+        language_ = "cn";
+#ifdef CONFIG_CUSTOM_WAKE_WORD
+        threshold_ = CONFIG_CUSTOM_WAKE_WORD_THRESHOLD / 100.0f;
+        commands_.push_back({CONFIG_CUSTOM_WAKE_WORD, CONFIG_CUSTOM_WAKE_WORD_DISPLAY, "wake", ""});
+#endif
+    }
+
+    // 初始化 multinet (命令词识别)
+    mn_name_ = esp_srmodel_filter(models, ESP_MN_PREFIX, language_.c_str());
+    if (mn_name_ == nullptr) {
+        ESP_LOGW(TAG, "Language '%s' multinet not found, falling back to any multinet model", language_.c_str());
+        mn_name_ = esp_srmodel_filter(models, ESP_MN_PREFIX, NULL);
+    }
+    if (mn_name_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to initialize multinet, mn_name is nullptr");
+        ESP_LOGI(TAG, "Please refer to https://pcn7cs20v8cr.feishu.cn/wiki/CpQjwQsCJiQSWSkYEvrcxcbVnwh to add custom wake word");
+        return false;
+    }
+
+    multinet_ = esp_mn_handle_from_name(mn_name_);
+    model_data_ = multinet_->create(mn_name_, duration_);
+    // 模型只有一个检测阈值，取所有命令中最低的一个，
+    // 各命令自己的阈值在 Detect 中再判定
+    float model_threshold = threshold_;
+    for (const auto& command : commands_) {
+        if (command.threshold > 0 && command.threshold < model_threshold) {
+            model_threshold = command.threshold;
+        }
+    }
+    multinet_->set_det_threshold(model_data_, model_threshold);
+    esp_mn_commands_clear();
+    for (int i = 0; i < commands_.size(); i++) {
+        esp_mn_commands_add(i + 1, commands_[i].command.c_str());
+    }
+    esp_mn_commands_update();
+
+    multinet_->print_active_speech_commands(model_data_);
+    chunk_size_ = multinet_->get_samp_chunksize(model_data_);
+    return true;
+}
+
+void MultinetDetector::Detect(const int16_t* data, std::function<void(const MultinetCommand& command, float prob)> on_detected) {
+    int64_t start_time = esp_timer_get_time();
+    esp_mn_state_t mn_state = multinet_->detect(model_data_, const_cast<int16_t*>(data));
+    int64_t elapsed = esp_timer_get_time() - start_time;
+
+    detect_time_total_us_ += elapsed;
+    if (elapsed > detect_time_max_us_) {
+        detect_time_max_us_ = elapsed;
+    }
+    if (++detect_count_ >= DETECTION_STATS_INTERVAL) {
+        // 16kHz 单声道，每块时长 chunk_size_ / 16 ms
+        int64_t average = detect_time_total_us_ / detect_count_;
+        ESP_LOGD(TAG, "Detect avg %lld us, max %lld us per chunk, %lld%% of real time",
+            average, detect_time_max_us_, average * 100 / (chunk_size_ * 1000 / 16));
+        detect_count_ = 0;
+        detect_time_total_us_ = 0;
+        detect_time_max_us_ = 0;
+    }
+
+    if (mn_state == ESP_MN_STATE_DETECTING) {
+        return;
+    } else if (mn_state == ESP_MN_STATE_DETECTED) {
+        esp_mn_results_t *mn_result = multinet_->get_results(model_data_);
+        for (int i = 0; i < mn_result->num; i++) {
+            ESP_LOGI(TAG, "Command detected: command_id=%d, string=%s, prob=%f",
+                    mn_result->command_id[i], mn_result->string, mn_result->prob[i]);
+            int index = mn_result->command_id[i] - 1;
+            if (index < 0 || index >= (int)commands_.size()) {
+                continue;
+            }
+            const auto& command = commands_[index];
+            float command_threshold = command.threshold > 0 ? command.threshold : threshold_;
+            if (mn_result->prob[i] < command_threshold) {
+                ESP_LOGI(TAG, "Command %s below its threshold %.2f", command.command.c_str(), command_threshold);
+                continue;
+            }
+            if (on_detected) {
+                on_detected(command, mn_result->prob[i]);
+            }
+        }
+        multinet_->clean(model_data_);
+    } else if (mn_state == ESP_MN_STATE_TIMEOUT) {
+        ESP_LOGD(TAG, "Command word detection timeout, cleaning state");
+        multinet_->clean(model_data_);
+    }
+}
+
+void MultinetDetector::Reset() {
+    if (model_data_ != nullptr) {
+        multinet_->clean(model_data_);
+    }
+}
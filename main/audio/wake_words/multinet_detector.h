@@ -0,0 +1,60 @@
+#ifndef MULTINET_DETECTOR_H
+#define MULTINET_DETECTOR_H
+
+#include <esp_mn_iface.h>
+#include <esp_mn_models.h>
+#include <model_path.h>
+
+#include <deque>
+#include <string>
+#include <functional>
+
+// 命令词表中的一项，来自 index.json 的 multinet_model.commands 或 Kconfig
+struct MultinetCommand {
+    std::string command;    // 拼音/英文命令词
+    std::string text;       // 显示文本或发送给服务器的唤醒词
+    std::string action;     // "wake" 或 MCP 工具名
+    std::string arguments;  // 可选，MCP 工具参数 (JSON 对象字符串)
+    float threshold = 0;    // 可选，该命令的识别阈值，0 表示使用全局阈值
+    int cooldown_ms = -1;   // 可选，该命令两次触发的最小间隔，-1 表示使用默认值
+};
+
+// multinet 命令词识别，供 CustomWakeWord 与 MultiWakeWord 共用
+class MultinetDetector {
+public:
+    MultinetDetector() = default;
+    ~MultinetDetector();
+
+    // models: 已加载的模型列表
+    // load_assets_config: 为 true 时从 assets 的 index.json 读取语言、阈值与命令词
+    bool Initialize(srmodel_list_t* models, bool load_assets_config);
+
+    // 处理一块单声道 16kHz 数据，长度为 chunk_size()
+    // 识别到命令时按概率从高到低依次回调，低于该命令阈值的结果不回调
+    void Detect(const int16_t* data, std::function<void(const MultinetCommand& command, float prob)> on_detected);
+    void Reset();
+
+    inline bool initialized() const { return model_data_ != nullptr; }
+    inline size_t chunk_size() const { return chunk_size_; }
+    // 全局阈值，未单独配置阈值的命令使用该值
+    inline float threshold() const { return threshold_; }
+    inline const std::deque<MultinetCommand>& commands() const { return commands_; }
+
+private:
+    esp_mn_iface_t* multinet_ = nullptr;
+    model_iface_data_t* model_data_ = nullptr;
+    char* mn_name_ = nullptr;
+    std::string language_ = "cn";
+    int duration_ = 3000;
+    float threshold_ = 0.2;
+    size_t chunk_size_ = 0;
+    std::deque<MultinetCommand> commands_;
+
+    uint32_t detect_count_ = 0;
+    int64_t detect_time_total_us_ = 0;
+    int64_t detect_time_max_us_ = 0;
+
+    void ParseAssetsConfig();
+};
+
+#endif // MULTINET_DETECTOR_H
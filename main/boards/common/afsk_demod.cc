@@ -1,6 +1,6 @@
 #include "afsk_demod.h"
+#include <cmath>
 #include <cstring>
-#include <algorithm>
 #include "esp_log.h"
 #include "display.h"
 #include "ssid_manager.h"
@@ -19,10 +19,9 @@ namespace audio_wifi_config
                                         size_t input_channels
                                     )
     {
-        const int kInputSampleRate = 16000;                                    // Input sampling rate
-        const float kDownsampleStep = static_cast<float>(kInputSampleRate) / static_cast<float>(kAudioSampleRate); // Downsampling step
         std::vector<int16_t> audio_data;
-        AudioSignalProcessor signal_processor(kAudioSampleRate, kMarkFrequency, kSpaceFrequency, kBitRate, kWindowSize);
+        std::array<uint8_t, 16> bits;  // 30ms of input yields at most 4 bits
+        AfskDemodulator demodulator;
         AudioDataBuffer data_buffer;
 
         while (true)
@@ -41,39 +40,13 @@ namespace audio_wifi_config
                 continue;
             }
 
-            if (input_channels == 2) { // 如果是双声道输入，转换为单声道
-                auto mono_data = std::vector<int16_t>(audio_data.size() / 2);
-                for (size_t i = 0, j = 0; i < mono_data.size(); ++i, j += 2) {
-                    mono_data[i] = audio_data[j];
+            // Demodulate, only the first channel is used
+            size_t bit_count = demodulator.Process(audio_data.data(), audio_data.size() / input_channels,
+                                                   input_channels, bits.data(), bits.size());
+            for (size_t i = 0; i < bit_count; ++i) {
+                if (!data_buffer.PushBit(bits[i])) {
+                    continue;
                 }
-                audio_data = std::move(mono_data);
-            }
-            
-            // Downsample the audio data
-            std::vector<float> downsampled_data;
-            size_t last_index = 0;
-
-            if (kDownsampleStep > 1.0f) {
-                downsampled_data.reserve(audio_data.size() / static_cast<size_t>(kDownsampleStep));
-                for (size_t i = 0; i < audio_data.size(); ++i) {
-                    size_t sample_index = static_cast<size_t>(i / kDownsampleStep);
-                    if ((sample_index + 1) > last_index) {
-                        downsampled_data.push_back(static_cast<float>(audio_data[i]));
-                        last_index = sample_index + 1;
-                    }
-                }
-            } else {
-                downsampled_data.reserve(audio_data.size());
-                for (int16_t sample : audio_data) {
-                    downsampled_data.push_back(static_cast<float>(sample));
-                }
-            }
-            
-            // Process audio samples to get probability data
-            auto probabilities = signal_processor.ProcessAudioSamples(downsampled_data);
-            
-            // Feed probability data to the data buffer
-            if (data_buffer.ProcessProbabilityData(probabilities, 0.5f)) {
                 // If complete data was received, extract WiFi credentials
                 if (data_buffer.decoded_text.has_value()) {
                     ESP_LOGI(kLogTag, "Received text data: %s", data_buffer.decoded_text->c_str());
@@ -107,269 +80,164 @@ namespace audio_wifi_config
         }
     }
 
-    // Default start and end transmission identifiers
-    // \x01\x02 = 00000001 00000010
-    const std::vector<uint8_t> kDefaultStartTransmissionPattern = {
-        0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0};
-
-    // \x03\x04 = 00000011 00000100
-    const std::vector<uint8_t> kDefaultEndTransmissionPattern = {
-        0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0};
 
-    // FrequencyDetector implementation
-    FrequencyDetector::FrequencyDetector(float frequency, size_t window_size)
-        : frequency_(frequency), window_size_(window_size) {
-        frequency_bin_ = std::floor(frequency_ * static_cast<float>(window_size_));
-        angular_frequency_ = 2.0f * M_PI * frequency_;
-        cos_coefficient_ = std::cos(angular_frequency_);
-        sin_coefficient_ = std::sin(angular_frequency_);
-        filter_coefficient_ = 2.0f * cos_coefficient_;
-
-        // Initialize state buffer
-        state_buffer_.push_back(0.0f);
-        state_buffer_.push_back(0.0f);
+    AfskDemodulator::AfskDemodulator()
+    {
+        auto build_tables = [](ToneCorrelator &tone, size_t frequency) {
+            // frequency / kBitRate is the DFT bin of the one-bit window
+            const double step = 2.0 * M_PI * static_cast<double>(frequency / kBitRate) / kSamplesPerBit;
+            for (size_t n = 0; n < kSamplesPerBit; ++n) {
+                tone.cos_table[n] = static_cast<int16_t>(std::lround(std::cos(step * n) * 1024.0));
+                tone.sin_table[n] = static_cast<int16_t>(std::lround(std::sin(step * n) * 1024.0));
+            }
+        };
+        build_tables(mark_, kMarkFrequency);
+        build_tables(space_, kSpaceFrequency);
+        Reset();
     }
 
-    void FrequencyDetector::Reset() {
-        state_buffer_.clear();
-        state_buffer_.push_back(0.0f);
-        state_buffer_.push_back(0.0f);
+    void AfskDemodulator::Reset()
+    {
+        window_.fill(0);
+        window_index_ = 0;
+        mark_.in_phase = mark_.quadrature = 0;
+        space_.in_phase = space_.quadrature = 0;
+        previous_odd_sample_ = 0;
+        has_even_sample_ = false;
+        even_sample_ = 0;
+        bit_phase_ = 0;
+        last_mark_ = false;
     }
 
-    void FrequencyDetector::ProcessSample(float sample) {
-        if (state_buffer_.size() < 2) {
-            return;
+    size_t AfskDemodulator::Process(const int16_t *samples, size_t frames, size_t channels, uint8_t *bits, size_t max_bits)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < frames; ++i) {
+            int16_t sample = samples[i * channels];
+            if (!has_even_sample_) {
+                even_sample_ = sample;
+                has_even_sample_ = true;
+                continue;
+            }
+            // [1 2 1] / 4 low-pass, centered on the even sample, then drop the odd one
+            int32_t filtered = (previous_odd_sample_ + 2 * even_sample_ + sample) >> 2;
+            previous_odd_sample_ = sample;
+            has_even_sample_ = false;
+            ProcessSample(static_cast<int16_t>(filtered), bits, max_bits, count);
         }
-
-        float s_minus_2 = state_buffer_.front();  // S[-2]
-        state_buffer_.pop_front();
-        float s_minus_1 = state_buffer_.front();  // S[-1]
-        state_buffer_.pop_front();
-
-        float s_current = sample + filter_coefficient_ * s_minus_1 - s_minus_2;
-
-        state_buffer_.push_back(s_minus_1);  // Put S[-1] back
-        state_buffer_.push_back(s_current);  // Add new S[0]
+        return count;
     }
 
-    float FrequencyDetector::GetAmplitude() const {
-        if (state_buffer_.size() < 2) {
-            return 0.0f;
-        }
-
-        float s_minus_1 = state_buffer_[1];                      // S[-1]
-        float s_minus_2 = state_buffer_[0];                      // S[-2]
-        float real_part = cos_coefficient_ * s_minus_1 - s_minus_2;  // Real part
-        float imaginary_part = sin_coefficient_ * s_minus_1;         // Imaginary part
-
-        return std::sqrt(real_part * real_part + imaginary_part * imaginary_part) / 
-               (static_cast<float>(window_size_) / 2.0f);
+    int64_t AfskDemodulator::Energy(const ToneCorrelator &tone)
+    {
+        return static_cast<int64_t>(tone.in_phase) * tone.in_phase +
+               static_cast<int64_t>(tone.quadrature) * tone.quadrature;
     }
 
-    // AudioSignalProcessor implementation
-    AudioSignalProcessor::AudioSignalProcessor(size_t sample_rate, size_t mark_frequency, size_t space_frequency,
-                                             size_t bit_rate, size_t window_size)
-        : input_buffer_size_(window_size), output_sample_count_(0) {
-        if (sample_rate % bit_rate != 0) {
-            // On ESP32 we can continue execution, but log the error
-            ESP_LOGW(kLogTag, "Sample rate %zu is not divisible by bit rate %zu", sample_rate, bit_rate);
+    void AfskDemodulator::ProcessSample(int16_t sample, uint8_t *bits, size_t max_bits, size_t &count)
+    {
+        // 14-bit samples keep |sum| <= 80 * 8192 * 1024 within int32
+        int16_t x = sample >> 2;
+        int32_t delta = x - window_[window_index_];
+        window_[window_index_] = x;
+        mark_.in_phase += delta * mark_.cos_table[window_index_];
+        mark_.quadrature += delta * mark_.sin_table[window_index_];
+        space_.in_phase += delta * space_.cos_table[window_index_];
+        space_.quadrature += delta * space_.sin_table[window_index_];
+        if (++window_index_ == kSamplesPerBit) {
+            window_index_ = 0;
         }
 
-        float normalized_mark_freq = static_cast<float>(mark_frequency) / static_cast<float>(sample_rate);
-        float normalized_space_freq = static_cast<float>(space_frequency) / static_cast<float>(sample_rate);
-
-        mark_detector_ = std::make_unique<FrequencyDetector>(normalized_mark_freq, window_size);
-        space_detector_ = std::make_unique<FrequencyDetector>(normalized_space_freq, window_size);
-
-        samples_per_bit_ = sample_rate / bit_rate;  // Number of samples per bit
-    }
-
-    std::vector<float> AudioSignalProcessor::ProcessAudioSamples(const std::vector<float> &samples) {
-        std::vector<float> result;
-
-        for (float sample : samples) {
-            if (input_buffer_.size() < input_buffer_size_) {
-                input_buffer_.push_back(sample);  // Just add, don't process yet
-            } else {
-                // Input buffer is full, process the data
-                input_buffer_.pop_front();   // Remove oldest sample
-                input_buffer_.push_back(sample);  // Add new sample
-                output_sample_count_++;
-
-                if (output_sample_count_ >= samples_per_bit_) {
-                    // Process all samples in the window using Goertzel algorithm
-                    for (float window_sample : input_buffer_) {
-                        mark_detector_->ProcessSample(window_sample);
-                        space_detector_->ProcessSample(window_sample);
-                    }
-
-                    float mark_amplitude = mark_detector_->GetAmplitude();   // Mark amplitude
-                    float space_amplitude = space_detector_->GetAmplitude(); // Space amplitude
-
-                    // Avoid division by zero
-                    float mark_probability = mark_amplitude / 
-                                           (space_amplitude + mark_amplitude + std::numeric_limits<float>::epsilon());
-                    result.push_back(mark_probability);
-
-                    // Reset detector windows
-                    mark_detector_->Reset();
-                    space_detector_->Reset();
-                    output_sample_count_ = 0;  // Reset output counter
-                }
+        bool mark = Energy(mark_) > Energy(space_);
+        if (mark != last_mark_) {
+            // A transition is seen half a window after the bit edge, so the window is aligned with
+            // the bit half a bit later. Pull the clock halfway towards it to tolerate glitches.
+            const int32_t half = kSamplesPerBit / 2;
+            int32_t error = half - bit_phase_;
+            if (error > half) {
+                error -= kSamplesPerBit;
+            } else if (error <= -half) {
+                error += kSamplesPerBit;
             }
+            bit_phase_ += error / 2;
+            last_mark_ = mark;
         }
 
-        return result;
+        if (++bit_phase_ >= static_cast<int32_t>(kSamplesPerBit)) {
+            bit_phase_ -= kSamplesPerBit;
+            if (count < max_bits) {
+                bits[count++] = mark ? 1 : 0;
+            }
+        }
     }
 
-    // AudioDataBuffer implementation
     AudioDataBuffer::AudioDataBuffer()
-        : current_state_(DataReceptionState::kInactive),
-          start_of_transmission_(kDefaultStartTransmissionPattern),
-          end_of_transmission_(kDefaultEndTransmissionPattern),
-          enable_checksum_validation_(true) {
-        identifier_buffer_size_ = std::max(start_of_transmission_.size(), end_of_transmission_.size());
-        max_bit_buffer_size_ = 776;  // Preset bit buffer size, 776 bits = (32 + 1 + 63 + 1) * 8 = 776
-
-        bit_buffer_.reserve(max_bit_buffer_size_);
-    }
-
-    AudioDataBuffer::AudioDataBuffer(size_t max_byte_size, const std::vector<uint8_t> &start_identifier,
-                                   const std::vector<uint8_t> &end_identifier, bool enable_checksum)
-        : current_state_(DataReceptionState::kInactive),
-          start_of_transmission_(start_identifier),
-          end_of_transmission_(end_identifier),
-          enable_checksum_validation_(enable_checksum) {
-        identifier_buffer_size_ = std::max(start_of_transmission_.size(), end_of_transmission_.size());
-        max_bit_buffer_size_ = max_byte_size * 8;  // Bit buffer size in bytes
-
-        bit_buffer_.reserve(max_bit_buffer_size_);
+    {
+        history_.fill(0);
     }
 
-    uint8_t AudioDataBuffer::CalculateChecksum(const std::string &text) {
-        uint8_t checksum = 0;
-        for (char character : text) {
-            checksum += static_cast<uint8_t>(character);
+    bool AudioDataBuffer::PushBit(uint8_t bit)
+    {
+        bit &= 1;
+        history_[history_count_ % kHistoryBits] = bit;
+        history_count_++;
+        shift_register_ = static_cast<uint16_t>((shift_register_ << 1) | bit);
+        if (shift_register_ != kEndIdentifier || history_count_ < 16 + 16 + 16) {
+            return false;
         }
-        return checksum;
+        return TryDecodeFrame();
     }
 
-    void AudioDataBuffer::ClearBuffers() {
-        identifier_buffer_.clear();
-        bit_buffer_.clear();
+    uint8_t AudioDataBuffer::ByteAt(size_t index) const
+    {
+        uint8_t value = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            value = static_cast<uint8_t>((value << 1) | BitAt(index + i));
+        }
+        return value;
     }
 
-    bool AudioDataBuffer::ProcessProbabilityData(const std::vector<float> &probabilities, float threshold) {
-        for (float probability : probabilities) {
-            uint8_t bit = (probability > threshold) ? 1 : 0;
-
-            if (identifier_buffer_.size() >= identifier_buffer_size_) {
-                identifier_buffer_.pop_front();  // Maintain buffer size
-            }
-            identifier_buffer_.push_back(bit);
-
-            // Process received bit based on state machine
-            switch (current_state_) {
-            case DataReceptionState::kInactive:
-                if (identifier_buffer_.size() >= start_of_transmission_.size()) {
-                    current_state_ = DataReceptionState::kWaiting;  // Enter waiting state
-                    ESP_LOGI(kLogTag, "Entering Waiting state");
+    bool AudioDataBuffer::TryDecodeFrame()
+    {
+        static_assert(kMaxFrameBits <= kHistoryBits, "History must hold a full frame");
+        const size_t payload_end = history_count_ - 16;  // End identifier excluded
+        const size_t oldest = history_count_ > kHistoryBits ? history_count_ - kHistoryBits : 0;
+
+        // Exact start identifiers first, then one bit error; shortest payload first
+        for (int max_errors = 0; max_errors <= 1; ++max_errors) {
+            // Payload: at least one text byte plus the checksum
+            for (size_t payload_bytes = 2; payload_bytes * 8 + 32 <= kMaxFrameBits; ++payload_bytes) {
+                if (payload_end < payload_bytes * 8 + 16 + oldest) {
+                    break;
                 }
-                break;
-
-            case DataReceptionState::kWaiting:
-                // Waiting state, possibly waiting for transmission end
-                if (identifier_buffer_.size() >= start_of_transmission_.size()) {
-                    std::vector<uint8_t> identifier_snapshot(identifier_buffer_.begin(), identifier_buffer_.end());
-                    if (identifier_snapshot == start_of_transmission_)
-                    {
-                        ClearBuffers();                                // Clear buffers
-                        current_state_ = DataReceptionState::kReceiving;  // Enter receiving state
-                        ESP_LOGI(kLogTag, "Entering Receiving state");
-                    }
+                const size_t payload_start = payload_end - payload_bytes * 8;
+                uint16_t start = static_cast<uint16_t>((ByteAt(payload_start - 16) << 8) | ByteAt(payload_start - 8));
+                if (__builtin_popcount(start ^ kStartIdentifier) != max_errors) {
+                    continue;
                 }
-                break;
-
-            case DataReceptionState::kReceiving:
-                bit_buffer_.push_back(bit);
-                if (identifier_buffer_.size() >= end_of_transmission_.size()) {
-                    std::vector<uint8_t> identifier_snapshot(identifier_buffer_.begin(), identifier_buffer_.end());
-                    if (identifier_snapshot == end_of_transmission_) {
-                        current_state_ = DataReceptionState::kInactive;  // Enter inactive state
 
-                        // Convert bits to bytes
-                        std::vector<uint8_t> bytes = ConvertBitsToBytes(bit_buffer_);
-
-                        uint8_t received_checksum = 0;
-                        size_t minimum_length = 0;
-
-                        if (enable_checksum_validation_) {
-                            // If checksum is required, last byte is checksum
-                            minimum_length = 1 + start_of_transmission_.size() / 8;
-                            if (bytes.size() >= minimum_length)
-                            {
-                                received_checksum = bytes[bytes.size() - start_of_transmission_.size() / 8 - 1];
-                            }
-                        } else {
-                            minimum_length = start_of_transmission_.size() / 8;
-                        }
-
-                        if (bytes.size() < minimum_length) {
-                            ClearBuffers();
-                            ESP_LOGW(kLogTag, "Data too short, clearing buffer");
-                            return false;  // Data too short, return failure
-                        }
-
-                        // Extract text data (remove trailing identifier part)
-                        std::vector<uint8_t> text_bytes(
-                            bytes.begin(), bytes.begin() + bytes.size() - minimum_length);
-
-                        std::string result(text_bytes.begin(), text_bytes.end());
-
-                        // Validate checksum if required
-                        if (enable_checksum_validation_) {
-                            uint8_t calculated_checksum = CalculateChecksum(result);
-                            if (calculated_checksum != received_checksum) {
-                                // Checksum mismatch
-                                ESP_LOGW(kLogTag, "Checksum mismatch: expected %d, got %d", 
-                                        received_checksum, calculated_checksum);
-                                ClearBuffers();
-                                return false;
-                            }
-                        }
-
-                        ClearBuffers();
-                        decoded_text = result;
-                        return true;  // Return success
-                    } else if (bit_buffer_.size() >= max_bit_buffer_size_) {
-                        // If not end identifier and bit buffer is full, reset
-                        ClearBuffers();
-                        ESP_LOGW(kLogTag, "Buffer overflow, clearing buffer");
-                        current_state_ = DataReceptionState::kInactive;  // Reset state machine
-                    }
+                std::string text;
+                text.reserve(payload_bytes - 1);
+                for (size_t i = 0; i < payload_bytes - 1; ++i) {
+                    text.push_back(static_cast<char>(ByteAt(payload_start + i * 8)));
                 }
-                break;
+                if (CalculateChecksum(text) != ByteAt(payload_end - 8)) {
+                    continue;
+                }
+                decoded_text = std::move(text);
+                return true;
             }
         }
-
+        ESP_LOGD(kLogTag, "End identifier without a valid frame");
         return false;
     }
 
-    std::vector<uint8_t> AudioDataBuffer::ConvertBitsToBytes(const std::vector<uint8_t> &bits) const {
-        std::vector<uint8_t> bytes;
-
-        // Ensure number of bits is a multiple of 8
-        size_t complete_bytes_count = bits.size() / 8;
-        bytes.reserve(complete_bytes_count);
-
-        for (size_t i = 0; i < complete_bytes_count; ++i) {
-            uint8_t byte_value = 0;
-            for (size_t j = 0; j < 8; ++j) {
-                byte_value |= bits[i * 8 + j] << (7 - j);
-            }
-            bytes.push_back(byte_value);
+    uint8_t AudioDataBuffer::CalculateChecksum(const std::string &text)
+    {
+        uint8_t checksum = 0;
+        for (char character : text) {
+            checksum += static_cast<uint8_t>(character);
         }
-
-        return bytes;
+        return checksum;
     }
 }
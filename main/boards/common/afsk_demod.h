@@ -1,154 +1,106 @@
 #pragma once
 
+#include <array>
 #include <vector>
-#include <deque>
 #include <string>
-#include <memory>
 #include <optional>
-#include <cmath>
+#include <cstdint>
 #include "wifi_manager.h"
 #include "application.h"
 
 // Audio signal processing constants for WiFi configuration via audio
-const size_t kAudioSampleRate = 6400;
+const size_t kInputSampleRate = 16000;                  // Microphone sampling rate
+const size_t kAudioSampleRate = 8000;                   // Demodulator rate, input is decimated by 2
 const size_t kMarkFrequency = 1800;
 const size_t kSpaceFrequency = 1500;
 const size_t kBitRate = 100;
-const size_t kWindowSize = 64;
+const size_t kSamplesPerBit = kAudioSampleRate / kBitRate;  // Window size, one bit
+
+// Mark / space must fall on integer DFT bins of the one-bit window
+static_assert(kAudioSampleRate % kBitRate == 0, "Sample rate must be a multiple of the bit rate");
+static_assert(kMarkFrequency % kBitRate == 0 && kSpaceFrequency % kBitRate == 0,
+              "Mark / space frequencies must be multiples of the bit rate");
 
 namespace audio_wifi_config
 {
     // Main function to receive WiFi credentials through audio signal
-    void ReceiveWifiCredentialsFromAudio(Application *app, WifiManager *wifi_manager, Display *display, 
+    void ReceiveWifiCredentialsFromAudio(Application *app, WifiManager *wifi_manager, Display *display,
                                          size_t input_channels = 1);
 
     /**
-     * Goertzel algorithm implementation for single frequency detection
-     * Used to detect specific audio frequencies in the AFSK demodulation process
+     * Fixed-point AFSK demodulator
+     *
+     * The 16kHz input is decimated to 8kHz with a [1 2 1] / 4 filter. Mark and space energies are
+     * computed by a sliding single-bin DFT over one bit period: since both tones are integer bins of
+     * the window, the correlation tables are periodic and the I/Q sums can be updated with
+     * (x[n] - x[n - N]) * table[n mod N], which is exact in integer arithmetic and never drifts.
+     * The bit clock is recovered from the zero crossings of (mark - space), so the decision is made
+     * when the window is aligned with the bit.
      */
-    class FrequencyDetector
+    class AfskDemodulator
     {
-    private:
-        float frequency_;              // Target frequency (normalized, i.e., f / fs)
-        size_t window_size_;           // Window size for analysis
-        float frequency_bin_;          // Frequency bin
-        float angular_frequency_;      // Angular frequency
-        float cos_coefficient_;        // cos(w)
-        float sin_coefficient_;        // sin(w)
-        float filter_coefficient_;     // 2 * cos(w)
-        std::deque<float> state_buffer_;  // Circular buffer for storing S[-1] and S[-2]
-
     public:
-        /**
-         * Constructor
-         * @param frequency Normalized frequency (f / fs)
-         * @param window_size Window size for analysis
-         */
-        FrequencyDetector(float frequency, size_t window_size);
+        AfskDemodulator();
 
         /**
-         * Reset the detector state
+         * Reset the window and the bit clock
          */
         void Reset();
 
         /**
-         * Process one audio sample
-         * @param sample Input audio sample
+         * Process 16kHz input samples
+         * @param samples Interleaved input samples, only the first channel is used
+         * @param frames Number of frames
+         * @param channels Number of interleaved channels
+         * @param bits Output bits (0 / 1)
+         * @param max_bits Capacity of bits
+         * @return Number of bits written
          */
-        void ProcessSample(float sample);
+        size_t Process(const int16_t *samples, size_t frames, size_t channels, uint8_t *bits, size_t max_bits);
 
-        /**
-         * Calculate current amplitude
-         * @return Amplitude value
-         */
-        float GetAmplitude() const;
-    };
-
-    /**
-     * Audio signal processor for Mark/Space frequency pair detection
-     * Processes audio signals to extract digital data using AFSK demodulation
-     */
-    class AudioSignalProcessor
-    {
     private:
-        std::deque<float> input_buffer_;             // Input sample buffer
-        size_t input_buffer_size_;                   // Input buffer size = window size
-        size_t output_sample_count_;                 // Output sample counter
-        size_t samples_per_bit_;                     // Samples per bit threshold
-        std::unique_ptr<FrequencyDetector> mark_detector_;   // Mark frequency detector
-        std::unique_ptr<FrequencyDetector> space_detector_;  // Space frequency detector
-
-    public:
-        /**
-         * Constructor
-         * @param sample_rate Audio sampling rate
-         * @param mark_frequency Mark frequency for digital '1'
-         * @param space_frequency Space frequency for digital '0'
-         * @param bit_rate Data transmission bit rate
-         * @param window_size Analysis window size
-         */
-        AudioSignalProcessor(size_t sample_rate, size_t mark_frequency, size_t space_frequency,
-                           size_t bit_rate, size_t window_size);
-
-        /**
-         * Process input audio samples
-         * @param samples Input audio sample vector
-         * @return Vector of Mark probability values (0.0 to 1.0)
-         */
-        std::vector<float> ProcessAudioSamples(const std::vector<float> &samples);
+        struct ToneCorrelator {
+            std::array<int16_t, kSamplesPerBit> cos_table;  // Q10
+            std::array<int16_t, kSamplesPerBit> sin_table;  // Q10
+            int32_t in_phase = 0;
+            int32_t quadrature = 0;
+        };
+
+        ToneCorrelator mark_;
+        ToneCorrelator space_;
+        std::array<int16_t, kSamplesPerBit> window_;  // Ring buffer of decimated samples
+        size_t window_index_ = 0;
+        int16_t previous_odd_sample_ = 0;
+        bool has_even_sample_ = false;
+        int16_t even_sample_ = 0;
+        int32_t bit_phase_ = 0;                        // Samples since the last bit decision
+        bool last_mark_ = false;
+
+        void ProcessSample(int16_t sample, uint8_t *bits, size_t max_bits, size_t &count);
+        static int64_t Energy(const ToneCorrelator &tone);
     };
 
     /**
-     * Data reception state machine states
-     */
-    enum class DataReceptionState
-    {
-        kInactive,  // Waiting for start signal
-        kWaiting,   // Detected potential start, waiting for confirmation
-        kReceiving  // Actively receiving data
-    };
-
-    /**
-     * Data buffer for managing audio-to-digital data conversion
-     * Handles the complete process from audio signal to decoded text data
+     * Frame decoder for the demodulated bit stream
+     *
+     * Frame: start identifier (\x01\x02), text, checksum byte, end identifier (\x03\x04), MSB first.
+     * Bits are kept in a ring buffer. Each time the end identifier is seen, the decoder searches
+     * backwards for a start identifier (allowing one bit error) whose payload passes the checksum,
+     * so a corrupted frame never blocks the next repetition from being received.
      */
     class AudioDataBuffer
     {
-    private:
-        DataReceptionState current_state_;       // Current reception state
-        std::deque<uint8_t> identifier_buffer_;  // Buffer for start/end identifier detection
-        size_t identifier_buffer_size_;          // Identifier buffer size
-        std::vector<uint8_t> bit_buffer_;        // Buffer for storing bit stream
-        size_t max_bit_buffer_size_;             // Maximum bit buffer size
-        const std::vector<uint8_t> start_of_transmission_;  // Start-of-transmission identifier
-        const std::vector<uint8_t> end_of_transmission_;    // End-of-transmission identifier
-        bool enable_checksum_validation_;       // Whether to validate checksum
-
     public:
         std::optional<std::string> decoded_text; // Successfully decoded text data
 
-        /**
-         * Default constructor using predefined start and end identifiers
-         */
         AudioDataBuffer();
 
         /**
-         * Constructor with custom parameters
-         * @param max_byte_size Expected maximum data size in bytes
-         * @param start_identifier Start-of-transmission identifier
-         * @param end_identifier End-of-transmission identifier
-         * @param enable_checksum Whether to enable checksum validation
+         * Push one demodulated bit
+         * @param bit Bit value (0 / 1)
+         * @return true if a complete frame was received and decoded into decoded_text
          */
-        AudioDataBuffer(size_t max_byte_size, const std::vector<uint8_t> &start_identifier,
-                      const std::vector<uint8_t> &end_identifier, bool enable_checksum = false);
-
-        /**
-         * Process probability data and attempt to decode
-         * @param probabilities Vector of Mark probabilities
-         * @param threshold Decision threshold for bit detection
-         * @return true if complete data was successfully received and decoded
-         */
-        bool ProcessProbabilityData(const std::vector<float> &probabilities, float threshold = 0.5f);
+        bool PushBit(uint8_t bit);
 
         /**
          * Calculate checksum for ASCII text
@@ -158,20 +110,18 @@ namespace audio_wifi_config
         static uint8_t CalculateChecksum(const std::string &text);
 
     private:
-        /**
-         * Convert bit vector to byte vector
-         * @param bits Input bit vector
-         * @return Converted byte vector
-         */
-        std::vector<uint8_t> ConvertBitsToBytes(const std::vector<uint8_t> &bits) const;
-
-        /**
-         * Clear all buffers and reset state
-         */
-        void ClearBuffers();
+        // 2 start bytes + 32 (SSID) + 1 (\n) + 63 (password) + 1 (checksum) + 2 end bytes
+        static constexpr size_t kMaxFrameBits = (2 + 32 + 1 + 63 + 1 + 2) * 8;
+        static constexpr size_t kHistoryBits = 1024;
+        static constexpr uint16_t kStartIdentifier = 0x0102;
+        static constexpr uint16_t kEndIdentifier = 0x0304;
+
+        std::array<uint8_t, kHistoryBits> history_;
+        size_t history_count_ = 0;   // Total number of bits received
+        uint16_t shift_register_ = 0;
+
+        uint8_t BitAt(size_t index) const { return history_[index % kHistoryBits]; }
+        uint8_t ByteAt(size_t index) const;
+        bool TryDecodeFrame();
     };
-
-    // Default start and end transmission identifiers
-    extern const std::vector<uint8_t> kDefaultStartTransmissionPattern;
-    extern const std::vector<uint8_t> kDefaultEndTransmissionPattern;
-}
\ No newline at end of file
+}
@@ -22,6 +22,7 @@ enum class NetworkEvent {
     Connecting,            // Network is connecting (data: SSID/network name)
     Connected,             // Network connected successfully (data: SSID/network name)
     Disconnected,          // Network disconnected
+    Handover,              // Connections should move to the new GetNetwork() (data: network name)
     WifiConfigModeEnter,   // Entered WiFi configuration mode
     WifiConfigModeExit,    // Exited WiFi configuration mode
     // Cellular modem specific events
@@ -76,6 +77,8 @@ public:
     virtual NetworkInterface* GetNetwork() = 0;
     virtual void StartNetwork() = 0;
     virtual void SetNetworkEventCallback(NetworkEventCallback callback) { (void)callback; }
+    // Called after the connections have moved to the new network of a Handover event
+    virtual void ReleasePreviousNetwork() {}
     virtual const char* GetNetworkStateIcon() = 0;
     virtual bool GetBatteryLevel(int &level, bool& charging, bool& discharging);
     virtual std::string GetSystemInfoJson();
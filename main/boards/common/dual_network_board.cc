@@ -5,8 +5,20 @@
 #include "settings.h"
 #include <esp_log.h>
 
+#if CONFIG_NETWORK_FAILOVER
+#include <wifi_manager.h>
+#endif
+
 static const char *TAG = "DualNetworkBoard";
 
+#if CONFIG_NETWORK_FAILOVER
+// RSSI is sampled every 2 seconds, 3 weak samples in a row start the 4G link
+static constexpr int SIGNAL_CHECK_INTERVAL_MS = 2000;
+static constexpr int WEAK_SIGNAL_SAMPLES = 3;
+// A WiFi disconnect is held back this long while the 4G link registers
+static constexpr int STANDBY_TIMEOUT_MS = 30000;
+#endif
+
 DualNetworkBoard::DualNetworkBoard(gpio_num_t ml307_tx_pin, gpio_num_t ml307_rx_pin, gpio_num_t ml307_dtr_pin, int32_t default_net_type) 
     : Board(), 
       ml307_tx_pin_(ml307_tx_pin), 
@@ -18,6 +30,45 @@ DualNetworkBoard::DualNetworkBoard(gpio_num_t ml307_tx_pin, gpio_num_t ml307_rx_
     
     // 只初始化当前网络类型对应的板卡
     InitializeCurrentBoard();
+
+#if CONFIG_NETWORK_FAILOVER
+    esp_timer_create_args_t timer_args = {
+        .callback = [](void* arg) {
+            static_cast<DualNetworkBoard*>(arg)->CheckWifiSignal();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_signal",
+        .skip_unhandled_events = true
+    };
+    esp_timer_create(&timer_args, &signal_timer_);
+
+    esp_timer_create_args_t standby_timer_args = {
+        .callback = [](void* arg) {
+            auto board = static_cast<DualNetworkBoard*>(arg);
+            ESP_LOGW(TAG, "Standby 4G link is not ready after %d ms", STANDBY_TIMEOUT_MS);
+            board->ForwardHeldDisconnect();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "standby_timeout",
+        .skip_unhandled_events = true
+    };
+    esp_timer_create(&standby_timer_args, &standby_timer_);
+#endif
+}
+
+DualNetworkBoard::~DualNetworkBoard() {
+#if CONFIG_NETWORK_FAILOVER
+    if (signal_timer_ != nullptr) {
+        esp_timer_stop(signal_timer_);
+        esp_timer_delete(signal_timer_);
+    }
+    if (standby_timer_ != nullptr) {
+        esp_timer_stop(standby_timer_);
+        esp_timer_delete(standby_timer_);
+    }
+#endif
 }
 
 NetworkType DualNetworkBoard::LoadNetworkTypeFromSettings(int32_t default_net_type) {
@@ -70,12 +121,149 @@ void DualNetworkBoard::StartNetwork() {
         display->SetStatus(Lang::Strings::DETECTING_MODULE);
     }
     current_board_->StartNetwork();
+
+#if CONFIG_NETWORK_FAILOVER
+    if (network_type_ == NetworkType::WIFI) {
+        esp_timer_start_periodic(signal_timer_, SIGNAL_CHECK_INTERVAL_MS * 1000);
+    }
+#endif
 }
 
 void DualNetworkBoard::SetNetworkEventCallback(NetworkEventCallback callback) {
-    // Forward the callback to the current board
-    current_board_->SetNetworkEventCallback(std::move(callback));
+    network_event_callback_ = std::move(callback);
+    current_board_->SetNetworkEventCallback([this](NetworkEvent event, const std::string& data) {
+        OnBoardNetworkEvent(event, data);
+    });
+}
+
+void DualNetworkBoard::OnBoardNetworkEvent(NetworkEvent event, const std::string& data) {
+#if CONFIG_NETWORK_FAILOVER
+    if (handover_done_) {
+        // The released WiFi board, the application only follows the 4G link from here on
+        return;
+    }
+
+    if (network_type_ == NetworkType::WIFI) {
+        if (event == NetworkEvent::Connected) {
+            wifi_connected_ = true;
+            weak_signal_count_ = 0;
+            // WiFi came back first, the held disconnect is no longer true
+            disconnect_held_ = false;
+            esp_timer_stop(standby_timer_);
+        } else if (event == NetworkEvent::Disconnected && wifi_connected_.exchange(false)) {
+            // WiFi dropped before its signal looked weak, 4G is still the quickest way back.
+            // The disconnect would close the conversation, so it waits for the handover instead.
+            StartStandbyNetwork();
+            disconnect_held_ = true;
+            esp_timer_stop(standby_timer_);
+            esp_timer_start_once(standby_timer_, STANDBY_TIMEOUT_MS * 1000);
+            ESP_LOGI(TAG, "WiFi disconnected, holding it back while the 4G link comes up");
+            return;
+        }
+    }
+#endif
+
+    if (network_event_callback_) {
+        network_event_callback_(event, data);
+    }
+}
+
+void DualNetworkBoard::ReleasePreviousNetwork() {
+#if CONFIG_NETWORK_FAILOVER
+    if (!handover_done_) {
+        return;
+    }
+    // The WiFi board stays allocated, WifiManager keeps its event callback
+    ESP_LOGI(TAG, "Connections moved to 4G, stopping WiFi");
+    WifiManager::GetInstance().StopStation();
+#endif
+}
+
+#if CONFIG_NETWORK_FAILOVER
+void DualNetworkBoard::CheckWifiSignal() {
+    auto& wifi = WifiManager::GetInstance();
+    if (standby_started_ || !wifi.IsConnected()) {
+        return;
+    }
+
+    int rssi = wifi.GetRssi();
+    if (rssi >= CONFIG_NETWORK_FAILOVER_RSSI) {
+        weak_signal_count_ = 0;
+        return;
+    }
+    if (++weak_signal_count_ >= WEAK_SIGNAL_SAMPLES) {
+        ESP_LOGW(TAG, "WiFi RSSI %d dBm is below %d dBm", rssi, CONFIG_NETWORK_FAILOVER_RSSI);
+        StartStandbyNetwork();
+    }
+}
+
+void DualNetworkBoard::ForwardHeldDisconnect() {
+    esp_timer_stop(standby_timer_);
+    if (disconnect_held_.exchange(false) && network_event_callback_) {
+        network_event_callback_(NetworkEvent::Disconnected, "");
+    }
+}
+
+void DualNetworkBoard::StartStandbyNetwork() {
+    if (standby_started_.exchange(true)) {
+        return;
+    }
+    esp_timer_stop(signal_timer_);
+
+    // Make before break: the 4G link registers while WiFi still carries the conversation
+    ESP_LOGI(TAG, "Starting the standby 4G link");
+    PowerOnStandbyModem();
+    standby_board_ = std::make_unique<Ml307Board>(ml307_tx_pin_, ml307_rx_pin_, ml307_dtr_pin_);
+    standby_board_->SetNetworkEventCallback([this](NetworkEvent event, const std::string& data) {
+        OnStandbyNetworkEvent(event, data);
+    });
+    standby_board_->StartNetwork();
+}
+
+void DualNetworkBoard::OnStandbyNetworkEvent(NetworkEvent event, const std::string& data) {
+    if (handover_done_) {
+        // The 4G board is the current board now
+        if (network_event_callback_) {
+            network_event_callback_(event, data);
+        }
+        return;
+    }
+
+    // The conversation still runs on WiFi, only the readiness of the 4G link matters
+    if (event == NetworkEvent::Connected) {
+        Application::GetInstance().Schedule([this]() {
+            HandOverToStandby();
+        }, kMainTaskPriorityNormal, "network_handover");
+    } else if (event == NetworkEvent::ModemErrorNoSim || event == NetworkEvent::ModemErrorRegDenied ||
+               event == NetworkEvent::ModemErrorInitFailed || event == NetworkEvent::ModemErrorTimeout) {
+        // 4G will not come up, the application learns about the lost WiFi after all
+        ESP_LOGW(TAG, "Standby 4G link failed, event %d", static_cast<int>(event));
+        ForwardHeldDisconnect();
+    } else {
+        ESP_LOGI(TAG, "Standby 4G link event %d", static_cast<int>(event));
+    }
+}
+
+void DualNetworkBoard::HandOverToStandby() {
+    // Runs in the main task, GetNetwork() returns the 4G interface from here on.
+    // The application moves its connections, then calls ReleasePreviousNetwork().
+    // handover_done_ is set first, so WiFi events are dropped and 4G events forwarded
+    // before the boards are swapped
+    if (handover_done_.exchange(true)) {
+        return;
+    }
+    ESP_LOGI(TAG, "Standby 4G link is ready, handing over from WiFi");
+    network_type_ = NetworkType::ML307;
+    std::swap(current_board_, standby_board_);
+    // The session is moved by the handover, a held WiFi disconnect must not close it
+    disconnect_held_ = false;
+    esp_timer_stop(standby_timer_);
+
+    if (network_event_callback_) {
+        network_event_callback_(NetworkEvent::Handover, "");
+    }
 }
+#endif
 
 NetworkInterface* DualNetworkBoard::GetNetwork() {
     return current_board_->GetNetwork();
@@ -4,6 +4,8 @@
 #include "board.h"
 #include "wifi_board.h"
 #include "ml307_board.h"
+#include <esp_timer.h>
+#include <atomic>
 #include <memory>
 
 //enum NetworkType
@@ -17,7 +19,8 @@ class DualNetworkBoard : public Board {
 private:
     // 使用基类指针存储当前活动的板卡
     std::unique_ptr<Board> current_board_;
-    NetworkType network_type_ = NetworkType::ML307;  // Default to ML307
+    // 切换在主任务中进行，网络事件任务与定时器任务也会读取
+    std::atomic<NetworkType> network_type_{NetworkType::ML307};  // Default to ML307
 
     // ML307的引脚配置
     gpio_num_t ml307_tx_pin_;
@@ -32,10 +35,39 @@ private:
 
     // 初始化当前网络类型对应的板卡
     void InitializeCurrentBoard();
- 
+
+    // 应用层的网络事件回调，子板卡的事件经过 OnBoardNetworkEvent 过滤后转发
+    NetworkEventCallback network_event_callback_;
+    void OnBoardNetworkEvent(NetworkEvent event, const std::string& data);
+
+#if CONFIG_NETWORK_FAILOVER
+    // Wi-Fi 信号变差时提前建立的 4G 链路，切换后改为保存已停用的 Wi-Fi 板卡。
+    // 只在 StartStandbyNetwork 中创建、在主任务的 HandOverToStandby 中交换，事件回调不访问它
+    std::unique_ptr<Board> standby_board_;
+    esp_timer_handle_t signal_timer_ = nullptr;
+    std::atomic<bool> standby_started_{false};
+    // Wi-Fi 断开事件在 4G 就绪前暂不转发，切换成功后丢弃，4G 失败或超时再转发
+    esp_timer_handle_t standby_timer_ = nullptr;
+    std::atomic<bool> disconnect_held_{false};
+    std::atomic<bool> handover_done_{false};
+    std::atomic<bool> wifi_connected_{false};
+    std::atomic<int> weak_signal_count_{0};
+
+    // 4G 板卡的事件：切换前只关心链路是否就绪，切换后与当前板卡一样转发给应用层
+    void OnStandbyNetworkEvent(NetworkEvent event, const std::string& data);
+    void CheckWifiSignal();
+    void StartStandbyNetwork();
+    void ForwardHeldDisconnect();
+    void HandOverToStandby();
+#endif
+
+protected:
+    // Boards that keep the 4G module powered off on Wi-Fi turn it on here before failover
+    virtual void PowerOnStandbyModem() {}
+
 public:
     DualNetworkBoard(gpio_num_t ml307_tx_pin, gpio_num_t ml307_rx_pin, gpio_num_t ml307_dtr_pin = GPIO_NUM_NC, int32_t default_net_type = 1);
-    virtual ~DualNetworkBoard() = default;
+    virtual ~DualNetworkBoard();
  
     // 切换网络类型
     void SwitchNetworkType();
@@ -50,6 +82,7 @@ public:
     virtual std::string GetBoardType() override;
     virtual void StartNetwork() override;
     virtual void SetNetworkEventCallback(NetworkEventCallback callback) override;
+    virtual void ReleasePreviousNetwork() override;
     virtual NetworkInterface* GetNetwork() override;
     virtual const char* GetNetworkStateIcon() override;
     virtual void SetPowerSaveLevel(PowerSaveLevel level) override;
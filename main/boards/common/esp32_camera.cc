@@ -1,6 +1,7 @@
 #include "sdkconfig.h"
 
 #include <esp_heap_caps.h>
+#include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <esp_log.h>
@@ -17,6 +18,60 @@
 
 #define TAG "Esp32Camera"
 
+namespace {
+
+// 编码线程与上传方共享的状态，Explain() 返回前总会 join 编码线程
+struct JpegEncodeJob {
+    QueueHandle_t queue;
+    std::atomic<bool> aborted{false};  // 上传方已放弃，编码线程不再入队
+    std::atomic<bool> failed{false};   // 编码或内存分配失败，图像不完整
+};
+
+// 队列满时分段等待，上传方放弃后编码线程可以退出而不是永久阻塞
+bool SendJpegChunk(JpegEncodeJob* job, const JpegChunk& chunk) {
+    while (xQueueSend(job->queue, &chunk, pdMS_TO_TICKS(100)) != pdPASS) {
+        if (job->aborted) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 结束标记由编码线程在 image_to_jpeg_cb 返回后统一发送，这里只转发数据块
+size_t QueueJpegChunk(void* arg, size_t index, const void* data, size_t len) {
+    auto job = static_cast<JpegEncodeJob*>(arg);
+    if (data == nullptr || len == 0) {
+        return len;
+    }
+    if (job->aborted) {
+        return 0;
+    }
+    JpegChunk chunk = {.data = nullptr, .len = len};
+    chunk.data = (uint8_t*)heap_caps_aligned_alloc(16, len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (chunk.data == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate %zu bytes for JPEG chunk", len);
+        job->failed = true;
+        return 0;
+    }
+    memcpy(chunk.data, data, len);
+    if (!SendJpegChunk(job, chunk)) {
+        heap_caps_free(chunk.data);
+        return 0;
+    }
+    return len;
+}
+
+// 编码线程的最后一步：记录结果并发送结束标记
+void FinishJpegEncode(JpegEncodeJob* job, bool ok) {
+    if (!ok) {
+        job->failed = true;
+    }
+    JpegChunk chunk = {.data = nullptr, .len = 0};
+    SendJpegChunk(job, chunk);
+}
+
+} // namespace
+
 Esp32Camera::Esp32Camera(const camera_config_t &config) {
     esp_err_t err = esp_camera_init(&config);
     if (err != ESP_OK) {
@@ -143,7 +198,8 @@ std::string Esp32Camera::Explain(const std::string &question) {
     }
 
     // Start encoding thread
-    encoder_thread_ = std::thread([this, jpeg_queue]() {
+    JpegEncodeJob job{jpeg_queue};
+    encoder_thread_ = std::thread([this, &job]() {
         int64_t start_time = esp_timer_get_time();
         uint16_t w = current_fb_->width;
         uint16_t h = current_fb_->height;
@@ -169,32 +225,12 @@ std::string Esp32Camera::Explain(const std::string &question) {
                 break;
             default:
                 ESP_LOGE(TAG, "Unsupported pixel format: %d", current_fb_->format);
+                FinishJpegEncode(&job, false);
                 return;
         }
 
-        bool ok = image_to_jpeg_cb(current_fb_->buf, current_fb_->len, w, h, enc_fmt, 80,
-            [](void* arg, size_t index, const void* data, size_t len) -> size_t {
-                auto jpeg_queue = static_cast<QueueHandle_t>(arg);
-                JpegChunk chunk = {.data = nullptr, .len = len};
-                if (index == 0 && data != nullptr && len > 0) {
-                    chunk.data = (uint8_t*)heap_caps_aligned_alloc(16, len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-                    if (chunk.data == nullptr) {
-                        ESP_LOGE(TAG, "Failed to allocate %zu bytes for JPEG chunk", len);
-                        chunk.len = 0;
-                    } else {
-                        memcpy(chunk.data, data, len);
-                    }
-                } else {
-                    chunk.len = 0;  // Sentinel or error
-                }
-                xQueueSend(jpeg_queue, &chunk, portMAX_DELAY);
-                return len;
-            }, jpeg_queue);
-
-        if (!ok) {
-            JpegChunk chunk = {.data = nullptr, .len = 0};
-            xQueueSend(jpeg_queue, &chunk, portMAX_DELAY);
-        }
+        bool ok = image_to_jpeg_cb(current_fb_->buf, current_fb_->len, w, h, enc_fmt, 80, QueueJpegChunk, &job);
+        FinishJpegEncode(&job, ok);
         int64_t end_time = esp_timer_get_time();
         ESP_LOGI(TAG, "JPEG encoding time: %ld ms", int((end_time - start_time) / 1000));
     });
@@ -212,13 +248,13 @@ std::string Esp32Camera::Explain(const std::string &question) {
     http->SetHeader("Transfer-Encoding", "chunked");
     if (!http->Open("POST", explain_url_)) {
         ESP_LOGE(TAG, "Failed to connect to explain URL");
+        // 先让编码线程放弃入队再 join，队列容量小于分条输出的块数时不会卡死
+        job.aborted = true;
         encoder_thread_.join();
         JpegChunk chunk;
-        while (xQueueReceive(jpeg_queue, &chunk, portMAX_DELAY) == pdPASS) {
+        while (xQueueReceive(jpeg_queue, &chunk, 0) == pdPASS) {
             if (chunk.data != nullptr) {
                 heap_caps_free(chunk.data);
-            } else {
-                break;
             }
         }
         vQueueDelete(jpeg_queue);
@@ -258,11 +294,12 @@ std::string Esp32Camera::Explain(const std::string &question) {
         total_sent += chunk.len;
         heap_caps_free(chunk.data);
     }
+    job.aborted = true;
     encoder_thread_.join();
     vQueueDelete(jpeg_queue);
 
-    if (!saw_terminator || total_sent == 0) {
-        ESP_LOGE(TAG, "JPEG encoder failed or produced empty output");
+    if (!saw_terminator || total_sent == 0 || job.failed) {
+        ESP_LOGE(TAG, "JPEG encoder failed, image truncated or empty (%u bytes sent)", (unsigned)total_sent);
         throw std::runtime_error("Failed to encode image to JPEG");
     }
 
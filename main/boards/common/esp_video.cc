@@ -7,6 +7,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <esp_heap_caps.h>
+#include <atomic>
 #include <cstdio>
 #include <cstring>
 
@@ -56,6 +57,60 @@
 
 #define TAG "EspVideo"
 
+namespace {
+
+// 编码线程与上传方共享的状态，Explain() 返回前总会 join 编码线程
+struct JpegEncodeJob {
+    QueueHandle_t queue;
+    std::atomic<bool> aborted{false};  // 上传方已放弃，编码线程不再入队
+    std::atomic<bool> failed{false};   // 编码或内存分配失败，图像不完整
+};
+
+// 队列满时分段等待，上传方放弃后编码线程可以退出而不是永久阻塞
+bool SendJpegChunk(JpegEncodeJob* job, const JpegChunk& chunk) {
+    while (xQueueSend(job->queue, &chunk, pdMS_TO_TICKS(100)) != pdPASS) {
+        if (job->aborted) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 结束标记由编码线程在 image_to_jpeg_cb 返回后统一发送，这里只转发数据块
+size_t QueueJpegChunk(void* arg, size_t index, const void* data, size_t len) {
+    auto job = static_cast<JpegEncodeJob*>(arg);
+    if (data == nullptr || len == 0) {
+        return len;
+    }
+    if (job->aborted) {
+        return 0;
+    }
+    JpegChunk chunk = {.data = nullptr, .len = len};
+    chunk.data = (uint8_t*)heap_caps_aligned_alloc(16, len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (chunk.data == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate %zu bytes for JPEG chunk", len);
+        job->failed = true;
+        return 0;
+    }
+    memcpy(chunk.data, data, len);
+    if (!SendJpegChunk(job, chunk)) {
+        heap_caps_free(chunk.data);
+        return 0;
+    }
+    return len;
+}
+
+// 编码线程的最后一步：记录结果并发送结束标记
+void FinishJpegEncode(JpegEncodeJob* job, bool ok) {
+    if (!ok) {
+        job->failed = true;
+    }
+    JpegChunk chunk = {.data = nullptr, .len = 0};
+    SendJpegChunk(job, chunk);
+}
+
+} // namespace
+
 #if defined(CONFIG_CAMERA_SENSOR_SWAP_PIXEL_BYTE_ORDER) || defined(CONFIG_XIAOZHI_ENABLE_CAMERA_ENDIANNESS_SWAP)
 #warning \
     "CAMERA_SENSOR_SWAP_PIXEL_BYTE_ORDER or CONFIG_XIAOZHI_ENABLE_CAMERA_ENDIANNESS_SWAP is enabled, which may cause image corruption in YUV422 format!"
@@ -910,35 +965,13 @@ std::string EspVideo::Explain(const std::string& question) {
     }
 
     // We spawn a thread to encode the image to JPEG using optimized encoder (cost about 500ms and 8KB SRAM)
-    encoder_thread_ = std::thread([this, jpeg_queue]() {
+    JpegEncodeJob job{jpeg_queue};
+    encoder_thread_ = std::thread([this, &job]() {
         uint16_t w = frame_.width ? frame_.width : 320;
         uint16_t h = frame_.height ? frame_.height : 240;
         v4l2_pix_fmt_t enc_fmt = frame_.format;
-        bool ok = image_to_jpeg_cb(
-            frame_.data, frame_.len, w, h, enc_fmt, 80,
-            [](void* arg, size_t index, const void* data, size_t len) -> size_t {
-                auto jpeg_queue = static_cast<QueueHandle_t>(arg);
-                JpegChunk chunk = {.data = nullptr, .len = len};
-                if (index == 0 && data != nullptr && len > 0) {
-                    chunk.data = (uint8_t*)heap_caps_aligned_alloc(16, len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-                    if (chunk.data == nullptr) {
-                        ESP_LOGE(TAG, "Failed to allocate %zu bytes for JPEG chunk", len);
-                        chunk.len = 0;
-                    } else {
-                        memcpy(chunk.data, data, len);
-                    }
-                } else {
-                    chunk.len = 0;  // Sentinel or error
-                }
-                xQueueSend(jpeg_queue, &chunk, portMAX_DELAY);
-                return len;
-            },
-            jpeg_queue);
-
-        if (!ok) {
-            JpegChunk chunk = {.data = nullptr, .len = 0};
-            xQueueSend(jpeg_queue, &chunk, portMAX_DELAY);
-        }
+        bool ok = image_to_jpeg_cb(frame_.data, frame_.len, w, h, enc_fmt, 80, QueueJpegChunk, &job);
+        FinishJpegEncode(&job, ok);
     });
 
     auto network = Board::GetInstance().GetNetwork();
@@ -956,14 +989,13 @@ std::string EspVideo::Explain(const std::string& question) {
     http->SetHeader("Transfer-Encoding", "chunked");
     if (!http->Open("POST", explain_url_)) {
         ESP_LOGE(TAG, "Failed to connect to explain URL");
-        // Clear the queue
+        // 先让编码线程放弃入队再 join，队列容量小于分条输出的块数时不会卡死
+        job.aborted = true;
         encoder_thread_.join();
         JpegChunk chunk;
-        while (xQueueReceive(jpeg_queue, &chunk, portMAX_DELAY) == pdPASS) {
+        while (xQueueReceive(jpeg_queue, &chunk, 0) == pdPASS) {
             if (chunk.data != nullptr) {
                 heap_caps_free(chunk.data);
-            } else {
-                break;
             }
         }
         vQueueDelete(jpeg_queue);
@@ -1007,12 +1039,13 @@ std::string EspVideo::Explain(const std::string& question) {
         heap_caps_free(chunk.data);
     }
     // Wait for the encoder thread to finish
+    job.aborted = true;
     encoder_thread_.join();
     // 清理队列
     vQueueDelete(jpeg_queue);
 
-    if (!saw_terminator || total_sent == 0) {
-        ESP_LOGE(TAG, "JPEG encoder failed or produced empty output");
+    if (!saw_terminator || total_sent == 0 || job.failed) {
+        ESP_LOGE(TAG, "JPEG encoder failed, image truncated or empty (%u bytes sent)", (unsigned)total_sent);
         throw std::runtime_error("Failed to encode image to JPEG");
     }
 
@@ -1,9 +1,10 @@
 #include "k10_audio_codec.h"
+#include "pcm_convert.h"
 
 #include <esp_log.h>
 #include <driver/i2c_master.h>
 #include <driver/i2s_tdm.h>
-#include <cmath>
+#include <algorithm>
 
 static const char TAG[] = "K10AudioCodec";
 
@@ -199,27 +200,21 @@ int K10AudioCodec::Read(int16_t* dest, int samples) {
 
 int K10AudioCodec::Write(const int16_t* data, int samples) {
     if (output_enabled_) {
-        std::vector<int32_t> buffer(samples * 2);  // Allocate buffer for 2x samples
-
-        // Apply volume adjustment (same as before)
-        int32_t volume_factor = pow(double(output_volume_) / 100.0, 2) * 65536;
-        for (int i = 0; i < samples; i++) {
-            int64_t temp = int64_t(data[i]) * volume_factor;
-            if (temp > INT32_MAX) {
-            buffer[i * 2] = INT32_MAX;
-            } else if (temp < INT32_MIN) {
-            buffer[i * 2] = INT32_MIN;
-            } else {
-            buffer[i * 2] = static_cast<int32_t>(temp);
+        // Apply volume adjustment, repeat each sample for slow playback (assuming mono audio)
+        int32_t gain = pcm_volume_to_gain_q16(output_volume_);
+        int written = 0;
+        while (written < samples) {
+            int frames = std::min(samples - written, (int)AUDIO_CODEC_DMA_FRAME_NUM);
+            pcm_s16_to_s32_stereo(data + written, tx_buffer_, frames, gain);
+
+            size_t bytes_written;
+            ESP_ERROR_CHECK(i2s_channel_write(tx_handle_, tx_buffer_, frames * 2 * sizeof(int32_t), &bytes_written, portMAX_DELAY));
+            written += bytes_written / (2 * sizeof(int32_t));
+            if (bytes_written < frames * 2 * sizeof(int32_t)) {
+                break;
             }
-
-            // Repeat each sample for slow playback (assuming mono audio)
-            buffer[i * 2 + 1] = buffer[i * 2];
         }
-
-        size_t bytes_written;
-        ESP_ERROR_CHECK(i2s_channel_write(tx_handle_, buffer.data(), samples * 2 * sizeof(int32_t), &bytes_written, portMAX_DELAY));
-        return bytes_written / sizeof(int32_t);
+        return written;
     }
     return samples;
 }
@@ -18,6 +18,9 @@ private:
     esp_codec_dev_handle_t output_dev_ = nullptr;
     esp_codec_dev_handle_t input_dev_ = nullptr;
 
+    // 立体声 32 位输出缓冲区，按块复用
+    int32_t tx_buffer_[AUDIO_CODEC_DMA_FRAME_NUM * 2];
+
     void CreateDuplexChannels(gpio_num_t mclk, gpio_num_t bclk, gpio_num_t ws, gpio_num_t dout, gpio_num_t din);
 
     virtual int Read(int16_t* dest, int samples) override;
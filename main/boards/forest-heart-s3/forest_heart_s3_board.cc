@@ -15,6 +15,8 @@
 #include "mmw.h"
 #include "esp_lcd_gdew042t2.h"
 #include "led/rgbw_strip.h"
+#include "mcp_server.h"
+#include "settings.h"
 
 #define TAG "ForestHeartS3"
 
@@ -238,6 +240,24 @@ private:
         esp_lcd_panel_reset(panel);
         ESP_ERROR_CHECK(esp_lcd_panel_init(panel));
         display_ = new EpdDisplay(panel_io, panel, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        Settings settings("display", false);
+        static_cast<EpdDisplay*>(display_)->SetDithering(settings.GetBool("dithering", false));
+    }
+
+    void InitializeTools() {
+        auto& mcp_server = McpServer::GetInstance();
+        mcp_server.AddTool("self.screen.set_dithering",
+            "Enable ordered dithering on the e-paper screen. Use it when showing pictures, "
+            "disable it for sharper text.",
+            PropertyList({
+                Property("enable", kPropertyTypeBoolean)
+            }), [this](const PropertyList& properties) -> ReturnValue {
+                bool enable = properties["enable"].value<bool>();
+                static_cast<EpdDisplay*>(display_)->SetDithering(enable);
+                Settings settings("display", true);
+                settings.SetBool("dithering", enable);
+                return true;
+            });
     }
     // Init sdmmc
     void Sdmmc_Init(){
@@ -328,6 +348,7 @@ public:
         // Init_PresenSensor();
         // Init RgbStrip
         Init_RgbwStrip();
+        InitializeTools();
     }
     
     virtual AudioCodec* GetAudioCodec() override {
@@ -114,6 +114,9 @@ private:
         gpio_set_direction(ML307_POWER_PIN, GPIO_MODE_OUTPUT);
         gpio_set_level(ML307_POWER_PIN, ML307_POWER_OUTPUT_INVERT ? 1 : 0);
     }
+    virtual void PowerOnStandbyModem() override {
+        Enable4GModule();
+    }
 
     void InitializeCodecI2c() {
         // Initialize I2C peripheral
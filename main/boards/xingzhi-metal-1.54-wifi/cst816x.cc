@@ -126,8 +126,8 @@ void Cst816x::touchpad_daemon(void* arg) {
                 switch (current_event.type) {
                     case TouchEventType::SINGLE_CLICK:
                         if (current_event.x == 40) {
-                            board.SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
                             auto& app = Application::GetInstance();
+                            app.SetPowerSaveLevel(PowerSaveLevel::PERFORMANCE);
                             if (app.GetDeviceState() == kDeviceStateStarting) {
                                 auto& wifi_board = static_cast<WifiBoard&>(Board::GetInstance());
                                 wifi_board.EnterWifiConfigMode();
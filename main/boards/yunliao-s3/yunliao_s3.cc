@@ -244,6 +244,10 @@ class YunliaoS3 : public DualNetworkBoard {
         return true;
     }
 
+    virtual void PowerOnStandbyModem() override {
+        power_manager_->Start4G();
+    }
+
     virtual void SetPowerSaveLevel(PowerSaveLevel level) override {
         if (level != PowerSaveLevel::LOW_POWER) {
             power_save_timer_->WakeUp();
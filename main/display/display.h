@@ -14,6 +14,16 @@
 
 #include <string>
 #include <chrono>
+#include <atomic>
+
+// Status bar fields, sources mark the ones that changed and only those are rendered
+enum StatusBarField : uint32_t {
+    kStatusBarClock = 1 << 0,
+    kStatusBarBattery = 1 << 1,
+    kStatusBarNetwork = 1 << 2,
+    kStatusBarMute = 1 << 3,
+    kStatusBarAll = kStatusBarClock | kStatusBarBattery | kStatusBarNetwork | kStatusBarMute,
+};
 
 class Theme {
 public:
@@ -37,9 +47,13 @@ public:
     virtual void SetChatMessage(const char* role, const char* content);
     virtual void SetTheme(Theme* theme);
     virtual Theme* GetTheme() { return current_theme_; }
+    // Render the fields marked by InvalidateStatusBar, or all of them if update_all
     virtual void UpdateStatusBar(bool update_all = false);
     virtual void SetPowerSaveMode(bool on);
 
+    // Thread safe, use Application::InvalidateStatusBar to also trigger the rendering
+    void InvalidateStatusBar(uint32_t fields) { dirty_status_fields_.fetch_or(fields); }
+
     inline int width() const { return width_; }
     inline int height() const { return height_; }
 
@@ -48,6 +62,13 @@ protected:
     int height_ = 0;
 
     Theme* current_theme_ = nullptr;
+    std::atomic<uint32_t> dirty_status_fields_{kStatusBarAll};
+
+    // Returns and clears the dirty fields
+    uint32_t TakeDirtyStatusFields(bool update_all) {
+        uint32_t fields = dirty_status_fields_.exchange(0);
+        return update_all ? static_cast<uint32_t>(kStatusBarAll) : fields;
+    }
 
     friend class DisplayLockGuard;
     virtual bool Lock(int timeout_ms = 0) = 0;
@@ -91,19 +91,43 @@ lv_result_t lv_mem_test_core(void) {
 }
 
 
-static inline void set_pixel_1bpp_safe(uint8_t* buffer, int x, int y, int width, int height, bool is_white) {
-    if (x < 0 || x >= width || y < 0 || y >= height) return;
+// RGB565 -> 1bpp 阈值：与旧实现一致，color > 0x8000 视为白色。
+// 对一个装有两个像素的 32 位字并行计算，结果在 bit15 / bit31。
+static inline uint32_t threshold_pair(uint32_t w) {
+    return w & ((w & 0x7FFF7FFF) + 0x7FFF7FFF) & 0x80008000;
+}
 
-    // 1bpp compact layout: 8 pixels per byte
-    int stride = width / 8;
-    int idx = y * stride + (x / 8);
-    int bit = 7 - (x % 8); // MSB first
-    
-    if (is_white) {
-        buffer[idx] |= (1 << bit);
-    } else {
-        buffer[idx] &= ~(1 << bit);
-    }
+// 8 个像素 (4 个字) 打包为 1 字节，MSB 为最左侧像素
+static inline uint8_t pack8_threshold(uint32_t w0, uint32_t w1, uint32_t w2, uint32_t w3) {
+    uint32_t m0 = threshold_pair(w0);
+    uint32_t m1 = threshold_pair(w1);
+    uint32_t m2 = threshold_pair(w2);
+    uint32_t m3 = threshold_pair(w3);
+    return (uint8_t)(((m0 >> 8) & 0x80) | ((m0 >> 25) & 0x40) |
+                     ((m1 >> 10) & 0x20) | ((m1 >> 27) & 0x10) |
+                     ((m2 >> 12) & 0x08) | ((m2 >> 29) & 0x04) |
+                     ((m3 >> 14) & 0x02) | ((m3 >> 31) & 0x01));
+}
+
+static inline uint32_t threshold_pixel(uint16_t color) {
+    return ((uint32_t)color + 0x7FFF) >> 16;
+}
+
+// 4x4 Bayer 矩阵，按亮度 0..255 的阈值
+static const uint8_t kBayer4x4[4][4] = {
+    {   8, 136,  40, 168 },
+    { 200,  72, 232, 104 },
+    {  56, 184,  24, 152 },
+    { 248, 120, 216,  88 },
+};
+
+static inline uint32_t dither_pixel(uint16_t color, int x, int y) {
+    uint32_t r = (color >> 11) & 0x1F;
+    uint32_t g = (color >> 5) & 0x3F;
+    uint32_t b = color & 0x1F;
+    // 近似 BT.601 亮度，结果范围 0..255
+    uint32_t luma = (r * 314 + g * 304 + b * 120) >> 7;
+    return luma > kBayer4x4[y & 3][x & 3] ? 1 : 0;
 }
 
 void EpdDisplay::FlushCallback(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map)
@@ -113,22 +137,64 @@ void EpdDisplay::FlushCallback(lv_display_t* disp, const lv_area_t* area, uint8_
         lv_display_flush_ready(disp);
         return;
     }
+    int64_t start_time = esp_timer_get_time();
+
     int32_t w = area->x2 - area->x1 + 1;
-    int32_t h = area->y2 - area->y1 + 1;
-    uint16_t* src_pixels = (uint16_t*)px_map;
-    for (int y = 0; y < h; y++) {
-        for (int x = 0; x < w; x++) {
-            uint16_t color = src_pixels[y * w + x];
-            bool is_white = (color > 0x8000); 
-            set_pixel_1bpp_safe((uint8_t*)self->lvgl_buf_, 
-                                area->x1 + x, 
-                                area->y1 + y, 
-                                self->width_, 
-                                self->height_, 
-                                is_white);
+    // 裁剪一次，循环内不再做边界检查
+    int32_t x1 = std::max<int32_t>(area->x1, 0);
+    int32_t x2 = std::min<int32_t>(area->x2, self->width_ - 1);
+    int32_t y1 = std::max<int32_t>(area->y1, 0);
+    int32_t y2 = std::min<int32_t>(area->y2, self->height_ - 1);
+    const int stride = self->width_ / 8;
+    const uint16_t* src_pixels = (const uint16_t*)px_map;
+    uint8_t* dst = (uint8_t*)self->lvgl_buf_;
+    const bool dithering = self->dithering_;
+
+    for (int32_t y = y1; y <= y2; y++) {
+        const uint16_t* src = src_pixels + (y - area->y1) * w - area->x1;
+        uint8_t* row = dst + y * stride;
+        int32_t x = x1;
+
+        // 行首未对齐到字节的部分
+        while (x <= x2 && (x & 7) != 0) {
+            uint8_t bit = 0x80 >> (x & 7);
+            uint32_t white = dithering ? dither_pixel(src[x], x, y) : threshold_pixel(src[x]);
+            row[x >> 3] = white ? (row[x >> 3] | bit) : (row[x >> 3] & ~bit);
+            x++;
+        }
+
+        // 中间整字节部分
+        if (dithering) {
+            for (; x + 7 <= x2; x += 8) {
+                uint8_t byte = 0;
+                for (int i = 0; i < 8; i++) {
+                    byte |= dither_pixel(src[x + i], x + i, y) << (7 - i);
+                }
+                row[x >> 3] = byte;
+            }
+        } else if ((((uintptr_t)(src + x)) & 3) == 0) {
+            // 源地址 4 字节对齐时按字读取
+            for (; x + 7 <= x2; x += 8) {
+                const uint32_t* words = (const uint32_t*)(src + x);
+                row[x >> 3] = pack8_threshold(words[0], words[1], words[2], words[3]);
+            }
+        } else {
+            for (; x + 7 <= x2; x += 8) {
+                const uint16_t* p = src + x;
+                row[x >> 3] = pack8_threshold(p[0] | ((uint32_t)p[1] << 16), p[2] | ((uint32_t)p[3] << 16),
+                                              p[4] | ((uint32_t)p[5] << 16), p[6] | ((uint32_t)p[7] << 16));
+            }
+        }
+
+        // 行尾剩余像素
+        for (; x <= x2; x++) {
+            uint8_t bit = 0x80 >> (x & 7);
+            uint32_t white = dithering ? dither_pixel(src[x], x, y) : threshold_pixel(src[x]);
+            row[x >> 3] = white ? (row[x >> 3] | bit) : (row[x >> 3] & ~bit);
         }
     }
     self->is_dirty_ = true;
+    self->stats_.flush_cpu_us += esp_timer_get_time() - start_time;
     lv_display_flush_ready(disp);
 }
 
@@ -145,24 +211,168 @@ void EpdDisplay::FlushToHardware()
     last_refresh_time_ = now;
     {
         DisplayLockGuard lock(this);
+        std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
         memcpy(snapshot_buf_, lvgl_buf_, (width_ * height_) / 8);
         is_dirty_ = false;
     }
 
     EpdCmd cmd;
-    cmd.force_full_refresh = false; 
-    if (update_counter_ >= EPD_FULL_REFRESH_EVERY_X_FRAMES) {
-        cmd.force_full_refresh = true;
-    }
+    cmd.force_full_refresh = force_full_refresh_.exchange(false);
     xQueueOverwrite(display_queue_, &cmd);
 }
 
 // // Helper Functions
 void EpdDisplay::TriggerFullRefresh() {
-    update_counter_ = EPD_FULL_REFRESH_EVERY_X_FRAMES + 1;
+    force_full_refresh_ = true;
     is_dirty_ = true;
 }
 
+void EpdDisplay::SetDithering(bool enable) {
+    DisplayLockGuard lock(this);
+    if (dithering_ == enable) {
+        return;
+    }
+    dithering_ = enable;
+    if (display_) {
+        lv_obj_invalidate(lv_screen_active());
+    }
+}
+
+// 比较待发送快照与面板内容，按行合并为若干矩形窗口，返回窗口数量
+int EpdDisplay::CollectDirtyRegions(EpdRegion* regions, int max_regions) {
+    const int stride = width_ / 8;
+    const uint8_t* cur = (const uint8_t*)snapshot_buf_;
+    const uint8_t* old = (const uint8_t*)sent_buf_;
+    int count = 0;
+
+    for (int y = 0; y < height_; y++) {
+        const uint8_t* a = cur + y * stride;
+        const uint8_t* b = old + y * stride;
+        if (memcmp(a, b, stride) == 0) {
+            continue;
+        }
+        int first = 0;
+        while (a[first] == b[first]) first++;
+        int last = stride - 1;
+        while (a[last] == b[last]) last--;
+
+        if (count > 0) {
+            EpdRegion& prev = regions[count - 1];
+            if (y - prev.y_end <= EPD_DIRTY_REGION_MERGE_ROWS || count == max_regions) {
+                prev.y_end = y;
+                prev.x_byte_start = std::min(prev.x_byte_start, first);
+                prev.x_byte_end = std::max(prev.x_byte_end, last);
+                continue;
+            }
+        }
+        regions[count++] = { first, last, y, y };
+    }
+    return count;
+}
+
+// 相邻窗口间隔较小时合并为外接矩形（x 以字节为单位，天然 8 像素对齐），减少局刷次数
+int EpdDisplay::MergeNearbyRegions(EpdRegion* regions, int count) {
+    int merged = 0;
+    for (int i = 0; i < count; i++) {
+        if (merged > 0) {
+            EpdRegion& prev = regions[merged - 1];
+            // 窗口按行从上到下收集，只需与上一个比较
+            if (regions[i].y_start - prev.y_end - 1 <= EPD_PARTIAL_MERGE_GAP_ROWS) {
+                prev.y_end = regions[i].y_end;
+                prev.x_byte_start = std::min(prev.x_byte_start, regions[i].x_byte_start);
+                prev.x_byte_end = std::max(prev.x_byte_end, regions[i].x_byte_end);
+                continue;
+            }
+        }
+        regions[merged++] = regions[i];
+    }
+    return merged;
+}
+
+// 将窗口内的快照数据连续打包到 out，同步更新 sent_buf_，返回翻转的像素数
+int EpdDisplay::PackRegion(const EpdRegion& region, uint8_t* out) {
+    const int stride = width_ / 8;
+    const int bytes = region.x_byte_end - region.x_byte_start + 1;
+    int changed = 0;
+    for (int y = region.y_start; y <= region.y_end; y++) {
+        const uint8_t* src = (const uint8_t*)snapshot_buf_ + y * stride + region.x_byte_start;
+        uint8_t* sent = (uint8_t*)sent_buf_ + y * stride + region.x_byte_start;
+        for (int i = 0; i < bytes; i++) {
+            changed += __builtin_popcount(src[i] ^ sent[i]);
+        }
+        memcpy(out, src, bytes);
+        memcpy(sent, src, bytes);
+        out += bytes;
+    }
+    return changed;
+}
+
+void EpdDisplay::RefreshPanel(bool force_full_refresh) {
+    const size_t frame_size = (width_ * height_) / 8;
+    const int64_t ghosting_limit = (int64_t)width_ * height_ * EPD_GHOSTING_FULL_REFRESH_SCREENS;
+    EpdRegion regions[EPD_MAX_DIRTY_REGIONS];
+    uint8_t* region_data[EPD_MAX_DIRTY_REGIONS];
+    int region_count = 0;
+
+    int64_t start_time = esp_timer_get_time();
+    bool full_refresh = force_full_refresh || ghosting_pixels_ >= ghosting_limit ||
+                        partial_refresh_count_ >= EPD_MAX_PARTIAL_REFRESHES;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        if (full_refresh) {
+            memcpy(sent_buf_, snapshot_buf_, frame_size);
+        } else {
+            region_count = CollectDirtyRegions(regions, EPD_MAX_DIRTY_REGIONS);
+            region_count = MergeNearbyRegions(regions, region_count);
+            uint8_t* out = (uint8_t*)window_buf_;
+            for (int i = 0; i < region_count; i++) {
+                region_data[i] = out;
+                ghosting_pixels_ += PackRegion(regions[i], out);
+                out += (regions[i].x_byte_end - regions[i].x_byte_start + 1) *
+                       (regions[i].y_end - regions[i].y_start + 1);
+            }
+        }
+    }
+    stats_.flush_cpu_us += esp_timer_get_time() - start_time;
+
+    if (full_refresh) {
+        esp_lcd_gdew042t2_set_mode(panel_, GDEW042T2_REFRESH_FULL);
+        esp_lcd_panel_draw_bitmap(panel_, 0, 0, width_, height_, sent_buf_);
+        ghosting_pixels_ = 0;
+        partial_refresh_count_ = 0;
+        stats_.full_refreshes++;
+        ESP_LOGI(TAG, "E-Ink Task: FULL REFRESH DONE");
+        return;
+    }
+    if (region_count == 0) {
+        ESP_LOGD(TAG, "E-Ink Task: nothing changed");
+        return;
+    }
+
+    esp_lcd_gdew042t2_set_mode(panel_, GDEW042T2_REFRESH_PARTIAL);
+    for (int i = 0; i < region_count; i++) {
+        const EpdRegion& r = regions[i];
+        esp_lcd_gdew042t2_draw_partial(panel_, r.x_byte_start * 8, r.y_start,
+                                       (r.x_byte_end - r.x_byte_start + 1) * 8,
+                                       r.y_end - r.y_start + 1, region_data[i]);
+    }
+    partial_refresh_count_++;
+    stats_.partial_refreshes++;
+    stats_.regions_sent += region_count;
+    ESP_LOGI(TAG, "E-Ink Task: PARTIAL REFRESH DONE, regions: %d, ghosting: %lld/%lld",
+             region_count, ghosting_pixels_, ghosting_limit);
+}
+
+void EpdDisplay::LogRefreshStats() {
+    ESP_LOGI(TAG, "Conversation refresh stats: flush cpu %lld us, partial %d (%d regions), full %d",
+             stats_.flush_cpu_us.load(), stats_.partial_refreshes.load(),
+             stats_.regions_sent.load(), stats_.full_refreshes.load());
+    stats_.flush_cpu_us = 0;
+    stats_.partial_refreshes = 0;
+    stats_.regions_sent = 0;
+    stats_.full_refreshes = 0;
+}
+
 // LOCKING: Must be blocking to prevent race conditions
 bool EpdDisplay::Lock(int timeout_ms) {
     if (timeout_ms == 0) timeout_ms = 1000;
@@ -212,8 +422,10 @@ EpdDisplay::EpdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_handle_
 
     uint32_t safe_snapshot_size = 32 * 1024; 
     snapshot_buf_ = heap_caps_calloc(1, safe_snapshot_size, MALLOC_CAP_SPIRAM);
+    sent_buf_ = heap_caps_calloc(1, full_1bpp_size, MALLOC_CAP_SPIRAM);
+    window_buf_ = heap_caps_malloc(full_1bpp_size, MALLOC_CAP_SPIRAM);
 
-    if (!lvgl_buf_ || !snapshot_buf_ || !draw_buf_) {
+    if (!lvgl_buf_ || !snapshot_buf_ || !sent_buf_ || !window_buf_ || !draw_buf_) {
         ESP_LOGE(TAG, "Failed to allocate buffers!");
         lvgl_port_unlock();
         return;
@@ -249,6 +461,8 @@ EpdDisplay::~EpdDisplay() {
 
     if (lvgl_buf_) free(lvgl_buf_);
     if (snapshot_buf_) free(snapshot_buf_);
+    if (sent_buf_) free(sent_buf_);
+    if (window_buf_) free(window_buf_);
     if (draw_buf_) free(draw_buf_);
 
     if (panel_) esp_lcd_panel_del(panel_);
@@ -292,15 +506,7 @@ void EpdDisplay::DisplayTask(void* arg) {
         // 1. 阻塞等待命令。没有命令时，线程休眠，不占用 CPU。
         if (xQueueReceive(self->display_queue_, &cmd, portMAX_DELAY)) {
             ESP_LOGD(TAG, "E-Ink Task: Start Refresh...");
-            if (self->update_counter_ >= EPD_FULL_REFRESH_EVERY_X_FRAMES || cmd.force_full_refresh) {
-                 esp_lcd_gdew042t2_set_mode(self->panel_, GDEW042T2_REFRESH_FULL);
-                 self->update_counter_ = 0;
-            } else {
-                 esp_lcd_gdew042t2_set_mode(self->panel_, GDEW042T2_REFRESH_PARTIAL);
-                 self->update_counter_++; 
-            }
-            esp_lcd_panel_draw_bitmap(self->panel_, 0, 0, self->width_, self->height_, self->snapshot_buf_);
-            ESP_LOGI(TAG, "E-Ink Task: FLUSH DONE");
+            self->RefreshPanel(cmd.force_full_refresh);
         }
     }
 }
@@ -347,6 +553,9 @@ void EpdDisplay::SetStatus(const char* status) {
     if (strcmp(status, last_status_str) != 0) {
         bool need_full_refresh = false;
         if (strcmp(status, Lang::Strings::STANDBY) == 0) {
+            if (last_status_str[0] != '\0') {
+                LogRefreshStats();
+            }
             if (guider_ui != nullptr && guider_ui->screen != nullptr) {
                 if (lv_scr_act() != guider_ui->screen) {
                     lv_scr_load(guider_ui->screen);
@@ -363,7 +572,6 @@ void EpdDisplay::SetStatus(const char* status) {
                     need_full_refresh = true; 
                 }
             }
-            update_counter_++;
             if (strcmp(last_status_str, Lang::Strings::SPEAKING) != 0) {
                 need_full_refresh = true;
             }
@@ -428,10 +636,15 @@ void EpdDisplay::SetEmotion(const char* emotion) {
 }
 
 void EpdDisplay::UpdateStatusBar(bool update_all) {
+    uint32_t fields = TakeDirtyStatusFields(update_all);
+    if (fields == 0) {
+        return;
+    }
+
     auto& app = Application::GetInstance();
     auto& board = Board::GetInstance();
     // Update time
-    if (app.GetDeviceState() == kDeviceStateIdle) {
+    if ((fields & kStatusBarClock) && app.GetDeviceState() == kDeviceStateIdle) {
         if (last_status_update_time_ + std::chrono::seconds(10) < std::chrono::system_clock::now()) {
             time_t now = time(NULL);
             struct tm* tm = localtime(&now);
@@ -448,7 +661,7 @@ void EpdDisplay::UpdateStatusBar(bool update_all) {
     int battery_level;
     bool charging, discharging;
     const char* icon = nullptr;
-    if (board.GetBatteryLevel(battery_level, charging, discharging)) {
+    if ((fields & kStatusBarBattery) && board.GetBatteryLevel(battery_level, charging, discharging)) {
         if (battery_level < 0) {
             icon = FONT_AWESOME_BATTERY_SLASH;
         } 
@@ -484,9 +697,8 @@ void EpdDisplay::UpdateStatusBar(bool update_all) {
             }
         }
     }
-    // Update network icon every 10 seconds
-    static int seconds_counter = 0;
-    if (update_all || seconds_counter++ % 10 == 0) {
+    // Update network icon
+    if (fields & kStatusBarNetwork) {
         auto device_state = Application::GetInstance().GetDeviceState();
         static const std::vector<DeviceState> allowed_states = {
             kDeviceStateIdle,
@@ -506,14 +718,18 @@ void EpdDisplay::UpdateStatusBar(bool update_all) {
 
     esp_pm_lock_release(pm_lock_);
 
-    // Update weather every 1 hour (check cache)
-    static int weather_counter = 0;
-    if (update_all || weather_counter++ % 1800 == 0) {
+    // The status bar is no longer refreshed every second, so use elapsed time
+    int64_t now_us = esp_timer_get_time();
+    // Update weather every 30 minutes (check cache)
+    static int64_t last_weather_us = 0;
+    if (update_all || last_weather_us == 0 || now_us - last_weather_us >= 1800LL * 1000 * 1000) {
+        last_weather_us = now_us;
         UpdateWeatherUI();
     }
     // Update date per hour
-    static int date_counter = 0;
-    if (update_all || date_counter++ % 3600 == 0) {
+    static int64_t last_date_us = 0;
+    if (update_all || last_date_us == 0 || now_us - last_date_us >= 3600LL * 1000 * 1000) {
+        last_date_us = now_us;
         UpdateDateDisplay();
     }
 }
@@ -6,9 +6,19 @@
 #include <esp_lcd_panel_ops.h>
 #include <esp_timer.h>
 #include <memory>
+#include <mutex>
+#include <atomic>
 
-// 定义全刷新的阈值 (每更新几次文字执行一次全刷去残影)
-#define EPD_FULL_REFRESH_EVERY_X_FRAMES 10
+// 残影累计阈值：局刷累计翻转的像素数达到 N 个整屏时执行一次全刷
+#define EPD_GHOSTING_FULL_REFRESH_SCREENS 3
+// 局刷次数上限，即使变化很小也定期全刷
+#define EPD_MAX_PARTIAL_REFRESHES 40
+// 每次局刷最多的窗口数量，超过后合并
+#define EPD_MAX_DIRTY_REGIONS 4
+// 两个脏行之间相隔不超过该行数时合并为同一个窗口
+#define EPD_DIRTY_REGION_MERGE_ROWS 8
+// 每个局刷窗口都是一次完整的刷新周期（面板会闪一次），窗口间隔不超过该行数时合并成一个外接矩形
+#define EPD_PARTIAL_MERGE_GAP_ROWS 64
 
 class EpdDisplay : public LvglDisplay {
 private:
@@ -22,16 +32,40 @@ private:
 
 
     QueueHandle_t display_queue_ = nullptr;
-    int update_counter_ = 0;
     int64_t last_refresh_time_ = 0; // 上一次刷新发送的时间 (us)
     // 定义发送给显示线程的命令
     struct EpdCmd {
         bool force_full_refresh; // 是否强制全刷（可选）
     };
-    void* lvgl_buf_ = nullptr;
-    void* snapshot_buf_ = nullptr;
+    // 局刷窗口，x 以字节 (8 像素) 为单位，均为闭区间
+    struct EpdRegion {
+        int x_byte_start;
+        int x_byte_end;
+        int y_start;
+        int y_end;
+    };
+    // 每轮对话的刷新统计
+    struct EpdRefreshStats {
+        std::atomic<int64_t> flush_cpu_us{0};
+        std::atomic<int> partial_refreshes{0};
+        std::atomic<int> full_refreshes{0};
+        std::atomic<int> regions_sent{0};
+    };
+
+    void* lvgl_buf_ = nullptr;      // LVGL 渲染结果 (1bpp)
+    void* snapshot_buf_ = nullptr;  // 等待发送的快照 (1bpp)
+    void* sent_buf_ = nullptr;      // 面板上当前显示的内容 (1bpp)
+    void* window_buf_ = nullptr;    // 局刷窗口数据的打包缓冲区
     void* draw_buf_ = nullptr;
     volatile bool is_dirty_ = false;
+    bool dithering_ = false;
+    std::atomic<bool> force_full_refresh_{false};
+    std::mutex snapshot_mutex_;
+
+    // 以下仅在 DisplayTask 中访问
+    int64_t ghosting_pixels_ = 0;
+    int partial_refresh_count_ = 0;
+    EpdRefreshStats stats_;
 
     esp_timer_handle_t refresh_timer_ = nullptr;
 
@@ -42,6 +76,11 @@ private:
     // "假"的刷新回调，只做标记
     static void FlushCallback(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map);
     static void DisplayTask(void* arg);
+    void RefreshPanel(bool force_full_refresh);
+    int CollectDirtyRegions(EpdRegion* regions, int max_regions);
+    int MergeNearbyRegions(EpdRegion* regions, int count);
+    int PackRegion(const EpdRegion& region, uint8_t* out);
+    void LogRefreshStats();
 
     virtual bool Lock(int timeout_ms = 0) override;
     virtual void Unlock() override;
@@ -61,6 +100,8 @@ public:
     void FlushToHardware();
     void TriggerFullRefresh();
     void UpdateDateDisplay();
+    // 启用后按亮度做 4x4 有序抖动，适合显示图片；关闭时为简单阈值
+    void SetDithering(bool enable);
     
     virtual void SetChatMessage(const char* role, const char* content) override;
     virtual void SetEmotion(const char* emotion) override;
@@ -1,8 +1,10 @@
 #include <esp_attr.h>
 #include <esp_heap_caps.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <stddef.h>
 #include <string.h>
+#include <new>
 #include <utility>
 
 #include "esp_jpeg_common.h"
@@ -35,6 +37,46 @@ static __always_inline uint8_t expand_6_to_8(uint8_t v) {
     return (uint8_t)((v << 2) | (v >> 4));
 }
 
+// 交换每个 16 位内的两个字节：UYVY <-> YUYV 重排与 YUYV 大端化共用。
+// 对齐时按 32 位字处理，循环体无分支，编译器可直接展开/向量化。
+static void swap_bytes16(const uint8_t* __restrict src, uint8_t* __restrict dst, size_t bytes) {
+    size_t i = 0;
+    if ((((uintptr_t)src | (uintptr_t)dst) & 3) == 0) {
+        const uint32_t* s = (const uint32_t*)src;
+        uint32_t* d = (uint32_t*)dst;
+        size_t words = bytes / 4;
+        for (size_t w = 0; w < words; w++) {
+            uint32_t v = s[w];
+            d[w] = ((v & 0x00FF00FF) << 8) | ((v >> 8) & 0x00FF00FF);
+        }
+        i = words * 4;
+    }
+    for (; i + 1 < bytes; i += 2) {
+        dst[i] = src[i + 1];
+        dst[i + 1] = src[i];
+    }
+}
+
+// YUV422P 的一行 (Y, U, V 三个平面) 交织为 YUYV
+static void pack_yuv422p_row(const uint8_t* __restrict y_row, const uint8_t* __restrict u_row,
+                             const uint8_t* __restrict v_row, uint8_t* __restrict dst, int width) {
+    int pairs = width / 2;
+    if (((uintptr_t)dst & 3) == 0) {
+        uint32_t* d = (uint32_t*)dst;
+        for (int x = 0; x < pairs; x++) {
+            d[x] = (uint32_t)y_row[2 * x] | ((uint32_t)u_row[x] << 8) | ((uint32_t)y_row[2 * x + 1] << 16) |
+                   ((uint32_t)v_row[x] << 24);
+        }
+        return;
+    }
+    for (int x = 0; x < pairs; x++) {
+        dst[4 * x + 0] = y_row[2 * x];
+        dst[4 * x + 1] = u_row[x];
+        dst[4 * x + 2] = y_row[2 * x + 1];
+        dst[4 * x + 3] = v_row[x];
+    }
+}
+
 static uint8_t* convert_input_to_encoder_buf(const uint8_t* src, uint16_t width, uint16_t height, v4l2_pix_fmt_t format,
                                              jpeg_pixel_format_t* out_fmt, int* out_size) {
     // GRAY 直接作为 JPEG_PIXEL_FORMAT_GRAY 输入
@@ -73,16 +115,8 @@ static uint8_t* convert_input_to_encoder_buf(const uint8_t* src, uint16_t width,
         uint8_t* buf = (uint8_t*)jpeg_calloc_align(sz, 16);
         if (!buf)
             return NULL;
-        uint8_t* d = buf;
-        for (int i = 0; i < sz; i += 4) {
-            // src: Cb, Y0, Cr, Y1 -> dst: Y0, Cb, Y1, Cr
-            d[0] = s[1];
-            d[1] = s[0];
-            d[2] = s[3];
-            d[3] = s[2];
-            s += 4;
-            d += 4;
-        }
+        // src: Cb, Y0, Cr, Y1 -> dst: Y0, Cb, Y1, Cr
+        swap_bytes16(s, buf, sz);
         if (out_fmt)
             *out_fmt = JPEG_PIXEL_FORMAT_YCbYCr;
         if (out_size)
@@ -100,22 +134,9 @@ static uint8_t* convert_input_to_encoder_buf(const uint8_t* src, uint16_t width,
         uint8_t* buf = (uint8_t*)jpeg_calloc_align(sz, 16);
         if (!buf)
             return NULL;
-        uint8_t* dst = buf;
         for (int y = 0; y < height; y++) {
-            const uint8_t* y_row = y_plane + y * (int)width;
-            const uint8_t* u_row = u_plane + y * ((int)width / 2);
-            const uint8_t* v_row = v_plane + y * ((int)width / 2);
-            for (int x = 0; x < width; x += 2) {
-                uint8_t y0 = y_row[x + 0];
-                uint8_t y1 = y_row[x + 1];
-                uint8_t cb = u_row[x / 2];
-                uint8_t cr = v_row[x / 2];
-                dst[0] = y0;
-                dst[1] = cb;
-                dst[2] = y1;
-                dst[3] = cr;
-                dst += 4;
-            }
+            pack_yuv422p_row(y_plane + y * (int)width, u_plane + y * ((int)width / 2), v_plane + y * ((int)width / 2),
+                             buf + y * (int)width * 2, width);
         }
         if (out_fmt)
             *out_fmt = JPEG_PIXEL_FORMAT_YCbYCr;
@@ -261,10 +282,7 @@ static uint8_t* convert_input_to_hw_encoder_buf(const uint8_t* src, uint16_t wid
         uint16_t* buf = (uint16_t*)malloc_psram(sz);
         if (!buf)
             return NULL;
-        const uint16_t* bsrc = (const uint16_t*)src;
-        for (int i = 0; i < sz / 2; i++) {
-            buf[i] = __builtin_bswap16(bsrc[i]);
-        }
+        swap_bytes16(src, (uint8_t*)buf, sz);
         if (out_fmt)
             *out_fmt = JPEG_ENCODE_IN_FORMAT_YUV422;
         if (out_size)
@@ -424,6 +442,372 @@ static bool encode_with_esp_new_jpeg(const uint8_t* src, size_t src_len, uint16_
     return true;
 }
 
+struct image_to_jpeg_strip_t {
+    jpeg_enc_handle_t enc = nullptr;
+    esp_imgfx_color_convert_handle_t convert = nullptr;
+    esp_imgfx_pixel_fmt_t in_pixel_fmt = ESP_IMGFX_PIXEL_FMT_RGB888;
+    v4l2_pix_fmt_t format = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint16_t strip_lines = 0;
+    uint16_t lines_done = 0;
+    int src_bpp = 0;        // 源格式每像素字节数
+    int enc_bpp = 0;        // 编码器输入每像素字节数
+    int block_size = 0;     // 编码器每次输入的字节数
+    uint8_t* block = nullptr;
+    uint8_t* outbuf = nullptr;
+    int outbuf_size = 0;
+    jpg_out_cb cb = nullptr;
+    void* arg = nullptr;
+    size_t index = 0;
+};
+
+static esp_imgfx_color_convert_handle_t open_strip_converter(esp_imgfx_pixel_fmt_t in_fmt, uint16_t width,
+                                                             uint16_t lines) {
+    esp_imgfx_color_convert_cfg_t convert_cfg = {
+        .in_res = {.width = static_cast<int16_t>(width),
+                    .height = static_cast<int16_t>(lines)},
+        .in_pixel_fmt = in_fmt,
+        .out_pixel_fmt = ESP_IMGFX_PIXEL_FMT_YUYV,
+        .color_space_std = ESP_IMGFX_COLOR_SPACE_STD_BT601,
+    };
+    esp_imgfx_color_convert_handle_t handle = nullptr;
+    if (esp_imgfx_color_convert_open(&convert_cfg, &handle) != ESP_IMGFX_ERR_OK) {
+        return nullptr;
+    }
+    return handle;
+}
+
+// 将一条源数据直接转换到编码器输入 s->block，返回是否成功。
+// 打包格式只用 p0；YUV422P 的 p0/p1/p2 分别指向本条的 Y/U/V 行。
+static bool convert_strip(image_to_jpeg_strip_t* s, const uint8_t* p0, const uint8_t* p1, const uint8_t* p2,
+                          uint16_t lines) {
+    size_t src_size = (size_t)s->width * lines * s->src_bpp;
+    size_t enc_size = (size_t)s->width * lines * s->enc_bpp;
+    switch (s->format) {
+        case V4L2_PIX_FMT_GREY:
+        case V4L2_PIX_FMT_YUYV:
+            memcpy(s->block, p0, src_size);
+            return true;
+        case V4L2_PIX_FMT_UYVY:
+            swap_bytes16(p0, s->block, src_size);
+            return true;
+        case V4L2_PIX_FMT_YUV422P:
+            for (uint16_t y = 0; y < lines; y++) {
+                pack_yuv422p_row(p0 + y * s->width, p1 + y * (s->width / 2), p2 + y * (s->width / 2),
+                                 s->block + y * s->width * 2, s->width);
+            }
+            return true;
+        default:
+            break;
+    }
+
+    // 最后一条行数不足时临时用对应尺寸的转换器
+    esp_imgfx_color_convert_handle_t convert = s->convert;
+    if (lines != s->strip_lines) {
+        convert = open_strip_converter(s->in_pixel_fmt, s->width, lines);
+        if (convert == nullptr) {
+            ESP_LOGE(TAG, "esp_imgfx_color_convert_open failed");
+            return false;
+        }
+    }
+    esp_imgfx_data_t in_data = {
+        .data = const_cast<uint8_t*>(p0),
+        .data_len = static_cast<uint32_t>(src_size),
+    };
+    esp_imgfx_data_t out_data = {
+        .data = s->block,
+        .data_len = static_cast<uint32_t>(enc_size),
+    };
+    esp_imgfx_err_t err = esp_imgfx_color_convert_process(convert, &in_data, &out_data);
+    if (convert != s->convert) {
+        esp_imgfx_color_convert_close(convert);
+    }
+    if (err != ESP_IMGFX_ERR_OK) {
+        ESP_LOGE(TAG, "esp_imgfx_color_convert_process failed");
+        return false;
+    }
+    return true;
+}
+
+bool image_to_jpeg_strip_open(uint16_t width, uint16_t height, v4l2_pix_fmt_t format, uint8_t quality,
+                              jpg_out_cb cb, void* arg, image_to_jpeg_strip_handle_t* handle,
+                              uint16_t* strip_lines) {
+    if (handle == nullptr || strip_lines == nullptr || cb == nullptr || width == 0 || height == 0) {
+        return false;
+    }
+    if (quality < 1)
+        quality = 1;
+    if (quality > 100)
+        quality = 100;
+
+    auto s = new (std::nothrow) image_to_jpeg_strip_t();
+    if (s == nullptr) {
+        return false;
+    }
+    s->format = format;
+    s->width = width;
+    s->height = height;
+    s->cb = cb;
+    s->arg = arg;
+
+    jpeg_pixel_format_t enc_src_type = JPEG_PIXEL_FORMAT_YCbYCr;
+    switch (format) {
+        case V4L2_PIX_FMT_GREY:
+            enc_src_type = JPEG_PIXEL_FORMAT_GRAY;
+            s->src_bpp = 1;
+            s->enc_bpp = 1;
+            break;
+        case V4L2_PIX_FMT_YUYV:
+        case V4L2_PIX_FMT_UYVY:
+            s->src_bpp = 2;
+            s->enc_bpp = 2;
+            break;
+        case V4L2_PIX_FMT_YUV422P:
+            if (width % 2 != 0) {
+                delete s;
+                return false;
+            }
+            s->src_bpp = 1;  // 仅 Y 平面，U/V 单独寻址
+            s->enc_bpp = 2;
+            break;
+        case V4L2_PIX_FMT_RGB565:
+            s->in_pixel_fmt = ESP_IMGFX_PIXEL_FMT_RGB565_LE;
+            s->src_bpp = 2;
+            s->enc_bpp = 2;
+            break;
+        case V4L2_PIX_FMT_RGB565X:
+            s->in_pixel_fmt = ESP_IMGFX_PIXEL_FMT_RGB565_BE;
+            s->src_bpp = 2;
+            s->enc_bpp = 2;
+            break;
+        case V4L2_PIX_FMT_RGB24:
+            s->in_pixel_fmt = ESP_IMGFX_PIXEL_FMT_RGB888;
+            s->src_bpp = 3;
+            s->enc_bpp = 2;
+            break;
+        default:
+            ESP_LOGW(TAG, "strip encoder: unsupported format: 0x%08lx", format);
+            delete s;
+            return false;
+    }
+
+    jpeg_enc_config_t cfg = DEFAULT_JPEG_ENC_CONFIG();
+    cfg.width = width;
+    cfg.height = height;
+    cfg.src_type = enc_src_type;
+    cfg.subsampling = (enc_src_type == JPEG_PIXEL_FORMAT_GRAY) ? JPEG_SUBSAMPLE_GRAY : JPEG_SUBSAMPLE_420;
+    cfg.quality = quality;
+    cfg.rotate = JPEG_ROTATE_0D;
+    cfg.task_enable = false;
+
+    jpeg_error_t ret = jpeg_enc_open(&cfg, &s->enc);
+    if (ret != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "jpeg_enc_open failed: %d", (int)ret);
+        image_to_jpeg_strip_close(s);
+        return false;
+    }
+
+    // 编码器按 MCU 行取数据，块大小必须恰好是整数行
+    s->block_size = jpeg_enc_get_block_size(s->enc);
+    int line_size = (int)width * s->enc_bpp;
+    if (s->block_size <= 0 || s->block_size % line_size != 0) {
+        ESP_LOGW(TAG, "strip encoder: block size %d not aligned to width %u", s->block_size, width);
+        image_to_jpeg_strip_close(s);
+        return false;
+    }
+    s->strip_lines = (uint16_t)(s->block_size / line_size);
+
+    s->block = (uint8_t*)jpeg_calloc_align(s->block_size, 16);
+    // 按基线 Huffman 编码的最坏情况估算：每个 8x8 块 64 个系数，每个最多 16 位码字 + 11 位附加位，
+    // 约 3.4 字节/采样；4:2:0 为每像素 1.5 个采样。高质量下的噪声图像压缩后可能比原始数据更大
+    size_t samples = (size_t)width * s->strip_lines;
+    if (enc_src_type != JPEG_PIXEL_FORMAT_GRAY) {
+        samples = samples * 3 / 2;
+    }
+    s->outbuf_size = (int)(samples * 4) + 2048;  // 额外预留文件头的空间
+    s->outbuf = (uint8_t*)malloc_psram(s->outbuf_size);
+    if (s->block == nullptr || s->outbuf == nullptr) {
+        ESP_LOGE(TAG, "strip encoder: alloc buffers failed");
+        image_to_jpeg_strip_close(s);
+        return false;
+    }
+
+    if (format == V4L2_PIX_FMT_RGB565 || format == V4L2_PIX_FMT_RGB565X || format == V4L2_PIX_FMT_RGB24) {
+        s->convert = open_strip_converter(s->in_pixel_fmt, width, s->strip_lines);
+        if (s->convert == nullptr) {
+            ESP_LOGE(TAG, "esp_imgfx_color_convert_open failed");
+            image_to_jpeg_strip_close(s);
+            return false;
+        }
+    }
+
+    *handle = s;
+    *strip_lines = s->strip_lines;
+    return true;
+}
+
+static bool strip_encode(image_to_jpeg_strip_t* s, const uint8_t* p0, const uint8_t* p1, const uint8_t* p2,
+                         uint16_t lines) {
+    if (lines == 0 || lines > s->strip_lines || s->lines_done + lines > s->height) {
+        return false;
+    }
+    if (lines != s->strip_lines && s->lines_done + lines != s->height) {
+        ESP_LOGE(TAG, "strip encoder: only the last strip may be short");
+        return false;
+    }
+    if (!convert_strip(s, p0, p1, p2, lines)) {
+        return false;
+    }
+
+    // 最后一条不足一个 MCU 行时复制最后一行补齐
+    size_t line_size = (size_t)s->width * s->enc_bpp;
+    for (uint16_t i = lines; i < s->strip_lines; i++) {
+        memcpy(s->block + i * line_size, s->block + (lines - 1) * line_size, line_size);
+    }
+
+    int out_len = 0;
+    jpeg_error_t ret = jpeg_enc_process_with_block(s->enc, s->block, s->block_size, s->outbuf, s->outbuf_size, &out_len);
+    if (ret != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "jpeg_enc_process_with_block failed: %d, output buffer %d bytes", (int)ret, s->outbuf_size);
+        return false;
+    }
+    if (out_len > 0) {
+        if (s->cb(s->arg, s->index++, s->outbuf, (size_t)out_len) != (size_t)out_len) {
+            ESP_LOGE(TAG, "strip encoder: output callback failed");
+            return false;
+        }
+    }
+
+    s->lines_done += lines;
+    if (s->lines_done == s->height) {
+        s->cb(s->arg, s->index++, nullptr, 0);  // 结束信号
+    }
+    return true;
+}
+
+bool image_to_jpeg_strip_write(image_to_jpeg_strip_handle_t s, const uint8_t* src, uint16_t lines) {
+    if (s == nullptr || src == nullptr) {
+        return false;
+    }
+    if (s->format == V4L2_PIX_FMT_YUV422P) {
+        // 本条按 Y, U, V 平面依次排列
+        const uint8_t* u = src + (size_t)s->width * lines;
+        const uint8_t* v = u + (size_t)(s->width / 2) * lines;
+        return strip_encode(s, src, u, v, lines);
+    }
+    return strip_encode(s, src, nullptr, nullptr, lines);
+}
+
+void image_to_jpeg_strip_close(image_to_jpeg_strip_handle_t s) {
+    if (s == nullptr) {
+        return;
+    }
+    if (s->convert) {
+        esp_imgfx_color_convert_close(s->convert);
+    }
+    if (s->enc) {
+        jpeg_enc_close(s->enc);
+    }
+    if (s->block) {
+        jpeg_free_align(s->block);
+    }
+    if (s->outbuf) {
+        free(s->outbuf);
+    }
+    delete s;
+}
+
+// 整帧输入时按条转换+编码，无需整帧的中间缓冲区
+// 回调模式下若中途失败且已有数据交给回调，*partial 置为 true，调用方不能再回退到整帧编码
+struct strip_output_t {
+    jpg_out_cb cb;
+    void* arg;
+    uint8_t* buf;
+    size_t cap;
+    size_t len;
+    size_t emitted;  // 已交给调用方回调的字节数
+};
+
+static bool encode_with_strips(const uint8_t* src, size_t src_len, uint16_t width, uint16_t height,
+                               v4l2_pix_fmt_t format, uint8_t quality, uint8_t** jpg_out, size_t* jpg_out_len,
+                               jpg_out_cb cb, void* cb_arg, bool* partial) {
+    strip_output_t output = {cb, cb_arg, nullptr, 0, 0, 0};
+    if (partial) {
+        *partial = false;
+    }
+    if (cb == nullptr) {
+        if (jpg_out == nullptr || jpg_out_len == nullptr) {
+            return false;
+        }
+        // 与整帧编码相同的输出缓冲区估算
+        output.cap = (size_t)width * (size_t)height * 3 / 2 + 64 * 1024;
+        if (output.cap < 128 * 1024)
+            output.cap = 128 * 1024;
+        output.buf = (uint8_t*)malloc_psram(output.cap);
+        if (output.buf == nullptr) {
+            return false;
+        }
+    }
+
+    int64_t start_time = esp_timer_get_time();
+    image_to_jpeg_strip_handle_t s = nullptr;
+    uint16_t strip_lines = 0;
+    bool ok = image_to_jpeg_strip_open(width, height, format, quality,
+        [](void* arg, size_t index, const void* data, size_t len) -> size_t {
+            auto out = static_cast<strip_output_t*>(arg);
+            if (out->cb) {
+                if (data != nullptr && len > 0) {
+                    out->emitted += len;
+                }
+                return out->cb(out->arg, index, data, len);
+            }
+            if (data == nullptr || len == 0) {
+                return 0;
+            }
+            if (out->len + len > out->cap) {
+                return 0;
+            }
+            memcpy(out->buf + out->len, data, len);
+            out->len += len;
+            return len;
+        }, &output, &s, &strip_lines);
+    if (!ok) {
+        free(output.buf);
+        return false;
+    }
+
+    for (uint16_t y = 0; y < height && ok; y += strip_lines) {
+        uint16_t lines = (uint16_t)((height - y) < strip_lines ? (height - y) : strip_lines);
+        if (format == V4L2_PIX_FMT_YUV422P) {
+            const uint8_t* y_plane = src;
+            const uint8_t* u_plane = y_plane + (size_t)width * height;
+            const uint8_t* v_plane = u_plane + (size_t)(width / 2) * height;
+            ok = strip_encode(s, y_plane + (size_t)y * width, u_plane + (size_t)y * (width / 2),
+                              v_plane + (size_t)y * (width / 2), lines);
+        } else {
+            ok = strip_encode(s, src + (size_t)y * width * s->src_bpp, nullptr, nullptr, lines);
+        }
+    }
+    image_to_jpeg_strip_close(s);
+
+    if (!ok) {
+        free(output.buf);
+        if (partial && output.emitted > 0) {
+            *partial = true;
+        }
+        return false;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_time;
+    ESP_LOGD(TAG, "strip encode %ux%u in %lld us (%.2f MP/s)", width, height, elapsed_us,
+             elapsed_us > 0 ? (double)width * height / elapsed_us : 0.0);
+    if (cb == nullptr) {
+        *jpg_out = output.buf;
+        *jpg_out_len = output.len;
+    }
+    return true;
+}
+
 bool image_to_jpeg(uint8_t* src, size_t src_len, uint16_t width, uint16_t height, v4l2_pix_fmt_t format,
                    uint8_t quality, uint8_t** out, size_t* out_len) {
 #ifdef CONFIG_XIAOZHI_CAMERA_ALLOW_JPEG_INPUT
@@ -445,6 +829,9 @@ bool image_to_jpeg(uint8_t* src, size_t src_len, uint16_t width, uint16_t height
     }
     // Fallback to esp_new_jpeg
 #endif
+    if (encode_with_strips(src, src_len, width, height, format, quality, out, out_len, NULL, NULL, NULL)) {
+        return true;
+    }
     return encode_with_esp_new_jpeg(src, src_len, width, height, format, quality, out, out_len, NULL, NULL);
 }
 
@@ -463,5 +850,14 @@ bool image_to_jpeg_cb(uint8_t* src, size_t src_len, uint16_t width, uint16_t hei
     }
     // Fallback to esp_new_jpeg
 #endif
+    bool partial = false;
+    if (encode_with_strips(src, src_len, width, height, format, quality, NULL, NULL, cb, arg, &partial)) {
+        return true;
+    }
+    if (partial) {
+        // 已输出的 JPEG 片段无法撤回，再整帧编码只会让接收方拿到截断图 + 完整图
+        ESP_LOGE(TAG, "Strip encoding failed after output started, not falling back");
+        return false;
+    }
     return encode_with_esp_new_jpeg(src, src_len, width, height, format, quality, NULL, NULL, cb, arg);
 }
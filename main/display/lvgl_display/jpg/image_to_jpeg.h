@@ -63,7 +63,7 @@ extern "C"
      * 使用回调函数处理JPEG输出数据，适合流式传输或分块处理：
      * - 节省约8KB的SRAM使用（静态变量改为堆分配）
      * - 支持流式输出，无需预分配大缓冲区
-     * - 通过回调函数逐块处理JPEG数据
+     * - 通过回调函数逐块处理JPEG数据，可能分多次回调，最后以 (NULL, 0) 结束
      *
      * @param src       源图像数据
      * @param src_len   源图像数据长度
@@ -79,6 +79,49 @@ extern "C"
     bool image_to_jpeg_cb(uint8_t *src, size_t src_len, uint16_t width, uint16_t height,
                           v4l2_pix_fmt_t format, uint8_t quality, jpg_out_cb cb, void *arg);
 
+    typedef struct image_to_jpeg_strip_t *image_to_jpeg_strip_handle_t;
+
+    /**
+     * @brief 打开分条 (strip) JPEG 编码器
+     *
+     * 按 MCU 行分条输入图像，每条在内部转换为编码器格式后立即编码，
+     * 输出通过回调流式送出，无需整帧的中间缓冲区：
+     * - 峰值内存约为 2 条 MCU 行 + 输出块，而不是整帧
+     * - 支持 RGB565 / RGB565X / RGB24 / YUYV / UYVY / YUV422P / GREY 输入
+     * - YUV422P 的一条按 Y、U、V 平面依次排列（各 lines 行）
+     * - 最后一条不足 strip_lines 时会复制最后一行补齐
+     *
+     * @param width       图像宽度
+     * @param height      图像高度
+     * @param format      输入图像格式
+     * @param quality     JPEG质量 (1-100)
+     * @param cb          输出回调函数，全部写完后以 (NULL, 0) 作为结束信号
+     * @param arg         传递给回调函数的用户参数
+     * @param handle      返回的编码器句柄
+     * @param strip_lines 返回每次 image_to_jpeg_strip_write 应输入的行数
+     *
+     * @return true 成功, false 失败（格式或宽度不支持分条编码时调用者应回退到整帧编码）
+     */
+    bool image_to_jpeg_strip_open(uint16_t width, uint16_t height, v4l2_pix_fmt_t format, uint8_t quality,
+                                  jpg_out_cb cb, void *arg, image_to_jpeg_strip_handle_t *handle,
+                                  uint16_t *strip_lines);
+
+    /**
+     * @brief 输入一条图像数据并编码
+     *
+     * @param handle 编码器句柄
+     * @param src    本条源数据，行间紧密排列
+     * @param lines  本条行数，除最后一条外必须等于 strip_lines
+     *
+     * @return true 成功, false 失败
+     */
+    bool image_to_jpeg_strip_write(image_to_jpeg_strip_handle_t handle, const uint8_t *src, uint16_t lines);
+
+    /**
+     * @brief 关闭分条编码器并释放资源
+     */
+    void image_to_jpeg_strip_close(image_to_jpeg_strip_handle_t handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,9 @@
 #include <esp_check.h>
 #include <esp_err.h>
 #include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <stdbool.h>
+#include <string.h>
 #include <sys/param.h>
 
 #include "esp_jpeg_common.h"
@@ -20,20 +23,71 @@
 
 #define TAG "jpeg_to_image"
 
-static esp_err_t decode_with_new_jpeg(const uint8_t* src, size_t src_len, uint8_t** out, size_t* out_len, size_t* width,
-                                      size_t* height, size_t* stride) {
-    ESP_LOGD(TAG, "Decoding JPEG with software decoder");
+// Pick the largest DCT-domain downscale (1/2, 1/4, 1/8) that still keeps the image at least as large as the
+// size it will be shown at, so LVGL only has to shrink it a little further.
+static int select_scale_shift(size_t width, size_t height, size_t max_width, size_t max_height) {
+    if (max_width == 0 || max_height == 0) {
+        return 0;
+    }
+    // The image is shown at fit = min(max_width / width, max_height / height), so 1 / 2^shift must stay >= fit
+    int shift = 0;
+    while (shift < 3 && (width >= (max_width << (shift + 1)) || height >= (max_height << (shift + 1)))) {
+        shift++;
+    }
+    return shift;
+}
+
+// esp_new_jpeg scales to exactly width >> shift and height >> shift, both of which must be multiples of 8
+static bool scale_is_exact(size_t width, size_t height, int shift) {
+    size_t scaled_width = width >> shift;
+    size_t scaled_height = height >> shift;
+    return (scaled_width << shift) == width && (scaled_height << shift) == height && scaled_width > 0 &&
+           scaled_height > 0 && (scaled_width % 8) == 0 && (scaled_height % 8) == 0;
+}
+
+static esp_err_t decode_with_new_jpeg(const uint8_t* src, size_t src_len, int scale_shift, uint8_t** out,
+                                      size_t* out_len, size_t* width, size_t* height, size_t* stride) {
+    ESP_LOGD(TAG, "Decoding JPEG with software decoder, scale 1/%d", 1 << scale_shift);
     esp_err_t ret = ESP_OK;
     jpeg_error_t jpeg_ret = JPEG_ERR_OK;
     uint8_t* out_buf = NULL;
     jpeg_dec_io_t jpeg_io = {0};
     jpeg_dec_header_info_t out_info = {0};
+    size_t out_width = 0;
+    size_t out_height = 0;
 
     jpeg_dec_config_t config = DEFAULT_JPEG_DEC_CONFIG();
     config.output_type = JPEG_PIXEL_FORMAT_RGB565_LE;
     config.rotate = JPEG_ROTATE_0D;
 
     jpeg_dec_handle_t jpeg_dec = NULL;
+    if (scale_shift > 0) {
+        // The scaled resolution depends on the header, so peek at it with a throwaway decoder first
+        jpeg_ret = jpeg_dec_open(&config, &jpeg_dec);
+        if (jpeg_ret == JPEG_ERR_OK) {
+            jpeg_io.inbuf = (uint8_t*)src;
+            jpeg_io.inbuf_len = (int)src_len;
+            jpeg_ret = jpeg_dec_parse_header(jpeg_dec, &jpeg_io, &out_info);
+            jpeg_dec_close(jpeg_dec);
+            jpeg_dec = NULL;
+        }
+        if (jpeg_ret != JPEG_ERR_OK) {
+            ESP_LOGE(TAG, "Failed to parse JPEG header");
+            ret = ESP_ERR_INVALID_ARG;
+            goto jpeg_dec_failed;
+        }
+        // Truncating the size would distort the picture or fail, the caller tries the next smaller shift instead
+        if (!scale_is_exact(out_info.width, out_info.height, scale_shift)) {
+            ESP_LOGD(TAG, "%ux%u cannot be scaled by 1/%d exactly", (unsigned)out_info.width,
+                     (unsigned)out_info.height, 1 << scale_shift);
+            ret = ESP_ERR_NOT_SUPPORTED;
+            goto jpeg_dec_failed;
+        }
+        config.scale.width = out_info.width >> scale_shift;
+        config.scale.height = out_info.height >> scale_shift;
+        memset(&jpeg_io, 0, sizeof(jpeg_io));
+    }
+
     jpeg_ret = jpeg_dec_open(&config, &jpeg_dec);
     if (jpeg_ret != JPEG_ERR_OK) {
         ESP_LOGE(TAG, "Failed to open JPEG decoder");
@@ -52,8 +106,10 @@ static esp_err_t decode_with_new_jpeg(const uint8_t* src, size_t src_len, uint8_
     }
 
     ESP_LOGD(TAG, "JPEG header info: width=%d, height=%d", out_info.width, out_info.height);
+    out_width = scale_shift > 0 ? config.scale.width : out_info.width;
+    out_height = scale_shift > 0 ? config.scale.height : out_info.height;
 
-    out_buf = jpeg_calloc_align(out_info.width * out_info.height * 2, 16);
+    out_buf = jpeg_calloc_align(out_width * out_height * 2, 16);
     if (out_buf == NULL) {
         ESP_LOGE(TAG, "Failed to allocate memory for JPEG output buffer");
         ret = ESP_ERR_NO_MEM;
@@ -68,14 +124,14 @@ static esp_err_t decode_with_new_jpeg(const uint8_t* src, size_t src_len, uint8_
         goto jpeg_dec_failed;
     }
 
-    ESP_LOG_BUFFER_HEXDUMP(TAG, out_buf, MIN(out_info.width * out_info.height * 2, 256), ESP_LOG_DEBUG);
+    ESP_LOG_BUFFER_HEXDUMP(TAG, out_buf, MIN(out_width * out_height * 2, 256), ESP_LOG_DEBUG);
 
     *out = out_buf;
     out_buf = NULL;
-    *out_len = (size_t)(out_info.width * out_info.height * 2);
-    *width = (size_t)out_info.width;
-    *height = (size_t)out_info.height;
-    *stride = (size_t)out_info.width * 2;
+    *out_len = out_width * out_height * 2;
+    *width = out_width;
+    *height = out_height;
+    *stride = out_width * 2;
     jpeg_dec_close(jpeg_dec);
     jpeg_dec = NULL;
 
@@ -260,5 +316,76 @@ esp_err_t jpeg_to_image(const uint8_t* src, size_t src_len, uint8_t** out, size_
     ESP_LOGW(TAG, "Failed to decode with hardware JPEG, fallback to software decoder");
     // Fallback to esp_new_jpeg
 #endif
-    return decode_with_new_jpeg(src, src_len, out, out_len, width, height, stride);
+    return decode_with_new_jpeg(src, src_len, 0, out, out_len, width, height, stride);
+}
+
+esp_err_t jpeg_to_image_fit(const uint8_t* src, size_t src_len, size_t max_width, size_t max_height, uint8_t** out,
+                            size_t* out_len, size_t* width, size_t* height, size_t* stride) {
+#ifdef CONFIG_XIAOZHI_ENABLE_CAMERA_DEBUG_MODE
+    esp_log_level_set(TAG, ESP_LOG_DEBUG);
+#endif  // CONFIG_XIAOZHI_ENABLE_CAMERA_DEBUG_MODE
+    if (src == NULL || src_len == 0 || out == NULL || out_len == NULL || width == NULL || height == NULL ||
+        stride == NULL) {
+        ESP_LOGE(TAG, "Invalid parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t start_time = esp_timer_get_time();
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    // Track the low-water mark of this decode only, heap_caps_get_minimum_free_size() reports it until stop
+    bool monitoring = heap_caps_monitor_local_minimum_free_size_start() == ESP_OK;
+    esp_err_t ret = ESP_FAIL;
+    const char* path = "software";
+#ifdef CONFIG_XIAOZHI_ENABLE_HARDWARE_JPEG_DECODER
+    // The hardware engine is fast enough to decode at full resolution, LVGL scales the result
+    ret = decode_with_hardware_jpeg(src, src_len, out, out_len, width, height, stride);
+    path = "hardware";
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to decode with hardware JPEG, fallback to software decoder");
+        path = "software";
+    }
+#endif
+    if (ret != ESP_OK) {
+        jpeg_dec_config_t config = DEFAULT_JPEG_DEC_CONFIG();
+        jpeg_dec_handle_t jpeg_dec = NULL;
+        jpeg_dec_io_t jpeg_io = {0};
+        jpeg_dec_header_info_t info = {0};
+        int scale_shift = 0;
+        if (jpeg_dec_open(&config, &jpeg_dec) == JPEG_ERR_OK) {
+            jpeg_io.inbuf = (uint8_t*)src;
+            jpeg_io.inbuf_len = (int)src_len;
+            if (jpeg_dec_parse_header(jpeg_dec, &jpeg_io, &info) == JPEG_ERR_OK) {
+                scale_shift = select_scale_shift(info.width, info.height, max_width, max_height);
+                // Step down to the largest shift the decoder can apply without truncating the size
+                while (scale_shift > 0 && !scale_is_exact(info.width, info.height, scale_shift)) {
+                    scale_shift--;
+                }
+            }
+            jpeg_dec_close(jpeg_dec);
+        }
+        // A smaller exact scale is still much cheaper than the full-resolution buffer
+        for (int shift = scale_shift; shift > 0 && ret != ESP_OK; shift--) {
+            if (scale_is_exact(info.width, info.height, shift)) {
+                ret = decode_with_new_jpeg(src, src_len, shift, out, out_len, width, height, stride);
+            }
+        }
+        if (ret != ESP_OK) {
+            if (scale_shift > 0) {
+                ESP_LOGW(TAG, "Scaled decode failed, decoding %ux%u at full resolution", (unsigned)info.width,
+                         (unsigned)info.height);
+            }
+            ret = decode_with_new_jpeg(src, src_len, 0, out, out_len, width, height, stride);
+        }
+    }
+
+    size_t min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    if (monitoring) {
+        heap_caps_monitor_local_minimum_free_size_stop();
+    }
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Decoded %u bytes JPEG to %ux%u (%s) in %lld us, output %u bytes, peak heap %d bytes",
+                 (unsigned)src_len, (unsigned)*width, (unsigned)*height, path, esp_timer_get_time() - start_time,
+                 (unsigned)*out_len, monitoring ? (int)(free_before - min_free) : -1);
+    }
+    return ret;
 }
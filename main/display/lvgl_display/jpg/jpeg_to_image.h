@@ -55,6 +55,29 @@ extern "C" {
 esp_err_t jpeg_to_image(const uint8_t* src, size_t src_len, uint8_t** out, size_t* out_len, size_t* width,
                         size_t* height, size_t* stride);
 
+/**
+ * @brief Decodes a JPEG image to RGB565, downscaled in the DCT domain to fit a target box
+ *
+ * Same contract as jpeg_to_image(), but the software decoder picks the largest 1/2, 1/4 or 1/8 scale that keeps
+ * the result at least as large as the image will be shown inside `max_width` x `max_height`. esp_new_jpeg scales to
+ * exactly width >> n and height >> n, which must be multiples of 8, so only shifts that divide the image evenly are
+ * used: a 2048x1536 photo for a 240x240 panel is decoded straight to 256x192 instead of a 6 MB full-resolution
+ * buffer, while a 1920x1080 one (1080 / 8 is not a multiple of 8) falls back to the next smaller exact shift or to
+ * full resolution. The size is never truncated.
+ *
+ * When CONFIG_XIAOZHI_ENABLE_HARDWARE_JPEG_DECODER is enabled the hardware engine is tried first at full
+ * resolution (it has no downscale support), falling back to the scaled software path.
+ *
+ * Decode time and peak heap usage (lowest free heap during the decode) are logged at INFO level.
+ *
+ * @param[in] max_width Width of the box the image will be displayed in, 0 to disable scaling
+ * @param[in] max_height Height of the box the image will be displayed in, 0 to disable scaling
+ *
+ * @return Same as jpeg_to_image()
+ */
+esp_err_t jpeg_to_image_fit(const uint8_t* src, size_t src_len, size_t max_width, size_t max_height, uint8_t** out,
+                            size_t* out_len, size_t* width, size_t* height, size_t* stride);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 #include <string>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 #include <font_awesome.h>
 
 #include "lvgl_display.h"
@@ -13,6 +14,8 @@
 #include "assets/lang_config.h"
 #include "jpg/image_to_jpeg.h"
 
+#include <lvgl_private.h>
+
 #define TAG "Display"
 
 LvglDisplay::LvglDisplay() {
@@ -99,12 +102,17 @@ void LvglDisplay::ShowNotification(const char* notification, int duration_ms) {
 }
 
 void LvglDisplay::UpdateStatusBar(bool update_all) {
+    uint32_t fields = TakeDirtyStatusFields(update_all);
+    if (fields == 0) {
+        return;
+    }
+
     auto& app = Application::GetInstance();
     auto& board = Board::GetInstance();
     auto codec = board.GetAudioCodec();
 
     // Update mute icon
-    {
+    if (fields & kStatusBarMute) {
         DisplayLockGuard lock(this);
         if (mute_label_ == nullptr) {
             return;
@@ -121,7 +129,7 @@ void LvglDisplay::UpdateStatusBar(bool update_all) {
     }
 
     // Update time
-    if (app.GetDeviceState() == kDeviceStateIdle) {
+    if ((fields & kStatusBarClock) && app.GetDeviceState() == kDeviceStateIdle) {
         if (last_status_update_time_ + std::chrono::seconds(10) < std::chrono::system_clock::now()) {
             // Set status to clock "HH:MM"
             time_t now = time(NULL);
@@ -137,12 +145,16 @@ void LvglDisplay::UpdateStatusBar(bool update_all) {
         }
     }
 
+    if ((fields & (kStatusBarBattery | kStatusBarNetwork)) == 0) {
+        return;
+    }
+
     esp_pm_lock_acquire(pm_lock_);
     // Update battery icon
     int battery_level;
     bool charging, discharging;
     const char* icon = nullptr;
-    if (board.GetBatteryLevel(battery_level, charging, discharging)) {
+    if ((fields & kStatusBarBattery) && board.GetBatteryLevel(battery_level, charging, discharging)) {
         if (charging) {
             icon = FONT_AWESOME_BATTERY_BOLT;
         } else {
@@ -177,9 +189,8 @@ void LvglDisplay::UpdateStatusBar(bool update_all) {
         }
     }
 
-    // Update network icon every 10 seconds
-    static int seconds_counter = 0;
-    if (update_all || seconds_counter++ % 10 == 0) {
+    // Update network icon
+    if (fields & kStatusBarNetwork) {
         // Don't read 4G network status during firmware upgrade to avoid occupying UART resources
         auto device_state = Application::GetInstance().GetDeviceState();
         static const std::vector<DeviceState> allowed_states = {
@@ -215,41 +226,109 @@ void LvglDisplay::SetPowerSaveMode(bool on) {
     }
 }
 
+#if CONFIG_LV_USE_SNAPSHOT
+// Render rows [y1, y2] of obj into buf, the same way lv_snapshot does for the whole object
+static void RenderBand(lv_obj_t* obj, lv_draw_buf_t* buf, const lv_area_t& band) {
+    lv_draw_buf_clear(buf, nullptr);
+
+    lv_layer_t layer;
+    lv_memzero(&layer, sizeof(layer));
+    layer.draw_buf = buf;
+    layer.buf_area = band;
+    layer.color_format = LV_COLOR_FORMAT_RGB565;
+    layer._clip_area = band;
+    layer.phy_clip_area = band;
+
+    lv_display_t* disp_old = lv_refr_get_disp_refreshing();
+    lv_display_t* disp = lv_obj_get_display(obj);
+    lv_layer_t* layer_old = disp->layer_head;
+    disp->layer_head = &layer;
+    lv_refr_set_disp_refreshing(disp);
+
+    lv_obj_redraw(&layer, obj);
+    while (layer.draw_task_head) {
+        lv_draw_dispatch_wait_for_request();
+        lv_draw_dispatch();
+    }
+
+    disp->layer_head = layer_old;
+    lv_refr_set_disp_refreshing(disp_old);
+}
+#endif
+
 bool LvglDisplay::SnapshotToJpeg(std::string& jpeg_data, int quality) {
+    jpeg_data.clear();
+    bool ret = SnapshotToJpeg([&jpeg_data](const void* data, size_t len) {
+        jpeg_data.append(static_cast<const char*>(data), len);
+        return true;
+    }, quality);
+    if (!ret) {
+        jpeg_data.clear();
+    }
+    return ret;
+}
+
+bool LvglDisplay::SnapshotToJpeg(std::function<bool(const void* data, size_t len)> sink, int quality) {
 #if CONFIG_LV_USE_SNAPSHOT
+    int64_t start_time = esp_timer_get_time();
+    // The lock is held for the whole capture: LVGL must not redraw between bands (torn image) or delete
+    // the screen. Each band is rendered, encoded and handed to the sink before the next one, so no
+    // full-frame buffer exists; a slow sink (network upload) holds off UI updates for that long.
     DisplayLockGuard lock(this);
-
     lv_obj_t* screen = lv_screen_active();
-    lv_draw_buf_t* draw_buffer = lv_snapshot_take(screen, LV_COLOR_FORMAT_RGB565);
-    if (draw_buffer == nullptr) {
-        ESP_LOGE(TAG, "Failed to take snapshot, draw_buffer is nullptr");
+    lv_area_t coords;
+    lv_obj_get_coords(screen, &coords);
+    int32_t width = lv_area_get_width(&coords);
+    int32_t height = lv_area_get_height(&coords);
+
+    struct SnapshotOutput {
+        std::function<bool(const void* data, size_t len)>* sink;
+        size_t total;
+    } output = { &sink, 0 };
+
+    // LVGL renders RGB565 in native order, the encoder consumes it as big-endian RGB565X,
+    // so the byte swap happens inside the color converter instead of a separate pass.
+    image_to_jpeg_strip_handle_t encoder = nullptr;
+    uint16_t strip_lines = 0;
+    if (!image_to_jpeg_strip_open(width, height, V4L2_PIX_FMT_RGB565X, quality,
+        [](void* arg, size_t index, const void* data, size_t len) -> size_t {
+            if (data == nullptr || len == 0) {
+                return 0;
+            }
+            auto out = static_cast<SnapshotOutput*>(arg);
+            if (!(*out->sink)(data, len)) {
+                return 0;
+            }
+            out->total += len;
+            return len;
+        }, &output, &encoder, &strip_lines)) {
+        ESP_LOGE(TAG, "Failed to open JPEG strip encoder");
         return false;
     }
 
-    // swap bytes
-    uint16_t* data = (uint16_t*)draw_buffer->data;
-    size_t pixel_count = draw_buffer->data_size / 2;
-    for (size_t i = 0; i < pixel_count; i++) {
-        data[i] = __builtin_bswap16(data[i]);
+    lv_draw_buf_t* band_buffer = lv_draw_buf_create(width, strip_lines, LV_COLOR_FORMAT_RGB565, width * 2);
+    if (band_buffer == nullptr) {
+        ESP_LOGE(TAG, "Failed to create band buffer");
+        image_to_jpeg_strip_close(encoder);
+        return false;
     }
 
-    // Clear output string and use callback version to avoid pre-allocating large memory blocks
-    jpeg_data.clear();
-
-    // Use callback-based JPEG encoder to further save memory
-    bool ret = image_to_jpeg_cb((uint8_t*)draw_buffer->data, draw_buffer->data_size, draw_buffer->header.w, draw_buffer->header.h, V4L2_PIX_FMT_RGB565, quality,
-        [](void *arg, size_t index, const void *data, size_t len) -> size_t {
-        std::string* output = static_cast<std::string*>(arg);
-        if (data && len > 0) {
-            output->append(static_cast<const char*>(data), len);
-        }
-        return len;
-    }, &jpeg_data);
+    bool ret = true;
+    for (int32_t y = 0; y < height && ret; y += strip_lines) {
+        uint16_t lines = std::min<int32_t>(strip_lines, height - y);
+        lv_area_t band = { coords.x1, coords.y1 + y, coords.x2, coords.y1 + y + lines - 1 };
+        RenderBand(screen, band_buffer, band);
+        ret = image_to_jpeg_strip_write(encoder, band_buffer->data, lines);
+    }
     if (!ret) {
-        ESP_LOGE(TAG, "Failed to convert image to JPEG");
+        ESP_LOGE(TAG, "Failed to convert image to JPEG or the sink rejected the data");
+    } else {
+        ESP_LOGI(TAG, "Snapshot %ldx%ld to JPEG %u bytes in %lld us, band buffer %lu bytes",
+            width, height, output.total, esp_timer_get_time() - start_time, band_buffer->data_size);
     }
 
-    lv_draw_buf_destroy(draw_buffer);
+    lv_draw_buf_destroy(band_buffer);
+    image_to_jpeg_strip_close(encoder);
     return ret;
 #else
     ESP_LOGE(TAG, "LV_USE_SNAPSHOT is not enabled");
@@ -11,6 +11,7 @@
 
 #include <string>
 #include <chrono>
+#include <functional>
 
 class LvglDisplay : public Display {
 public:
@@ -23,7 +24,11 @@ public:
     virtual void SetPreviewImage(std::unique_ptr<LvglImage> image);
     virtual void UpdateStatusBar(bool update_all = false);
     virtual void SetPowerSaveMode(bool on);
+    // Collects the output of the sink version below
     virtual bool SnapshotToJpeg(std::string& jpeg_data, int quality = 80);
+    // Render and encode the active screen band by band under the display lock, each band's JPEG output
+    // goes to sink as it is produced; returning false from sink aborts the snapshot
+    virtual bool SnapshotToJpeg(std::function<bool(const void* data, size_t len)> sink, int quality = 80);
 
 protected:
     esp_pm_lock_handle_t pm_lock_ = nullptr;
@@ -1,5 +1,17 @@
 #include "lvgl_theme.h"
 
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#define TAG "LvglTheme"
+
+static void InitStyles(LvglThemeStyles& styles) {
+    lv_style_t* first = reinterpret_cast<lv_style_t*>(&styles);
+    for (size_t i = 0; i < sizeof(LvglThemeStyles) / sizeof(lv_style_t); i++) {
+        lv_style_init(&first[i]);
+    }
+}
+
 LvglTheme::LvglTheme(const std::string& name) : Theme(name) {
 }
 
@@ -14,7 +26,68 @@ lv_color_t LvglTheme::ParseColor(const std::string& color) {
     return lv_color_black();
 }
 
+const LvglThemeStyles& LvglTheme::styles() {
+    if (!styles_initialized_) {
+        InitStyles(styles_);
+        styles_initialized_ = true;
+        styles_dirty_ = true;
+    }
+    if (styles_dirty_) {
+        BuildStyles();
+        styles_dirty_ = false;
+    }
+    return styles_;
+}
+
+void LvglTheme::BuildStyles() {
+    lv_style_t* first = reinterpret_cast<lv_style_t*>(&styles_);
+    for (size_t i = 0; i < sizeof(LvglThemeStyles) / sizeof(lv_style_t); i++) {
+        lv_style_reset(&first[i]);
+    }
+
+    if (text_font_ != nullptr) {
+        lv_style_set_text_font(&styles_.screen, text_font_->font());
+    }
+    lv_style_set_text_color(&styles_.screen, text_color_);
+    lv_style_set_bg_color(&styles_.screen, background_color_);
+
+    lv_style_set_bg_color(&styles_.container, background_color_);
+    lv_style_set_border_color(&styles_.container, border_color_);
+    if (background_image_ != nullptr) {
+        lv_style_set_bg_image_src(&styles_.container, background_image_->image_dsc());
+    }
+
+    // 顶部/底部栏：50% 透明度的背景色
+    lv_style_set_bg_color(&styles_.bar, background_color_);
+    lv_style_set_bg_opa(&styles_.bar, LV_OPA_50);
+
+    lv_style_set_bg_color(&styles_.chat_background, chat_background_color_);
+
+    lv_style_set_text_color(&styles_.text, text_color_);
+    lv_style_set_text_color(&styles_.system_text, system_text_color_);
+
+    lv_style_set_radius(&styles_.bubble, 8);
+    lv_style_set_border_width(&styles_.bubble, 0);
+    lv_style_set_border_color(&styles_.bubble, border_color_);
+    lv_style_set_pad_all(&styles_.bubble, spacing(4));
+    lv_style_set_bg_opa(&styles_.bubble, LV_OPA_70);
+
+    lv_style_set_bg_color(&styles_.user_bubble, user_bubble_color_);
+    lv_style_set_text_color(&styles_.user_bubble, text_color_);
+    lv_style_set_bg_color(&styles_.assistant_bubble, assistant_bubble_color_);
+    lv_style_set_text_color(&styles_.assistant_bubble, text_color_);
+    lv_style_set_bg_color(&styles_.system_bubble, system_bubble_color_);
+    lv_style_set_text_color(&styles_.system_bubble, system_text_color_);
+
+    lv_style_set_bg_opa(&styles_.transparent, LV_OPA_TRANSP);
+    lv_style_set_border_width(&styles_.transparent, 0);
+    lv_style_set_pad_all(&styles_.transparent, 0);
+
+    lv_style_set_bg_color(&styles_.low_battery, low_battery_color_);
+}
+
 LvglThemeManager::LvglThemeManager() {
+    InitStyles(active_styles_);
 }
 
 LvglTheme* LvglThemeManager::GetTheme(const std::string& theme_name) {
@@ -28,3 +101,19 @@ LvglTheme* LvglThemeManager::GetTheme(const std::string& theme_name) {
 void LvglThemeManager::RegisterTheme(const std::string& theme_name, LvglTheme* theme) {
     themes_[theme_name] = theme;
 }
+
+void LvglThemeManager::ApplyTheme(LvglTheme* theme) {
+    if (theme == nullptr) {
+        return;
+    }
+    int64_t start_time = esp_timer_get_time();
+    const LvglThemeStyles& src = theme->styles();
+    const lv_style_t* from = reinterpret_cast<const lv_style_t*>(&src);
+    lv_style_t* to = reinterpret_cast<lv_style_t*>(&active_styles_);
+    for (size_t i = 0; i < sizeof(LvglThemeStyles) / sizeof(lv_style_t); i++) {
+        lv_style_copy(&to[i], &from[i]);
+    }
+    // 通知所有引用共享样式的对象刷新，只触发一次重绘
+    lv_obj_report_style_change(nullptr);
+    ESP_LOGD(TAG, "Applied theme %s in %lld us", theme->name().c_str(), esp_timer_get_time() - start_time);
+}
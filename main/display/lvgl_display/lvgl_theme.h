@@ -11,6 +11,23 @@
 #include <string>
 
 
+// Shared styles derived from a theme. UI objects reference the active set through
+// lv_obj_add_style() instead of carrying their own local style copies.
+struct LvglThemeStyles {
+    lv_style_t screen;              // text font/color and background of the screen
+    lv_style_t container;           // background color/image and border color
+    lv_style_t bar;                 // semi-transparent top/bottom bar background
+    lv_style_t chat_background;     // chat content area background
+    lv_style_t text;                // regular text color
+    lv_style_t system_text;         // system message text color
+    lv_style_t bubble;              // common chat bubble geometry and opacity
+    lv_style_t user_bubble;
+    lv_style_t assistant_bubble;
+    lv_style_t system_bubble;
+    lv_style_t transparent;         // invisible layout containers
+    lv_style_t low_battery;
+};
+
 class LvglTheme : public Theme {
 public:
     static lv_color_t ParseColor(const std::string& color);
@@ -34,20 +51,23 @@ public:
     inline std::shared_ptr<LvglFont> large_icon_font() const { return large_icon_font_; }
     inline int spacing(int scale) const { return spacing_ * scale; }
 
-    inline void set_background_color(lv_color_t background) { background_color_ = background; }
-    inline void set_text_color(lv_color_t text) { text_color_ = text; }
-    inline void set_chat_background_color(lv_color_t chat_background) { chat_background_color_ = chat_background; }
-    inline void set_user_bubble_color(lv_color_t user_bubble) { user_bubble_color_ = user_bubble; }
-    inline void set_assistant_bubble_color(lv_color_t assistant_bubble) { assistant_bubble_color_ = assistant_bubble; }
-    inline void set_system_bubble_color(lv_color_t system_bubble) { system_bubble_color_ = system_bubble; }
-    inline void set_system_text_color(lv_color_t system_text) { system_text_color_ = system_text; }
-    inline void set_border_color(lv_color_t border) { border_color_ = border; }
-    inline void set_low_battery_color(lv_color_t low_battery) { low_battery_color_ = low_battery; }
-    inline void set_background_image(std::shared_ptr<LvglImage> background_image) { background_image_ = background_image; }
+    inline void set_background_color(lv_color_t background) { background_color_ = background; styles_dirty_ = true; }
+    inline void set_text_color(lv_color_t text) { text_color_ = text; styles_dirty_ = true; }
+    inline void set_chat_background_color(lv_color_t chat_background) { chat_background_color_ = chat_background; styles_dirty_ = true; }
+    inline void set_user_bubble_color(lv_color_t user_bubble) { user_bubble_color_ = user_bubble; styles_dirty_ = true; }
+    inline void set_assistant_bubble_color(lv_color_t assistant_bubble) { assistant_bubble_color_ = assistant_bubble; styles_dirty_ = true; }
+    inline void set_system_bubble_color(lv_color_t system_bubble) { system_bubble_color_ = system_bubble; styles_dirty_ = true; }
+    inline void set_system_text_color(lv_color_t system_text) { system_text_color_ = system_text; styles_dirty_ = true; }
+    inline void set_border_color(lv_color_t border) { border_color_ = border; styles_dirty_ = true; }
+    inline void set_low_battery_color(lv_color_t low_battery) { low_battery_color_ = low_battery; styles_dirty_ = true; }
+    inline void set_background_image(std::shared_ptr<LvglImage> background_image) { background_image_ = background_image; styles_dirty_ = true; }
     inline void set_emoji_collection(std::shared_ptr<EmojiCollection> emoji_collection) { emoji_collection_ = emoji_collection; }
-    inline void set_text_font(std::shared_ptr<LvglFont> text_font) { text_font_ = text_font; }
-    inline void set_icon_font(std::shared_ptr<LvglFont> icon_font) { icon_font_ = icon_font; }
-    inline void set_large_icon_font(std::shared_ptr<LvglFont> large_icon_font) { large_icon_font_ = large_icon_font; }
+    inline void set_text_font(std::shared_ptr<LvglFont> text_font) { text_font_ = text_font; styles_dirty_ = true; }
+    inline void set_icon_font(std::shared_ptr<LvglFont> icon_font) { icon_font_ = icon_font; styles_dirty_ = true; }
+    inline void set_large_icon_font(std::shared_ptr<LvglFont> large_icon_font) { large_icon_font_ = large_icon_font; styles_dirty_ = true; }
+
+    // Pre-built styles for this theme, rebuilt only after a property changed
+    const LvglThemeStyles& styles();
 
 private:
     int spacing_ = 2;
@@ -73,6 +93,12 @@ private:
 
     // Emoji collection
     std::shared_ptr<EmojiCollection> emoji_collection_ = nullptr;
+
+    LvglThemeStyles styles_;
+    bool styles_initialized_ = false;
+    bool styles_dirty_ = true;
+
+    void BuildStyles();
 };
 
 
@@ -86,9 +112,16 @@ public:
     void RegisterTheme(const std::string& theme_name, LvglTheme* theme);
     LvglTheme* GetTheme(const std::string& theme_name);
 
+    // Styles that UI objects attach to. Must be called with the LVGL lock held.
+    LvglThemeStyles& active_styles() { return active_styles_; }
+    // Copy the theme's pre-built styles into the active set and notify LVGL once.
+    // Must be called with the LVGL lock held.
+    void ApplyTheme(LvglTheme* theme);
+
 private:
     LvglThemeManager();
     void InitializeDefaultThemes();
 
     std::map<std::string, LvglTheme*> themes_;
+    LvglThemeStyles active_styles_;
 };
@@ -0,0 +1,321 @@
+#include "heap_profiler.h"
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <esp_attr.h>
+#include <esp_cpu.h>
+#include <esp_timer.h>
+#include <esp_private/cache_utils.h>
+#include <esp_private/esp_clk.h>
+#include <freertos/task.h>
+#include <cJSON.h>
+
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+#include <esp_debug_helpers.h>
+#include <esp_cpu_utils.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#define TAG "HeapProfiler"
+
+// Set once the tables exist, the hooks may run before any C++ static initialization guard is usable
+static HeapProfiler* active_profiler = nullptr;
+
+static inline int LiveSlot(uintptr_t ptr) {
+    return static_cast<int>(((ptr >> 3) * 2654435761u) & (HeapProfiler::kMaxLiveAllocations - 1));
+}
+
+static uint32_t HashBytes(const void* data, size_t length, uint32_t hash = 2166136261u) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Return addresses of the allocating call chain, starting above the heap hook
+static void __attribute__((noinline)) CaptureStack(uint32_t* pcs) {
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    esp_backtrace_frame_t frame = {};
+    esp_backtrace_get_start(&frame.pc, &frame.sp, &frame.next_pc);
+    // Skip HeapProfiler::OnAlloc and esp_heap_trace_alloc_hook
+    int skip = 2;
+    int depth = 0;
+    while (depth < HeapProfiler::kStackDepth && frame.next_pc != 0) {
+        if (!esp_backtrace_get_next_frame(&frame)) {
+            break;
+        }
+        if (skip > 0) {
+            skip--;
+            continue;
+        }
+        pcs[depth++] = esp_cpu_process_stack_pc(frame.pc);
+    }
+#endif
+}
+
+bool HeapProfiler::Start(int sample_rate) {
+    if (IsRunning()) {
+        return true;
+    }
+    sites_ = static_cast<Site*>(heap_caps_calloc(kMaxSites, sizeof(Site), MALLOC_CAP_SPIRAM));
+    live_ = static_cast<LiveAllocation*>(heap_caps_calloc(kMaxLiveAllocations, sizeof(LiveAllocation), MALLOC_CAP_SPIRAM));
+    if (sites_ == nullptr || live_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate profiler tables in PSRAM");
+        heap_caps_free(sites_);
+        heap_caps_free(live_);
+        sites_ = nullptr;
+        live_ = nullptr;
+        return false;
+    }
+    sample_rate_ = std::max(1, sample_rate);
+    start_time_us_ = esp_timer_get_time();
+    running_.store(true, std::memory_order_release);
+    active_profiler = this;
+    ESP_LOGI(TAG, "Started, sampling 1/%d of allocations below %u bytes, tables use %u KB PSRAM", sample_rate_,
+        (unsigned)kAlwaysSampleBytes, (unsigned)((sizeof(Site) * kMaxSites + sizeof(LiveAllocation) * kMaxLiveAllocations) / 1024));
+    return true;
+}
+
+int HeapProfiler::FindOrAddSite(uint32_t hash, const uint32_t* pcs, const char* task) {
+    int index = hash & (kMaxSites - 1);
+    // Probe at most half of the table, the last slot is reserved for overflow
+    for (int probe = 0; probe < kMaxSites / 2; probe++, index = (index + 1) & (kMaxSites - 1)) {
+        if (index == kMaxSites - 1) {
+            continue;
+        }
+        auto& site = sites_[index];
+        if (site.hash == 0) {
+            site.hash = hash;
+            memcpy(site.pcs, pcs, sizeof(site.pcs));
+            strncpy(site.task, task, sizeof(site.task) - 1);
+            return index;
+        }
+        if (site.hash == hash && memcmp(site.pcs, pcs, sizeof(site.pcs)) == 0 &&
+            (pcs[0] != 0 || strncmp(site.task, task, sizeof(site.task)) == 0)) {
+            return index;
+        }
+    }
+    auto& overflow = sites_[kMaxSites - 1];
+    if (overflow.hash == 0) {
+        overflow.hash = 1;
+        strncpy(overflow.task, "(overflow)", sizeof(overflow.task) - 1);
+    }
+    return kMaxSites - 1;
+}
+
+void HeapProfiler::RemoveLive(int index) {
+    // Backward shift deletion keeps linear probing chains intact without tombstones
+    const int mask = kMaxLiveAllocations - 1;
+    int next = index;
+    while (true) {
+        live_[index].ptr = 0;
+        while (true) {
+            next = (next + 1) & mask;
+            if (live_[next].ptr == 0) {
+                live_used_--;
+                return;
+            }
+            int home = LiveSlot(live_[next].ptr);
+            bool stays = index <= next ? (index < home && home <= next) : (index < home || home <= next);
+            if (!stays) {
+                break;
+            }
+        }
+        live_[index] = live_[next];
+        index = next;
+    }
+}
+
+void HeapProfiler::OnAlloc(void* ptr, size_t size) {
+    if (ptr == nullptr || !IsRunning()) {
+        return;
+    }
+    uint16_t weight = 1;
+    if (size < kAlwaysSampleBytes && sample_rate_ > 1) {
+        if (alloc_counter_.fetch_add(1, std::memory_order_relaxed) % sample_rate_ != 0) {
+            return;
+        }
+        weight = sample_rate_;
+    }
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+
+    uint32_t pcs[kStackDepth] = {};
+    CaptureStack(pcs);
+    TaskHandle_t current = xTaskGetCurrentTaskHandle();
+    const char* task = current != nullptr ? pcTaskGetName(current) : "";
+    // Without a backtrace the task name is the only key
+    uint32_t hash = pcs[0] != 0 ? HashBytes(pcs, sizeof(pcs)) : HashBytes(task, strlen(task));
+    if (hash == 0) {
+        hash = 1;
+    }
+    uint32_t bytes = static_cast<uint32_t>(std::min<size_t>(size * weight, UINT32_MAX));
+    uintptr_t key = reinterpret_cast<uintptr_t>(ptr);
+
+    portENTER_CRITICAL(&lock_);
+    int site_index = FindOrAddSite(hash, pcs, task);
+    auto& site = sites_[site_index];
+    site.allocs += weight;
+
+    // An address still in the table was released without a free hook (realloc), replace it
+    const int mask = kMaxLiveAllocations - 1;
+    int index = LiveSlot(key);
+    while (live_[index].ptr != 0 && live_[index].ptr != key) {
+        index = (index + 1) & mask;
+    }
+    if (live_[index].ptr == key) {
+        auto& stale = sites_[live_[index].site];
+        stale.live_bytes -= live_[index].bytes;
+        stale.live_count -= live_[index].weight;
+        live_[index] = LiveAllocation{key, bytes, static_cast<uint16_t>(site_index), weight};
+    } else if (live_used_ < kMaxLiveAllocations * 3 / 4) {
+        live_[index] = LiveAllocation{key, bytes, static_cast<uint16_t>(site_index), weight};
+        live_used_++;
+    } else {
+        dropped_++;
+        index = -1;
+    }
+    if (index >= 0) {
+        site.live_bytes += bytes;
+        site.live_count += weight;
+        if (site.live_bytes > site.peak_bytes) {
+            site.peak_bytes = site.live_bytes;
+        }
+    }
+    uint32_t cycles = esp_cpu_get_cycle_count() - start_cycles;
+    overhead_.sampled_allocs++;
+    overhead_.alloc_cycles += cycles;
+    overhead_.max_cycles = std::max(overhead_.max_cycles, cycles);
+    portEXIT_CRITICAL(&lock_);
+}
+
+void HeapProfiler::OnFree(void* ptr) {
+    if (ptr == nullptr || !IsRunning()) {
+        return;
+    }
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+    uintptr_t key = reinterpret_cast<uintptr_t>(ptr);
+    const int mask = kMaxLiveAllocations - 1;
+
+    portENTER_CRITICAL(&lock_);
+    int index = LiveSlot(key);
+    while (live_[index].ptr != 0) {
+        if (live_[index].ptr == key) {
+            auto& site = sites_[live_[index].site];
+            site.live_bytes -= live_[index].bytes;
+            site.live_count -= live_[index].weight;
+            RemoveLive(index);
+            break;
+        }
+        index = (index + 1) & mask;
+    }
+    uint32_t cycles = esp_cpu_get_cycle_count() - start_cycles;
+    overhead_.frees++;
+    overhead_.free_cycles += cycles;
+    overhead_.max_cycles = std::max(overhead_.max_cycles, cycles);
+    portEXIT_CRITICAL(&lock_);
+}
+
+std::string HeapProfiler::GetJson(int top) {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "running", IsRunning());
+    auto snapshot = IsRunning() ? static_cast<Site*>(heap_caps_malloc(sizeof(Site) * kMaxSites, MALLOC_CAP_SPIRAM)) : nullptr;
+    if (snapshot != nullptr) {
+        int live_used = 0;
+        uint32_t dropped = 0;
+        Overhead overhead = {};
+        // Copy a few sites per critical section, holding the lock for the whole 17KB PSRAM copy would stall
+        // allocations on both cores. Each site is consistent, totals may be off by allocations made in between
+        static_assert(kMaxSites % kSnapshotSites == 0);
+        for (int i = 0; i < kMaxSites; i += kSnapshotSites) {
+            portENTER_CRITICAL(&lock_);
+            memcpy(snapshot + i, sites_ + i, sizeof(Site) * kSnapshotSites);
+            if (i + kSnapshotSites >= kMaxSites) {
+                live_used = live_used_;
+                dropped = dropped_;
+                overhead = overhead_;
+            }
+            portEXIT_CRITICAL(&lock_);
+        }
+
+        std::vector<const Site*> sorted;
+        uint64_t live_bytes = 0;
+        for (int i = 0; i < kMaxSites; i++) {
+            if (snapshot[i].hash != 0) {
+                sorted.push_back(&snapshot[i]);
+                live_bytes += snapshot[i].live_bytes;
+            }
+        }
+        top = std::clamp(top, 1, static_cast<int>(std::max<size_t>(sorted.size(), 1)));
+        std::partial_sort(sorted.begin(), sorted.begin() + std::min<size_t>(top, sorted.size()), sorted.end(),
+            [](const Site* a, const Site* b) {
+                return a->live_bytes > b->live_bytes;
+            });
+
+        cJSON_AddNumberToObject(root, "sample_rate", sample_rate_);
+        cJSON_AddNumberToObject(root, "always_sample_bytes", kAlwaysSampleBytes);
+        cJSON_AddNumberToObject(root, "live_bytes", live_bytes);
+        cJSON_AddNumberToObject(root, "tracked", live_used);
+        cJSON_AddNumberToObject(root, "dropped", dropped);
+        cJSON_AddNumberToObject(root, "sites_used", sorted.size());
+
+        // Average cycles per hook call and the share of one core spent in the hooks since Start
+        double cycles_per_us = esp_clk_cpu_freq() / 1000000.0;
+        double elapsed_us = std::max<int64_t>(1, esp_timer_get_time() - start_time_us_);
+        cJSON* cost = cJSON_CreateObject();
+        cJSON_AddNumberToObject(cost, "sampled_allocs", overhead.sampled_allocs);
+        cJSON_AddNumberToObject(cost, "frees", overhead.frees);
+        cJSON_AddNumberToObject(cost, "alloc_cycles", overhead.sampled_allocs ? overhead.alloc_cycles / overhead.sampled_allocs : 0);
+        cJSON_AddNumberToObject(cost, "free_cycles", overhead.frees ? overhead.free_cycles / overhead.frees : 0);
+        cJSON_AddNumberToObject(cost, "max_cycles", overhead.max_cycles);
+        cJSON_AddNumberToObject(cost, "cpu_percent",
+            (overhead.alloc_cycles + overhead.free_cycles) / cycles_per_us / elapsed_us * 100);
+        cJSON_AddItemToObject(root, "overhead", cost);
+
+        cJSON* sites = cJSON_CreateArray();
+        for (int i = 0; i < top && i < static_cast<int>(sorted.size()); i++) {
+            auto site = sorted[i];
+            char pcs[kStackDepth * 11 + 1] = {};
+            int length = 0;
+            for (int j = 0; j < kStackDepth && site->pcs[j] != 0; j++) {
+                length += snprintf(pcs + length, sizeof(pcs) - length, j == 0 ? "0x%08lx" : " 0x%08lx", (unsigned long)site->pcs[j]);
+            }
+            cJSON* item = cJSON_CreateObject();
+            cJSON_AddStringToObject(item, "task", site->task);
+            cJSON_AddStringToObject(item, "pcs", pcs);
+            cJSON_AddNumberToObject(item, "live_bytes", site->live_bytes);
+            cJSON_AddNumberToObject(item, "live_count", site->live_count);
+            cJSON_AddNumberToObject(item, "allocs", site->allocs);
+            cJSON_AddNumberToObject(item, "peak_bytes", site->peak_bytes);
+            cJSON_AddItemToArray(sites, item);
+        }
+        cJSON_AddItemToObject(root, "sites", sites);
+        heap_caps_free(snapshot);
+    }
+
+    auto str = cJSON_PrintUnformatted(root);
+    std::string json(str);
+    cJSON_free(str);
+    cJSON_Delete(root);
+    return json;
+}
+
+#if CONFIG_USE_HEAP_PROFILER
+// The heap calls these from IRAM, PSRAM tables and flash code are only touched while the cache is enabled
+extern "C" IRAM_ATTR void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    auto profiler = active_profiler;
+    if (profiler != nullptr && spi_flash_cache_enabled()) {
+        profiler->OnAlloc(ptr, size);
+    }
+}
+
+extern "C" IRAM_ATTR void esp_heap_trace_free_hook(void* ptr) {
+    auto profiler = active_profiler;
+    if (profiler != nullptr && spi_flash_cache_enabled()) {
+        profiler->OnFree(ptr);
+    }
+}
+#endif
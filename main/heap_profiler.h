@@ -0,0 +1,93 @@
+#ifndef HEAP_PROFILER_H
+#define HEAP_PROFILER_H
+
+#include <freertos/FreeRTOS.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * 堆内存分配分析器 (CONFIG_USE_HEAP_PROFILER)
+ *
+ * 通过 IDF 的堆钩子 (CONFIG_HEAP_USE_HOOKS) 记录每次分配的调用栈，按调用点汇总存活字节数、
+ * 存活块数、累计分配次数和峰值。汇总表和存活分配表都放在 PSRAM 中。
+ *
+ * - 大于等于 kAlwaysSampleBytes 的分配全部记录，小分配每 sample_rate 次记录一次，
+ *   统计值按权重放大为估计值
+ * - Xtensa 芯片按返回地址区分调用点，RISC-V 芯片没有廉价的栈回溯，按任务名区分
+ * - GetJson() 输出前 N 个调用点，用 scripts/heap_profile.py 对照 ELF 符号化
+ * - 钩子自身的耗时按 CPU 周期累计，随 GetJson() 一起输出，用于评估在设备上常开的开销
+ */
+class HeapProfiler {
+public:
+    static constexpr int kStackDepth = 8;               // Includes allocator frames, the host script skips them
+    static constexpr int kMaxSites = 256;               // Power of two, the last site collects overflow
+    static constexpr int kMaxLiveAllocations = 4096;    // Power of two
+    static constexpr size_t kAlwaysSampleBytes = 1024;
+    static constexpr int kSnapshotSites = 16;           // Sites copied per critical section in GetJson
+
+    static HeapProfiler& GetInstance() {
+        static HeapProfiler instance;
+        return instance;
+    }
+    HeapProfiler(const HeapProfiler&) = delete;
+    HeapProfiler& operator=(const HeapProfiler&) = delete;
+
+    // Allocate the tables and start recording, allocations made before are not tracked
+    bool Start(int sample_rate);
+    bool IsRunning() const { return running_.load(std::memory_order_acquire); }
+
+    // Top sites by estimated live bytes
+    std::string GetJson(int top);
+
+    // Called from the heap hooks
+    void OnAlloc(void* ptr, size_t size);
+    void OnFree(void* ptr);
+
+private:
+    HeapProfiler() = default;
+
+    struct Site {
+        uint32_t hash;                  // 0 if unused
+        uint32_t pcs[kStackDepth];
+        char task[configMAX_TASK_NAME_LEN];
+        uint32_t live_bytes;            // Estimated, weighted by the sample rate
+        uint32_t live_count;
+        uint32_t allocs;
+        uint32_t peak_bytes;
+    };
+
+    struct LiveAllocation {
+        uintptr_t ptr;                  // 0 if unused
+        uint32_t bytes;                 // Weighted
+        uint16_t site;
+        uint16_t weight;
+    };
+
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+    std::atomic<bool> running_{false};
+    std::atomic<uint32_t> alloc_counter_{0};
+    int sample_rate_ = 1;
+    Site* sites_ = nullptr;
+    LiveAllocation* live_ = nullptr;
+    int live_used_ = 0;
+    uint32_t dropped_ = 0;              // Sampled allocations that did not fit in the live table
+    int64_t start_time_us_ = 0;
+
+    // Hook cost, updated under lock_. Allocations skipped by sampling only pay for one atomic increment
+    struct Overhead {
+        uint32_t sampled_allocs;
+        uint32_t frees;
+        uint64_t alloc_cycles;
+        uint64_t free_cycles;
+        uint32_t max_cycles;
+    };
+    Overhead overhead_ = {};
+
+    int FindOrAddSite(uint32_t hash, const uint32_t* pcs, const char* task);
+    void RemoveLive(int index);
+};
+
+#endif // HEAP_PROFILER_H
@@ -0,0 +1,66 @@
+#include "local_intent.h"
+#include "mcp_server.h"
+#include "application.h"
+#include "board.h"
+#include "assets/lang_config.h"
+
+#include <esp_log.h>
+#include <algorithm>
+
+#define TAG "LocalIntent"
+
+// 音量/亮度每次调整的步长
+#define LOCAL_INTENT_STEP 10
+
+static std::string VolumeArguments(int delta) {
+    auto codec = Board::GetInstance().GetAudioCodec();
+    int volume = std::clamp(codec->output_volume() + delta, 0, 100);
+    return "{\"volume\":" + std::to_string(volume) + "}";
+}
+
+static std::string BrightnessArguments(int delta) {
+    auto backlight = Board::GetInstance().GetBacklight();
+    int brightness = backlight != nullptr ? backlight->brightness() : 0;
+    brightness = std::clamp(brightness + delta, 0, 100);
+    return "{\"brightness\":" + std::to_string(brightness) + "}";
+}
+
+const std::vector<LocalIntent::BuiltinIntent>& LocalIntent::BuiltinIntents() {
+    static const std::vector<BuiltinIntent> intents = {
+        {"volume_up", "self.audio_speaker.set_volume", []() { return VolumeArguments(LOCAL_INTENT_STEP); }},
+        {"volume_down", "self.audio_speaker.set_volume", []() { return VolumeArguments(-LOCAL_INTENT_STEP); }},
+        {"volume_max", "self.audio_speaker.set_volume", []() { return std::string("{\"volume\":100}"); }},
+        {"brightness_up", "self.screen.set_brightness", []() { return BrightnessArguments(LOCAL_INTENT_STEP); }},
+        {"brightness_down", "self.screen.set_brightness", []() { return BrightnessArguments(-LOCAL_INTENT_STEP); }},
+        {"theme_light", "self.screen.set_theme", []() { return std::string("{\"theme\":\"light\"}"); }},
+        {"theme_dark", "self.screen.set_theme", []() { return std::string("{\"theme\":\"dark\"}"); }},
+        {"lamp_on", "self.lamp.turn_on", []() { return std::string(); }},
+        {"lamp_off", "self.lamp.turn_off", []() { return std::string(); }},
+    };
+    return intents;
+}
+
+void LocalIntent::Execute(const std::string& text, const std::string& action, const std::string& arguments) {
+    std::string tool = action;
+    auto& intents = BuiltinIntents();
+    auto it = std::find_if(intents.begin(), intents.end(), [&action](const BuiltinIntent& intent) {
+        return action == intent.action;
+    });
+
+    // Current values are read on the main task, right before the tool runs
+    auto& app = Application::GetInstance();
+    app.Schedule([text, tool, arguments, builtin = it != intents.end() ? &*it : nullptr]() {
+        std::string tool_name = builtin != nullptr ? builtin->tool : tool;
+        std::string tool_arguments = builtin != nullptr && arguments.empty() ? builtin->arguments() : arguments;
+        ESP_LOGI(TAG, "Command '%s' -> %s %s", text.c_str(), tool_name.c_str(), tool_arguments.c_str());
+
+        // 短提示音确认执行结果；本地执行失败时交给服务器按普通对话处理
+        auto& app = Application::GetInstance();
+        if (McpServer::GetInstance().CallToolLocally(tool_name, tool_arguments)) {
+            app.PlaySound(Lang::Sounds::OGG_POPUP);
+        } else {
+            ESP_LOGW(TAG, "Command '%s' failed locally, falling back to the server", text.c_str());
+            app.WakeWordInvoke(text);
+        }
+    });
+}
@@ -0,0 +1,51 @@
+#ifndef LOCAL_INTENT_H
+#define LOCAL_INTENT_H
+
+#include <string>
+#include <functional>
+#include <vector>
+
+/**
+ * LocalIntent - Executes recognized voice commands on the device
+ *
+ * Multinet commands whose action is not "wake" are routed here instead of
+ * opening a server session. The action is either a built-in intent name
+ * (e.g. "volume_up", "theme_dark", "lamp_on") or the name of any registered
+ * MCP tool with optional JSON arguments. A short sound confirms the result;
+ * if the tool is unknown or fails, the command text is sent to the server
+ * as a wake word so it is handled as a normal conversation.
+ */
+class LocalIntent {
+public:
+    static LocalIntent& GetInstance() {
+        static LocalIntent instance;
+        return instance;
+    }
+
+    // Delete copy constructor and assignment operator
+    LocalIntent(const LocalIntent&) = delete;
+    LocalIntent& operator=(const LocalIntent&) = delete;
+
+    /**
+     * Execute a command recognized on the device
+     * @param text Display text of the command
+     * @param action Built-in intent name or MCP tool name
+     * @param arguments Optional JSON object with tool arguments
+     */
+    void Execute(const std::string& text, const std::string& action, const std::string& arguments);
+
+private:
+    LocalIntent() = default;
+    ~LocalIntent() = default;
+
+    struct BuiltinIntent {
+        const char* action;
+        const char* tool;
+        // Builds the tool arguments from the current device state
+        std::function<std::string()> arguments;
+    };
+
+    static const std::vector<BuiltinIntent>& BuiltinIntents();
+};
+
+#endif // LOCAL_INTENT_H
@@ -9,6 +9,7 @@
 
 #include "application.h"
 #include "system_info.h"
+#include "heap_profiler.h"
 
 #define TAG "main"
 
@@ -23,6 +24,11 @@ extern "C" void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
 
+#if CONFIG_USE_HEAP_PROFILER
+    // Start before the application so its long-lived buffers are attributed
+    HeapProfiler::GetInstance().Start(CONFIG_HEAP_PROFILER_SAMPLE_RATE);
+#endif
+
     // Initialize and run the application
     auto& app = Application::GetInstance();
     app.Initialize();
@@ -0,0 +1,151 @@
+#include "main_task_queue.h"
+
+#include <cstring>
+#include <esp_timer.h>
+
+static bool SameKey(const char* a, const char* b) {
+    return a == b || (a != nullptr && b != nullptr && strcmp(a, b) == 0);
+}
+
+bool MainTaskQueue::Push(MainTask&& task, MainTaskPriority priority, const char* name, const char* key, int deadline_ms) {
+    if (name == nullptr) {
+        name = key != nullptr ? key : "other";
+    }
+    int64_t now_us = esp_timer_get_time();
+    bool heap = !task.is_inline();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (heap) {
+        StatsFor(name).heap_tasks++;
+    }
+    if (key != nullptr) {
+        for (auto& queue : queues_) {
+            for (auto& entry : queue) {
+                if (entry.key != nullptr && SameKey(entry.key, key)) {
+                    // Keep the queue position and enqueue time, only the latest callback survives
+                    StatsFor(entry.name).coalesced++;
+                    entry.task = std::move(task);
+                    entry.name = name;
+                    return false;
+                }
+            }
+        }
+    }
+    int64_t deadline_us = deadline_ms > 0 ? now_us + deadline_ms * 1000LL : 0;
+    queues_[priority].push_back(Entry{std::move(task), name, key, now_us, deadline_us});
+    return true;
+}
+
+void MainTaskQueue::Cancel(const char* key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& queue : queues_) {
+        for (auto it = queue.begin(); it != queue.end();) {
+            if (it->key != nullptr && SameKey(it->key, key)) {
+                it = queue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+bool MainTaskQueue::PopNext(Entry& entry, int64_t now_us) {
+    // An expired deadline wins over priority, the earliest one first
+    std::deque<Entry>* selected = nullptr;
+    for (auto& queue : queues_) {
+        if (queue.empty() || queue.front().deadline_us == 0 || queue.front().deadline_us > now_us) {
+            continue;
+        }
+        if (selected == nullptr || queue.front().deadline_us < selected->front().deadline_us) {
+            selected = &queue;
+        }
+    }
+    if (selected == nullptr) {
+        for (auto& queue : queues_) {
+            if (!queue.empty()) {
+                selected = &queue;
+                break;
+            }
+        }
+    }
+    if (selected == nullptr) {
+        return false;
+    }
+    entry = std::move(selected->front());
+    selected->pop_front();
+    return true;
+}
+
+bool MainTaskQueue::RunPending(int64_t budget_us) {
+    int64_t start_us = esp_timer_get_time();
+    while (true) {
+        Entry entry;
+        int64_t begin_us = esp_timer_get_time();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!PopNext(entry, begin_us)) {
+                return false;
+            }
+        }
+
+        entry.task();
+        int64_t end_us = esp_timer_get_time();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& stats = StatsFor(entry.name);
+            int64_t run_us = end_us - begin_us;
+            int64_t wait_us = begin_us - entry.enqueue_us;
+            stats.runs++;
+            stats.total_run_us += run_us;
+            if (run_us > stats.max_run_us) {
+                stats.max_run_us = run_us;
+            }
+            if (wait_us > stats.max_wait_us) {
+                stats.max_wait_us = wait_us;
+            }
+            if (entry.deadline_us != 0 && begin_us > entry.deadline_us) {
+                stats.deadline_misses++;
+            }
+            if (end_us - start_us >= budget_us) {
+                for (auto& queue : queues_) {
+                    if (!queue.empty()) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        }
+    }
+}
+
+size_t MainTaskQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (auto& queue : queues_) {
+        count += queue.size();
+    }
+    return count;
+}
+
+std::vector<MainTaskStats> MainTaskQueue::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<MainTaskStats>(stats_.begin(), stats_.begin() + stats_count_);
+}
+
+MainTaskStats& MainTaskQueue::StatsFor(const char* name) {
+    for (size_t i = 0; i < stats_count_; i++) {
+        if (SameKey(stats_[i].name, name)) {
+            return stats_[i];
+        }
+    }
+    if (stats_count_ < kMaxStats - 1) {
+        stats_[stats_count_].name = name;
+        return stats_[stats_count_++];
+    }
+    // The last entry collects everything that does not fit
+    if (stats_count_ < kMaxStats) {
+        stats_[stats_count_++].name = "(overflow)";
+    }
+    return stats_[kMaxStats - 1];
+}
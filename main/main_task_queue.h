@@ -0,0 +1,172 @@
+#ifndef MAIN_TASK_QUEUE_H
+#define MAIN_TASK_QUEUE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+enum MainTaskPriority {
+    kMainTaskPriorityHigh,      // Device state transitions, protocol control
+    kMainTaskPriorityNormal,
+    kMainTaskPriorityLow,       // UI refresh, usually coalesced
+    kMainTaskPriorityCount
+};
+
+/*
+ * 主任务回调
+ *
+ * 与 std::function<void()> 用法相同，但只能移动。捕获不超过 kInlineSize 字节的
+ * lambda（例如 this + std::string）直接存放在对象内部，不额外分配堆内存。
+ */
+class MainTask {
+public:
+    static constexpr size_t kInlineSize = sizeof(void*) * 8;
+
+    MainTask() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, MainTask>>>
+    MainTask(F&& callable) {
+        using T = std::decay_t<F>;
+        if constexpr (sizeof(T) <= kInlineSize && alignof(T) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible_v<T>) {
+            new (buffer_) T(std::forward<F>(callable));
+            ops_ = &kInlineOps<T>;
+        } else {
+            *reinterpret_cast<T**>(buffer_) = new T(std::forward<F>(callable));
+            ops_ = &kHeapOps<T>;
+        }
+    }
+
+    MainTask(MainTask&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    MainTask& operator=(MainTask&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    MainTask(const MainTask&) = delete;
+    MainTask& operator=(const MainTask&) = delete;
+
+    ~MainTask() {
+        Reset();
+    }
+
+    void operator()() {
+        ops_->invoke(buffer_);
+    }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+    bool is_inline() const { return ops_ != nullptr && !ops_->heap; }
+
+    void Reset() {
+        if (ops_ != nullptr) {
+            ops_->destroy(buffer_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src);     // Leaves src destroyed
+        void (*destroy)(void* storage);
+        bool heap;
+    };
+
+    template <typename T>
+    static constexpr Ops kInlineOps = {
+        [](void* storage) { (*static_cast<T*>(storage))(); },
+        [](void* dst, void* src) {
+            new (dst) T(std::move(*static_cast<T*>(src)));
+            static_cast<T*>(src)->~T();
+        },
+        [](void* storage) { static_cast<T*>(storage)->~T(); },
+        false,
+    };
+
+    template <typename T>
+    static constexpr Ops kHeapOps = {
+        [](void* storage) { (**static_cast<T**>(storage))(); },
+        [](void* dst, void* src) { *static_cast<T**>(dst) = *static_cast<T**>(src); },
+        [](void* storage) { delete *static_cast<T**>(storage); },
+        true,
+    };
+
+    void MoveFrom(MainTask& other) {
+        ops_ = other.ops_;
+        if (ops_ != nullptr) {
+            ops_->move(buffer_, other.buffer_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char buffer_[kInlineSize];
+    const Ops* ops_ = nullptr;
+};
+
+// Run time accounting per task name, names are string literals
+struct MainTaskStats {
+    const char* name = nullptr;
+    uint32_t runs = 0;
+    uint32_t coalesced = 0;         // Replaced by a newer task with the same key before running
+    uint32_t deadline_misses = 0;   // Started after its deadline
+    uint32_t heap_tasks = 0;        // Captures too large for the inline buffer
+    int64_t total_run_us = 0;
+    int64_t max_run_us = 0;
+    int64_t max_wait_us = 0;        // From Push to start of execution
+};
+
+/*
+ * 主循环任务队列
+ *
+ * - 按优先级出队；低优先级任务超过截止时间后提前执行，避免饥饿
+ * - 带 key 的任务在队列中只保留最新的一个（例如 SetChatMessage / SetEmotion）
+ * - RunPending 只执行一个时间片，剩余任务留给下一轮，主循环可以先处理音频和状态事件
+ */
+class MainTaskQueue {
+public:
+    static constexpr size_t kMaxStats = 24;
+
+    // Returns false if the task replaced a pending one with the same key
+    bool Push(MainTask&& task, MainTaskPriority priority = kMainTaskPriorityNormal, const char* name = nullptr,
+              const char* key = nullptr, int deadline_ms = 0);
+
+    // Drop pending tasks with the given key
+    void Cancel(const char* key);
+
+    // Run tasks until the queue is empty or budget_us has elapsed, returns true if tasks remain
+    bool RunPending(int64_t budget_us);
+
+    size_t size() const;
+    std::vector<MainTaskStats> GetStats() const;
+
+private:
+    struct Entry {
+        MainTask task;
+        const char* name;
+        const char* key;
+        int64_t enqueue_us;
+        int64_t deadline_us;        // 0 if none
+    };
+
+    mutable std::mutex mutex_;
+    std::array<std::deque<Entry>, kMainTaskPriorityCount> queues_;
+    std::array<MainTaskStats, kMaxStats> stats_;
+    size_t stats_count_ = 0;
+
+    bool PopNext(Entry& entry, int64_t now_us);
+    MainTaskStats& StatsFor(const char* name);
+};
+
+#endif // MAIN_TASK_QUEUE_H
@@ -15,8 +15,14 @@
 #include "oled_display.h"
 #include "board.h"
 #include "settings.h"
+#include "progress_channel.h"
+#include "runtime_metrics.h"
+#include "heap_profiler.h"
 #include "lvgl_theme.h"
 #include "lvgl_display.h"
+#ifndef CONFIG_IDF_TARGET_ESP32
+#include "jpg/jpeg_to_image.h"
+#endif
 
 #define TAG "MCP"
 
@@ -135,6 +141,34 @@ void McpServer::AddUserOnlyTools() {
             return board.GetSystemInfoJson();
         });
 
+    AddUserOnlyTool("self.audio.get_metrics",
+        "Get audio quality metrics: microphone / processed / speaker levels, clipping, noise floor, SNR and echo return loss",
+        PropertyList(),
+        [this](const PropertyList& properties) -> ReturnValue {
+            auto& app = Application::GetInstance();
+            return app.GetAudioService().GetAudioMetricsJson();
+        });
+
+    AddUserOnlyTool("self.system.get_metrics",
+        "Get runtime metrics: per-task CPU usage over the last window, stack high-water marks, "
+        "internal / PSRAM heap with largest free block and fragmentation, allocation failures",
+        PropertyList(),
+        [this](const PropertyList& properties) -> ReturnValue {
+            return RuntimeMetrics::GetInstance().GetJson();
+        });
+
+#if CONFIG_USE_HEAP_PROFILER
+    AddUserOnlyTool("self.system.get_heap_profile",
+        "Get the allocation call sites holding the most live heap memory. "
+        "Symbolize the returned program counters with scripts/heap_profile.py",
+        PropertyList({
+            Property("top", kPropertyTypeInteger, 10, 1, 50)
+        }),
+        [this](const PropertyList& properties) -> ReturnValue {
+            return HeapProfiler::GetInstance().GetJson(properties["top"].value<int>());
+        });
+#endif
+
     AddUserOnlyTool("self.reboot", "Reboot the system",
         PropertyList(),
         [this](const PropertyList& properties) -> ReturnValue {
@@ -196,12 +230,7 @@ void McpServer::AddUserOnlyTools() {
                 auto url = properties["url"].value<std::string>();
                 auto quality = properties["quality"].value<int>();
 
-                std::string jpeg_data;
-                if (!display->SnapshotToJpeg(jpeg_data, quality)) {
-                    throw std::runtime_error("Failed to snapshot screen");
-                }
-
-                ESP_LOGI(TAG, "Upload snapshot %u bytes to %s", jpeg_data.size(), url.c_str());
+                ESP_LOGI(TAG, "Upload snapshot to %s", url.c_str());
                 
                 // 构造multipart/form-data请求体
                 std::string boundary = "----ESP32_SCREEN_SNAPSHOT_BOUNDARY";
@@ -221,8 +250,14 @@ void McpServer::AddUserOnlyTools() {
                     http->Write(file_header.c_str(), file_header.size());
                 }
 
-                // JPEG数据
-                http->Write((const char*)jpeg_data.data(), jpeg_data.size());
+                // JPEG数据，边编码边上传
+                bool snapshot_ok = display->SnapshotToJpeg([&http](const void* data, size_t len) {
+                    return http->Write((const char*)data, len) >= 0;
+                }, quality);
+                if (!snapshot_ok) {
+                    http->Close();
+                    throw std::runtime_error("Failed to snapshot screen");
+                }
 
                 {
                     // multipart尾部
@@ -263,19 +298,41 @@ void McpServer::AddUserOnlyTools() {
                     throw std::runtime_error("Failed to allocate memory for image: " + url);
                 }
                 size_t total_read = 0;
-                while (total_read < content_length) {
-                    int ret = http->Read(data + total_read, content_length - total_read);
-                    if (ret < 0) {
-                        heap_caps_free(data);
-                        throw std::runtime_error("Failed to download image: " + url);
-                    }
-                    if (ret == 0) {
-                        break;
+                {
+                    ProgressScope progress(kProgressTool);
+                    while (total_read < content_length) {
+                        int ret = http->Read(data + total_read, content_length - total_read);
+                        if (ret < 0) {
+                            heap_caps_free(data);
+                            throw std::runtime_error("Failed to download image: " + url);
+                        }
+                        if (ret == 0) {
+                            break;
+                        }
+                        total_read += ret;
+                        progress.Update(total_read * 100 / content_length);
                     }
-                    total_read += ret;
                 }
                 http->Close();
 
+#ifndef CONFIG_IDF_TARGET_ESP32
+                // Decode JPEG straight to display resolution instead of letting LVGL decode the full picture
+                if (total_read > 2 && (uint8_t)data[0] == 0xFF && (uint8_t)data[1] == 0xD8) {
+                    uint8_t* pixels = nullptr;
+                    size_t pixels_len = 0, width = 0, height = 0, stride = 0;
+                    esp_err_t ret = jpeg_to_image_fit((const uint8_t*)data, total_read, display->width(), display->height(),
+                        &pixels, &pixels_len, &width, &height, &stride);
+                    heap_caps_free(data);
+                    if (ret != ESP_OK) {
+                        throw std::runtime_error("Failed to decode image: " + url);
+                    }
+                    auto image = std::make_unique<LvglAllocatedImage>(pixels, pixels_len, width, height, stride,
+                        LV_COLOR_FORMAT_RGB565);
+                    display->SetPreviewImage(std::move(image));
+                    return true;
+                }
+#endif
+
                 auto image = std::make_unique<LvglAllocatedImage>(data, content_length);
                 display->SetPreviewImage(std::move(image));
                 return true;
@@ -508,19 +565,8 @@ void McpServer::GetToolsList(int id, const std::string& cursor, bool list_user_o
     ReplyResult(id, json);
 }
 
-void McpServer::DoToolCall(int id, const std::string& tool_name, const cJSON* tool_arguments) {
-    auto tool_iter = std::find_if(tools_.begin(), tools_.end(), 
-                                 [&tool_name](const McpTool* tool) { 
-                                     return tool->name() == tool_name; 
-                                 });
-    
-    if (tool_iter == tools_.end()) {
-        ESP_LOGE(TAG, "tools/call: Unknown tool: %s", tool_name.c_str());
-        ReplyError(id, "Unknown tool: " + tool_name);
-        return;
-    }
-
-    PropertyList arguments = (*tool_iter)->properties();
+bool McpServer::ParseToolArguments(const McpTool* tool, const cJSON* tool_arguments, PropertyList& arguments, std::string& error) {
+    arguments = tool->properties();
     try {
         for (auto& argument : arguments) {
             bool found = false;
@@ -539,14 +585,34 @@ void McpServer::DoToolCall(int id, const std::string& tool_name, const cJSON* to
             }
 
             if (!argument.has_default_value() && !found) {
-                ESP_LOGE(TAG, "tools/call: Missing valid argument: %s", argument.name().c_str());
-                ReplyError(id, "Missing valid argument: " + argument.name());
-                return;
+                error = "Missing valid argument: " + argument.name();
+                return false;
             }
         }
     } catch (const std::exception& e) {
-        ESP_LOGE(TAG, "tools/call: %s", e.what());
-        ReplyError(id, e.what());
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+void McpServer::DoToolCall(int id, const std::string& tool_name, const cJSON* tool_arguments) {
+    auto tool_iter = std::find_if(tools_.begin(), tools_.end(), 
+                                 [&tool_name](const McpTool* tool) { 
+                                     return tool->name() == tool_name; 
+                                 });
+    
+    if (tool_iter == tools_.end()) {
+        ESP_LOGE(TAG, "tools/call: Unknown tool: %s", tool_name.c_str());
+        ReplyError(id, "Unknown tool: " + tool_name);
+        return;
+    }
+
+    PropertyList arguments;
+    std::string error;
+    if (!ParseToolArguments(*tool_iter, tool_arguments, arguments, error)) {
+        ESP_LOGE(TAG, "tools/call: %s", error.c_str());
+        ReplyError(id, error);
         return;
     }
 
@@ -559,5 +625,37 @@ void McpServer::DoToolCall(int id, const std::string& tool_name, const cJSON* to
             ESP_LOGE(TAG, "tools/call: %s", e.what());
             ReplyError(id, e.what());
         }
-    });
+    }, kMainTaskPriorityNormal, "mcp_tool_call");
+}
+
+bool McpServer::CallToolLocally(const std::string& tool_name, const std::string& arguments_json) {
+    auto tool_iter = std::find_if(tools_.begin(), tools_.end(),
+                                 [&tool_name](const McpTool* tool) {
+                                     return tool->name() == tool_name;
+                                 });
+    if (tool_iter == tools_.end()) {
+        ESP_LOGW(TAG, "Local call: unknown tool: %s", tool_name.c_str());
+        return false;
+    }
+
+    cJSON* json = arguments_json.empty() ? nullptr : cJSON_Parse(arguments_json.c_str());
+    PropertyList arguments;
+    std::string error;
+    bool ok = ParseToolArguments(*tool_iter, json, arguments, error);
+    cJSON_Delete(json);
+    if (!ok) {
+        ESP_LOGW(TAG, "Local call %s: %s", tool_name.c_str(), error.c_str());
+        return false;
+    }
+
+    // 结果只记录日志，不发送给服务器
+    try {
+        bool succeeded = true;
+        auto result = (*tool_iter)->Call(arguments, &succeeded);
+        ESP_LOGI(TAG, "Local call %s: %s", tool_name.c_str(), result.c_str());
+        return succeeded;
+    } catch (const std::exception& e) {
+        ESP_LOGE(TAG, "Local call %s: %s", tool_name.c_str(), e.what());
+        return false;
+    }
 }
@@ -269,8 +269,12 @@ public:
         return result;
     }
 
-    std::string Call(const PropertyList& properties) {
+    // succeeded: optional, set to false when the tool returned a bool false
+    std::string Call(const PropertyList& properties, bool* succeeded = nullptr) {
         ReturnValue return_value = callback_(properties);
+        if (succeeded != nullptr) {
+            *succeeded = !std::holds_alternative<bool>(return_value) || std::get<bool>(return_value);
+        }
         // 返回结果
         cJSON* result = cJSON_CreateObject();
         cJSON* content = cJSON_CreateArray();
@@ -325,6 +329,10 @@ public:
     void AddUserOnlyTool(const std::string& name, const std::string& description, const PropertyList& properties, std::function<ReturnValue(const PropertyList&)> callback);
     void ParseMessage(const cJSON* json);
     void ParseMessage(const std::string& message);
+    // Call a tool on the device itself (e.g. from a local voice command); the result is not sent to the server.
+    // Must be called on the main task, like tool calls coming from the server.
+    // Returns false if the tool is unknown, the arguments are invalid, the tool throws or returns false.
+    bool CallToolLocally(const std::string& tool_name, const std::string& arguments_json);
 
 private:
     McpServer();
@@ -336,6 +344,7 @@ private:
     void ReplyError(int id, const std::string& message);
 
     void GetToolsList(int id, const std::string& cursor, bool list_user_only_tools);
+    bool ParseToolArguments(const McpTool* tool, const cJSON* tool_arguments, PropertyList& arguments, std::string& error);
     void DoToolCall(int id, const std::string& tool_name, const cJSON* tool_arguments);
 
     std::vector<McpTool*> tools_;
@@ -0,0 +1,103 @@
+#include "progress_channel.h"
+
+#include <algorithm>
+#include <esp_log.h>
+
+#define TAG "ProgressChannel"
+
+ProgressChannel::~ProgressChannel() {
+    if (timer_ != nullptr) {
+        esp_timer_stop(timer_);
+        esp_timer_delete(timer_);
+    }
+}
+
+uint32_t ProgressChannel::Pack(int progress, size_t speed) {
+    uint32_t percent = static_cast<uint32_t>(std::clamp(progress, 0, 100));
+    uint32_t speed_kb = static_cast<uint32_t>(std::min<size_t>(speed / 1024, 0xFFFF));
+    return kActiveBit | (percent << 16) | speed_kb;
+}
+
+ProgressUpdate ProgressChannel::Unpack(ProgressSlot slot, uint32_t value) {
+    return ProgressUpdate{
+        .slot = slot,
+        .active = (value & kActiveBit) != 0,
+        .progress = static_cast<int>((value >> 16) & 0xFF),
+        .speed = static_cast<size_t>(value & 0xFFFF) * 1024,
+    };
+}
+
+void ProgressChannel::Publish(ProgressSlot slot, int progress, size_t speed) {
+    uint32_t previous = slots_[slot].exchange(Pack(progress, speed), std::memory_order_release);
+    if ((previous & kActiveBit) == 0) {
+        StartTimer();
+    }
+}
+
+void ProgressChannel::Finish(ProgressSlot slot) {
+    // Keep the last value so the consumer still sees where the job stopped
+    slots_[slot].fetch_and(~kActiveBit, std::memory_order_release);
+}
+
+bool ProgressChannel::IsActive(ProgressSlot slot) const {
+    return (slots_[slot].load(std::memory_order_acquire) & kActiveBit) != 0;
+}
+
+void ProgressChannel::SetConsumer(std::function<void(const ProgressUpdate& update)> consumer, int interval_ms) {
+    consumer_ = std::move(consumer);
+    interval_ms_ = interval_ms;
+    if (timer_ == nullptr) {
+        esp_timer_create_args_t timer_args = {
+            .callback = [](void* arg) {
+                static_cast<ProgressChannel*>(arg)->Poll();
+            },
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "progress_timer",
+            .skip_unhandled_events = true,
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &timer_));
+    }
+    // Jobs may have started before the consumer was registered
+    for (int i = 0; i < kProgressSlotCount; i++) {
+        if (IsActive(static_cast<ProgressSlot>(i))) {
+            StartTimer();
+            break;
+        }
+    }
+}
+
+void ProgressChannel::StartTimer() {
+    if (timer_ == nullptr) {
+        return;
+    }
+    // ESP_ERR_INVALID_STATE means the timer is already running
+    esp_timer_start_periodic(timer_, interval_ms_ * 1000);
+}
+
+void ProgressChannel::Poll() {
+    bool any_active = false;
+    for (int i = 0; i < kProgressSlotCount; i++) {
+        uint32_t value = slots_[i].load(std::memory_order_acquire);
+        any_active |= (value & kActiveBit) != 0;
+        if (value == delivered_[i]) {
+            continue;
+        }
+        delivered_[i] = value;
+        if (consumer_) {
+            consumer_(Unpack(static_cast<ProgressSlot>(i), value));
+        }
+    }
+
+    if (!any_active && timer_ != nullptr) {
+        esp_timer_stop(timer_);
+        // A job may have started between the scan and the stop, its Publish could not restart a running timer
+        for (int i = 0; i < kProgressSlotCount; i++) {
+            if (IsActive(static_cast<ProgressSlot>(i))) {
+                ESP_LOGD(TAG, "Slot %d became active while stopping, restarting timer", i);
+                StartTimer();
+                break;
+            }
+        }
+    }
+}
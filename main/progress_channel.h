@@ -0,0 +1,99 @@
+#ifndef PROGRESS_CHANNEL_H
+#define PROGRESS_CHANNEL_H
+
+#include <atomic>
+#include <array>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+#include <esp_timer.h>
+
+// One latest-value slot per kind of long running job
+enum ProgressSlot {
+    kProgressFirmware,
+    kProgressAssets,
+    kProgressModel,
+    kProgressTool,
+    kProgressSlotCount
+};
+
+struct ProgressUpdate {
+    ProgressSlot slot;
+    bool active;        // false once the job has finished
+    int progress;       // 0-100
+    size_t speed;       // Bytes per second, 0 if unknown
+};
+
+/*
+ * 长任务进度通道
+ *
+ * 生产者（下载循环等）只写入一个原子变量，不加锁、不分配内存、不创建线程；
+ * 同一槽位的多次更新会合并为最新值。消费者通过 SetConsumer 注册，
+ * 由 esp_timer 按固定周期读取有变化的槽位，任一槽位激活时才启动定时器。
+ */
+class ProgressChannel {
+public:
+    static ProgressChannel& GetInstance() {
+        static ProgressChannel instance;
+        return instance;
+    }
+    ProgressChannel(const ProgressChannel&) = delete;
+    ProgressChannel& operator=(const ProgressChannel&) = delete;
+
+    // Producer side, wait-free, may be called from any task
+    void Publish(ProgressSlot slot, int progress, size_t speed = 0);
+    void Finish(ProgressSlot slot);
+
+    // Consumer side, the callback runs in the esp_timer task for every slot changed since the last poll
+    void SetConsumer(std::function<void(const ProgressUpdate& update)> consumer, int interval_ms = 500);
+    void Poll();
+
+    bool IsActive(ProgressSlot slot) const;
+
+private:
+    ProgressChannel() = default;
+    ~ProgressChannel();
+
+    // Packed slot value: [31] active, [30:24] unused, [23:16] progress, [15:0] speed in KB/s
+    static constexpr uint32_t kActiveBit = 1u << 31;
+    static uint32_t Pack(int progress, size_t speed);
+    static ProgressUpdate Unpack(ProgressSlot slot, uint32_t value);
+
+    std::array<std::atomic<uint32_t>, kProgressSlotCount> slots_ = {};
+    std::array<uint32_t, kProgressSlotCount> delivered_ = {};  // Only touched by the consumer
+    std::function<void(const ProgressUpdate& update)> consumer_;
+    esp_timer_handle_t timer_ = nullptr;
+    int interval_ms_ = 500;
+
+    void StartTimer();
+};
+
+// Publishes to a slot for the lifetime of the scope, so early returns and exceptions never leave it active
+class ProgressScope {
+public:
+    explicit ProgressScope(ProgressSlot slot) : slot_(slot) {
+        ProgressChannel::GetInstance().Publish(slot_, 0);
+    }
+    ~ProgressScope() {
+        ProgressChannel::GetInstance().Finish(slot_);
+    }
+    ProgressScope(const ProgressScope&) = delete;
+    ProgressScope& operator=(const ProgressScope&) = delete;
+
+    void Update(int progress, size_t speed = 0) {
+        ProgressChannel::GetInstance().Publish(slot_, progress, speed);
+    }
+
+    // Adapter for the (progress, speed) callbacks of Ota::Upgrade and Assets::Download
+    std::function<void(int progress, size_t speed)> Callback() const {
+        return [slot = slot_](int progress, size_t speed) {
+            ProgressChannel::GetInstance().Publish(slot, progress, speed);
+        };
+    }
+
+private:
+    ProgressSlot slot_;
+};
+
+#endif // PROGRESS_CHANNEL_H
@@ -5,6 +5,7 @@
 
 #include <esp_log.h>
 #include <cstring>
+#include <algorithm>
 #include <arpa/inet.h>
 #include "assets/lang_config.h"
 
@@ -31,6 +32,22 @@ MqttProtocol::MqttProtocol() {
         .arg = this,
     };
     esp_timer_create(&reconnect_timer_args, &reconnect_timer_);
+
+    // Sends a held batch when no further frame arrives before its pacing deadline
+    esp_timer_create_args_t batch_timer_args = {
+        .callback = [](void* arg) {
+            MqttProtocol* protocol = (MqttProtocol*)arg;
+            auto alive = protocol->alive_;  // Capture alive flag
+            Application::GetInstance().Schedule([protocol, alive]() {
+                if (*alive) {
+                    std::lock_guard<std::mutex> lock(protocol->channel_mutex_);
+                    protocol->FlushBatch();
+                }
+            });
+        },
+        .arg = this,
+    };
+    esp_timer_create(&batch_timer_args, &batch_timer_);
 }
 
 MqttProtocol::~MqttProtocol() {
@@ -43,6 +60,10 @@ MqttProtocol::~MqttProtocol() {
         esp_timer_stop(reconnect_timer_);
         esp_timer_delete(reconnect_timer_);
     }
+    if (batch_timer_ != nullptr) {
+        esp_timer_stop(batch_timer_);
+        esp_timer_delete(batch_timer_);
+    }
 
     udp_.reset();
     mqtt_.reset();
@@ -56,7 +77,7 @@ bool MqttProtocol::Start() {
     return StartMqttClient(false);
 }
 
-bool MqttProtocol::StartMqttClient(bool report_error) {
+bool MqttProtocol::StartMqttClient(bool report_error, int timeout_ms) {
     if (mqtt_ != nullptr) {
         ESP_LOGW(TAG, "Mqtt client already started");
         mqtt_.reset();
@@ -79,10 +100,10 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
     }
 
     auto network = Board::GetInstance().GetNetwork();
-    mqtt_ = network->CreateMqtt(0);
-    mqtt_->SetKeepAlive(keepalive_interval);
+    auto mqtt = network->CreateMqtt(0);
+    mqtt->SetKeepAlive(keepalive_interval);
 
-    mqtt_->OnDisconnected([this]() {
+    mqtt->OnDisconnected([this]() {
         if (on_disconnected_ != nullptr) {
             on_disconnected_();
         }
@@ -90,14 +111,14 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
         esp_timer_start_once(reconnect_timer_, MQTT_RECONNECT_INTERVAL_MS * 1000);
     });
 
-    mqtt_->OnConnected([this]() {
+    mqtt->OnConnected([this]() {
         if (on_connected_ != nullptr) {
             on_connected_();
         }
         esp_timer_stop(reconnect_timer_);
     });
 
-    mqtt_->OnMessage([this](const std::string& topic, const std::string& payload) {
+    mqtt->OnMessage([this](const std::string& topic, const std::string& payload) {
         cJSON* root = cJSON_Parse(payload.c_str());
         if (root == nullptr) {
             ESP_LOGE(TAG, "Failed to parse json message %s", payload.c_str());
@@ -140,10 +161,24 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
     } else {
         broker_address = endpoint;
     }
-    if (!mqtt_->Connect(broker_address, broker_port, client_id, username, password)) {
-        ESP_LOGE(TAG, "Failed to connect to endpoint, code=%d", mqtt_->GetLastError());
-        SetError(Lang::Strings::SERVER_NOT_CONNECTED);
-        return false;
+    if (timeout_ms > 0) {
+        // Connected in another task, a client still connecting at the deadline is deleted there
+        auto pending = std::make_shared<std::unique_ptr<Mqtt>>(std::move(mqtt));
+        if (!ConnectWithTimeout([pending, broker_address, broker_port, client_id, username, password]() {
+                return (*pending)->Connect(broker_address, broker_port, client_id, username, password);
+            }, timeout_ms)) {
+            ESP_LOGE(TAG, "Failed to connect to endpoint within %d ms", timeout_ms);
+            SetError(Lang::Strings::SERVER_NOT_CONNECTED);
+            return false;
+        }
+        mqtt_ = std::move(*pending);
+    } else {
+        mqtt_ = std::move(mqtt);
+        if (!mqtt_->Connect(broker_address, broker_port, client_id, username, password)) {
+            ESP_LOGE(TAG, "Failed to connect to endpoint, code=%d", mqtt_->GetLastError());
+            SetError(Lang::Strings::SERVER_NOT_CONNECTED);
+            return false;
+        }
     }
 
     ESP_LOGI(TAG, "Connected to endpoint");
@@ -151,9 +186,17 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
 }
 
 bool MqttProtocol::SendText(const std::string& text) {
-    if (publish_topic_.empty()) {
+    // No client after a migration that could not reconnect
+    if (mqtt_ == nullptr || publish_topic_.empty()) {
         return false;
     }
+    {
+        // Held audio goes out first, so the server gets it before a control message like listen stop
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        if (udp_ != nullptr) {
+            FlushBatch();
+        }
+    }
     if (!mqtt_->Publish(publish_topic_, text)) {
         ESP_LOGE(TAG, "Failed to publish message: %s", text.c_str());
         SetError(Lang::Strings::SERVER_ERROR);
@@ -168,29 +211,119 @@ bool MqttProtocol::SendAudio(std::unique_ptr<AudioStreamPacket> packet) {
         return false;
     }
 
+    // One frame per datagram, also for the empty packet that announces a new address
+    // and for a frame that alone would exceed the negotiated datagram size
+    const size_t entry_header_size = 10;
+    if (batch_max_bytes_ == 0 || packet->payload.empty() ||
+        aes_nonce_.size() + entry_header_size + packet->payload.size() > batch_max_bytes_) {
+        if (!FlushBatch()) {
+            return false;
+        }
+        std::string nonce(aes_nonce_);
+        *(uint16_t*)&nonce[2] = htons(packet->payload.size());
+        *(uint32_t*)&nonce[8] = htonl(packet->timestamp);
+        *(uint32_t*)&nonce[12] = htonl(++local_sequence_);
+        sent_frames_++;
+        return SendDatagram(nonce, packet->payload.data(), packet->payload.size());
+    }
+
+    // Start a new datagram when the frame does not fit into the size budget
+    if (batch_frames_ > 0 && aes_nonce_.size() + batch_.size() + entry_header_size + packet->payload.size() > batch_max_bytes_) {
+        if (!FlushBatch()) {
+            return false;
+        }
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (batch_frames_ == 0) {
+        batch_timestamp_ = packet->timestamp;
+        batch_sequence_ = local_sequence_ + 1;
+        batch_started_us_ = now;
+    }
+    // Entries are not aligned in the buffer, so the fields are copied byte-wise
+    uint8_t entry_header[entry_header_size];
+    uint16_t size = htons(packet->payload.size());
+    uint32_t timestamp = htonl(packet->timestamp);
+    uint32_t sequence = htonl(++local_sequence_);
+    memcpy(&entry_header[0], &size, sizeof(size));
+    memcpy(&entry_header[2], &timestamp, sizeof(timestamp));
+    memcpy(&entry_header[6], &sequence, sizeof(sequence));
+    batch_.append((const char*)entry_header, entry_header_size);
+    batch_.append((const char*)packet->payload.data(), packet->payload.size());
+    batch_frames_++;
+    sent_frames_++;
+
+    // Send at once while the link is idle, hold frames while the modem is still busy with the last datagram
+    if (batch_frames_ >= batch_max_frames_ || now - last_send_us_ >= send_time_us_ * MQTT_UDP_PACING_FACTOR) {
+        return FlushBatch();
+    }
+    ScheduleBatchFlush();
+    return true;
+}
+
+bool MqttProtocol::FlushBatch() {
+    if (batch_frames_ == 0) {
+        return true;
+    }
+    esp_timer_stop(batch_timer_);
+
+    // The header carries the first frame, the entries keep their own timestamp and sequence
     std::string nonce(aes_nonce_);
-    *(uint16_t*)&nonce[2] = htons(packet->payload.size());
-    *(uint32_t*)&nonce[8] = htonl(packet->timestamp);
-    *(uint32_t*)&nonce[12] = htonl(++local_sequence_);
+    nonce[1] |= MQTT_UDP_FLAG_BATCH;
+    *(uint16_t*)&nonce[2] = htons(batch_.size());
+    *(uint32_t*)&nonce[8] = htonl(batch_timestamp_);
+    *(uint32_t*)&nonce[12] = htonl(batch_sequence_);
+    bool sent = SendDatagram(nonce, (const uint8_t*)batch_.data(), batch_.size());
+    batch_.clear();
+    batch_frames_ = 0;
+    return sent;
+}
 
+void MqttProtocol::ScheduleBatchFlush() {
+    if (esp_timer_is_active(batch_timer_)) {
+        return;
+    }
+    int64_t pacing_deadline = last_send_us_ + send_time_us_ * MQTT_UDP_PACING_FACTOR;
+    int64_t hold_deadline = batch_started_us_ + (int64_t)(batch_max_frames_ - 1) * OPUS_FRAME_DURATION_MS * 1000;
+    int64_t delay = std::min(pacing_deadline, hold_deadline) - esp_timer_get_time();
+    esp_timer_start_once(batch_timer_, std::max<int64_t>(delay, 1000));
+}
+
+bool MqttProtocol::SendDatagram(const std::string& nonce, const uint8_t* data, size_t size) {
     std::string encrypted;
-    encrypted.resize(aes_nonce_.size() + packet->payload.size());
+    encrypted.resize(nonce.size() + size);
     memcpy(encrypted.data(), nonce.data(), nonce.size());
 
     size_t nc_off = 0;
+    uint8_t nonce_counter[16];
     uint8_t stream_block[16] = {0};
-    if (mbedtls_aes_crypt_ctr(&aes_ctx_, packet->payload.size(), &nc_off, (uint8_t*)nonce.c_str(), stream_block,
-        (uint8_t*)packet->payload.data(), (uint8_t*)&encrypted[nonce.size()]) != 0) {
+    memcpy(nonce_counter, nonce.data(), sizeof(nonce_counter));
+    if (mbedtls_aes_crypt_ctr(&aes_ctx_, size, &nc_off, nonce_counter, stream_block,
+        data, (uint8_t*)&encrypted[nonce.size()]) != 0) {
         ESP_LOGE(TAG, "Failed to encrypt audio data");
         return false;
     }
 
-    return udp_->Send(encrypted) > 0;
+    // On AT command modems the call blocks for a whole AT transaction, its duration paces the batches
+    int64_t start = esp_timer_get_time();
+    bool sent = udp_->Send(encrypted) > 0;
+    last_send_us_ = esp_timer_get_time();
+    int64_t elapsed = last_send_us_ - start;
+    send_time_us_ = send_time_us_ == 0 ? elapsed : (send_time_us_ * 7 + elapsed) / 8;
+    sent_datagrams_++;
+    return sent;
 }
 
 void MqttProtocol::CloseAudioChannel() {
     {
         std::lock_guard<std::mutex> lock(channel_mutex_);
+        if (sent_datagrams_ > 0) {
+            ESP_LOGI(TAG, "UDP uplink: %lu frames in %lu datagrams, send time %lld us",
+                sent_frames_, sent_datagrams_, send_time_us_);
+        }
+        esp_timer_stop(batch_timer_);
+        batch_.clear();
+        batch_frames_ = 0;
         udp_.reset();
     }
 
@@ -215,22 +348,88 @@ bool MqttProtocol::OpenAudioChannel() {
 
     error_occurred_ = false;
     session_id_ = "";
+    if (!RequestSession("", SERVER_HELLO_TIMEOUT_MS)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        ConnectUdp();
+    }
+
+    if (on_audio_channel_opened_ != nullptr) {
+        on_audio_channel_opened_();
+    }
+    return true;
+}
+
+bool MqttProtocol::MigrateAudioChannel() {
+    // The broker allows one connection per client id, so the MQTT link is reconnected first
+    // while the old UDP socket keeps carrying audio
+    if (!StartMqttClient(false, SERVER_RECONNECT_TIMEOUT_MS)) {
+        // Retried on the new network once the conversation is closed and the device is idle
+        esp_timer_start_once(reconnect_timer_, MQTT_RECONNECT_INTERVAL_MS * 1000);
+        return false;
+    }
+    if (udp_ == nullptr) {
+        return true;
+    }
+
+    ESP_LOGI(TAG, "Resuming session %s on the new network", session_id_.c_str());
+    if (!RequestSession(session_id_, SERVER_RESUME_TIMEOUT_MS)) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        ConnectUdp();
+    }
+    // An empty packet tells the server the new UDP address before there is uplink audio
+    SendAudio(std::make_unique<AudioStreamPacket>());
+    return true;
+}
+
+bool MqttProtocol::RequestSession(const std::string& session_id, int hello_timeout_ms) {
     xEventGroupClearBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT);
 
-    auto message = GetHelloMessage();
+    auto message = GetHelloMessage(session_id);
     if (!SendText(message)) {
         return false;
     }
 
     // 等待服务器响应
-    EventBits_t bits = xEventGroupWaitBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(10000));
+    EventBits_t bits = xEventGroupWaitBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(hello_timeout_ms));
     if (!(bits & MQTT_PROTOCOL_SERVER_HELLO_EVENT)) {
         ESP_LOGE(TAG, "Failed to receive server hello");
         SetError(Lang::Strings::SERVER_TIMEOUT);
         return false;
     }
+    return true;
+}
+
+void MqttProtocol::ConnectUdp() {
+    // The old socket is closed before the key of the new session replaces its key,
+    // a batch still held for it goes out first
+    if (udp_ != nullptr) {
+        FlushBatch();
+    }
+    udp_.reset();
+    aes_nonce_ = udp_nonce_;
+    mbedtls_aes_init(&aes_ctx_);
+    mbedtls_aes_setkey_enc(&aes_ctx_, (const unsigned char*)udp_key_.c_str(), 128);
+    local_sequence_ = 0;
+    remote_sequence_ = 0;
+    esp_timer_stop(batch_timer_);
+    batch_.clear();
+    batch_frames_ = 0;
+    batch_max_bytes_ = udp_batch_max_bytes_;
+    batch_max_frames_ = udp_batch_max_frames_;
+    batch_.reserve(batch_max_bytes_);
+    // The send time is measured again, the new socket may be on another network
+    send_time_us_ = 0;
+    last_send_us_ = 0;
+    sent_frames_ = 0;
+    sent_datagrams_ = 0;
 
-    std::lock_guard<std::mutex> lock(channel_mutex_);
     auto network = Board::GetInstance().GetNetwork();
     udp_ = network->CreateUdp(2);
     udp_->OnMessage([this](const std::string& data) {
@@ -238,6 +437,8 @@ bool MqttProtocol::OpenAudioChannel() {
          * UDP Encrypted OPUS Packet Format:
          * |type 1u|flags 1u|payload_len 2u|ssrc 4u|timestamp 4u|sequence 4u|
          * |payload payload_len|
+         * With MQTT_UDP_FLAG_BATCH the decrypted payload is a list of frames:
+         * |size 2u|timestamp 4u|sequence 4u|payload size| ...
          */
         if (data.size() < sizeof(aes_nonce_)) {
             ESP_LOGE(TAG, "Invalid audio packet size: %u", data.size());
@@ -249,50 +450,79 @@ bool MqttProtocol::OpenAudioChannel() {
         }
         uint32_t timestamp = ntohl(*(uint32_t*)&data[8]);
         uint32_t sequence = ntohl(*(uint32_t*)&data[12]);
-        if (sequence < remote_sequence_) {
-            ESP_LOGW(TAG, "Received audio packet with old sequence: %lu, expected: %lu", sequence, remote_sequence_);
-            return;
-        }
-        if (sequence != remote_sequence_ + 1) {
-            ESP_LOGW(TAG, "Received audio packet with wrong sequence: %lu, expected: %lu", sequence, remote_sequence_ + 1);
-        }
 
         size_t decrypted_size = data.size() - aes_nonce_.size();
         size_t nc_off = 0;
         uint8_t stream_block[16] = {0};
         auto nonce = (uint8_t*)data.data();
         auto encrypted = (uint8_t*)data.data() + aes_nonce_.size();
-        auto packet = std::make_unique<AudioStreamPacket>();
-        packet->sample_rate = server_sample_rate_;
-        packet->frame_duration = server_frame_duration_;
-        packet->timestamp = timestamp;
-        packet->payload.resize(decrypted_size);
-        int ret = mbedtls_aes_crypt_ctr(&aes_ctx_, decrypted_size, &nc_off, nonce, stream_block, encrypted, (uint8_t*)packet->payload.data());
+        std::vector<uint8_t> decrypted(decrypted_size);
+        int ret = mbedtls_aes_crypt_ctr(&aes_ctx_, decrypted_size, &nc_off, nonce, stream_block, encrypted, decrypted.data());
         if (ret != 0) {
             ESP_LOGE(TAG, "Failed to decrypt audio data, ret: %d", ret);
             return;
         }
-        if (on_incoming_audio_ != nullptr) {
-            on_incoming_audio_(std::move(packet));
-        }
-        remote_sequence_ = sequence;
         last_incoming_time_ = std::chrono::steady_clock::now();
+
+        if (!(data[1] & MQTT_UDP_FLAG_BATCH)) {
+            OnIncomingFrame(timestamp, sequence, std::move(decrypted));
+            return;
+        }
+        if (batch_max_bytes_ == 0) {
+            ESP_LOGE(TAG, "Dropped a batched audio packet, batching was not negotiated");
+            return;
+        }
+        size_t pos = 0;
+        while (pos + 10 <= decrypted.size()) {
+            uint16_t size;
+            memcpy(&size, &decrypted[pos], sizeof(size));
+            memcpy(&timestamp, &decrypted[pos + 2], sizeof(timestamp));
+            memcpy(&sequence, &decrypted[pos + 6], sizeof(sequence));
+            size = ntohs(size);
+            pos += 10;
+            if (pos + size > decrypted.size()) {
+                ESP_LOGE(TAG, "Invalid batched frame size: %u", size);
+                break;
+            }
+            OnIncomingFrame(ntohl(timestamp), ntohl(sequence),
+                std::vector<uint8_t>(decrypted.begin() + pos, decrypted.begin() + pos + size));
+            pos += size;
+        }
     });
 
     udp_->Connect(udp_server_, udp_port_);
+}
 
-    if (on_audio_channel_opened_ != nullptr) {
-        on_audio_channel_opened_();
+void MqttProtocol::OnIncomingFrame(uint32_t timestamp, uint32_t sequence, std::vector<uint8_t>&& payload) {
+    if (sequence < remote_sequence_) {
+        ESP_LOGW(TAG, "Received audio packet with old sequence: %lu, expected: %lu", sequence, remote_sequence_);
+        return;
     }
-    return true;
+    if (sequence != remote_sequence_ + 1) {
+        ESP_LOGW(TAG, "Received audio packet with wrong sequence: %lu, expected: %lu", sequence, remote_sequence_ + 1);
+    }
+
+    auto packet = std::make_unique<AudioStreamPacket>();
+    packet->sample_rate = server_sample_rate_;
+    packet->frame_duration = server_frame_duration_;
+    packet->timestamp = timestamp;
+    packet->payload = std::move(payload);
+    if (on_incoming_audio_ != nullptr) {
+        on_incoming_audio_(std::move(packet));
+    }
+    remote_sequence_ = sequence;
 }
 
-std::string MqttProtocol::GetHelloMessage() {
+std::string MqttProtocol::GetHelloMessage(const std::string& session_id) {
     // 发送 hello 消息申请 UDP 通道
     cJSON* root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "type", "hello");
     cJSON_AddNumberToObject(root, "version", 3);
     cJSON_AddStringToObject(root, "transport", "udp");
+    if (!session_id.empty()) {
+        // Ask the server to resume this session after a network handover
+        cJSON_AddStringToObject(root, "session_id", session_id.c_str());
+    }
     cJSON* features = cJSON_CreateObject();
 #if CONFIG_USE_SERVER_AEC
     cJSON_AddBoolToObject(features, "aec", true);
@@ -305,6 +535,15 @@ std::string MqttProtocol::GetHelloMessage() {
     cJSON_AddNumberToObject(audio_params, "channels", 1);
     cJSON_AddNumberToObject(audio_params, "frame_duration", OPUS_FRAME_DURATION_MS);
     cJSON_AddItemToObject(root, "audio_params", audio_params);
+#if CONFIG_MQTT_UDP_BATCH
+    // Offer several frames per datagram, the server answers with the limits it accepts
+    cJSON* udp = cJSON_CreateObject();
+    cJSON* batch = cJSON_CreateObject();
+    cJSON_AddNumberToObject(batch, "max_bytes", CONFIG_MQTT_UDP_BATCH_MAX_BYTES);
+    cJSON_AddNumberToObject(batch, "max_frames", CONFIG_MQTT_UDP_BATCH_MAX_FRAMES);
+    cJSON_AddItemToObject(udp, "batch", batch);
+    cJSON_AddItemToObject(root, "udp", udp);
+#endif
     auto json_str = cJSON_PrintUnformatted(root);
     std::string message(json_str);
     cJSON_free(json_str);
@@ -343,18 +582,36 @@ void MqttProtocol::ParseServerHello(const cJSON* root) {
         ESP_LOGE(TAG, "UDP is not specified");
         return;
     }
-    udp_server_ = cJSON_GetObjectItem(udp, "server")->valuestring;
-    udp_port_ = cJSON_GetObjectItem(udp, "port")->valueint;
     auto key = cJSON_GetObjectItem(udp, "key")->valuestring;
     auto nonce = cJSON_GetObjectItem(udp, "nonce")->valuestring;
 
+    // Runs in the MQTT task, the main task reads these in ConnectUdp and SendAudio
+    std::lock_guard<std::mutex> lock(channel_mutex_);
+    udp_server_ = cJSON_GetObjectItem(udp, "server")->valuestring;
+    udp_port_ = cJSON_GetObjectItem(udp, "port")->valueint;
     // auto encryption = cJSON_GetObjectItem(udp, "encryption")->valuestring;
     // ESP_LOGI(TAG, "UDP server: %s, port: %d, encryption: %s", udp_server_.c_str(), udp_port_, encryption);
-    aes_nonce_ = DecodeHexString(nonce);
-    mbedtls_aes_init(&aes_ctx_);
-    mbedtls_aes_setkey_enc(&aes_ctx_, (const unsigned char*)DecodeHexString(key).c_str(), 128);
-    local_sequence_ = 0;
-    remote_sequence_ = 0;
+    udp_nonce_ = DecodeHexString(nonce);
+    udp_key_ = DecodeHexString(key);
+
+    udp_batch_max_bytes_ = 0;
+    udp_batch_max_frames_ = 1;
+#if CONFIG_MQTT_UDP_BATCH
+    auto batch = cJSON_GetObjectItem(udp, "batch");
+    if (cJSON_IsObject(batch)) {
+        auto max_bytes = cJSON_GetObjectItem(batch, "max_bytes");
+        auto max_frames = cJSON_GetObjectItem(batch, "max_frames");
+        if (!cJSON_IsNumber(max_bytes) || !cJSON_IsNumber(max_frames) ||
+            max_bytes->valueint < MQTT_UDP_BATCH_MIN_BYTES || max_frames->valueint < 2) {
+            // Also rejects negative values, which would wrap around as a size
+            ESP_LOGW(TAG, "Ignoring invalid UDP batch parameters, sending one frame per datagram");
+        } else {
+            udp_batch_max_bytes_ = std::min(max_bytes->valueint, CONFIG_MQTT_UDP_BATCH_MAX_BYTES);
+            udp_batch_max_frames_ = std::min(max_frames->valueint, CONFIG_MQTT_UDP_BATCH_MAX_FRAMES);
+            ESP_LOGI(TAG, "UDP batching: %u bytes, %d frames", udp_batch_max_bytes_, udp_batch_max_frames_);
+        }
+    }
+#endif
     xEventGroupSetBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT);
 }
 
@@ -23,6 +23,13 @@
 
 #define MQTT_PROTOCOL_SERVER_HELLO_EVENT (1 << 0)
 
+// flags bit of a UDP audio packet that carries several frames
+#define MQTT_UDP_FLAG_BATCH 0x01
+// Smallest batch size accepted from the server hello, the same floor as CONFIG_MQTT_UDP_BATCH_MAX_BYTES
+#define MQTT_UDP_BATCH_MIN_BYTES 256
+// A held batch is sent no sooner than this many smoothed send times after the previous datagram
+#define MQTT_UDP_PACING_FACTOR 2
+
 class MqttProtocol : public Protocol {
 public:
     MqttProtocol();
@@ -33,6 +40,7 @@ public:
     bool OpenAudioChannel() override;
     void CloseAudioChannel() override;
     bool IsAudioChannelOpened() const override;
+    bool MigrateAudioChannel() override;
 
 private:
     // Alive flag for safe scheduled callbacks - set to false in destructor
@@ -49,16 +57,42 @@ private:
     std::string aes_nonce_;
     std::string udp_server_;
     int udp_port_;
+    // Key and nonce of the last server hello, applied when the UDP socket is created
+    std::string udp_key_;
+    std::string udp_nonce_;
     uint32_t local_sequence_;
     uint32_t remote_sequence_;
     esp_timer_handle_t reconnect_timer_;
 
-    bool StartMqttClient(bool report_error=false);
+    // Batching accepted by the last server hello, 0 bytes means one frame per datagram
+    size_t udp_batch_max_bytes_ = 0;
+    int udp_batch_max_frames_ = 1;
+    size_t batch_max_bytes_ = 0;
+    int batch_max_frames_ = 1;
+    std::string batch_;             // Pending plaintext entries |size 2u|timestamp 4u|sequence 4u|payload|
+    int batch_frames_ = 0;
+    uint32_t batch_timestamp_ = 0;
+    uint32_t batch_sequence_ = 0;
+    int64_t batch_started_us_ = 0;
+    int64_t last_send_us_ = 0;
+    int64_t send_time_us_ = 0;      // Smoothed duration of udp_->Send, one AT transaction on 4G modems
+    uint32_t sent_frames_ = 0;
+    uint32_t sent_datagrams_ = 0;
+    esp_timer_handle_t batch_timer_;
+
+    // timeout_ms > 0 bounds the connect, the client is only installed once it is connected
+    bool StartMqttClient(bool report_error=false, int timeout_ms=0);
+    bool RequestSession(const std::string& session_id, int hello_timeout_ms);
+    void ConnectUdp();
+    bool SendDatagram(const std::string& nonce, const uint8_t* data, size_t size);
+    bool FlushBatch();
+    void ScheduleBatchFlush();
+    void OnIncomingFrame(uint32_t timestamp, uint32_t sequence, std::vector<uint8_t>&& payload);
     void ParseServerHello(const cJSON* root);
     std::string DecodeHexString(const std::string& hex_string);
 
     bool SendText(const std::string& text) override;
-    std::string GetHelloMessage();
+    std::string GetHelloMessage(const std::string& session_id);
 };
 
 
@@ -1,6 +1,12 @@
 #include "protocol.h"
 
 #include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 
 #define TAG "Protocol"
 
@@ -78,6 +84,16 @@ void Protocol::SendMcpMessage(const std::string& payload) {
     SendText(message);
 }
 
+void Protocol::SendAudioMetrics(const std::string& metrics) {
+    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"audio_metrics\",\"metrics\":" + metrics + "}";
+    SendText(message);
+}
+
+void Protocol::SendRuntimeMetrics(const std::string& metrics) {
+    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"runtime_metrics\",\"metrics\":" + metrics + "}";
+    SendText(message);
+}
+
 bool Protocol::IsTimeout() const {
     const int kTimeoutSeconds = 120;
     auto now = std::chrono::steady_clock::now();
@@ -88,3 +104,42 @@ bool Protocol::IsTimeout() const {
     }
     return timeout;
 }
+
+bool Protocol::ConnectWithTimeout(std::function<bool()> connect, int timeout_ms) {
+    struct Attempt {
+        std::function<bool()> connect;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+        bool connected = false;
+    };
+    auto attempt = std::make_shared<Attempt>();
+    attempt->connect = std::move(connect);
+
+    // The task keeps its own reference, an abandoned attempt is freed when connect returns
+    auto task_attempt = new std::shared_ptr<Attempt>(attempt);
+    if (xTaskCreate([](void* arg) {
+        auto task_attempt = static_cast<std::shared_ptr<Attempt>*>(arg);
+        auto& attempt = *task_attempt;
+        bool connected = attempt->connect();
+        {
+            std::lock_guard<std::mutex> lock(attempt->mutex);
+            attempt->done = true;
+            attempt->connected = connected;
+        }
+        attempt->cv.notify_all();
+        delete task_attempt;
+        vTaskDelete(NULL);
+    }, "connect", 4096, task_attempt, 5, nullptr) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create connect task");
+        delete task_attempt;
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(attempt->mutex);
+    if (!attempt->cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&attempt]() { return attempt->done; })) {
+        ESP_LOGW(TAG, "Connect did not finish within %d ms", timeout_ms);
+        return false;
+    }
+    return attempt->connected;
+}
@@ -41,6 +41,13 @@ enum ListeningMode {
     kListeningModeRealtime // 需要 AEC 支持
 };
 
+// Opening a channel waits this long for the server hello
+#define SERVER_HELLO_TIMEOUT_MS 10000
+// A migration runs on the main loop while uplink audio waits in the send queue (2.4 s),
+// so reconnecting and the resumed hello get shorter bounds and the conversation is closed instead of stalling
+#define SERVER_RECONNECT_TIMEOUT_MS 3000
+#define SERVER_RESUME_TIMEOUT_MS 2000
+
 class Protocol {
 public:
     virtual ~Protocol() = default;
@@ -67,12 +74,17 @@ public:
     virtual bool OpenAudioChannel() = 0;
     virtual void CloseAudioChannel() = 0;
     virtual bool IsAudioChannelOpened() const = 0;
+    // Reconnect on Board::GetNetwork() after a network handover and resume the session by its id,
+    // the old connection is used until the new one is ready. false if the session could not be moved
+    virtual bool MigrateAudioChannel() { return false; }
     virtual bool SendAudio(std::unique_ptr<AudioStreamPacket> packet) = 0;
     virtual void SendWakeWordDetected(const std::string& wake_word);
     virtual void SendStartListening(ListeningMode mode);
     virtual void SendStopListening();
     virtual void SendAbortSpeaking(AbortReason reason);
     virtual void SendMcpMessage(const std::string& message);
+    virtual void SendAudioMetrics(const std::string& metrics);
+    virtual void SendRuntimeMetrics(const std::string& metrics);
 
 protected:
     std::function<void(const cJSON* root)> on_incoming_json_;
@@ -92,6 +104,10 @@ protected:
     virtual bool SendText(const std::string& text) = 0;
     virtual void SetError(const std::string& message);
     virtual bool IsTimeout() const;
+
+    // Runs connect in its own task and waits at most timeout_ms. A connect still running after that
+    // is left to finish there, everything it captured is released in that task
+    static bool ConnectWithTimeout(std::function<bool()> connect, int timeout_ms);
 };
 
 #endif // PROTOCOL_H
@@ -26,6 +26,7 @@ bool WebsocketProtocol::Start() {
 }
 
 bool WebsocketProtocol::SendAudio(std::unique_ptr<AudioStreamPacket> packet) {
+    std::lock_guard<std::mutex> lock(websocket_mutex_);
     if (websocket_ == nullptr || !websocket_->IsConnected()) {
         return false;
     }
@@ -58,6 +59,7 @@ bool WebsocketProtocol::SendAudio(std::unique_ptr<AudioStreamPacket> packet) {
 }
 
 bool WebsocketProtocol::SendText(const std::string& text) {
+    std::lock_guard<std::mutex> lock(websocket_mutex_);
     if (websocket_ == nullptr || !websocket_->IsConnected()) {
         return false;
     }
@@ -72,29 +74,105 @@ bool WebsocketProtocol::SendText(const std::string& text) {
 }
 
 bool WebsocketProtocol::IsAudioChannelOpened() const {
+    std::lock_guard<std::mutex> lock(websocket_mutex_);
     return websocket_ != nullptr && websocket_->IsConnected() && !error_occurred_ && !IsTimeout();
 }
 
 void WebsocketProtocol::CloseAudioChannel() {
-    websocket_.reset();
+    std::unique_ptr<WebSocket> websocket;
+    {
+        std::lock_guard<std::mutex> lock(websocket_mutex_);
+        websocket = std::move(websocket_);
+    }
+    if (websocket == nullptr) {
+        return;
+    }
+    // Destroyed outside the lock, its disconnect callback is filtered because it is no longer websocket_
+    websocket.reset();
+    if (on_audio_channel_closed_ != nullptr) {
+        on_audio_channel_closed_();
+    }
 }
 
 bool WebsocketProtocol::OpenAudioChannel() {
+    error_occurred_ = false;
+
+    std::string url;
+    auto websocket = CreateWebSocket(url);
+    if (websocket == nullptr) {
+        return false;
+    }
+    auto connection = websocket.get();
+    std::unique_ptr<WebSocket> previous;
+    {
+        std::lock_guard<std::mutex> lock(websocket_mutex_);
+        previous = std::move(websocket_);
+        websocket_ = std::move(websocket);
+    }
+    previous.reset();
+    if (!Handshake(connection, url, "", SERVER_HELLO_TIMEOUT_MS)) {
+        return false;
+    }
+
+    if (on_audio_channel_opened_ != nullptr) {
+        on_audio_channel_opened_();
+    }
+
+    return true;
+}
+
+bool WebsocketProtocol::MigrateAudioChannel() {
+    {
+        std::lock_guard<std::mutex> lock(websocket_mutex_);
+        if (websocket_ == nullptr) {
+            // No open channel, the next one is opened on the new network anyway
+            return true;
+        }
+    }
+
+    // Make before break: the old connection keeps receiving until the session is resumed
+    std::string url;
+    auto websocket = CreateWebSocket(url);
+    if (websocket == nullptr) {
+        return false;
+    }
+    // Connected in another task, a connection still pending at the deadline is deleted there
+    ESP_LOGI(TAG, "Connecting to websocket server: %s with version: %d", url.c_str(), version_);
+    auto pending = std::make_shared<std::unique_ptr<WebSocket>>(std::move(websocket));
+    if (!ConnectWithTimeout([pending, url]() { return (*pending)->Connect(url.c_str()); }, SERVER_RECONNECT_TIMEOUT_MS)) {
+        ESP_LOGE(TAG, "Failed to connect to websocket server within %d ms", SERVER_RECONNECT_TIMEOUT_MS);
+        SetError(Lang::Strings::SERVER_NOT_CONNECTED);
+        return false;
+    }
+    websocket = std::move(*pending);
+    ESP_LOGI(TAG, "Resuming session %s on the new network", session_id_.c_str());
+    if (!Handshake(websocket.get(), url, session_id_, SERVER_RESUME_TIMEOUT_MS)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(websocket_mutex_);
+        std::swap(websocket_, websocket);
+    }
+    // The old connection is closed outside the lock, its disconnect no longer matches websocket_
+    websocket.reset();
+    return true;
+}
+
+std::unique_ptr<WebSocket> WebsocketProtocol::CreateWebSocket(std::string& url) {
     Settings settings("websocket", false);
-    std::string url = settings.GetString("url");
+    url = settings.GetString("url");
     std::string token = settings.GetString("token");
     int version = settings.GetInt("version");
     if (version != 0) {
         version_ = version;
     }
 
-    error_occurred_ = false;
-
     auto network = Board::GetInstance().GetNetwork();
-    websocket_ = network->CreateWebSocket(1);
-    if (websocket_ == nullptr) {
+    auto websocket = network->CreateWebSocket(1);
+    if (websocket == nullptr) {
         ESP_LOGE(TAG, "Failed to create websocket");
-        return false;
+        return nullptr;
     }
 
     if (!token.empty()) {
@@ -102,13 +180,13 @@ bool WebsocketProtocol::OpenAudioChannel() {
         if (token.find(" ") == std::string::npos) {
             token = "Bearer " + token;
         }
-        websocket_->SetHeader("Authorization", token.c_str());
+        websocket->SetHeader("Authorization", token.c_str());
     }
-    websocket_->SetHeader("Protocol-Version", std::to_string(version_).c_str());
-    websocket_->SetHeader("Device-Id", SystemInfo::GetMacAddress().c_str());
-    websocket_->SetHeader("Client-Id", Board::GetInstance().GetUuid().c_str());
+    websocket->SetHeader("Protocol-Version", std::to_string(version_).c_str());
+    websocket->SetHeader("Device-Id", SystemInfo::GetMacAddress().c_str());
+    websocket->SetHeader("Client-Id", Board::GetInstance().GetUuid().c_str());
 
-    websocket_->OnData([this](const char* data, size_t len, bool binary) {
+    websocket->OnData([this](const char* data, size_t len, bool binary) {
         if (binary) {
             if (on_incoming_audio_ != nullptr) {
                 if (version_ == 2) {
@@ -164,46 +242,61 @@ bool WebsocketProtocol::OpenAudioChannel() {
         last_incoming_time_ = std::chrono::steady_clock::now();
     });
 
-    websocket_->OnDisconnected([this]() {
+    websocket->OnDisconnected([this, closed = websocket.get()]() {
+        {
+            std::lock_guard<std::mutex> lock(websocket_mutex_);
+            if (closed != websocket_.get()) {
+                return;
+            }
+        }
         ESP_LOGI(TAG, "Websocket disconnected");
         if (on_audio_channel_closed_ != nullptr) {
             on_audio_channel_closed_();
         }
     });
 
-    ESP_LOGI(TAG, "Connecting to websocket server: %s with version: %d", url.c_str(), version_);
-    if (!websocket_->Connect(url.c_str())) {
-        ESP_LOGE(TAG, "Failed to connect to websocket server, code=%d", websocket_->GetLastError());
-        SetError(Lang::Strings::SERVER_NOT_CONNECTED);
-        return false;
+    return websocket;
+}
+
+bool WebsocketProtocol::Handshake(WebSocket* websocket, const std::string& url, const std::string& session_id, int hello_timeout_ms) {
+    // A migration connects beforehand with a bound of its own
+    if (!websocket->IsConnected()) {
+        ESP_LOGI(TAG, "Connecting to websocket server: %s with version: %d", url.c_str(), version_);
+        if (!websocket->Connect(url.c_str())) {
+            ESP_LOGE(TAG, "Failed to connect to websocket server, code=%d", websocket->GetLastError());
+            SetError(Lang::Strings::SERVER_NOT_CONNECTED);
+            return false;
+        }
     }
 
     // Send hello message to describe the client
-    auto message = GetHelloMessage();
-    if (!SendText(message)) {
+    xEventGroupClearBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT);
+    auto message = GetHelloMessage(session_id);
+    if (!websocket->Send(message)) {
+        ESP_LOGE(TAG, "Failed to send text: %s", message.c_str());
+        SetError(Lang::Strings::SERVER_ERROR);
         return false;
     }
 
     // Wait for server hello
-    EventBits_t bits = xEventGroupWaitBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(10000));
+    EventBits_t bits = xEventGroupWaitBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(hello_timeout_ms));
     if (!(bits & WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT)) {
         ESP_LOGE(TAG, "Failed to receive server hello");
         SetError(Lang::Strings::SERVER_TIMEOUT);
         return false;
     }
-
-    if (on_audio_channel_opened_ != nullptr) {
-        on_audio_channel_opened_();
-    }
-
     return true;
 }
 
-std::string WebsocketProtocol::GetHelloMessage() {
+std::string WebsocketProtocol::GetHelloMessage(const std::string& session_id) {
     // keys: message type, version, audio_params (format, sample_rate, channels)
     cJSON* root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "type", "hello");
     cJSON_AddNumberToObject(root, "version", version_);
+    if (!session_id.empty()) {
+        // Ask the server to resume this session after a network handover
+        cJSON_AddStringToObject(root, "session_id", session_id.c_str());
+    }
     cJSON* features = cJSON_CreateObject();
 #if CONFIG_USE_SERVER_AEC
     cJSON_AddBoolToObject(features, "aec", true);
@@ -8,6 +8,8 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
 
+#include <mutex>
+
 #define WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT (1 << 0)
 
 class WebsocketProtocol : public Protocol {
@@ -20,15 +22,21 @@ public:
     bool OpenAudioChannel() override;
     void CloseAudioChannel() override;
     bool IsAudioChannelOpened() const override;
+    bool MigrateAudioChannel() override;
 
 private:
     EventGroupHandle_t event_group_handle_;
+    // Guards websocket_, declared first so it outlives the connection's disconnect callback
+    mutable std::mutex websocket_mutex_;
+    // Only this connection's disconnect closes the channel, older ones are retired or failed attempts
     std::unique_ptr<WebSocket> websocket_;
     int version_ = 1;
 
+    std::unique_ptr<WebSocket> CreateWebSocket(std::string& url);
+    bool Handshake(WebSocket* websocket, const std::string& url, const std::string& session_id, int hello_timeout_ms);
     void ParseServerHello(const cJSON* root);
     bool SendText(const std::string& text) override;
-    std::string GetHelloMessage();
+    std::string GetHelloMessage(const std::string& session_id);
 };
 
 #endif
@@ -0,0 +1,151 @@
+#include "runtime_metrics.h"
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <cJSON.h>
+
+#include <algorithm>
+#include <cstring>
+
+#define TAG "RuntimeMetrics"
+
+std::atomic<uint32_t> RuntimeMetrics::alloc_failures_{0};
+std::atomic<uint32_t> RuntimeMetrics::last_failed_size_{0};
+std::atomic<uint32_t> RuntimeMetrics::last_failed_caps_{0};
+
+void RuntimeMetrics::OnAllocFailed(size_t size, uint32_t caps, const char* function_name) {
+    // May run in any context, only touch atomics here
+    alloc_failures_.fetch_add(1, std::memory_order_relaxed);
+    last_failed_size_.store(size, std::memory_order_relaxed);
+    last_failed_caps_.store(caps, std::memory_order_relaxed);
+}
+
+void RuntimeMetrics::Initialize() {
+    heap_caps_register_failed_alloc_callback(OnAllocFailed);
+    Sample();
+}
+
+void RuntimeMetrics::Sample() {
+#if CONFIG_RUNTIME_METRICS_TASK_STATS
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;
+    auto status = static_cast<TaskStatus_t*>(malloc(sizeof(TaskStatus_t) * capacity));
+    if (status == nullptr) {
+        return;
+    }
+    configRUN_TIME_COUNTER_TYPE total_run_time = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, capacity, &total_run_time);
+    int64_t now_us = esp_timer_get_time();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t total_delta = static_cast<uint32_t>(total_run_time) - last_total_run_time_;
+    bool has_window = last_sample_us_ != 0 && total_delta != 0;
+
+    std::vector<TaskMetrics> tasks;
+    tasks.reserve(count);
+    for (UBaseType_t i = 0; i < count; i++) {
+        const auto& s = status[i];
+        TaskMetrics task = {};
+        task.handle = s.xHandle;
+        strncpy(task.name, s.pcTaskName, sizeof(task.name) - 1);
+        task.run_time = static_cast<uint32_t>(s.ulRunTimeCounter);
+        task.cpu_permille = -1;
+        task.stack_free_min = s.usStackHighWaterMark;
+        task.priority = s.uxCurrentPriority;
+
+        if (has_window) {
+            auto previous = std::find_if(tasks_.begin(), tasks_.end(), [&s](const TaskMetrics& t) {
+                return t.handle == s.xHandle;
+            });
+            // Tasks created during the window are measured from their start
+            uint32_t task_delta = previous != tasks_.end() ? task.run_time - previous->run_time : task.run_time;
+            task.cpu_permille = static_cast<int>(static_cast<uint64_t>(task_delta) * 1000 /
+                                                 (static_cast<uint64_t>(total_delta) * CONFIG_FREERTOS_NUMBER_OF_CORES));
+        }
+        tasks.push_back(task);
+    }
+    free(status);
+
+    tasks_ = std::move(tasks);
+    last_total_run_time_ = static_cast<uint32_t>(total_run_time);
+    window_us_ = last_sample_us_ != 0 ? now_us - last_sample_us_ : 0;
+    last_sample_us_ = now_us;
+#endif
+}
+
+static cJSON* HeapToJson(uint32_t caps) {
+    size_t total = heap_caps_get_total_size(caps);
+    if (total == 0) {
+        return nullptr;
+    }
+    size_t free_size = heap_caps_get_free_size(caps);
+    size_t largest = heap_caps_get_largest_free_block(caps);
+    cJSON* heap = cJSON_CreateObject();
+    cJSON_AddNumberToObject(heap, "total", total);
+    cJSON_AddNumberToObject(heap, "free", free_size);
+    cJSON_AddNumberToObject(heap, "min_free", heap_caps_get_minimum_free_size(caps));
+    cJSON_AddNumberToObject(heap, "largest", largest);
+    // Share of the free memory that is not usable as one block, in percent
+    cJSON_AddNumberToObject(heap, "frag", free_size > 0 ? 100 - static_cast<int>(largest * 100 / free_size) : 0);
+    return heap;
+}
+
+std::string RuntimeMetrics::GetJson() {
+    bool sampled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sampled = last_sample_us_ != 0;
+    }
+    if (!sampled) {
+        Sample();
+    }
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "uptime_ms", esp_timer_get_time() / 1000);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cJSON_AddNumberToObject(root, "window_ms", window_us_ / 1000);
+        // Busiest tasks first
+        std::vector<const TaskMetrics*> sorted;
+        for (const auto& task : tasks_) {
+            sorted.push_back(&task);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const TaskMetrics* a, const TaskMetrics* b) {
+            return a->cpu_permille > b->cpu_permille;
+        });
+        cJSON* tasks = cJSON_CreateArray();
+        for (auto task : sorted) {
+            cJSON* item = cJSON_CreateObject();
+            cJSON_AddStringToObject(item, "name", task->name);
+            if (task->cpu_permille >= 0) {
+                cJSON_AddNumberToObject(item, "cpu", task->cpu_permille / 10.0);
+            }
+            cJSON_AddNumberToObject(item, "stack_free", task->stack_free_min);
+            cJSON_AddNumberToObject(item, "prio", task->priority);
+            cJSON_AddItemToArray(tasks, item);
+        }
+        cJSON_AddItemToObject(root, "tasks", tasks);
+    }
+
+    cJSON* heap = cJSON_CreateObject();
+    if (auto internal = HeapToJson(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)) {
+        cJSON_AddItemToObject(heap, "internal", internal);
+    }
+    if (auto psram = HeapToJson(MALLOC_CAP_SPIRAM)) {
+        cJSON_AddItemToObject(heap, "psram", psram);
+    }
+    cJSON_AddItemToObject(root, "heap", heap);
+
+    cJSON* failures = cJSON_CreateObject();
+    cJSON_AddNumberToObject(failures, "count", alloc_failures_.load(std::memory_order_relaxed));
+    cJSON_AddNumberToObject(failures, "last_size", last_failed_size_.load(std::memory_order_relaxed));
+    cJSON_AddNumberToObject(failures, "last_caps", last_failed_caps_.load(std::memory_order_relaxed));
+    cJSON_AddItemToObject(root, "alloc_failures", failures);
+
+    auto str = cJSON_PrintUnformatted(root);
+    std::string json(str);
+    cJSON_free(str);
+    cJSON_Delete(root);
+    return json;
+}
@@ -0,0 +1,64 @@
+#ifndef RUNTIME_METRICS_H
+#define RUNTIME_METRICS_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * 运行时指标
+ *
+ * - 每个任务在最近一个采样窗口内的 CPU 占用 (需要 RUNTIME_METRICS_TASK_STATS)
+ * - 每个任务的栈剩余最小值 (high-water mark)，用于按板型裁剪任务栈 (同上)
+ * - 内部 SRAM / PSRAM 的空闲、历史最小、最大连续块和碎片率
+ * - 内存分配失败次数
+ *
+ * Sample() 由主循环定期调用，GetJson() 返回紧凑的 JSON，供 MCP 工具、会话期间的定期上报和会话结束上报使用。
+ */
+class RuntimeMetrics {
+public:
+    static RuntimeMetrics& GetInstance() {
+        static RuntimeMetrics instance;
+        return instance;
+    }
+    RuntimeMetrics(const RuntimeMetrics&) = delete;
+    RuntimeMetrics& operator=(const RuntimeMetrics&) = delete;
+
+    // Register the allocation failure hook, call once at startup
+    void Initialize();
+
+    // Close the current CPU window and start a new one
+    void Sample();
+
+    std::string GetJson();
+
+private:
+    RuntimeMetrics() = default;
+
+    struct TaskMetrics {
+        TaskHandle_t handle;
+        char name[configMAX_TASK_NAME_LEN];
+        uint32_t run_time;          // Run time counter at the last sample
+        int cpu_permille;           // CPU usage in the last window, -1 before the second sample
+        uint32_t stack_free_min;    // Bytes
+        UBaseType_t priority;
+    };
+
+    std::mutex mutex_;
+    std::vector<TaskMetrics> tasks_;
+    uint32_t last_total_run_time_ = 0;
+    int64_t last_sample_us_ = 0;
+    int64_t window_us_ = 0;
+
+    static std::atomic<uint32_t> alloc_failures_;
+    static std::atomic<uint32_t> last_failed_size_;
+    static std::atomic<uint32_t> last_failed_caps_;
+    static void OnAllocFailed(size_t size, uint32_t caps, const char* function_name);
+};
+
+#endif // RUNTIME_METRICS_H
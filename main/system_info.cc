@@ -1,4 +1,5 @@
 #include "system_info.h"
+#include "main_task_queue.h"
 
 #include <freertos/task.h>
 #include <esp_log.h>
@@ -8,6 +9,7 @@
 #include <esp_partition.h>
 #include <esp_app_desc.h>
 #include <esp_ota_ops.h>
+#include <algorithm>
 #if CONFIG_IDF_TARGET_ESP32P4
 #include "esp_wifi_remote.h"
 #endif
@@ -152,3 +154,16 @@ void SystemInfo::PrintHeapStats() {
     min_free_sram = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
     ESP_LOGI(TAG, "external free sram: %u minimal sram: %u", free_sram, min_free_sram);
 }
+
+void SystemInfo::PrintMainTaskStats(const MainTaskQueue& queue) {
+    auto stats = queue.GetStats();
+    std::sort(stats.begin(), stats.end(), [](const MainTaskStats& a, const MainTaskStats& b) {
+        return a.total_run_us > b.total_run_us;
+    });
+    ESP_LOGI(TAG, "main tasks: %u pending", queue.size());
+    for (const auto& item : stats) {
+        ESP_LOGI(TAG, "  %-24s runs=%lu total=%lldms max=%lldus wait_max=%lldus coalesced=%lu late=%lu heap=%lu",
+            item.name, item.runs, item.total_run_us / 1000, item.max_run_us, item.max_wait_us,
+            item.coalesced, item.deadline_misses, item.heap_tasks);
+    }
+}
@@ -6,6 +6,8 @@
 #include <esp_err.h>
 #include <freertos/FreeRTOS.h>
 
+class MainTaskQueue;
+
 class SystemInfo {
 public:
     static size_t GetFlashSize();
@@ -17,6 +19,7 @@ public:
     static esp_err_t PrintTaskCpuUsage(TickType_t xTicksToWait);
     static void PrintTaskList();
     static void PrintHeapStats();
+    static void PrintMainTaskStats(const MainTaskQueue& queue);
 };
 
 #endif // _SYSTEM_INFO_H_
@@ -1,54 +1,233 @@
 import socket
+import struct
 import wave
 import argparse
+import time
+from array import array
 
 
 '''
-  Create a UDP socket and bind it to the server's IP:8000.
-  Listen for incoming messages and print them to the console.
-  Save the audio to a WAV file.
+  Create a UDP socket and bind it to the server's IP:PORT.
+  Receive audio debug packets from the device (CONFIG_USE_AUDIO_DEBUGGER), detect packet loss
+  by sequence number, and save each tap to its own WAV file. On exit, all taps are aligned by
+  timestamp and saved to one multi-channel WAV file for AEC tuning.
+
+  Packet format (little-endian), see main/audio/processors/audio_debugger.h:
+    char magic[2] = "AD", u8 version, u8 tap, u8 encoding, u8 channels, u16 samples,
+    u32 sequence, u32 sample_rate, u64 sample_index, u64 timestamp_us
+    [IMA ADPCM] per channel: i16 predictor, u8 step_index, u8 reserved
+    payload
+  Packets without the magic are treated as raw PCM from older firmware.
 '''
-def main(samplerate, channels):
+
+HEADER = struct.Struct('<2sBBBBHIIQQ')
+TAP_NAMES = {0: 'mic', 1: 'reference', 2: 'processed', 3: 'playback'}
+ENCODING_PCM16 = 0
+ENCODING_IMA_ADPCM = 1
+
+IMA_STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+]
+IMA_INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def decode_ima_adpcm(payload, channels, samples):
+    state = []
+    for ch in range(channels):
+        predictor, index, _ = struct.unpack_from('<hBB', payload, ch * 4)
+        state.append([predictor, index])
+    codes = payload[channels * 4:]
+    out = array('h')
+    for i in range(samples * channels):
+        byte = codes[i // 2]
+        code = (byte >> 4) if (i & 1) else (byte & 0x0F)
+        s = state[i % channels]
+        step = IMA_STEP_TABLE[s[1]]
+        vpdiff = step >> 3
+        if code & 4:
+            vpdiff += step
+        if code & 2:
+            vpdiff += step >> 1
+        if code & 1:
+            vpdiff += step >> 2
+        s[0] = s[0] - vpdiff if code & 8 else s[0] + vpdiff
+        s[0] = max(-32768, min(32767, s[0]))
+        s[1] = max(0, min(88, s[1] + IMA_INDEX_TABLE[code & 7]))
+        out.append(s[0])
+    return out
+
+
+class TapRecorder:
+    def __init__(self, name, channels, sample_rate, prefix):
+        self.name = name
+        self.channels = channels
+        self.sample_rate = sample_rate
+        self.filename = f"{prefix}_{name}_{sample_rate}_{channels}.wav"
+        self.wav = wave.open(self.filename, 'wb')
+        self.wav.setnchannels(channels)
+        self.wav.setsampwidth(2)
+        self.wav.setframerate(sample_rate)
+        self.samples = array('h')
+        self.first_timestamp_us = None
+        self.next_sequence = None
+        self.next_index = None
+        self.received = 0
+        self.lost = 0
+        self.late = 0
+
+    def add(self, sequence, sample_index, timestamp_us, pcm):
+        if self.next_sequence is None:
+            self.first_timestamp_us = timestamp_us
+            self.next_sequence = sequence
+            self.next_index = sample_index
+        if sequence < self.next_sequence:
+            self.late += 1
+            return
+        self.lost += sequence - self.next_sequence
+        self.received += 1
+        self.next_sequence = sequence + 1
+
+        # 丢失的数据用静音填充，保持时间轴对齐
+        if sample_index > self.next_index:
+            self.write(array('h', bytes(2 * (sample_index - self.next_index) * self.channels)))
+        self.write(pcm)
+        self.next_index = sample_index + len(pcm) // self.channels
+
+    def write(self, pcm):
+        self.samples.extend(pcm)
+        self.wav.writeframes(pcm.tobytes())
+
+    def close(self):
+        self.wav.close()
+
+    def report(self):
+        total = self.received + self.lost
+        loss = 100.0 * self.lost / total if total else 0.0
+        return f"{self.name}: {self.received} packets, {self.lost} lost ({loss:.2f}%), {self.late} late"
+
+
+def resample_linear(samples, channels, src_rate, dst_rate):
+    if src_rate == dst_rate:
+        return samples
+    frames = len(samples) // channels
+    out_frames = frames * dst_rate // src_rate
+    out = array('h')
+    for i in range(out_frames):
+        pos = i * src_rate / dst_rate
+        j = int(pos)
+        frac = pos - j
+        k = min(j + 1, frames - 1)
+        for ch in range(channels):
+            a = samples[j * channels + ch]
+            b = samples[k * channels + ch]
+            out.append(int(a + (b - a) * frac))
+    return out
+
+
+def save_aligned(recorders, filename):
+    '''Align all taps by their first timestamp and save one channel per tap channel'''
+    recorders = [r for r in recorders if r.first_timestamp_us is not None]
+    if not recorders:
+        return
+    rate = max(set(r.sample_rate for r in recorders), key=lambda rt: sum(r.sample_rate == rt for r in recorders))
+    start = min(r.first_timestamp_us for r in recorders)
+    tracks = []
+    for r in recorders:
+        samples = resample_linear(r.samples, r.channels, r.sample_rate, rate)
+        offset = round((r.first_timestamp_us - start) * rate / 1000000)
+        for ch in range(r.channels):
+            tracks.append((offset, samples[ch::r.channels], f"{r.name}[{ch}]"))
+    length = max(offset + len(track) for offset, track, _ in tracks)
+
+    out = array('h', bytes(2 * length * len(tracks)))
+    for t, (offset, track, _) in enumerate(tracks):
+        for i, sample in enumerate(track):
+            out[(offset + i) * len(tracks) + t] = sample
+    with wave.open(filename, 'wb') as wav:
+        wav.setnchannels(len(tracks))
+        wav.setsampwidth(2)
+        wav.setframerate(rate)
+        wav.writeframes(out.tobytes())
+    print(f"Aligned WAV '{filename}' saved, {rate}Hz, channels: {', '.join(name for _, _, name in tracks)}")
+
+
+def main(port, samplerate, channels, prefix):
     # Create a UDP socket
     server_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-    server_socket.bind(('0.0.0.0', 8000))
+    server_socket.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4 * 1024 * 1024)
+    server_socket.bind(('0.0.0.0', port))
+    server_socket.settimeout(1.0)
 
-    # Create WAV file with parameters
-    filename = f"{samplerate}_{channels}.wav"
-    wav_file = wave.open(filename, "wb")
-    wav_file.setnchannels(channels)     # channels parameter
-    wav_file.setsampwidth(2)            # 2 bytes per sample (16-bit)
-    wav_file.setframerate(samplerate)   # samplerate parameter
-
-    print(f"Start saving audio from 0.0.0.0:8000 to {filename}...")
+    recorders = {}
+    legacy_wav = None
+    last_report = time.time()
+    print(f"Start receiving audio debug data on 0.0.0.0:{port}...")
 
     try:
         while True:
-            # Receive a message from the client
-            message, address = server_socket.recvfrom(8000)
-            
-            # Write PCM data to WAV file
-            wav_file.writeframes(message)
-
-            # Print length of the message
-            print(f"Received {len(message)} bytes from {address}")
-    
+            try:
+                message, address = server_socket.recvfrom(2048)
+            except socket.timeout:
+                message = None
+
+            if message and len(message) >= HEADER.size and message[:2] == b'AD':
+                (_, version, tap, encoding, ch, samples, sequence, rate,
+                 sample_index, timestamp_us) = HEADER.unpack_from(message)
+                payload = message[HEADER.size:]
+                if encoding == ENCODING_IMA_ADPCM:
+                    pcm = decode_ima_adpcm(payload, ch, samples)
+                else:
+                    pcm = array('h', payload[:samples * ch * 2])
+                recorder = recorders.get(tap)
+                if recorder is None:
+                    recorder = TapRecorder(TAP_NAMES.get(tap, f"tap{tap}"), ch, rate, prefix)
+                    recorders[tap] = recorder
+                    print(f"New tap '{recorder.name}' from {address}: {rate}Hz, {ch} channel(s) -> {recorder.filename}")
+                recorder.add(sequence, sample_index, timestamp_us, pcm)
+            elif message:
+                # Raw PCM from firmware without framing
+                if legacy_wav is None:
+                    filename = f"{samplerate}_{channels}.wav"
+                    legacy_wav = wave.open(filename, 'wb')
+                    legacy_wav.setnchannels(channels)
+                    legacy_wav.setsampwidth(2)
+                    legacy_wav.setframerate(samplerate)
+                    print(f"Received raw PCM from {address}, saving to {filename}")
+                legacy_wav.writeframes(message)
+
+            if time.time() - last_report >= 5 and recorders:
+                last_report = time.time()
+                print(" | ".join(r.report() for r in recorders.values()))
+
     except KeyboardInterrupt:
         print("\nStopping recording...")
-    
+
     finally:
         # Close files and socket
-        wav_file.close()
         server_socket.close()
-        print(f"WAV file '{filename}' saved successfully")
+        if legacy_wav is not None:
+            legacy_wav.close()
+        for recorder in recorders.values():
+            recorder.close()
+            print(f"WAV file '{recorder.filename}' saved, {recorder.report()}")
+        save_aligned(list(recorders.values()), f"{prefix}_aligned.wav")
 
 
 if __name__ == "__main__":
-    parser = argparse.ArgumentParser(description='UDP音频数据接收器，保存为WAV文件')
+    parser = argparse.ArgumentParser(description='UDP音频调试数据接收器，按采集点保存为WAV文件并统计丢包')
+    parser.add_argument('--port', '-p', type=int, default=8000,
+                        help='UDP 端口 (默认: 8000)')
     parser.add_argument('--samplerate', '-s', type=int, default=16000, 
-                        help='采样率 (默认: 16000)')
+                        help='旧版固件原始数据的采样率 (默认: 16000)')
     parser.add_argument('--channels', '-c', type=int, default=2, 
-                        help='声道数 (默认: 2)')
-    
+                        help='旧版固件原始数据的声道数 (默认: 2)')
+    parser.add_argument('--prefix', '-o', type=str, default=time.strftime('audio_%Y%m%d_%H%M%S'),
+                        help='输出文件名前缀')
+
     args = parser.parse_args()
-    main(args.samplerate, args.channels)
+    main(args.port, args.samplerate, args.channels, args.prefix)
@@ -0,0 +1,113 @@
+#! /usr/bin/env python3
+import argparse
+import json
+import re
+import shutil
+import subprocess
+import sys
+
+
+'''
+  Symbolize a heap profile dump (CONFIG_USE_HEAP_PROFILER) against the firmware ELF.
+
+  The dump is the JSON returned by the MCP tool self.system.get_heap_profile, either the bare
+  object or the whole JSON-RPC response. Each site carries up to 8 return addresses; frames inside
+  the allocator (heap_caps, malloc, operator new, std::allocator ...) are skipped and the first
+  application frame is reported as the call site.
+
+  Usage:
+    python scripts/heap_profile.py build/xiaozhi.elf dump.json
+    python scripts/heap_profile.py build/xiaozhi.elf dump.json --chain 4
+'''
+
+ALLOCATOR_FRAMES = re.compile(
+    r'^(heap_caps_|multi_heap_|tlsf_|esp_heap_trace_|HeapProfiler::|CaptureStack|'
+    r'malloc|calloc|realloc|free|_malloc_r|_calloc_r|_realloc_r|__wrap_|strdup|_strdup_r|'
+    r'operator new|std::__new_allocator|__gnu_cxx::new_allocator|std::allocator|'
+    r'std::allocator_traits|std::_Vector_base|std::__cxx11::basic_string<.*>::_M_create)'
+)
+
+ADDR2LINE_CANDIDATES = [
+    'xtensa-esp32s3-elf-addr2line',
+    'xtensa-esp32-elf-addr2line',
+    'xtensa-esp-elf-addr2line',
+    'riscv32-esp-elf-addr2line',
+]
+
+
+def find_addr2line(explicit):
+    if explicit:
+        return explicit
+    for name in ADDR2LINE_CANDIDATES:
+        path = shutil.which(name)
+        if path:
+            return path
+    sys.exit('addr2line not found, run export.sh from ESP-IDF or pass --addr2line')
+
+
+def load_dump(path):
+    with open(path, 'r', encoding='utf-8') if path != '-' else sys.stdin as f:
+        data = json.load(f)
+    # Unwrap a JSON-RPC tools/call response
+    if 'result' in data:
+        data = data['result']
+    if 'content' in data:
+        data = json.loads(data['content'][0]['text'])
+    return data
+
+
+def symbolize(addr2line, elf, addresses):
+    if not addresses:
+        return {}
+    output = subprocess.run([addr2line, '-a', '-f', '-C', '-e', elf] + addresses,
+                            capture_output=True, text=True, check=True).stdout.splitlines()
+    # addr2line prints address, function, file:line for each input
+    symbols = {}
+    for i in range(0, len(output) - 2, 3):
+        address = int(output[i], 16)
+        location = output[i + 2]
+        location = re.sub(r'^.*/(main|components|managed_components)/', r'\1/', location)
+        symbols[address] = (output[i + 1], location)
+    return symbols
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Symbolize a heap profile dump')
+    parser.add_argument('elf', help='Firmware ELF, e.g. build/xiaozhi.elf')
+    parser.add_argument('dump', help='JSON dump file, - for stdin')
+    parser.add_argument('--addr2line', help='addr2line binary of the target toolchain')
+    parser.add_argument('--chain', type=int, default=2, help='Application frames to print per site')
+    args = parser.parse_args()
+
+    dump = load_dump(args.dump)
+    if not dump.get('running'):
+        sys.exit('Heap profiler is not running on the device')
+
+    sites = dump.get('sites', [])
+    addresses = sorted({pc for site in sites for pc in site['pcs'].split()})
+    symbols = symbolize(find_addr2line(args.addr2line), args.elf, addresses)
+
+    print(f"live {dump['live_bytes'] / 1024:.1f} KB in {dump['tracked']} tracked allocations, "
+          f"{dump['sites_used']} sites, sampling 1/{dump['sample_rate']} below {dump['always_sample_bytes']} bytes, "
+          f"{dump['dropped']} dropped")
+    overhead = dump.get('overhead')
+    if overhead:
+        print(f"hooks: {overhead['alloc_cycles']} cycles per sampled alloc, {overhead['free_cycles']} per free, "
+              f"max {overhead['max_cycles']}, {overhead['cpu_percent']:.2f}% of one core")
+    print(f"{'live KB':>9} {'peak KB':>9} {'blocks':>7} {'allocs':>8}  {'task':<16} site")
+    for site in sites:
+        frames = []
+        for pc in site['pcs'].split():
+            function, location = symbols.get(int(pc, 16), ('??', '??:0'))
+            if frames or not ALLOCATOR_FRAMES.match(function):
+                frames.append(f'{function} ({location})')
+        if not frames:
+            frames = ['(no backtrace)']
+        print(f"{site['live_bytes'] / 1024:>9.1f} {site['peak_bytes'] / 1024:>9.1f} {site['live_count']:>7} "
+              f"{site['allocs']:>8}  {site['task']:<16} {frames[0]}")
+        for frame in frames[1:args.chain]:
+            print(f"{'':>56}<- {frame}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,1189 @@
+#! /usr/bin/env python3
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import os
+import random
+import struct
+import time
+import uuid
+
+
+'''
+  Local stand-in for the xiaozhi server, for load tests, benchmarks and fault injection.
+  Only the Python standard library is required; `cryptography` is used for AES-CTR if installed.
+
+  Implements the server side of docs/websocket.md and docs/mqtt-udp.md:
+    - HTTP OTA check (POST /xiaozhi/ota/), which writes the "websocket" or "mqtt" settings on the device
+    - WebSocket transport, binary protocol version 1, 2 and 3
+    - MQTT 3.1.1 (minimal built-in broker, no TLS) + UDP audio with AES-CTR
+    - hello negotiation, stt / llm / tts / mcp messages, goodbye
+    - TTS audio streamed in real time from Ogg Opus (.ogg) or .p3 files
+  Uplink Opus frames can be saved as .p3 files (--record-dir), play them with scripts/p3_tools.
+
+  Point a device at it by setting the OTA URL to http://<host>:8000/xiaozhi/ota/ (menuconfig
+  OTA_URL or the "ota_url" key in the "wifi" settings namespace). The OTA response then stores
+  ws://<host>:8000/xiaozhi/v1/ in the "websocket" namespace, or with --ota-transport mqtt
+  <host>:1883 in the "mqtt" namespace. Port 1883 keeps the device MQTT client on plain TCP.
+
+  Each listen turn is answered from a script (--script), a JSON file like:
+    {
+      "audio_params": {"sample_rate": 24000, "frame_duration": 60},
+      "vad_ms": 1500,
+      "turns": [
+        {"stt": "你好", "emotion": "happy", "think_ms": 300,
+         "mcp_call": {"name": "self.get_device_status", "arguments": {}},
+         "sentences": [{"text": "你好呀", "audio": "main/assets/common/success.ogg"}]},
+        {"stt": "再见", "sentences": [{"text": "再见", "audio": "bye.p3"}], "close": true}
+      ]
+    }
+  Turns are used in order and wrap around. In manual mode a turn is answered on "listen stop",
+  in auto / realtime mode after vad_ms of uplink audio.
+
+  Faults apply to everything the server sends: --latency-ms, --jitter-ms, --bandwidth-kbps,
+  and for audio frames --loss and --reorder (reordering only on UDP). --uplink-loss drops
+  received audio frames before they are counted.
+
+  A timing report is printed when each session ends, --report appends it as a JSON line. Each turn
+  lists the uplink packet rate (one AT command per datagram on 4G modems) and the uplink delay of
+  each frame relative to the earliest one.
+
+  A device that offers UDP batching in its hello (CONFIG_MQTT_UDP_BATCH) gets the limits of
+  --udp-batch-bytes / --udp-batch-frames in the reply, and downlink frames sent in the same burst
+  are then packed into one datagram as well. --udp-batch-frames 1 declines the offer.
+
+  A hello carrying the session_id of a live session resumes it on the new connection (network
+  handover, CONFIG_NETWORK_FAILOVER). Messages and TTS audio are held until the new link is usable
+  and then continue from where they stopped; the report lists each migration with the uplink and
+  downlink audio gap. A dropped MQTT connection keeps its session for --resume-window-s.
+
+  Usage:
+    python scripts/stand_in_server.py
+    python scripts/stand_in_server.py --ota-transport mqtt --latency-ms 80 --jitter-ms 30 --loss 0.02
+'''
+
+try:
+    from cryptography.hazmat.primitives.ciphers import Cipher, algorithms, modes
+except ImportError:
+    Cipher = None
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+WEBSOCKET_GUID = '258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+
+DEFAULT_SCRIPT = {
+    'audio_params': {'sample_rate': 24000, 'frame_duration': 60},
+    'vad_ms': 1500,
+    'turns': [{
+        'stt': '(stand-in)',
+        'emotion': 'happy',
+        'think_ms': 200,
+        'sentences': [{'text': 'stand-in reply', 'audio': 'main/assets/common/success.ogg'}],
+    }],
+}
+
+
+# ---------------------------------------------------------------------------
+# AES-128 CTR, same counter handling as mbedtls_aes_crypt_ctr (128-bit big-endian counter)
+
+def _rotl8(x, shift):
+    return ((x << shift) | (x >> (8 - shift))) & 0xFF
+
+
+def _make_sbox():
+    sbox = [0] * 256
+    p = q = 1
+    while True:
+        p = (p ^ (p << 1) ^ (0x1B if p & 0x80 else 0)) & 0xFF
+        q ^= q << 1
+        q ^= q << 2
+        q ^= q << 4
+        q &= 0xFF
+        if q & 0x80:
+            q ^= 0x09
+        sbox[p] = q ^ _rotl8(q, 1) ^ _rotl8(q, 2) ^ _rotl8(q, 3) ^ _rotl8(q, 4) ^ 0x63
+        if p == 1:
+            break
+    sbox[0] = 0x63
+    return sbox
+
+
+SBOX = _make_sbox()
+
+
+def _xtime(a):
+    return ((a << 1) ^ 0x1B) & 0xFF if a & 0x80 else a << 1
+
+
+class Aes128:
+    def __init__(self, key):
+        words = [list(key[i:i + 4]) for i in range(0, 16, 4)]
+        rcon = 1
+        for i in range(4, 44):
+            t = list(words[i - 1])
+            if i % 4 == 0:
+                t = [SBOX[b] for b in t[1:] + t[:1]]
+                t[0] ^= rcon
+                rcon = _xtime(rcon)
+            words.append([a ^ b for a, b in zip(words[i - 4], t)])
+        self.round_keys = [sum(words[r * 4:r * 4 + 4], []) for r in range(11)]
+
+    def encrypt_block(self, block):
+        s = [a ^ b for a, b in zip(block, self.round_keys[0])]
+        for r in range(1, 11):
+            s = [SBOX[b] for b in s]
+            s = [s[((c + row) % 4) * 4 + row] for c in range(4) for row in range(4)]
+            if r != 10:
+                mixed = []
+                for c in range(4):
+                    a0, a1, a2, a3 = s[c * 4:c * 4 + 4]
+                    x = a0 ^ a1 ^ a2 ^ a3
+                    mixed += [a0 ^ x ^ _xtime(a0 ^ a1), a1 ^ x ^ _xtime(a1 ^ a2),
+                              a2 ^ x ^ _xtime(a2 ^ a3), a3 ^ x ^ _xtime(a3 ^ a0)]
+                s = mixed
+            s = [a ^ b for a, b in zip(s, self.round_keys[r])]
+        return bytes(s)
+
+
+class AesCtr:
+    def __init__(self, key):
+        self.key = key
+        self.aes = Aes128(key) if Cipher is None else None
+
+    def crypt(self, counter, data):
+        if Cipher is not None:
+            return Cipher(algorithms.AES(self.key), modes.CTR(counter)).encryptor().update(data)
+        out = bytearray()
+        value = int.from_bytes(counter, 'big')
+        for i in range(0, len(data), 16):
+            stream = self.aes.encrypt_block(value.to_bytes(16, 'big'))
+            value = (value + 1) & ((1 << 128) - 1)
+            out += bytes(a ^ b for a, b in zip(data[i:i + 16], stream))
+        return bytes(out)
+
+
+# ---------------------------------------------------------------------------
+# Opus sources
+
+def opus_packet_duration_ms(packet):
+    if not packet:
+        return 0
+    config = packet[0] >> 3
+    if config < 12:
+        frame_ms = (10, 20, 40, 60)[config % 4]
+    elif config < 16:
+        frame_ms = (10, 20)[config % 2]
+    else:
+        frame_ms = (2.5, 5, 10, 20)[config % 4]
+    code = packet[0] & 0x03
+    frames = 1 if code == 0 else 2 if code < 3 else (packet[1] & 0x3F if len(packet) > 1 else 0)
+    return frame_ms * frames
+
+
+def read_ogg_opus(data):
+    packets = []
+    partial = b''
+    pos = 0
+    while pos + 27 <= len(data):
+        if data[pos:pos + 4] != b'OggS':
+            raise ValueError('not an Ogg stream')
+        segments = data[pos + 26]
+        table = data[pos + 27:pos + 27 + segments]
+        pos += 27 + segments
+        for lacing in table:
+            partial += data[pos:pos + lacing]
+            pos += lacing
+            if lacing < 255:
+                packets.append(partial)
+                partial = b''
+    return [p for p in packets if not p.startswith((b'OpusHead', b'OpusTags'))]
+
+
+def read_p3(data):
+    packets = []
+    pos = 0
+    while pos + 4 <= len(data):
+        _, _, length = struct.unpack_from('>BBH', data, pos)
+        packets.append(data[pos + 4:pos + 4 + length])
+        pos += 4 + length
+    return packets
+
+
+_audio_cache = {}
+
+
+def load_audio(path):
+    if path not in _audio_cache:
+        full_path = path if os.path.isabs(path) else os.path.join(REPO_ROOT, path)
+        with open(full_path, 'rb') as f:
+            data = f.read()
+        packets = read_ogg_opus(data) if data.startswith(b'OggS') else read_p3(data)
+        _audio_cache[path] = [(p, opus_packet_duration_ms(p)) for p in packets]
+    return _audio_cache[path]
+
+
+# ---------------------------------------------------------------------------
+# Fault injection
+
+class FaultLink:
+    '''Delays, drops and reorders outgoing messages. ordered=True keeps TCP ordering.'''
+
+    def __init__(self, args, ordered):
+        self.latency = args.latency_ms / 1000
+        self.jitter = args.jitter_ms / 1000
+        self.loss = args.loss
+        self.reorder = args.reorder if not ordered else 0
+        self.bits_per_second = args.bandwidth_kbps * 1000
+        self.ordered = ordered
+        self.next_free = 0
+        self.last_due = 0
+        self.held = None
+        self.dropped = 0
+        self.reordered = 0
+
+    def send(self, size, callback, droppable=False):
+        '''Returns the delivery time on the loop clock, or None if the message was dropped.'''
+        loop = asyncio.get_running_loop()
+        if droppable and random.random() < self.loss:
+            self.dropped += 1
+            return None
+        now = loop.time()
+        due = now + max(0, self.latency + random.uniform(-self.jitter, self.jitter))
+        if self.bits_per_second > 0:
+            self.next_free = max(now, self.next_free) + size * 8 / self.bits_per_second
+            due = max(due, self.next_free)
+        if self.ordered:
+            due = max(due, self.last_due + 1e-6)
+            self.last_due = due
+        if droppable and self.held is None and random.random() < self.reorder:
+            self.held = callback
+            self.reordered += 1
+            return due
+        loop.call_at(due, callback)
+        if self.held is not None:
+            loop.call_at(due + 1e-4, self.held)
+            self.held = None
+        return due
+
+
+# ---------------------------------------------------------------------------
+# Conversation logic, shared by both transports
+
+class Turn:
+    def __init__(self, index, mode, now):
+        self.index = index
+        self.mode = mode
+        self.listen_start = now
+        self.first_uplink = None
+        self.last_uplink = None
+        self.uplink_frames = 0
+        self.uplink_bytes = 0
+        self.uplink_ms = 0
+        self.uplink_max_gap = 0
+        self.uplink_jitter = 0
+        self.uplink_lost = 0
+        self.uplink_packets = 0
+        self.uplink_offsets = []
+        self.trigger = None
+        self.first_audio_due = None
+        self.tts_stop = None
+        self.downlink_frames = 0
+        self.downlink_dropped = 0
+        self.mcp_ms = None
+        self.aborted = False
+
+    def delay_report(self):
+        '''Arrival time minus audio position of each frame, relative to the least delayed frame.'''
+        if not self.uplink_offsets:
+            return None
+        base = min(self.uplink_offsets)
+        delays = sorted((offset - base) * 1000 for offset in self.uplink_offsets)
+        return {'mean': round(sum(delays) / len(delays)), 'p95': round(delays[int(len(delays) * 0.95)]),
+                'max': round(delays[-1])}
+
+    def report(self, origin):
+        def ms(t):
+            return None if t is None else round((t - origin) * 1000)
+        return {
+            'turn': self.index,
+            'mode': self.mode,
+            'listen_start_ms': ms(self.listen_start),
+            'uplink_frames': self.uplink_frames,
+            'uplink_bytes': self.uplink_bytes,
+            'uplink_audio_ms': round(self.uplink_ms),
+            'uplink_max_gap_ms': round(self.uplink_max_gap * 1000),
+            'uplink_jitter_ms': round(self.uplink_jitter * 1000, 1),
+            'uplink_lost': self.uplink_lost,
+            'uplink_packets': self.uplink_packets,
+            'uplink_packet_rate': None if self.uplink_packets < 2 or self.last_uplink == self.first_uplink
+                else round(self.uplink_packets / (self.last_uplink - self.first_uplink), 1),
+            'uplink_delay_ms': self.delay_report(),
+            'trigger_ms': ms(self.trigger),
+            'response_latency_ms': None if self.trigger is None or self.first_audio_due is None
+                else round((self.first_audio_due - self.trigger) * 1000),
+            'mcp_call_ms': self.mcp_ms,
+            'downlink_frames': self.downlink_frames,
+            'downlink_dropped': self.downlink_dropped,
+            'tts_stop_ms': ms(self.tts_stop),
+            'aborted': self.aborted,
+        }
+
+
+class Conversation:
+    def __init__(self, server, transport):
+        self.server = server
+        self.args = server.args
+        self.script = server.script
+        self.transport = transport
+        self.session_id = str(uuid.uuid4())
+        self.loop = asyncio.get_running_loop()
+        self.opened = self.loop.time()
+        self.hello_at = None
+        self.device_hello = None
+        self.turns = []
+        self.turn = None
+        self.speaking = None
+        self.mcp_pending = {}
+        self.mcp_next_id = 1
+        self.mcp_tools = None
+        self.device_reports = []
+        self.aborts = 0
+        self.record_file = None
+        self.closed = False
+        # Migration state: messages are held while no usable transport is attached
+        self.held = None
+        self.detached_at = None
+        self.detach_timer = None
+        self.migrations = []
+        self.last_downlink_sent = None
+        transport.conversation = self
+
+    def now(self):
+        return self.loop.time()
+
+    def send_json(self, message):
+        if 'session_id' not in message and message.get('type') != 'hello':
+            message = {'session_id': self.session_id, **message}
+        if self.held is not None:
+            self.held.append(('json', message))
+            return
+        self.transport.send_json(message)
+
+    def send_audio(self, payload, timestamp):
+        if self.held is not None:
+            self.held.append(('audio', payload, timestamp))
+            return self.now()
+        due = self.transport.send_audio(payload, timestamp)
+        if due is not None:
+            self.on_downlink_sent(due)
+        return due
+
+    # Device -> server
+
+    def on_json(self, message):
+        handler = {
+            'hello': self.on_hello,
+            'listen': self.on_listen,
+            'abort': self.on_abort,
+            'mcp': self.on_mcp,
+            # The MQTT connection ends the conversation, replying with another goodbye would loop
+            'goodbye': lambda m: None,
+            'audio_metrics': self.on_device_report,
+            'runtime_metrics': self.on_device_report,
+        }.get(message.get('type'))
+        if handler is not None:
+            handler(message)
+        else:
+            self.log(f"unhandled message: {json.dumps(message, ensure_ascii=False)[:200]}")
+
+    def on_hello(self, message):
+        self.hello_at = self.now()
+        self.device_hello = message
+        self.server.sessions[self.session_id] = self
+        audio_params = {'format': 'opus', 'channels': 1, **self.script.get('audio_params', {})}
+        reply = {'type': 'hello', 'session_id': self.session_id, 'audio_params': audio_params}
+        self.transport.send_hello(reply)
+        self.log(f"hello, transport {message.get('transport')}, version {message.get('version')}, "
+                 f"features {message.get('features')}")
+        if self.args.mcp and message.get('features', {}).get('mcp'):
+            asyncio.ensure_future(self.discover_tools())
+
+    def on_listen(self, message):
+        state = message.get('state')
+        if state == 'start':
+            self.turn = Turn(len(self.turns), message.get('mode'), self.now())
+            self.turns.append(self.turn)
+            self.open_recording()
+        elif state == 'stop' and self.turn is not None and self.turn.trigger is None:
+            self.answer(self.turn)
+        elif state == 'detect':
+            self.log(f"wake word: {message.get('text')}")
+
+    def on_abort(self, message):
+        self.aborts += 1
+        if self.speaking is not None and not self.speaking.done():
+            self.speaking.cancel()
+            if self.turn is not None:
+                self.turn.aborted = True
+            self.send_json({'type': 'tts', 'state': 'stop'})
+
+    def on_mcp(self, message):
+        payload = message.get('payload', {})
+        future = self.mcp_pending.pop(payload.get('id'), None)
+        if future is not None and not future.done():
+            future.set_result(payload)
+
+    def on_device_report(self, message):
+        self.device_reports.append({'type': message['type'], 'at_ms': round((self.now() - self.opened) * 1000),
+                                    'metrics': message.get('metrics')})
+
+    def on_audio(self, payload):
+        if random.random() < self.args.uplink_loss:
+            return
+        now = self.now()
+        migration = self.migrations[-1] if self.migrations else None
+        if migration is not None and migration['uplink_gap_ms'] is None and migration['_last_uplink'] is not None:
+            migration['uplink_gap_ms'] = round((now - migration['_last_uplink']) * 1000)
+            self.log(f"migration gap: uplink {migration['uplink_gap_ms']} ms")
+        turn = self.turn
+        if turn is None:
+            return
+        duration = opus_packet_duration_ms(payload)
+        if turn.last_uplink is not None:
+            gap = now - turn.last_uplink
+            turn.uplink_max_gap = max(turn.uplink_max_gap, gap)
+            # RFC 3550 interarrival jitter against the nominal frame duration
+            turn.uplink_jitter += (abs(gap - duration / 1000) - turn.uplink_jitter) / 16
+        else:
+            turn.first_uplink = now
+        turn.last_uplink = now
+        turn.uplink_offsets.append(now - turn.uplink_ms / 1000)
+        turn.uplink_frames += 1
+        turn.uplink_bytes += len(payload)
+        turn.uplink_ms += duration
+        if self.record_file is not None:
+            self.record_file.write(struct.pack('>BBH', 0, 0, len(payload)) + payload)
+        if turn.mode != 'manual' and turn.trigger is None and turn.uplink_ms >= self.script.get('vad_ms', 1500):
+            self.answer(turn)
+
+    def on_uplink_packet(self):
+        if self.turn is not None:
+            self.turn.uplink_packets += 1
+
+    # Server -> device
+
+    def answer(self, turn):
+        turn.trigger = self.now()
+        turns = self.script['turns']
+        spec = turns[turn.index % len(turns)]
+        self.speaking = asyncio.ensure_future(self.speak(turn, spec))
+
+    async def speak(self, turn, spec):
+        if spec.get('stt') is not None:
+            self.send_json({'type': 'stt', 'text': spec['stt']})
+        if spec.get('emotion'):
+            self.send_json({'type': 'llm', 'emotion': spec['emotion'], 'text': ''})
+        if spec.get('mcp_call'):
+            started = self.now()
+            result = await self.call_mcp('tools/call', spec['mcp_call'])
+            turn.mcp_ms = round((self.now() - started) * 1000) if result is not None else None
+        await asyncio.sleep(spec.get('think_ms', 0) / 1000)
+
+        self.send_json({'type': 'tts', 'state': 'start'})
+        for sentence in spec.get('sentences', []):
+            self.send_json({'type': 'tts', 'state': 'sentence_start', 'text': sentence.get('text', '')})
+            if sentence.get('audio'):
+                await self.stream_audio(turn, load_audio(sentence['audio']))
+        self.send_json({'type': 'tts', 'state': 'stop'})
+        turn.tts_stop = self.now()
+
+        if spec.get('close'):
+            await asyncio.sleep(0.5)
+            self.transport.close()
+
+    async def stream_audio(self, turn, packets):
+        # Send ahead of real time by a few frames, like a streaming TTS server
+        lead = self.args.tts_lead_ms / 1000
+        start = self.now()
+        position_ms = 0
+        for payload, duration in packets:
+            delay = start + position_ms / 1000 - lead - self.now()
+            if delay > 0:
+                await asyncio.sleep(delay)
+            due = self.send_audio(payload, int(position_ms))
+            if due is None:
+                turn.downlink_dropped += 1
+            elif turn.first_audio_due is None:
+                turn.first_audio_due = due
+            turn.downlink_frames += 1
+            position_ms += duration
+
+    async def call_mcp(self, method, params):
+        request_id = self.mcp_next_id
+        self.mcp_next_id += 1
+        future = self.loop.create_future()
+        self.mcp_pending[request_id] = future
+        self.send_json({'type': 'mcp', 'payload': {'jsonrpc': '2.0', 'method': method, 'params': params, 'id': request_id}})
+        try:
+            return await asyncio.wait_for(future, 5)
+        except asyncio.TimeoutError:
+            self.mcp_pending.pop(request_id, None)
+            self.log(f'mcp {method} timed out')
+            return None
+
+    async def discover_tools(self):
+        await self.call_mcp('initialize', {'protocolVersion': '2024-11-05', 'capabilities': {}})
+        tools = []
+        cursor = ''
+        while True:
+            response = await self.call_mcp('tools/list', {'cursor': cursor} if cursor else {})
+            if response is None:
+                return
+            result = response.get('result', {})
+            tools += [tool['name'] for tool in result.get('tools', [])]
+            cursor = result.get('nextCursor', '')
+            if not cursor:
+                break
+        self.mcp_tools = tools
+        self.log(f'{len(tools)} mcp tools')
+
+    # Network handover
+
+    def detach(self):
+        '''The connection dropped without goodbye, keep the session for a resume.'''
+        if self.closed or self.detached_at is not None:
+            return
+        self.detached_at = self.now()
+        if self.held is None:
+            self.held = []
+        self.detach_timer = self.loop.call_later(self.args.resume_window_s, self.close)
+        self.log(f'connection lost, waiting {self.args.resume_window_s:g} s for a resume')
+
+    def resume(self, transport, message):
+        now = self.now()
+        self.transport.release()
+        self.transport = transport
+        transport.conversation = self
+        if self.detach_timer is not None:
+            self.detach_timer.cancel()
+            self.detach_timer = None
+        self.migrations.append({
+            'at_ms': round((now - self.opened) * 1000),
+            'detached_ms': None if self.detached_at is None else round((now - self.detached_at) * 1000),
+            'held_messages': 0,
+            'uplink_gap_ms': None,
+            'downlink_gap_ms': None,
+            '_last_uplink': self.turn.last_uplink if self.turn is not None else None,
+            '_last_downlink': self.last_downlink_sent,
+        })
+        self.detached_at = None
+        if self.held is None:
+            self.held = []
+        audio_params = {'format': 'opus', 'channels': 1, **self.script.get('audio_params', {})}
+        transport.send_hello({'type': 'hello', 'session_id': self.session_id, 'audio_params': audio_params})
+        self.log(f"resumed on a new {transport.name} connection, transport {message.get('transport')}")
+        self.flush_held()
+
+    def flush_held(self):
+        '''Sends what was held during the handover once the new transport can carry audio.'''
+        if self.held is None or self.detached_at is not None or not self.transport.audio_ready():
+            return
+        held, self.held = self.held, None
+        if self.migrations:
+            self.migrations[-1]['held_messages'] = len(held)
+        for item in held:
+            if item[0] == 'json':
+                self.transport.send_json(item[1])
+            else:
+                due = self.transport.send_audio(item[1], item[2])
+                if due is not None:
+                    self.on_downlink_sent(due)
+
+    def on_downlink_sent(self, due):
+        migration = self.migrations[-1] if self.migrations else None
+        if migration is not None and migration['downlink_gap_ms'] is None and migration['_last_downlink'] is not None:
+            migration['downlink_gap_ms'] = round((due - migration['_last_downlink']) * 1000)
+            self.log(f"migration gap: downlink {migration['downlink_gap_ms']} ms")
+        self.last_downlink_sent = due
+
+    # Session end
+
+    def open_recording(self):
+        if self.record_file is not None:
+            self.record_file.close()
+            self.record_file = None
+        if self.args.record_dir:
+            os.makedirs(self.args.record_dir, exist_ok=True)
+            path = os.path.join(self.args.record_dir, f'{self.session_id[:8]}_{self.turn.index}.p3')
+            self.record_file = open(path, 'wb')
+
+    def close(self):
+        if self.closed:
+            return
+        self.closed = True
+        if self.detach_timer is not None:
+            self.detach_timer.cancel()
+        self.transport.release()
+        self.server.sessions.pop(self.session_id, None)
+        if self.speaking is not None:
+            self.speaking.cancel()
+        if self.record_file is not None:
+            self.record_file.close()
+        report = {
+            'session_id': self.session_id,
+            'transport': self.transport.name,
+            'version': (self.device_hello or {}).get('version'),
+            'hello_ms': None if self.hello_at is None else round((self.hello_at - self.opened) * 1000),
+            'duration_ms': round((self.now() - self.opened) * 1000),
+            'aborts': self.aborts,
+            'mcp_tools': None if self.mcp_tools is None else len(self.mcp_tools),
+            'faults': self.transport.fault_stats(),
+            'turns': [turn.report(self.opened) for turn in self.turns],
+            'migrations': [{k: v for k, v in m.items() if not k.startswith('_')} for m in self.migrations],
+            'device_reports': self.device_reports,
+        }
+        self.server.report(report)
+
+    def log(self, text):
+        print(f"[{time.strftime('%H:%M:%S')}] {self.transport.name} {self.session_id[:8]} {text}")
+
+
+# ---------------------------------------------------------------------------
+# WebSocket transport
+
+class WebsocketTransport:
+    name = 'websocket'
+
+    def __init__(self, writer, version, args):
+        self.writer = writer
+        self.version = version
+        self.link = FaultLink(args, ordered=True)
+
+    def write_frame(self, opcode, payload):
+        if self.writer.is_closing():
+            return
+        length = len(payload)
+        if length < 126:
+            header = struct.pack('>BB', 0x80 | opcode, length)
+        elif length < 65536:
+            header = struct.pack('>BBH', 0x80 | opcode, 126, length)
+        else:
+            header = struct.pack('>BBQ', 0x80 | opcode, 127, length)
+        self.writer.write(header + payload)
+
+    def send_json(self, message):
+        data = json.dumps(message, ensure_ascii=False).encode()
+        self.link.send(len(data), lambda: self.write_frame(0x1, data))
+
+    def send_hello(self, reply):
+        self.send_json({**reply, 'transport': 'websocket'})
+
+    def send_audio(self, payload, timestamp):
+        if self.version == 2:
+            data = struct.pack('>HHIII', 2, 0, 0, timestamp, len(payload)) + payload
+        elif self.version == 3:
+            data = struct.pack('>BBH', 0, 0, len(payload)) + payload
+        else:
+            data = payload
+        return self.link.send(len(data), lambda: self.write_frame(0x2, data), droppable=True)
+
+    def unpack_audio(self, data):
+        if self.version == 2:
+            _, _, _, _, size = struct.unpack_from('>HHIII', data)
+            return data[16:16 + size]
+        if self.version == 3:
+            _, _, size = struct.unpack_from('>BBH', data)
+            return data[4:4 + size]
+        return data
+
+    def audio_ready(self):
+        return not self.writer.is_closing()
+
+    def close(self):
+        self.link.send(0, lambda: self.write_frame(0x8, struct.pack('>H', 1000)))
+        asyncio.get_running_loop().call_later(self.link.latency + 0.5, self.writer.close)
+
+    def release(self):
+        pass
+
+    def fault_stats(self):
+        return {'dropped': self.link.dropped}
+
+
+async def read_websocket_message(reader, transport):
+    message = b''
+    message_opcode = None
+    while True:
+        b1, b2 = await reader.readexactly(2)
+        opcode = b1 & 0x0F
+        length = b2 & 0x7F
+        if length == 126:
+            length = struct.unpack('>H', await reader.readexactly(2))[0]
+        elif length == 127:
+            length = struct.unpack('>Q', await reader.readexactly(8))[0]
+        mask = await reader.readexactly(4) if b2 & 0x80 else None
+        payload = await reader.readexactly(length)
+        if mask is not None and length > 0:
+            mask_stream = (mask * (length // 4 + 1))[:length]
+            payload = (int.from_bytes(payload, 'big') ^ int.from_bytes(mask_stream, 'big')).to_bytes(length, 'big')
+        if opcode == 0x8:
+            return None, None
+        if opcode == 0x9:
+            transport.write_frame(0xA, payload)
+            continue
+        if opcode == 0xA:
+            continue
+        if opcode != 0x0:
+            message_opcode = opcode
+        message += payload
+        if b1 & 0x80:
+            return message_opcode, message
+
+
+async def serve_websocket(server, reader, writer, headers):
+    key = headers.get('sec-websocket-key', '')
+    accept = base64.b64encode(hashlib.sha1((key + WEBSOCKET_GUID).encode()).digest()).decode()
+    writer.write(('HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                  f'Sec-WebSocket-Accept: {accept}\r\n\r\n').encode())
+    transport = WebsocketTransport(writer, int(headers.get('protocol-version', '1')), server.args)
+    conversation = Conversation(server, transport)
+    conversation.log(f"connected, device {headers.get('device-id')}, protocol version {transport.version}")
+    try:
+        while True:
+            opcode, message = await read_websocket_message(reader, transport)
+            if opcode is None:
+                break
+            if opcode == 0x1:
+                message = json.loads(message)
+                resumed = server.sessions.get(message.get('session_id')) if message.get('type') == 'hello' else None
+                if resumed is not None and resumed.transport.name == transport.name:
+                    conversation = resumed
+                    conversation.resume(transport, message)
+                else:
+                    conversation.on_json(message)
+            elif opcode == 0x2:
+                conversation.on_uplink_packet()
+                conversation.on_audio(transport.unpack_audio(message))
+    except (asyncio.IncompleteReadError, ConnectionError):
+        pass
+    finally:
+        # After a resume the session belongs to the newer connection
+        if conversation.transport is transport:
+            conversation.close()
+        writer.close()
+
+
+# ---------------------------------------------------------------------------
+# MQTT + UDP transport
+
+def mqtt_packet(packet_type, body):
+    length = len(body)
+    encoded = bytearray()
+    while True:
+        byte = length & 0x7F
+        length >>= 7
+        encoded.append(byte | (0x80 if length else 0))
+        if not length:
+            break
+    return bytes([packet_type]) + bytes(encoded) + body
+
+
+class UdpTransport:
+    name = 'mqtt+udp'
+
+    def __init__(self, connection, udp_host, args, offer=None):
+        self.connection = connection
+        self.udp_host = udp_host
+        self.args = args
+        # Frame batching: the smaller of the device offer and the server limits
+        self.batch = None
+        self.pending_batch = None
+        offer = (offer or {}).get('batch')
+        if offer and args.udp_batch_frames > 1:
+            self.batch = {'max_bytes': min(offer.get('max_bytes', 0), args.udp_batch_bytes),
+                          'max_frames': min(offer.get('max_frames', 0), args.udp_batch_frames)}
+            # The device ignores limits below its 256 byte floor, so such a reply would not be batching
+            if self.batch['max_frames'] < 2 or self.batch['max_bytes'] < 256:
+                self.batch = None
+        self.key = os.urandom(16)
+        self.ssrc = os.urandom(4)
+        # Device packets copy the nonce: type 0x01, flags, size, ssrc, timestamp, sequence
+        self.nonce = b'\x01\x00\x00\x00' + self.ssrc + b'\x00' * 8
+        self.ctr = AesCtr(self.key)
+        self.link = FaultLink(args, ordered=False)
+        self.conversation = None
+        self.device_address = None
+        self.sequence = 0
+        self.expected_sequence = 1
+
+    def send_json(self, message):
+        self.connection.publish(message)
+
+    def send_hello(self, reply):
+        reply = {**reply, 'transport': 'udp', 'udp': {
+            'server': self.udp_host,
+            'port': self.connection.server.udp_port,
+            'key': self.key.hex().upper(),
+            'nonce': self.nonce.hex().upper(),
+        }}
+        if self.batch is not None:
+            reply['udp']['batch'] = self.batch
+        self.connection.server.udp_sessions[self.ssrc] = self
+        self.connection.publish(reply)
+
+    def send_audio(self, payload, timestamp):
+        if self.device_address is None:
+            return None
+        self.sequence += 1
+        if self.batch is None:
+            return self.send_packet(0, timestamp, self.sequence, payload)
+
+        # Frames sent in the same event loop turn (the TTS lead) share a datagram, which is
+        # dropped, delayed or reordered as a whole
+        entry = struct.pack('>HII', len(payload), timestamp, self.sequence) + payload
+        batch = self.pending_batch
+        if batch is not None and (len(batch['entries']) >= self.batch['max_frames']
+                                  or 16 + batch['size'] + len(entry) > self.batch['max_bytes']):
+            batch = None
+        if batch is None:
+            batch = {'entries': [], 'size': 0, 'timestamp': timestamp, 'sequence': self.sequence}
+            self.pending_batch = batch
+            batch['due'] = self.link.send(16 + len(entry), lambda: self.send_batch(batch), droppable=True)
+            asyncio.get_running_loop().call_soon(self.close_batch, batch)
+        batch['entries'].append(entry)
+        batch['size'] += len(entry)
+        return batch['due']
+
+    def close_batch(self, batch):
+        if self.pending_batch is batch:
+            self.pending_batch = None
+
+    def send_batch(self, batch):
+        self.close_batch(batch)
+        self.send_packet(0x01, batch['timestamp'], batch['sequence'], b''.join(batch['entries']), delay=False)
+
+    def send_packet(self, flags, timestamp, sequence, payload, delay=True):
+        header = bytearray(self.nonce)
+        header[1] = flags
+        struct.pack_into('>H', header, 2, len(payload))
+        struct.pack_into('>II', header, 8, timestamp, sequence)
+        packet = bytes(header) + self.ctr.crypt(bytes(header), payload)
+        address = self.device_address
+        if not delay:
+            self.connection.server.udp.sendto(packet, address)
+            return None
+        return self.link.send(len(packet), lambda: self.connection.server.udp.sendto(packet, address), droppable=True)
+
+    def audio_ready(self):
+        return self.device_address is not None
+
+    def on_datagram(self, data, address):
+        self.device_address = address
+        self.conversation.flush_held()
+        if len(data) > 16:
+            self.conversation.on_uplink_packet()
+        payload = self.ctr.crypt(data[:16], data[16:])
+        if not data[1] & 0x01:
+            self.on_frame(struct.unpack_from('>I', data, 12)[0], payload)
+            return
+        # Batch: |size 2|timestamp 4|sequence 4|payload| entries
+        pos = 0
+        while pos + 10 <= len(payload):
+            size, _, sequence = struct.unpack_from('>HII', payload, pos)
+            pos += 10
+            self.on_frame(sequence, payload[pos:pos + size])
+            pos += size
+
+    def on_frame(self, sequence, payload):
+        if sequence < self.expected_sequence:
+            return
+        conversation = self.conversation
+        if conversation.turn is not None:
+            conversation.turn.uplink_lost += sequence - self.expected_sequence
+        self.expected_sequence = sequence + 1
+        # An empty packet only announces the device address after a handover
+        if payload:
+            conversation.on_audio(payload)
+
+    def close(self):
+        self.connection.publish({'type': 'goodbye'})
+        self.release()
+
+    def release(self):
+        self.connection.server.udp_sessions.pop(self.ssrc, None)
+
+    def fault_stats(self):
+        return {'dropped': self.link.dropped, 'reordered': self.link.reordered}
+
+
+class MqttConnection:
+    '''Minimal MQTT 3.1.1 broker endpoint for one device, QoS 0/1 publish only.'''
+
+    def __init__(self, server, writer):
+        self.server = server
+        self.writer = writer
+        self.client_id = None
+        self.link = FaultLink(server.args, ordered=True)
+        self.conversation = None
+
+    def publish(self, message):
+        if 'session_id' not in message and self.conversation is not None and message.get('type') != 'hello':
+            message = {'session_id': self.conversation.session_id, **message}
+        payload = json.dumps(message, ensure_ascii=False).encode()
+        topic = f'devices/p2p/{self.client_id}'.encode()
+        packet = mqtt_packet(0x30, struct.pack('>H', len(topic)) + topic + payload)
+        self.link.send(len(packet), lambda: None if self.writer.is_closing() else self.writer.write(packet))
+
+    def on_publish(self, payload):
+        message = json.loads(payload)
+        if message.get('type') == 'hello':
+            udp_host = self.server.args.public_host or self.writer.get_extra_info('sockname')[0]
+            transport = UdpTransport(self, udp_host, self.server.args, message.get('udp'))
+            resumed = self.server.sessions.get(message.get('session_id'))
+            if resumed is not None and resumed.transport.name == transport.name:
+                # The previous MQTT connection no longer owns the session
+                previous = resumed.transport.connection
+                if previous is not self:
+                    previous.conversation = None
+                else:
+                    self.conversation = None
+                self.end_conversation()
+                self.conversation = resumed
+                resumed.resume(transport, message)
+                return
+            self.end_conversation()
+            self.conversation = Conversation(self.server, transport)
+        if self.conversation is None:
+            return
+        self.conversation.on_json(message)
+        if message.get('type') == 'goodbye':
+            self.end_conversation()
+
+    def end_conversation(self):
+        if self.conversation is not None:
+            self.conversation.close()
+            self.conversation = None
+
+    def detach_conversation(self):
+        if self.conversation is not None:
+            self.conversation.detach()
+            self.conversation = None
+
+
+async def serve_mqtt(server, reader, writer):
+    connection = MqttConnection(server, writer)
+    try:
+        while True:
+            header = (await reader.readexactly(1))[0]
+            length = 0
+            shift = 0
+            while True:
+                byte = (await reader.readexactly(1))[0]
+                length |= (byte & 0x7F) << shift
+                shift += 7
+                if not byte & 0x80:
+                    break
+            body = await reader.readexactly(length)
+            packet_type = header >> 4
+            if packet_type == 1:
+                # CONNECT: protocol name, level, flags, keepalive, then the client id
+                name_length = struct.unpack_from('>H', body)[0]
+                pos = 2 + name_length + 4
+                id_length = struct.unpack_from('>H', body, pos)[0]
+                connection.client_id = body[pos + 2:pos + 2 + id_length].decode()
+                writer.write(b'\x20\x02\x00\x00')
+                print(f"[{time.strftime('%H:%M:%S')}] mqtt client {connection.client_id} connected")
+            elif packet_type == 3:
+                qos = (header >> 1) & 0x03
+                topic_length = struct.unpack_from('>H', body)[0]
+                pos = 2 + topic_length
+                if qos > 0:
+                    writer.write(b'\x40\x02' + body[pos:pos + 2])
+                    pos += 2
+                connection.on_publish(body[pos:])
+            elif packet_type == 8:
+                pos = 2
+                granted = b''
+                while pos < len(body):
+                    topic_length = struct.unpack_from('>H', body, pos)[0]
+                    pos += 2 + topic_length + 1
+                    granted += b'\x00'
+                writer.write(mqtt_packet(0x90, body[:2] + granted))
+            elif packet_type == 12:
+                writer.write(b'\xd0\x00')
+            elif packet_type == 14:
+                break
+    except (asyncio.IncompleteReadError, ConnectionError):
+        pass
+    finally:
+        # Without a goodbye the device may resume the session on another connection
+        connection.detach_conversation()
+        writer.close()
+
+
+class UdpServer(asyncio.DatagramProtocol):
+    def __init__(self, server):
+        self.server = server
+
+    def datagram_received(self, data, address):
+        if len(data) < 16 or data[0] != 0x01:
+            return
+        session = self.server.udp_sessions.get(data[4:8])
+        if session is not None:
+            session.on_datagram(data, address)
+
+
+# ---------------------------------------------------------------------------
+# HTTP: OTA check and WebSocket upgrade on the same port
+
+class StandInServer:
+    def __init__(self, args, script):
+        self.args = args
+        self.script = script
+        self.udp = None
+        self.udp_port = args.udp_port
+        self.udp_sessions = {}
+        self.sessions = {}
+        self.report_file = open(args.report, 'a', encoding='utf-8') if args.report else None
+
+    def report(self, report):
+        print(json.dumps(report, ensure_ascii=False, indent=2))
+        if self.report_file is not None:
+            self.report_file.write(json.dumps(report, ensure_ascii=False) + '\n')
+            self.report_file.flush()
+
+    async def handle_http(self, reader, writer):
+        try:
+            request = await reader.readuntil(b'\r\n\r\n')
+        except (asyncio.IncompleteReadError, asyncio.LimitOverrunError, ConnectionError):
+            writer.close()
+            return
+        lines = request.decode('latin-1').split('\r\n')
+        method, path, _ = lines[0].split(' ', 2)
+        headers = {}
+        for line in lines[1:]:
+            if ':' in line:
+                name, value = line.split(':', 1)
+                headers[name.strip().lower()] = value.strip()
+
+        if headers.get('upgrade', '').lower() == 'websocket':
+            await serve_websocket(self, reader, writer, headers)
+            return
+
+        body = b''
+        if headers.get('transfer-encoding', '').lower() == 'chunked':
+            while True:
+                size = int((await reader.readline()).strip() or b'0', 16)
+                chunk = await reader.readexactly(size + 2)
+                if size == 0:
+                    break
+                body += chunk[:-2]
+        elif 'content-length' in headers:
+            body = await reader.readexactly(int(headers['content-length']))
+
+        if path.rstrip('/').endswith('/ota'):
+            response = json.dumps(self.ota_response(headers, body), ensure_ascii=False).encode()
+            status = '200 OK'
+        else:
+            response = b'{"error": "not found"}'
+            status = '404 Not Found'
+        writer.write((f'HTTP/1.1 {status}\r\nContent-Type: application/json\r\n'
+                      f'Content-Length: {len(response)}\r\nConnection: close\r\n\r\n').encode() + response)
+        await writer.drain()
+        writer.close()
+
+    def ota_response(self, headers, body):
+        host = self.args.public_host or headers.get('host', '127.0.0.1').split(':')[0]
+        now = time.time()
+        response = {
+            'server_time': {
+                'timestamp': int(now * 1000),
+                'timezone_offset': time.localtime(now).tm_gmtoff // 60,
+            },
+        }
+        try:
+            version = json.loads(body).get('application', {}).get('version')
+        except ValueError:
+            version = None
+        if version:
+            # Same version, so the device does not upgrade
+            response['firmware'] = {'version': version, 'url': ''}
+        if self.args.ota_transport == 'mqtt':
+            client_id = headers.get('client-id') or headers.get('device-id') or str(uuid.uuid4())
+            response['mqtt'] = {
+                'endpoint': f'{host}:{self.args.mqtt_port}',
+                'client_id': client_id,
+                'username': 'stand-in',
+                'password': 'stand-in',
+                'publish_topic': 'device-server',
+                'keepalive': 240,
+            }
+        else:
+            response['websocket'] = {
+                'url': f'ws://{host}:{self.args.port}/xiaozhi/v1/',
+                'token': 'stand-in',
+                'version': self.args.ws_version,
+            }
+        print(f"[{time.strftime('%H:%M:%S')}] ota check from {headers.get('device-id')}, "
+              f"sent {self.args.ota_transport} settings for {host}")
+        return response
+
+    async def run(self):
+        loop = asyncio.get_running_loop()
+        http = await asyncio.start_server(self.handle_http, self.args.host, self.args.port)
+        mqtt = await asyncio.start_server(lambda r, w: serve_mqtt(self, r, w), self.args.host, self.args.mqtt_port)
+        self.udp, _ = await loop.create_datagram_endpoint(lambda: UdpServer(self), local_addr=(self.args.host, self.udp_port))
+        print(f'OTA + WebSocket on :{self.args.port}, MQTT on :{self.args.mqtt_port}, UDP on :{self.udp_port}, '
+              f"AES {'cryptography' if Cipher is not None else 'pure python'}")
+        async with http, mqtt:
+            await asyncio.gather(http.serve_forever(), mqtt.serve_forever())
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Local stand-in server for the WebSocket and MQTT+UDP protocols')
+    parser.add_argument('--host', default='0.0.0.0', help='Listen address')
+    parser.add_argument('--public-host', help='Address the device should use, default: the address it connected to')
+    parser.add_argument('--port', type=int, default=8000, help='HTTP OTA + WebSocket port')
+    parser.add_argument('--mqtt-port', type=int, default=1883)
+    parser.add_argument('--udp-port', type=int, default=8888)
+    parser.add_argument('--ota-transport', choices=['websocket', 'mqtt'], default='websocket')
+    parser.add_argument('--ws-version', type=int, choices=[1, 2, 3], default=1, help='WebSocket binary protocol version')
+    parser.add_argument('--script', help='Session script JSON, see the header of this file')
+    parser.add_argument('--no-mcp', dest='mcp', action='store_false', help='Skip MCP initialize / tools/list after hello')
+    parser.add_argument('--tts-lead-ms', type=int, default=180, help='How far TTS audio is sent ahead of real time')
+    parser.add_argument('--latency-ms', type=float, default=0)
+    parser.add_argument('--jitter-ms', type=float, default=0)
+    parser.add_argument('--bandwidth-kbps', type=float, default=0, help='0 means unlimited')
+    parser.add_argument('--loss', type=float, default=0, help='Downlink audio frame loss probability')
+    parser.add_argument('--reorder', type=float, default=0, help='Downlink UDP audio reorder probability')
+    parser.add_argument('--uplink-loss', type=float, default=0, help='Uplink audio frame loss probability')
+    parser.add_argument('--udp-batch-bytes', type=int, default=1200, help='Largest batched UDP datagram accepted')
+    parser.add_argument('--udp-batch-frames', type=int, default=4,
+                        help='Most frames per batched UDP datagram, 1 declines batching')
+    parser.add_argument('--resume-window-s', type=float, default=10,
+                        help='How long a session without MQTT connection can be resumed')
+    parser.add_argument('--record-dir', help='Save uplink audio of each turn as .p3')
+    parser.add_argument('--report', help='Append session reports to this file as JSON lines')
+    parser.add_argument('--seed', type=int, help='Random seed for reproducible fault injection')
+    args = parser.parse_args()
+
+    if args.seed is not None:
+        random.seed(args.seed)
+    script = DEFAULT_SCRIPT
+    if args.script:
+        with open(args.script, 'r', encoding='utf-8') as f:
+            script = json.load(f)
+    for turn in script['turns']:
+        for sentence in turn.get('sentences', []):
+            if sentence.get('audio'):
+                load_audio(sentence['audio'])
+
+    try:
+        asyncio.run(StandInServer(args, script).run())
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
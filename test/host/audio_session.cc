@@ -0,0 +1,259 @@
+#include "audio_session.h"
+
+#include "audio_service.h"
+#include "board.h"
+#include "codecs/file_audio_codec.h"
+
+#include <freertos/task.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+// 会话期间统计 operator new，其它时间只计数不统计
+static std::atomic<bool> count_allocations{false};
+static std::atomic<uint64_t> allocation_count{0};
+static std::atomic<uint64_t> allocation_bytes{0};
+
+void* operator new(size_t size) {
+    if (count_allocations.load(std::memory_order_relaxed)) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+static double CpuMs() {
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+}
+
+static double Ms(Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); }
+
+// 记录每次 Read 返回与 Write 进入的时间，用于计算上下行延迟
+class TimedFileAudioCodec : public FileAudioCodec {
+public:
+    using FileAudioCodec::FileAudioCodec;
+
+    struct ReadMark {
+        int64_t frames;         // 本次读完后的累计帧数
+        Clock::time_point time;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<ReadMark> reads;
+    std::vector<Clock::time_point> writes;
+
+    // 读到第 frames 帧 (含) 的那次 Read 的返回时间
+    bool FindRead(int64_t frames, Clock::time_point& time) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::lower_bound(reads.begin(), reads.end(), frames,
+            [](const ReadMark& mark, int64_t value) { return mark.frames < value; });
+        if (it == reads.end()) {
+            return false;
+        }
+        time = it->time;
+        return true;
+    }
+
+protected:
+    int Read(int16_t* dest, int samples) override {
+        int result = FileAudioCodec::Read(dest, samples);
+        std::lock_guard<std::mutex> lock(mutex);
+        int64_t total = (reads.empty() ? 0 : reads.back().frames) + samples / input_channels_;
+        reads.push_back({total, Clock::now()});
+        return result;
+    }
+
+    int Write(const int16_t* data, int samples) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writes.push_back(Clock::now());
+        }
+        int result = FileAudioCodec::Write(data, samples);
+        cv.notify_all();
+        return result;
+    }
+};
+
+SessionResult RunSession(const SessionScript& script) {
+    SessionResult result;
+    host_real_time = script.realtime;
+
+    auto codec = std::make_unique<TimedFileAudioCodec>(script.input_path, script.output_path, script.output_sample_rate,
+        script.realtime);
+    Board::GetInstance().codec = codec.get();
+    const int input_sample_rate = codec->input_sample_rate();
+
+    auto service = std::make_unique<AudioService>();
+    service->Initialize(codec.get());
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Clock::time_point> uplink_times;
+    AudioServiceCallbacks callbacks;
+    AudioService* service_ptr = service.get();
+    callbacks.on_send_queue_available = [&]() {
+        // 在编码任务中直接取走，测得的是管线本身的延迟，不含主循环调度
+        while (auto packet = service_ptr->PopPacketFromSendQueue()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (result.uplink_packets < script.uplink_packets) {
+                auto pcm = reinterpret_cast<const int16_t*>(packet->payload.data());
+                result.uplink.insert(result.uplink.end(), pcm, pcm + packet->payload.size() / sizeof(int16_t));
+                uplink_times.push_back(Clock::now());
+                result.uplink_packets++;
+            }
+            cv.notify_all();
+        }
+    };
+    service->SetCallbacks(callbacks);
+
+    allocation_count = 0;
+    allocation_bytes = 0;
+    count_allocations = true;
+    double cpu_start = CpuMs();
+    auto wall_start = Clock::now();
+
+    service->Start();
+    service->EnableVoiceProcessing(true);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return result.uplink_packets >= script.uplink_packets; });
+    }
+    service->EnableVoiceProcessing(false);
+
+    std::vector<Clock::time_point> push_times;
+    auto next_push = Clock::now();
+    for (const auto& frame : script.tts_frames) {
+        auto packet = std::make_unique<AudioStreamPacket>();
+        packet->sample_rate = script.tts_sample_rate;
+        packet->frame_duration = OPUS_FRAME_DURATION_MS;
+        auto bytes = reinterpret_cast<const uint8_t*>(frame.data());
+        packet->payload.assign(bytes, bytes + frame.size() * sizeof(int16_t));
+        if (script.realtime) {
+            std::this_thread::sleep_until(next_push);
+            next_push += std::chrono::milliseconds(OPUS_FRAME_DURATION_MS);
+        }
+        push_times.push_back(Clock::now());
+        service->PushPacketToDecodeQueue(std::move(packet), true);
+    }
+    service->WaitForPlaybackQueueEmpty();
+    {
+        // 队列清空时最后一帧可能还在写
+        std::unique_lock<std::mutex> lock(codec->mutex);
+        codec->cv.wait_for(lock, std::chrono::seconds(5), [&]() { return codec->writes.size() >= push_times.size(); });
+        result.output_frames = codec->writes.size();
+    }
+
+    service->Stop();
+    host_join_tasks();
+    result.wall_ms = Ms(Clock::now() - wall_start);
+    result.cpu_ms = CpuMs() - cpu_start;
+    count_allocations = false;
+    result.allocations = allocation_count;
+    result.allocated_bytes = allocation_bytes;
+
+    for (size_t k = 0; k < uplink_times.size(); k++) {
+        // 第 k 个包的最后一个样本在输入文件中的帧号
+        int64_t last_frame = ((int64_t)(k + 1) * OPUS_FRAME_DURATION_MS * 16000 / 1000) * input_sample_rate / 16000;
+        Clock::time_point read_time;
+        if (codec->FindRead(last_frame, read_time)) {
+            result.uplink_latency_ms.push_back(Ms(uplink_times[k] - read_time));
+        }
+    }
+    for (size_t j = 0; j < push_times.size() && j < codec->writes.size(); j++) {
+        result.downlink_latency_ms.push_back(Ms(codec->writes[j] - push_times[j]));
+    }
+    result.audio_seconds = (script.uplink_packets + script.tts_frames.size()) * OPUS_FRAME_DURATION_MS / 1000.0;
+
+    service.reset();
+    Board::GetInstance().codec = nullptr;
+    codec.reset();
+    host_real_time = false;
+    return result;
+}
+
+bool WriteWav(const std::string& path, const std::vector<int16_t>& samples, int sample_rate, int channels) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint32_t data_size = samples.size() * sizeof(int16_t);
+    uint32_t riff_size = 36 + data_size;
+    uint32_t format_size = 16;
+    uint16_t format = 1, channel_count = channels, block_align = channels * 2, bits = 16;
+    uint32_t rate = sample_rate, byte_rate = sample_rate * channels * 2;
+    fwrite("RIFF", 1, 4, file);
+    fwrite(&riff_size, 4, 1, file);
+    fwrite("WAVEfmt ", 1, 8, file);
+    fwrite(&format_size, 4, 1, file);
+    fwrite(&format, 2, 1, file);
+    fwrite(&channel_count, 2, 1, file);
+    fwrite(&rate, 4, 1, file);
+    fwrite(&byte_rate, 4, 1, file);
+    fwrite(&block_align, 2, 1, file);
+    fwrite(&bits, 2, 1, file);
+    fwrite("data", 1, 4, file);
+    fwrite(&data_size, 4, 1, file);
+    fwrite(samples.data(), sizeof(int16_t), samples.size(), file);
+    fclose(file);
+    return true;
+}
+
+bool ReadWav(const std::string& path, std::vector<int16_t>& samples, int& sample_rate, int& channels) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    char riff[12];
+    bool ok = fread(riff, 1, sizeof(riff), file) == sizeof(riff) && memcmp(riff, "RIFF", 4) == 0;
+    char id[4];
+    uint32_t size;
+    while (ok && fread(id, 1, 4, file) == 4 && fread(&size, 4, 1, file) == 1) {
+        if (memcmp(id, "fmt ", 4) == 0) {
+            uint8_t format[16];
+            ok = size >= sizeof(format) && fread(format, 1, sizeof(format), file) == sizeof(format);
+            channels = format[2] | format[3] << 8;
+            sample_rate = format[4] | format[5] << 8 | format[6] << 16 | format[7] << 24;
+            fseek(file, size - sizeof(format), SEEK_CUR);
+        } else if (memcmp(id, "data", 4) == 0) {
+            samples.resize(size / sizeof(int16_t));
+            ok = fread(samples.data(), sizeof(int16_t), samples.size(), file) == samples.size();
+            fclose(file);
+            return ok;
+        } else {
+            fseek(file, size + (size & 1), SEEK_CUR);
+        }
+    }
+    fclose(file);
+    return false;
+}
+
+double Percentile(std::vector<double> values, double percentile) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = std::min(values.size() - 1, (size_t)(percentile / 100 * values.size()));
+    return values[index];
+}
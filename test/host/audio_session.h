@@ -0,0 +1,49 @@
+// 主机音频管线会话：FileAudioCodec + AudioService，由测试扮演服务器
+//
+// 一次会话对应一轮对话：
+// 1. 开启语音处理，输入 WAV 经 AudioInputTask -> 处理器 -> 编码任务进入发送队列，
+//    测试在 on_send_queue_available 回调中取走上行包，直到收满 uplink_packets 个
+// 2. 关闭语音处理 (设备进入说话状态)，按脚本把 TTS 帧逐个推入解码队列，
+//    realtime 时按帧长节拍发送，否则尽快发送
+// 3. 等待播放完成后停止服务，输出 WAV 由 FileAudioCodec 写出
+//
+// 主机上的 Opus 是直通的 (见 stubs/esp_opus_enc.h)，上行包就是 16kHz 的 PCM 帧，便于逐点比较。
+#ifndef HOST_AUDIO_SESSION_H
+#define HOST_AUDIO_SESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SessionScript {
+    std::string input_path;
+    std::string output_path;
+    int output_sample_rate = 24000;
+    size_t uplink_packets = 0;
+    int tts_sample_rate = 24000;
+    std::vector<std::vector<int16_t>> tts_frames;     // 每帧 60ms
+    bool realtime = false;
+};
+
+struct SessionResult {
+    std::vector<int16_t> uplink;                // 上行包拼接后的 PCM
+    size_t uplink_packets = 0;
+    size_t output_frames = 0;                   // OutputData 的调用次数
+    std::vector<double> uplink_latency_ms;      // 一帧最后一个样本读入到包进入发送队列
+    std::vector<double> downlink_latency_ms;    // 包推入解码队列到交给 OutputData
+    double audio_seconds = 0;                   // 上行与下行音频总时长
+    double cpu_ms = 0;                          // 进程 CPU 时间 (用户 + 系统)
+    double wall_ms = 0;
+    uint64_t allocations = 0;                   // 会话期间 operator new 的次数与字节数
+    uint64_t allocated_bytes = 0;
+};
+
+bool WriteWav(const std::string& path, const std::vector<int16_t>& samples, int sample_rate, int channels);
+bool ReadWav(const std::string& path, std::vector<int16_t>& samples, int& sample_rate, int& channels);
+
+SessionResult RunSession(const SessionScript& script);
+
+double Percentile(std::vector<double> values, double percentile);
+
+#endif // HOST_AUDIO_SESSION_H
@@ -0,0 +1,62 @@
+// AudioService 主机基准：一轮脚本对话的端到端延迟、CPU 与内存分配
+//
+// 用法: bench_audio_pipeline [seconds]
+// 用户说 seconds 秒 (默认 5)，随后服务器回复同样长的 TTS。实时模式下 FileAudioCodec 按采样时钟
+// 节拍读写，服务器按 60ms 一帧发送，测得的是管线自身的排队与处理延迟；非实时模式尽快处理，
+// 给出吞吐量。主机上 Opus 是直通的，不含编解码的开销，结果只用于比较管线本身的改动。
+
+#include "audio_session.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static std::vector<int16_t> Tone(int sample_rate, double seconds) {
+    std::vector<int16_t> pcm((size_t)(sample_rate * seconds));
+    for (size_t n = 0; n < pcm.size(); n++) {
+        double t = (double)n / sample_rate;
+        pcm[n] = (int16_t)(8000 * std::sin(2 * M_PI * 300 * t) * (0.6 + 0.4 * std::sin(2 * M_PI * 2 * t)));
+    }
+    return pcm;
+}
+
+static void Report(const char* name, const SessionResult& result) {
+    std::printf("%s: %.1f s of audio in %.0f ms, %.1fx realtime\n", name, result.audio_seconds, result.wall_ms,
+        result.audio_seconds * 1000 / result.wall_ms);
+    std::printf("  uplink   latency p50 %6.2f ms, p95 %6.2f ms, max %6.2f ms (%zu packets)\n",
+        Percentile(result.uplink_latency_ms, 50), Percentile(result.uplink_latency_ms, 95),
+        Percentile(result.uplink_latency_ms, 100), result.uplink_latency_ms.size());
+    std::printf("  downlink latency p50 %6.2f ms, p95 %6.2f ms, max %6.2f ms (%zu frames)\n",
+        Percentile(result.downlink_latency_ms, 50), Percentile(result.downlink_latency_ms, 95),
+        Percentile(result.downlink_latency_ms, 100), result.downlink_latency_ms.size());
+    std::printf("  cpu %.1f ms per audio second, %.0f allocations (%.1f KB) per audio second\n",
+        result.cpu_ms / result.audio_seconds, result.allocations / result.audio_seconds,
+        result.allocated_bytes / 1024.0 / result.audio_seconds);
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 5;
+    const std::string input_path = "bench_pipeline_input.wav";
+    const std::string output_path = "bench_pipeline_output.wav";
+    WriteWav(input_path, Tone(16000, seconds), 16000, 1);
+
+    SessionScript script;
+    script.input_path = input_path;
+    script.output_path = output_path;
+    script.uplink_packets = (size_t)(seconds * 1000 / 60);
+    auto tts = Tone(24000, seconds);
+    for (size_t offset = 0; offset + 1440 <= tts.size(); offset += 1440) {
+        script.tts_frames.emplace_back(tts.begin() + offset, tts.begin() + offset + 1440);
+    }
+
+    script.realtime = true;
+    Report("realtime", RunSession(script));
+    script.realtime = false;
+    Report("as fast as possible", RunSession(script));
+
+    std::remove(input_path.c_str());
+    std::remove(output_path.c_str());
+    return 0;
+}
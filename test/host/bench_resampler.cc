@@ -0,0 +1,71 @@
+// Resampler 主机基准：常用比例下每个输出样本的耗时与周期数
+//
+// 用法: bench_resampler [seconds]
+// 按 20ms 一帧处理 seconds 秒 (默认 60) 的单声道语音频段噪声。x86 上周期数取自 TSC，
+// 其它平台只输出纳秒。主机结果只用于比较不同实现，不代表 ESP32 上的绝对开销。
+
+#include "audio/resampler.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#endif
+
+struct Ratio {
+    int src_rate;
+    int dest_rate;
+};
+
+static const Ratio kRatios[] = {
+    {24000, 16000},
+    {16000, 48000},
+    {48000, 16000},
+    {16000, 24000},
+};
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 60;
+
+    for (const auto& ratio : kRatios) {
+        Resampler resampler;
+        if (!resampler.Configure(ratio.src_rate, ratio.dest_rate, 1)) {
+            std::fprintf(stderr, "Failed to configure %d -> %d\n", ratio.src_rate, ratio.dest_rate);
+            return 1;
+        }
+        size_t frame = ratio.src_rate / 50;
+        std::vector<int16_t> in(frame);
+        std::vector<int16_t> out(resampler.GetMaxOutputFrames(frame));
+        unsigned seed = 1;
+        for (auto& v : in) {
+            seed = seed * 1103515245 + 12345;
+            v = (int16_t)((int)(seed >> 16) - 32768) / 2;
+        }
+
+        size_t frames = (size_t)(seconds * 50);
+        size_t produced = 0;
+        auto start = std::chrono::steady_clock::now();
+#ifdef BENCH_HAS_TSC
+        uint64_t start_tsc = __rdtsc();
+#endif
+        for (size_t i = 0; i < frames; i++) {
+            produced += resampler.Process(in.data(), frame, out.data());
+        }
+#ifdef BENCH_HAS_TSC
+        uint64_t tsc = __rdtsc() - start_tsc;
+#endif
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%5d -> %5d: %6.2f ns/sample", ratio.src_rate, ratio.dest_rate, ns / produced);
+#ifdef BENCH_HAS_TSC
+        std::printf(", %6.1f cycles/sample", (double)tsc / produced);
+#endif
+        std::printf(", %.0fx realtime\n", seconds * 1e9 / ns);
+    }
+    return 0;
+}
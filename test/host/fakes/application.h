@@ -0,0 +1,77 @@
+// Host fake of Application: queues scheduled tasks, records sounds and wake word invocations,
+// and serves recorded PCM through GetAudioService()
+#ifndef HOST_FAKE_APPLICATION_H
+#define HOST_FAKE_APPLICATION_H
+
+#include "device_state.h"
+#include "display.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Thrown by AudioService::ReadAudioData once the recording is used up, so loops that
+// read audio forever on the device can be stopped on the host
+struct EndOfRecording : std::runtime_error {
+    EndOfRecording() : std::runtime_error("end of recording") {}
+};
+
+class AudioService {
+public:
+    bool ReadAudioData(std::vector<int16_t>& data, int sample_rate, int samples) {
+        if (position >= recording.size()) {
+            throw EndOfRecording();
+        }
+        size_t n = std::min(recording.size() - position, (size_t)samples * channels);
+        data.assign(recording.begin() + position, recording.begin() + position + n);
+        position += n;
+        return true;
+    }
+
+    // Interleaved 16kHz input
+    std::vector<int16_t> recording;
+    size_t position = 0;
+    int channels = 1;
+};
+
+class Application {
+public:
+    static Application& GetInstance() {
+        static Application instance;
+        return instance;
+    }
+
+    void Schedule(std::function<void()>&& callback) { tasks_.push_back(std::move(callback)); }
+    void PlaySound(const std::string_view& sound) { sounds.emplace_back(sound); }
+    void WakeWordInvoke(const std::string& wake_word) { invoked_wake_words.push_back(wake_word); }
+
+    DeviceState GetDeviceState() const { return device_state; }
+    AudioService& GetAudioService() { return audio_service; }
+
+    // Runs the scheduled tasks the way the main loop would
+    void RunScheduled() {
+        while (!tasks_.empty()) {
+            auto task = std::move(tasks_.front());
+            tasks_.pop_front();
+            task();
+        }
+    }
+
+    std::vector<std::string> sounds;
+    std::vector<std::string> invoked_wake_words;
+    DeviceState device_state = kDeviceStateIdle;
+    AudioService audio_service;
+
+private:
+    std::deque<std::function<void()>> tasks_;
+};
+
+#endif // HOST_FAKE_APPLICATION_H
@@ -0,0 +1,14 @@
+// Host fake of the generated language config, only the sounds used by the tests
+#ifndef HOST_FAKE_LANG_CONFIG_H
+#define HOST_FAKE_LANG_CONFIG_H
+
+#include <string_view>
+
+namespace Lang {
+namespace Sounds {
+inline constexpr std::string_view OGG_POPUP = "popup";
+inline constexpr std::string_view OGG_EXCLAMATION = "exclamation";
+} // namespace Sounds
+} // namespace Lang
+
+#endif // HOST_FAKE_LANG_CONFIG_H
@@ -0,0 +1,31 @@
+// Host fake of Board with a settable volume and brightness
+#ifndef HOST_FAKE_BOARD_H
+#define HOST_FAKE_BOARD_H
+
+class AudioCodec {
+public:
+    int output_volume() const { return volume; }
+    int volume = 70;
+};
+
+class Backlight {
+public:
+    int brightness() const { return level; }
+    int level = 50;
+};
+
+class Board {
+public:
+    static Board& GetInstance() {
+        static Board instance;
+        return instance;
+    }
+
+    AudioCodec* GetAudioCodec() { return &codec; }
+    Backlight* GetBacklight() { return &backlight; }
+
+    AudioCodec codec;
+    Backlight backlight;
+};
+
+#endif // HOST_FAKE_BOARD_H
@@ -0,0 +1,16 @@
+// Host fake of Display, records chat messages
+#ifndef HOST_FAKE_DISPLAY_H
+#define HOST_FAKE_DISPLAY_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class Display {
+public:
+    void SetChatMessage(const char* role, const char* content) { messages.emplace_back(role, content); }
+
+    std::vector<std::pair<std::string, std::string>> messages;
+};
+
+#endif // HOST_FAKE_DISPLAY_H
@@ -0,0 +1,27 @@
+// Host fake of McpServer: records local tool calls, tools listed in failing_tools report failure
+#ifndef HOST_FAKE_MCP_SERVER_H
+#define HOST_FAKE_MCP_SERVER_H
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class McpServer {
+public:
+    static McpServer& GetInstance() {
+        static McpServer instance;
+        return instance;
+    }
+
+    bool CallToolLocally(const std::string& tool_name, const std::string& arguments_json) {
+        calls.emplace_back(tool_name, arguments_json);
+        return tools.count(tool_name) != 0 && failing_tools.count(tool_name) == 0;
+    }
+
+    std::set<std::string> tools;
+    std::set<std::string> failing_tools;
+    std::vector<std::pair<std::string, std::string>> calls;
+};
+
+#endif // HOST_FAKE_MCP_SERVER_H
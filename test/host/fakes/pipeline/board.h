@@ -0,0 +1,19 @@
+// Host fake of Board for the audio pipeline, the test installs its codec
+#ifndef HOST_FAKE_PIPELINE_BOARD_H
+#define HOST_FAKE_PIPELINE_BOARD_H
+
+class AudioCodec;
+
+class Board {
+public:
+    static Board& GetInstance() {
+        static Board instance;
+        return instance;
+    }
+
+    AudioCodec* GetAudioCodec() { return codec; }
+
+    AudioCodec* codec = nullptr;
+};
+
+#endif // HOST_FAKE_PIPELINE_BOARD_H
@@ -0,0 +1,36 @@
+// Host fake of Settings, an in-memory store shared by all namespaces of the process
+#ifndef HOST_FAKE_SETTINGS_H
+#define HOST_FAKE_SETTINGS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+class Settings {
+public:
+    Settings(const std::string& ns, bool read_write = false) : ns_(ns) {}
+
+    std::string GetString(const std::string& key, const std::string& default_value = "") {
+        auto it = Store().find(ns_ + "." + key);
+        return it != Store().end() ? it->second : default_value;
+    }
+    void SetString(const std::string& key, const std::string& value) { Store()[ns_ + "." + key] = value; }
+    int32_t GetInt(const std::string& key, int32_t default_value = 0) {
+        auto it = Store().find(ns_ + "." + key);
+        return it != Store().end() ? std::stoi(it->second) : default_value;
+    }
+    void SetInt(const std::string& key, int32_t value) { Store()[ns_ + "." + key] = std::to_string(value); }
+    bool GetBool(const std::string& key, bool default_value = false) { return GetInt(key, default_value) != 0; }
+    void SetBool(const std::string& key, bool value) { SetInt(key, value); }
+    void EraseKey(const std::string& key) { Store().erase(ns_ + "." + key); }
+
+private:
+    std::string ns_;
+
+    static std::map<std::string, std::string>& Store() {
+        static std::map<std::string, std::string> store;
+        return store;
+    }
+};
+
+#endif // HOST_FAKE_SETTINGS_H
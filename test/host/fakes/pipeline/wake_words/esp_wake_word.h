@@ -0,0 +1,23 @@
+// Host fake of EspWakeWord, there are no wake word models on the host so it never detects anything
+#ifndef HOST_FAKE_ESP_WAKE_WORD_H
+#define HOST_FAKE_ESP_WAKE_WORD_H
+
+#include "wake_word.h"
+
+class EspWakeWord : public WakeWord {
+public:
+    bool Initialize(AudioCodec* codec, srmodel_list_t* models_list) override { return false; }
+    void Feed(const std::vector<int16_t>& data) override {}
+    void OnWakeWordDetected(std::function<void(const std::string& wake_word)> callback) override {}
+    void Start() override {}
+    void Stop() override {}
+    size_t GetFeedSize() override { return 0; }
+    void EncodeWakeWordData() override {}
+    bool GetWakeWordOpus(std::vector<uint8_t>& opus) override { return false; }
+    const std::string& GetLastDetectedWakeWord() const override { return last_; }
+
+private:
+    std::string last_;
+};
+
+#endif // HOST_FAKE_ESP_WAKE_WORD_H
@@ -0,0 +1,21 @@
+// Host fake of the esp-wifi-connect SsidManager, records saved credentials
+#ifndef HOST_FAKE_SSID_MANAGER_H
+#define HOST_FAKE_SSID_MANAGER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class SsidManager {
+public:
+    static SsidManager& GetInstance() {
+        static SsidManager instance;
+        return instance;
+    }
+
+    void AddSsid(const std::string& ssid, const std::string& password) { ssids.emplace_back(ssid, password); }
+
+    std::vector<std::pair<std::string, std::string>> ssids;
+};
+
+#endif // HOST_FAKE_SSID_MANAGER_H
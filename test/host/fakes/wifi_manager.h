@@ -0,0 +1,12 @@
+// Host fake of the esp-wifi-connect WifiManager
+#ifndef HOST_FAKE_WIFI_MANAGER_H
+#define HOST_FAKE_WIFI_MANAGER_H
+
+class WifiManager {
+public:
+    void StopConfigAp() { config_ap_stopped = true; }
+
+    bool config_ap_stopped = false;
+};
+
+#endif // HOST_FAKE_WIFI_MANAGER_H
@@ -0,0 +1,112 @@
+// Host stand-in for the subset of cJSON used by the sources under test: building objects, arrays,
+// strings, numbers and booleans, and printing them without formatting
+#ifndef HOST_STUB_CJSON_H
+#define HOST_STUB_CJSON_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct cJSON {
+    enum Type { kObject, kArray, kString, kNumber, kBool } type;
+    std::string string_value;
+    double number_value = 0;
+    bool bool_value = false;
+    std::vector<std::pair<std::string, cJSON*>> children;
+};
+
+inline cJSON* cJSON_CreateObject() { return new cJSON{cJSON::kObject}; }
+inline cJSON* cJSON_CreateArray() { return new cJSON{cJSON::kArray}; }
+
+inline void cJSON_Delete(cJSON* item) {
+    if (item == nullptr) {
+        return;
+    }
+    for (auto& child : item->children) {
+        cJSON_Delete(child.second);
+    }
+    delete item;
+}
+
+inline void cJSON_AddItemToObject(cJSON* object, const char* name, cJSON* item) { object->children.emplace_back(name, item); }
+inline void cJSON_AddItemToArray(cJSON* array, cJSON* item) { array->children.emplace_back("", item); }
+
+inline cJSON* cJSON_AddNumberToObject(cJSON* object, const char* name, double value) {
+    auto item = new cJSON{cJSON::kNumber};
+    item->number_value = value;
+    cJSON_AddItemToObject(object, name, item);
+    return item;
+}
+
+inline cJSON* cJSON_AddStringToObject(cJSON* object, const char* name, const char* value) {
+    auto item = new cJSON{cJSON::kString};
+    item->string_value = value;
+    cJSON_AddItemToObject(object, name, item);
+    return item;
+}
+
+inline cJSON* cJSON_AddBoolToObject(cJSON* object, const char* name, bool value) {
+    auto item = new cJSON{cJSON::kBool};
+    item->bool_value = value;
+    cJSON_AddItemToObject(object, name, item);
+    return item;
+}
+
+inline void cJSON_HostPrintString(const std::string& value, std::string& out) {
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+inline void cJSON_HostPrint(const cJSON* item, std::string& out) {
+    char number[32];
+    switch (item->type) {
+    case cJSON::kString:
+        cJSON_HostPrintString(item->string_value, out);
+        break;
+    case cJSON::kNumber:
+        if (item->number_value == std::floor(item->number_value) && std::fabs(item->number_value) < 1e15) {
+            std::snprintf(number, sizeof(number), "%.0f", item->number_value);
+        } else {
+            std::snprintf(number, sizeof(number), "%g", item->number_value);
+        }
+        out += number;
+        break;
+    case cJSON::kBool:
+        out += item->bool_value ? "true" : "false";
+        break;
+    default:
+        out += item->type == cJSON::kObject ? '{' : '[';
+        for (size_t i = 0; i < item->children.size(); i++) {
+            if (i > 0) {
+                out += ',';
+            }
+            if (item->type == cJSON::kObject) {
+                cJSON_HostPrintString(item->children[i].first, out);
+                out += ':';
+            }
+            cJSON_HostPrint(item->children[i].second, out);
+        }
+        out += item->type == cJSON::kObject ? '}' : ']';
+        break;
+    }
+}
+
+inline char* cJSON_PrintUnformatted(const cJSON* item) {
+    std::string out;
+    cJSON_HostPrint(item, out);
+    return strdup(out.c_str());
+}
+
+inline void cJSON_free(void* ptr) { std::free(ptr); }
+
+#endif // HOST_STUB_CJSON_H
@@ -0,0 +1,12 @@
+// Host stand-in for the I2S channel handle, host codecs never create a channel
+#ifndef HOST_STUB_I2S_COMMON_H
+#define HOST_STUB_I2S_COMMON_H
+
+#include "esp_err.h"
+
+typedef struct i2s_channel_obj_t* i2s_chan_handle_t;
+
+inline esp_err_t i2s_channel_enable(i2s_chan_handle_t) { return ESP_OK; }
+inline esp_err_t i2s_channel_disable(i2s_chan_handle_t) { return ESP_OK; }
+
+#endif // HOST_STUB_I2S_COMMON_H
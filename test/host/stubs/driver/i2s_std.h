@@ -0,0 +1,7 @@
+// Host stand-in for the I2S channel handle, host codecs never create a channel
+#ifndef HOST_STUB_I2S_STD_H
+#define HOST_STUB_I2S_STD_H
+
+#include "driver/i2s_common.h"
+
+#endif // HOST_STUB_I2S_STD_H
@@ -0,0 +1,43 @@
+// Host stand-in for esp_ae_rate_cvt: always fails to open, so only the polyphase path runs on the host
+#ifndef HOST_STUB_ESP_AE_RATE_CVT_H
+#define HOST_STUB_ESP_AE_RATE_CVT_H
+
+#include <cstdint>
+
+typedef void* esp_ae_rate_cvt_handle_t;
+typedef void* esp_ae_sample_t;
+typedef int esp_ae_err_t;
+
+#define ESP_AUDIO_BIT16 16
+#define ESP_AE_ERR_NOT_SUPPORT (-2)
+
+typedef enum {
+    ESP_AE_RATE_CVT_PERF_TYPE_MEMORY = 0,
+    ESP_AE_RATE_CVT_PERF_TYPE_SPEED = 1,
+} esp_ae_rate_cvt_perf_type_t;
+
+typedef struct {
+    uint32_t src_rate;
+    uint32_t dest_rate;
+    uint8_t channel;
+    uint8_t bits_per_sample;
+    uint8_t complexity;
+    esp_ae_rate_cvt_perf_type_t perf_type;
+} esp_ae_rate_cvt_cfg_t;
+
+inline esp_ae_err_t esp_ae_rate_cvt_open(esp_ae_rate_cvt_cfg_t*, esp_ae_rate_cvt_handle_t* handle) {
+    *handle = nullptr;
+    return ESP_AE_ERR_NOT_SUPPORT;
+}
+inline esp_ae_err_t esp_ae_rate_cvt_get_max_out_sample_num(esp_ae_rate_cvt_handle_t, uint32_t, uint32_t* out) {
+    *out = 0;
+    return ESP_AE_ERR_NOT_SUPPORT;
+}
+inline esp_ae_err_t esp_ae_rate_cvt_process(esp_ae_rate_cvt_handle_t, esp_ae_sample_t, uint32_t, esp_ae_sample_t, uint32_t* out) {
+    *out = 0;
+    return ESP_AE_ERR_NOT_SUPPORT;
+}
+inline esp_ae_err_t esp_ae_rate_cvt_reset(esp_ae_rate_cvt_handle_t) { return ESP_AE_ERR_NOT_SUPPORT; }
+inline void esp_ae_rate_cvt_close(esp_ae_rate_cvt_handle_t) {}
+
+#endif // HOST_STUB_ESP_AE_RATE_CVT_H
@@ -0,0 +1,9 @@
+// Host stand-in for the section attributes
+#ifndef HOST_STUB_ESP_ATTR_H
+#define HOST_STUB_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+
+#endif // HOST_STUB_ESP_ATTR_H
@@ -0,0 +1,7 @@
+// Host stand-in for the esp_audio_codec encoder interface
+#ifndef HOST_STUB_ESP_AUDIO_ENC_H
+#define HOST_STUB_ESP_AUDIO_ENC_H
+
+#include "esp_audio_types.h"
+
+#endif // HOST_STUB_ESP_AUDIO_ENC_H
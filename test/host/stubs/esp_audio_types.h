@@ -0,0 +1,56 @@
+// Host stand-in for the esp_audio_codec types used by the audio pipeline
+#ifndef HOST_STUB_ESP_AUDIO_TYPES_H
+#define HOST_STUB_ESP_AUDIO_TYPES_H
+
+#include <cstdint>
+
+typedef enum {
+    ESP_AUDIO_ERR_OK = 0,
+    ESP_AUDIO_ERR_FAIL = -1,
+    ESP_AUDIO_ERR_MEM_LACK = -2,
+    ESP_AUDIO_ERR_INVALID_PARAMETER = -4,
+    ESP_AUDIO_ERR_BUFF_NOT_ENOUGH = -6,
+} esp_audio_err_t;
+
+#define ESP_AUDIO_SAMPLE_RATE_16K 16000
+#define ESP_AUDIO_MONO 1
+#define ESP_AUDIO_BIT16 16
+
+typedef enum {
+    ESP_AUDIO_DEC_RECOVERY_NONE = 0,
+    ESP_AUDIO_DEC_RECOVERY_PLC = 1,
+} esp_audio_dec_recovery_t;
+
+typedef struct {
+    uint8_t* buffer;
+    uint32_t len;
+    uint32_t consumed;
+    esp_audio_dec_recovery_t frame_recover;
+} esp_audio_dec_in_raw_t;
+
+typedef struct {
+    uint8_t* buffer;
+    uint32_t len;
+    uint32_t decoded_size;
+} esp_audio_dec_out_frame_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t channel;
+    uint8_t bits_per_sample;
+    uint32_t bitrate;
+    uint32_t frame_size;
+} esp_audio_dec_info_t;
+
+typedef struct {
+    uint8_t* buffer;
+    uint32_t len;
+} esp_audio_enc_in_frame_t;
+
+typedef struct {
+    uint8_t* buffer;
+    uint32_t len;
+    uint32_t encoded_bytes;
+} esp_audio_enc_out_frame_t;
+
+#endif // HOST_STUB_ESP_AUDIO_TYPES_H
@@ -0,0 +1,21 @@
+// Host stand-in for the CPU cycle counter, the TSC on x86 and nanoseconds elsewhere
+#ifndef HOST_STUB_ESP_CPU_H
+#define HOST_STUB_ESP_CPU_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+inline uint32_t esp_cpu_get_cycle_count() {
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+#endif // HOST_STUB_ESP_CPU_H
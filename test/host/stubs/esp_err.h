@@ -0,0 +1,20 @@
+// Host stand-in for esp_err_t, ESP_ERROR_CHECK aborts like the device does
+#ifndef HOST_STUB_ESP_ERR_H
+#define HOST_STUB_ESP_ERR_H
+
+#include <cstdio>
+#include <cstdlib>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+#define ESP_ERROR_CHECK(x) do { \
+        esp_err_t err_ = (x); \
+        if (err_ != ESP_OK) { \
+            std::fprintf(stderr, "ESP_ERROR_CHECK failed: %d at %s:%d\n", err_, __FILE__, __LINE__); \
+            std::abort(); \
+        } \
+    } while (0)
+
+#endif // HOST_STUB_ESP_ERR_H
@@ -0,0 +1,16 @@
+// Host stand-in for the capability aware allocator, every capability maps to malloc
+#ifndef HOST_STUB_ESP_HEAP_CAPS_H
+#define HOST_STUB_ESP_HEAP_CAPS_H
+
+#include <cstdint>
+#include <cstdlib>
+
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_8BIT (1 << 2)
+
+inline void* heap_caps_malloc(size_t size, uint32_t) { return std::malloc(size); }
+inline void* heap_caps_calloc(size_t n, size_t size, uint32_t) { return std::calloc(n, size); }
+inline void heap_caps_free(void* ptr) { std::free(ptr); }
+
+#endif // HOST_STUB_ESP_HEAP_CAPS_H
@@ -0,0 +1,20 @@
+// Host stand-in for ESP-IDF logging, prints to stderr only when HOST_TEST_VERBOSE is set
+#ifndef HOST_STUB_ESP_LOG_H
+#define HOST_STUB_ESP_LOG_H
+
+#include <cstdio>
+#include <cstdlib>
+
+#define HOST_LOG(level, tag, format, ...) do { \
+        if (std::getenv("HOST_TEST_VERBOSE") != nullptr) { \
+            std::fprintf(stderr, level " (%s) " format "\n", tag, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG("D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) HOST_LOG("V", tag, format, ##__VA_ARGS__)
+
+#endif // HOST_STUB_ESP_LOG_H
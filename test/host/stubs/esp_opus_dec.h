@@ -0,0 +1,58 @@
+// Host stand-in for the Opus decoder, the inverse of the esp_opus_enc.h stand-in: packets carry PCM
+#ifndef HOST_STUB_ESP_OPUS_DEC_H
+#define HOST_STUB_ESP_OPUS_DEC_H
+
+#include "esp_audio_types.h"
+
+#include <cstring>
+
+typedef enum {
+    ESP_OPUS_DEC_FRAME_DURATION_INVALID = -1,
+    ESP_OPUS_DEC_FRAME_DURATION_2_5_MS = 0,
+    ESP_OPUS_DEC_FRAME_DURATION_5_MS = 5,
+    ESP_OPUS_DEC_FRAME_DURATION_10_MS = 10,
+    ESP_OPUS_DEC_FRAME_DURATION_20_MS = 20,
+    ESP_OPUS_DEC_FRAME_DURATION_40_MS = 40,
+    ESP_OPUS_DEC_FRAME_DURATION_60_MS = 60,
+    ESP_OPUS_DEC_FRAME_DURATION_80_MS = 80,
+    ESP_OPUS_DEC_FRAME_DURATION_100_MS = 100,
+    ESP_OPUS_DEC_FRAME_DURATION_120_MS = 120,
+} esp_opus_dec_frame_duration_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t channel;
+    esp_opus_dec_frame_duration_t frame_duration;
+    bool self_delimited;
+} esp_opus_dec_cfg_t;
+
+struct HostOpusDecoder {
+    uint32_t sample_rate;
+};
+
+inline esp_audio_err_t esp_opus_dec_open(void* config, uint32_t, void** decoder) {
+    *decoder = new HostOpusDecoder{static_cast<esp_opus_dec_cfg_t*>(config)->sample_rate};
+    return ESP_AUDIO_ERR_OK;
+}
+
+inline esp_audio_err_t esp_opus_dec_decode(void* decoder, esp_audio_dec_in_raw_t* raw, esp_audio_dec_out_frame_t* frame,
+                                           esp_audio_dec_info_t* info) {
+    if (raw->len > frame->len) {
+        return ESP_AUDIO_ERR_BUFF_NOT_ENOUGH;
+    }
+    std::memcpy(frame->buffer, raw->buffer, raw->len);
+    raw->consumed = raw->len;
+    frame->decoded_size = raw->len;
+    info->sample_rate = static_cast<HostOpusDecoder*>(decoder)->sample_rate;
+    info->channel = 1;
+    info->bits_per_sample = 16;
+    return ESP_AUDIO_ERR_OK;
+}
+
+inline esp_audio_err_t esp_opus_dec_reset(void*) { return ESP_AUDIO_ERR_OK; }
+inline esp_audio_err_t esp_opus_dec_close(void* decoder) {
+    delete static_cast<HostOpusDecoder*>(decoder);
+    return ESP_AUDIO_ERR_OK;
+}
+
+#endif // HOST_STUB_ESP_OPUS_DEC_H
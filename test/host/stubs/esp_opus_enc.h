@@ -0,0 +1,70 @@
+// Host stand-in for the Opus encoder. There is no libopus on the host: the "encoded" packet is the
+// PCM frame itself, so the pipeline can be checked sample by sample. Codec CPU time is not included
+// in host measurements.
+#ifndef HOST_STUB_ESP_OPUS_ENC_H
+#define HOST_STUB_ESP_OPUS_ENC_H
+
+#include "esp_audio_enc.h"
+
+#include <cstring>
+
+typedef enum {
+    ESP_OPUS_ENC_FRAME_DURATION_5_MS = 5,
+    ESP_OPUS_ENC_FRAME_DURATION_10_MS = 10,
+    ESP_OPUS_ENC_FRAME_DURATION_20_MS = 20,
+    ESP_OPUS_ENC_FRAME_DURATION_40_MS = 40,
+    ESP_OPUS_ENC_FRAME_DURATION_60_MS = 60,
+    ESP_OPUS_ENC_FRAME_DURATION_80_MS = 80,
+    ESP_OPUS_ENC_FRAME_DURATION_100_MS = 100,
+    ESP_OPUS_ENC_FRAME_DURATION_120_MS = 120,
+} esp_opus_enc_frame_duration_t;
+
+typedef enum {
+    ESP_OPUS_ENC_APPLICATION_VOIP,
+    ESP_OPUS_ENC_APPLICATION_AUDIO,
+    ESP_OPUS_ENC_APPLICATION_LOWDELAY,
+} esp_opus_enc_application_t;
+
+#define ESP_OPUS_BITRATE_AUTO -1000
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t channel;
+    uint8_t bits_per_sample;
+    int bitrate;
+    esp_opus_enc_frame_duration_t frame_duration;
+    esp_opus_enc_application_t application_mode;
+    int complexity;
+    bool enable_fec;
+    bool enable_dtx;
+    bool enable_vbr;
+} esp_opus_enc_config_t;
+
+struct HostOpusEncoder {
+    int frame_bytes;
+};
+
+inline esp_audio_err_t esp_opus_enc_open(void* config, uint32_t, void** encoder) {
+    auto cfg = static_cast<esp_opus_enc_config_t*>(config);
+    *encoder = new HostOpusEncoder{(int)(cfg->sample_rate / 1000 * cfg->frame_duration * cfg->channel * 2)};
+    return ESP_AUDIO_ERR_OK;
+}
+
+inline esp_audio_err_t esp_opus_enc_get_frame_size(void* encoder, int* in_size, int* out_size) {
+    *in_size = static_cast<HostOpusEncoder*>(encoder)->frame_bytes;
+    *out_size = *in_size;
+    return ESP_AUDIO_ERR_OK;
+}
+
+inline esp_audio_err_t esp_opus_enc_process(void* encoder, esp_audio_enc_in_frame_t* in, esp_audio_enc_out_frame_t* out) {
+    if (in->len > out->len) {
+        return ESP_AUDIO_ERR_BUFF_NOT_ENOUGH;
+    }
+    std::memcpy(out->buffer, in->buffer, in->len);
+    out->encoded_bytes = in->len;
+    return ESP_AUDIO_ERR_OK;
+}
+
+inline void esp_opus_enc_close(void* encoder) { delete static_cast<HostOpusEncoder*>(encoder); }
+
+#endif // HOST_STUB_ESP_OPUS_ENC_H
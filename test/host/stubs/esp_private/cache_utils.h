@@ -0,0 +1,7 @@
+// Host stand-in, the flash cache is always enabled
+#ifndef HOST_STUB_CACHE_UTILS_H
+#define HOST_STUB_CACHE_UTILS_H
+
+inline bool spi_flash_cache_enabled() { return true; }
+
+#endif // HOST_STUB_CACHE_UTILS_H
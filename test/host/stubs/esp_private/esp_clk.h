@@ -0,0 +1,7 @@
+// Host stand-in for the CPU clock. Host cycle counts come from the TSC, so percentages derived from it are approximate
+#ifndef HOST_STUB_ESP_CLK_H
+#define HOST_STUB_ESP_CLK_H
+
+inline int esp_clk_cpu_freq() { return 240000000; }
+
+#endif // HOST_STUB_ESP_CLK_H
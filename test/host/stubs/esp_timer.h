@@ -0,0 +1,57 @@
+// Host stand-in for esp_timer. esp_timer_get_time reads the steady clock; timers can be created and
+// started but never fire, tests drive time dependent code directly
+#ifndef HOST_STUB_ESP_TIMER_H
+#define HOST_STUB_ESP_TIMER_H
+
+#include "esp_err.h"
+
+#include <chrono>
+#include <cstdint>
+
+inline int64_t esp_timer_get_time() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef enum {
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+struct HostTimer {
+    esp_timer_create_args_t args;
+    bool running;
+};
+typedef HostTimer* esp_timer_handle_t;
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    *handle = new HostTimer{*args, false};
+    return ESP_OK;
+}
+inline esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t) {
+    timer->running = true;
+    return ESP_OK;
+}
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t) {
+    timer->running = true;
+    return ESP_OK;
+}
+inline esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    timer->running = false;
+    return ESP_OK;
+}
+inline esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    delete timer;
+    return ESP_OK;
+}
+
+#endif // HOST_STUB_ESP_TIMER_H
@@ -0,0 +1,25 @@
+// Host stand-in for the FreeRTOS types, tick helpers and critical sections
+#ifndef HOST_STUB_FREERTOS_H
+#define HOST_STUB_FREERTOS_H
+
+#include <atomic>
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xffffffff)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configMAX_TASK_NAME_LEN 16
+
+// Spinlock in place of the cross-core portMUX
+typedef std::atomic_flag portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED ATOMIC_FLAG_INIT
+#define portENTER_CRITICAL(mux) do { while ((mux)->test_and_set(std::memory_order_acquire)) {} } while (0)
+#define portEXIT_CRITICAL(mux) (mux)->clear(std::memory_order_release)
+
+#endif // HOST_STUB_FREERTOS_H
@@ -0,0 +1,65 @@
+// Host stand-in for FreeRTOS tasks. Tasks are std::threads that the test joins with host_join_tasks()
+// once they have been told to stop. vTaskDelay returns at once (simulated time) unless the test sets
+// host_real_time, then it sleeps like the device would.
+#ifndef HOST_STUB_FREERTOS_TASK_H
+#define HOST_STUB_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Each host thread is its own task, named by the test or by xTaskCreate
+inline thread_local const char* host_task_name = "main";
+inline bool host_real_time = false;
+
+inline void vTaskDelay(TickType_t ticks) {
+    if (host_real_time) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+    }
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return (TaskHandle_t)&host_task_name; }
+inline char* pcTaskGetName(TaskHandle_t) { return const_cast<char*>(host_task_name); }
+
+inline std::mutex host_tasks_mutex;
+inline std::vector<std::thread> host_tasks;
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t, void* arg, UBaseType_t,
+                              TaskHandle_t* handle) {
+    std::lock_guard<std::mutex> lock(host_tasks_mutex);
+    host_tasks.emplace_back([function, name, arg]() {
+        host_task_name = name;
+        function(arg);
+    });
+    if (handle != nullptr) {
+        *handle = (TaskHandle_t)&host_tasks.back();
+    }
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack, void* arg,
+                                          UBaseType_t priority, TaskHandle_t* handle, BaseType_t) {
+    return xTaskCreate(function, name, stack, arg, priority, handle);
+}
+
+// Only deleting the calling task is supported, the thread ends when its function returns
+inline void vTaskDelete(TaskHandle_t) {}
+
+inline void host_join_tasks() {
+    std::vector<std::thread> tasks;
+    {
+        std::lock_guard<std::mutex> lock(host_tasks_mutex);
+        tasks.swap(host_tasks);
+    }
+    for (auto& task : tasks) {
+        task.join();
+    }
+}
+
+#endif // HOST_STUB_FREERTOS_TASK_H
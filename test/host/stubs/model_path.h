@@ -0,0 +1,15 @@
+// Host stand-in for the esp-sr model list, there are no models on the host
+#ifndef HOST_STUB_MODEL_PATH_H
+#define HOST_STUB_MODEL_PATH_H
+
+#define ESP_WN_PREFIX "wn"
+#define ESP_MN_PREFIX "mn"
+
+typedef struct {
+    char** model_name;
+    int num;
+} srmodel_list_t;
+
+inline char* esp_srmodel_filter(srmodel_list_t*, const char*, const char*) { return nullptr; }
+
+#endif // HOST_STUB_MODEL_PATH_H
@@ -0,0 +1,5 @@
+// Host stand-in for the generated Kconfig header, every optional feature is off on the host
+#ifndef HOST_STUB_SDKCONFIG_H
+#define HOST_STUB_SDKCONFIG_H
+
+#endif // HOST_STUB_SDKCONFIG_H
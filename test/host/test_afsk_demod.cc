@@ -0,0 +1,191 @@
+// AFSK 声波配网主机测试
+//
+// 按 scripts/sonic_wifi_config.html 的方式调制帧 (MSB 先发，mark 1800Hz / space 1500Hz，
+// 100 bit/s，相位按绝对时间计算)，以 16kHz 录入，叠加宽带高斯白噪声与 1% 的频偏，
+// 在不同 SNR 下统计解码成功率。另外覆盖：纯噪声不误报、首遍损坏后下一遍仍能解出、
+// 立体声只用第一声道，以及 ReceiveWifiCredentialsFromAudio 的完整流程。
+
+#include "afsk_demod.h"
+#include "application.h"
+#include "display.h"
+#include "ssid_manager.h"
+#include "wifi_manager.h"
+#include "test_util.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace audio_wifi_config;
+
+static const std::string kCredentials = "xiaozhi-test\nsecret-password-123";
+static constexpr double kAmplitude = 12000;
+static constexpr int kTrials = 20;
+
+struct SnrCase {
+    double snr_db;
+    int min_decoded;  // kTrials 次中至少成功的次数
+};
+
+static const SnrCase kSnrCases[] = {
+    {20, kTrials},
+    {10, kTrials},
+    {6, kTrials},
+    {3, kTrials},
+    {0, kTrials * 9 / 10},
+    // 低于 0dB 只统计成功率，仍要求不解出错误的帧
+    {-3, 0},
+    {-6, 0},
+};
+
+static std::vector<uint8_t> FrameBits(const std::string& text) {
+    std::vector<uint8_t> bytes = {0x01, 0x02};
+    bytes.insert(bytes.end(), text.begin(), text.end());
+    bytes.push_back(AudioDataBuffer::CalculateChecksum(text));
+    bytes.push_back(0x03);
+    bytes.push_back(0x04);
+    std::vector<uint8_t> bits;
+    for (uint8_t byte : bytes) {
+        for (int i = 7; i >= 0; i--) {
+            bits.push_back((byte >> i) & 1);
+        }
+    }
+    return bits;
+}
+
+// 调制一遍帧并追加到 pcm，freq_scale 模拟播放与录音两端的时钟偏差
+static void Modulate(const std::vector<uint8_t>& bits, double freq_scale, std::vector<double>& pcm) {
+    const double samples_per_bit = kInputSampleRate / (double)kBitRate / freq_scale;
+    size_t start = pcm.size();
+    size_t total = (size_t)(bits.size() * samples_per_bit);
+    for (size_t n = 0; n < total; n++) {
+        size_t bit = std::min(bits.size() - 1, (size_t)(n / samples_per_bit));
+        double freq = (bits[bit] ? kMarkFrequency : kSpaceFrequency) * freq_scale;
+        double t = (double)(start + n) / kInputSampleRate;
+        pcm.push_back(kAmplitude * std::sin(2 * M_PI * freq * t));
+    }
+}
+
+// 静音前导 + repetitions 遍帧 + 静音结尾，再加上指定 SNR 的白噪声
+static std::vector<int16_t> Recording(const std::string& text, double snr_db, int repetitions, double freq_scale,
+                                      std::mt19937& rng) {
+    std::vector<double> pcm(std::uniform_int_distribution<int>(0, kInputSampleRate / 2)(rng), 0.0);
+    auto bits = FrameBits(text);
+    for (int i = 0; i < repetitions; i++) {
+        Modulate(bits, freq_scale, pcm);
+    }
+    pcm.resize(pcm.size() + kInputSampleRate / 5, 0.0);
+
+    double noise_sigma = std::sqrt(kAmplitude * kAmplitude / 2 / std::pow(10, snr_db / 10));
+    std::normal_distribution<double> noise(0, noise_sigma);
+    std::vector<int16_t> out(pcm.size());
+    for (size_t i = 0; i < pcm.size(); i++) {
+        double v = pcm[i] + noise(rng);
+        out[i] = (int16_t)std::lround(std::max(-32767.0, std::min(32767.0, v)));
+    }
+    return out;
+}
+
+// 按设备上的 30ms 一块送入解调器与帧解码器，返回第一帧解出的文本
+static std::optional<std::string> Decode(const std::vector<int16_t>& pcm, size_t channels = 1) {
+    AfskDemodulator demodulator;
+    AudioDataBuffer buffer;
+    uint8_t bits[16];
+    const size_t block = 480 * channels;
+    for (size_t offset = 0; offset < pcm.size(); offset += block) {
+        size_t n = std::min(block, pcm.size() - offset);
+        size_t count = demodulator.Process(pcm.data() + offset, n / channels, channels, bits, sizeof(bits));
+        for (size_t i = 0; i < count; i++) {
+            if (buffer.PushBit(bits[i]) && buffer.decoded_text.has_value()) {
+                return buffer.decoded_text;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+int main() {
+    std::mt19937 rng(2024);
+
+    // 不同 SNR 下的解码成功率，每次只播放一遍帧
+    for (const auto& test : kSnrCases) {
+        int decoded = 0, wrong = 0;
+        for (int trial = 0; trial < kTrials; trial++) {
+            double freq_scale = trial % 2 ? 1.01 : 0.99;
+            auto result = Decode(Recording(kCredentials, test.snr_db, 1, freq_scale, rng));
+            if (result.has_value()) {
+                if (*result == kCredentials) {
+                    decoded++;
+                } else {
+                    wrong++;
+                }
+            }
+        }
+        std::printf("SNR %5.1f dB: %d/%d decoded, %d wrong\n", test.snr_db, decoded, kTrials, wrong);
+        CHECK_MSG(decoded >= test.min_decoded, "SNR %.1f dB: %d/%d decoded", test.snr_db, decoded, kTrials);
+        CHECK_MSG(wrong == 0, "SNR %.1f dB: %d wrong frames", test.snr_db, wrong);
+    }
+
+    // 10 秒纯噪声不应解出任何帧
+    {
+        std::normal_distribution<double> noise(0, 4000);
+        std::vector<int16_t> pcm(kInputSampleRate * 10);
+        for (auto& v : pcm) {
+            v = (int16_t)std::lround(noise(rng));
+        }
+        CHECK(!Decode(pcm).has_value());
+    }
+
+    // 第一遍中间被噪声打断，第二遍仍能解出
+    {
+        auto pcm = Recording(kCredentials, 10, 2, 1.0, rng);
+        size_t frame_samples = FrameBits(kCredentials).size() * kInputSampleRate / kBitRate;
+        std::uniform_int_distribution<int> burst(-30000, 30000);
+        for (size_t i = 0; i < kInputSampleRate / 10 && i + frame_samples / 2 < pcm.size(); i++) {
+            pcm[frame_samples / 2 + i] = (int16_t)burst(rng);
+        }
+        auto result = Decode(pcm);
+        CHECK(result.has_value() && *result == kCredentials);
+    }
+
+    // 立体声输入只解调第一声道，第二声道为无关的强干扰
+    {
+        auto mono = Recording(kCredentials, 10, 1, 1.0, rng);
+        std::vector<int16_t> stereo(mono.size() * 2);
+        for (size_t i = 0; i < mono.size(); i++) {
+            stereo[2 * i] = mono[i];
+            stereo[2 * i + 1] = (int16_t)(20000 * std::sin(2 * M_PI * 1650 * i / kInputSampleRate));
+        }
+        auto result = Decode(stereo, 2);
+        CHECK(result.has_value() && *result == kCredentials);
+    }
+
+    // 完整流程：从 AudioService 读取录音，解出后保存 SSID 并退出配网模式
+    {
+        auto& app = Application::GetInstance();
+        app.device_state = kDeviceStateWifiConfiguring;
+        app.audio_service.recording = Recording(kCredentials, 10, 2, 1.0, rng);
+        app.audio_service.position = 0;
+        WifiManager wifi_manager;
+        Display display;
+        try {
+            ReceiveWifiCredentialsFromAudio(&app, &wifi_manager, &display);
+        } catch (const EndOfRecording&) {
+            CHECK_MSG(false, "recording ended without decoding a frame");
+        }
+        auto& ssids = SsidManager::GetInstance().ssids;
+        CHECK(ssids.size() == 1);
+        if (ssids.size() == 1) {
+            CHECK(ssids[0].first == "xiaozhi-test");
+            CHECK(ssids[0].second == "secret-password-123");
+        }
+        CHECK(wifi_manager.config_ap_stopped);
+        CHECK(display.messages.size() == 1);
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,165 @@
+// AudioMixer 主机测试
+//
+// 按固定脚本 (TTS 单独播放 -> 提示音开始闪避 -> 告警叠加饱和 -> 提示音结束恢复 -> 调整增益)
+// 逐帧混音，输出与双精度参考模型逐点比较，并与记录的黄金校验和比较，
+// 任何定点实现上的改动都会被发现。确认新的输出正确后用 --print-golden 更新 kGoldenHash。
+
+#include "audio/audio_mixer.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static constexpr int kSampleRate = 16000;
+static constexpr size_t kFrameSamples = 320;
+static constexpr int kFrames = 50;
+// 全部输出样本的 FNV-1a 校验和
+static constexpr uint32_t kGoldenHash = 0x3D666690;
+
+struct Step {
+    int first_frame;
+    bool voice, sound, alarm;
+    float voice_gain;
+};
+
+// 每一段从 first_frame 开始，直到下一段
+static const Step kScript[] = {
+    {0, true, false, false, 1.0f},    // TTS 单独播放，直通
+    {10, true, true, false, 1.0f},    // 提示音开始，TTS 闪避
+    {20, true, true, true, 1.0f},     // 告警叠加，总和超过满幅
+    {30, true, false, false, 1.0f},   // 提示音与告警结束，TTS 恢复
+    {40, true, false, false, 0.5f},   // TTS 增益调到 0.5
+};
+
+static int16_t VoiceSample(long n) { return (int16_t)(12000 * std::sin(2 * M_PI * 440 * n / kSampleRate)); }
+static int16_t SoundSample(long n) { return (n / 8) % 2 ? 10000 : -10000; }
+static int16_t AlarmSample(long n) { return (int16_t)(20000 * std::sin(2 * M_PI * 2000 * n / kSampleRate)); }
+
+// 参考模型：增益在一帧内从上一帧目标线性过渡到本帧目标，双精度累加后饱和
+class ReferenceMixer {
+public:
+    void Mix(const std::vector<int16_t>* sources[kAudioStreamCount], const float targets[kAudioStreamCount],
+             std::vector<double>& output) {
+        output.assign(kFrameSamples, 0.0);
+        for (int s = 0; s < kAudioStreamCount; s++) {
+            if (sources[s] == nullptr) {
+                current_[s] = targets[s];
+                continue;
+            }
+            for (size_t i = 0; i < kFrameSamples; i++) {
+                double g = current_[s] + (targets[s] - current_[s]) * i / kFrameSamples;
+                output[i] += (*sources[s])[i] * g;
+            }
+            current_[s] = targets[s];
+        }
+        for (auto& v : output) {
+            v = std::clamp(v, -32767.0, 32767.0);
+        }
+    }
+
+private:
+    double current_[kAudioStreamCount] = {1.0, 1.0, 1.0};
+};
+
+static const Step& StepAt(int frame) {
+    const Step* step = &kScript[0];
+    for (const auto& s : kScript) {
+        if (frame >= s.first_frame) {
+            step = &s;
+        }
+    }
+    return *step;
+}
+
+int main(int argc, char** argv) {
+    bool print_golden = argc > 1 && std::strcmp(argv[1], "--print-golden") == 0;
+
+    AudioMixer mixer;
+    ReferenceMixer reference;
+    std::vector<int16_t> streams[kAudioStreamCount];
+    std::vector<int16_t> output;
+    std::vector<double> expected;
+    uint32_t hash = 2166136261u;
+    int max_error = 0;
+    double total_error = 0;
+    int max_step_at_duck = 0;
+
+    for (auto& stream : streams) {
+        stream.resize(kFrameSamples);
+    }
+    for (int frame = 0; frame < kFrames; frame++) {
+        const Step& step = StepAt(frame);
+        mixer.SetGain(kAudioStreamVoice, step.voice_gain);
+        bool active[kAudioStreamCount] = {step.voice, step.sound, step.alarm};
+
+        const int16_t* sources[kAudioStreamCount] = {};
+        size_t samples[kAudioStreamCount] = {};
+        const std::vector<int16_t>* reference_sources[kAudioStreamCount] = {};
+        for (size_t i = 0; i < kFrameSamples; i++) {
+            long n = (long)frame * kFrameSamples + i;
+            streams[kAudioStreamVoice][i] = VoiceSample(n);
+            streams[kAudioStreamSound][i] = SoundSample(n);
+            streams[kAudioStreamAlarm][i] = AlarmSample(n);
+        }
+        for (int s = 0; s < kAudioStreamCount; s++) {
+            if (active[s]) {
+                sources[s] = streams[s].data();
+                samples[s] = kFrameSamples;
+                reference_sources[s] = &streams[s];
+            }
+        }
+
+        // TTS 单独以单位增益播放时应当可以直通
+        if (frame < kScript[1].first_frame && frame > 0) {
+            CHECK(mixer.IsPassthrough(kAudioStreamVoice));
+        }
+        // 闪避由 Mix 施加，从提示音开始后的下一帧起 TTS 增益已不是 1.0
+        if (frame > kScript[1].first_frame && frame <= kScript[3].first_frame) {
+            CHECK(!mixer.IsPassthrough(kAudioStreamVoice));
+        }
+
+        mixer.Mix(sources, samples, kFrameSamples, output);
+
+        bool duck = step.sound || step.alarm;
+        float targets[kAudioStreamCount] = {step.voice_gain * (duck ? AUDIO_MIXER_DUCKING_GAIN : 1.0f), 1.0f, 1.0f};
+        reference.Mix(reference_sources, targets, expected);
+
+        for (size_t i = 0; i < kFrameSamples; i++) {
+            int error = (int)std::lround(std::fabs(output[i] - expected[i]));
+            max_error = std::max(max_error, error);
+            total_error += std::fabs(output[i] - expected[i]);
+            uint16_t v = (uint16_t)output[i];
+            hash = (hash ^ (v & 0xFF)) * 16777619u;
+            hash = (hash ^ (v >> 8)) * 16777619u;
+        }
+        // 闪避开始的一帧内 TTS 增益线性下降，相邻样本的变化不超过信号本身的变化
+        if (frame == kScript[1].first_frame) {
+            for (size_t i = 1; i < kFrameSamples; i++) {
+                int jump = std::abs(output[i] - output[i - 1]);
+                max_step_at_duck = std::max(max_step_at_duck, jump);
+            }
+        }
+        // 告警叠加后饱和到 +-32767，不会回绕
+        if (step.alarm) {
+            CHECK(*std::max_element(output.begin(), output.end()) == 32767);
+            CHECK(*std::min_element(output.begin(), output.end()) == -32767);
+        }
+    }
+
+    double mean_error = total_error / (kFrames * kFrameSamples);
+    CHECK_MSG(max_error <= 3, "max error %d LSB", max_error);
+    CHECK_MSG(mean_error < 1.0, "mean error %.3f LSB", mean_error);
+    // 提示音方波的跳变为 20000，加上 TTS 每样本最大变化约 2100
+    CHECK_MSG(max_step_at_duck <= 23000, "max step %d", max_step_at_duck);
+
+    if (print_golden) {
+        std::printf("0x%08X\n", hash);
+        return 0;
+    }
+    CHECK_MSG(hash == kGoldenHash, "output hash 0x%08X, golden 0x%08X", hash, kGoldenHash);
+    return TEST_RESULT();
+}
@@ -0,0 +1,166 @@
+// AudioService 主机管线测试：FileAudioCodec 回放 WAV，测试扮演服务器收发音频
+//
+// 主机上的 Opus 是直通的，上行包应与输入逐点相同，下行 PCM 经播放队列与混音器 (单独 TTS 时直通)
+// 后应与输出 WAV 逐点相同。另外覆盖双声道 (麦克风 + 回采) 输入只上传麦克风声道、
+// 输入采样率不是 16kHz 时的重采样，以及 TTS 采样率与输出不同时的重采样。
+
+#include "audio_session.h"
+#include "test_util.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr int kUplinkPackets = 20;
+static constexpr int kTtsFrames = 15;
+
+// 幅度缓慢变化的多音调信号，近似语音的频谱范围
+static std::vector<int16_t> Speech(int sample_rate, double seconds, int channels, std::mt19937& rng) {
+    std::uniform_real_distribution<double> phase(0, 2 * M_PI);
+    double p1 = phase(rng), p2 = phase(rng), p3 = phase(rng);
+    size_t frames = (size_t)(sample_rate * seconds);
+    std::vector<int16_t> pcm(frames * channels);
+    for (size_t n = 0; n < frames; n++) {
+        double t = (double)n / sample_rate;
+        double envelope = 0.5 + 0.5 * std::sin(2 * M_PI * 3 * t);
+        double v = envelope * (6000 * std::sin(2 * M_PI * 220 * t + p1) + 3000 * std::sin(2 * M_PI * 1100 * t + p2) +
+            1500 * std::sin(2 * M_PI * 2900 * t + p3));
+        pcm[n * channels] = (int16_t)std::lround(v);
+        for (int c = 1; c < channels; c++) {
+            // 回采声道是与麦克风无关的扬声器信号
+            pcm[n * channels + c] = (int16_t)std::lround(4000 * std::sin(2 * M_PI * 440 * t));
+        }
+    }
+    return pcm;
+}
+
+static std::vector<std::vector<int16_t>> TtsFrames(int sample_rate, std::mt19937& rng) {
+    auto pcm = Speech(sample_rate, kTtsFrames * 0.06, 1, rng);
+    size_t frame = sample_rate * 60 / 1000;
+    std::vector<std::vector<int16_t>> frames;
+    for (int i = 0; i < kTtsFrames; i++) {
+        frames.emplace_back(pcm.begin() + i * frame, pcm.begin() + (i + 1) * frame);
+    }
+    return frames;
+}
+
+static std::vector<int16_t> Concat(const std::vector<std::vector<int16_t>>& frames) {
+    std::vector<int16_t> out;
+    for (const auto& frame : frames) {
+        out.insert(out.end(), frame.begin(), frame.end());
+    }
+    return out;
+}
+
+// 第一个不同样本的位置，相同时返回 -1
+static long FirstDifference(const std::vector<int16_t>& a, const std::vector<int16_t>& b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (i >= a.size() || i >= b.size() || a[i] != b[i]) {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+static double Rms(const std::vector<int16_t>& pcm, size_t skip) {
+    double sum = 0;
+    for (size_t i = skip; i < pcm.size(); i++) {
+        sum += (double)pcm[i] * pcm[i];
+    }
+    return pcm.size() > skip ? std::sqrt(sum / (pcm.size() - skip)) : 0;
+}
+
+int main() {
+    std::mt19937 rng(47);
+    const std::string input_path = "pipeline_input.wav";
+    const std::string output_path = "pipeline_output.wav";
+    const size_t uplink_samples = kUplinkPackets * 960;
+
+    // 单声道 16kHz：上行与下行都逐点相同
+    {
+        auto input = Speech(16000, 1.5, 1, rng);
+        CHECK(WriteWav(input_path, input, 16000, 1));
+        SessionScript script;
+        script.input_path = input_path;
+        script.output_path = output_path;
+        script.uplink_packets = kUplinkPackets;
+        script.tts_frames = TtsFrames(24000, rng);
+        auto result = RunSession(script);
+
+        CHECK(result.uplink_packets == kUplinkPackets);
+        CHECK(result.uplink.size() == uplink_samples);
+        // 1.5 秒之后是 FileAudioCodec 补的静音
+        std::vector<int16_t> expected(input);
+        expected.resize(uplink_samples, 0);
+        long diff = FirstDifference(result.uplink, expected, uplink_samples);
+        CHECK_MSG(diff < 0, "uplink differs at sample %ld", diff);
+
+        std::vector<int16_t> output;
+        int rate = 0, channels = 0;
+        CHECK(ReadWav(output_path, output, rate, channels));
+        CHECK(rate == 24000 && channels == 1);
+        auto tts = Concat(script.tts_frames);
+        CHECK_MSG(output.size() == tts.size(), "output %zu samples, expected %zu", output.size(), tts.size());
+        diff = FirstDifference(output, tts, tts.size());
+        CHECK_MSG(diff < 0, "downlink differs at sample %ld", diff);
+        CHECK(result.output_frames == kTtsFrames);
+        CHECK(result.uplink_latency_ms.size() == kUplinkPackets);
+        CHECK(result.downlink_latency_ms.size() == kTtsFrames);
+    }
+
+    // 双声道 (麦克风 + 回采)：只上传第一声道
+    {
+        auto input = Speech(16000, 1.5, 2, rng);
+        CHECK(WriteWav(input_path, input, 16000, 2));
+        SessionScript script;
+        script.input_path = input_path;
+        script.output_path = output_path;
+        script.uplink_packets = kUplinkPackets;
+        auto result = RunSession(script);
+
+        std::vector<int16_t> mic(uplink_samples, 0);
+        for (size_t i = 0; i < uplink_samples && i * 2 < input.size(); i++) {
+            mic[i] = input[i * 2];
+        }
+        long diff = FirstDifference(result.uplink, mic, uplink_samples);
+        CHECK_MSG(diff < 0, "stereo uplink differs at sample %ld", diff);
+    }
+
+    // 48kHz 输入重采样到 16kHz，16kHz 的 TTS 重采样到 24kHz 输出：长度正确且信号完整
+    {
+        auto input = Speech(48000, 1.5, 1, rng);
+        CHECK(WriteWav(input_path, input, 48000, 1));
+        SessionScript script;
+        script.input_path = input_path;
+        script.output_path = output_path;
+        script.uplink_packets = kUplinkPackets;
+        script.tts_sample_rate = 16000;
+        script.tts_frames = TtsFrames(16000, rng);
+        auto result = RunSession(script);
+
+        CHECK(result.uplink.size() == uplink_samples);
+        std::vector<int16_t> reference(input.size() / 3);
+        for (size_t i = 0; i < reference.size(); i++) {
+            reference[i] = input[i * 3];
+        }
+        reference.resize(uplink_samples);
+        double level = Rms(result.uplink, 960) / Rms(reference, 960);
+        CHECK_MSG(level > 0.95 && level < 1.05, "resampled uplink level %.3f", level);
+
+        std::vector<int16_t> output;
+        int rate = 0, channels = 0;
+        CHECK(ReadWav(output_path, output, rate, channels));
+        size_t expected = kTtsFrames * 1440;
+        CHECK_MSG(output.size() + 4 >= expected && output.size() <= expected + 4, "resampled output %zu samples, expected %zu",
+            output.size(), expected);
+        level = Rms(output, 1440) / Rms(Concat(script.tts_frames), 960);
+        CHECK_MSG(level > 0.95 && level < 1.05, "resampled downlink level %.3f", level);
+    }
+
+    std::remove(input_path.c_str());
+    std::remove(output_path.c_str());
+    return TEST_RESULT();
+}
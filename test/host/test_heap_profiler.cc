@@ -0,0 +1,133 @@
+// HeapProfiler 主机测试：按调用点汇总的存活字节数、采样权重、realloc 替换，以及并发分配时导出快照
+//
+// 主机上没有栈回溯，调用点按任务名区分，由各线程设置 host_task_name。
+// 分配地址是虚构的，只作为存活分配表的键，不会被解引用。
+
+#include "heap_profiler.h"
+#include "test_util.h"
+
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr int kSampleRate = 8;
+static constexpr int kThreads = 4;
+static constexpr int kOpsPerThread = 200000;
+
+static void* Address(uintptr_t base, int i) { return reinterpret_cast<void*>(base + (uintptr_t)i * 64); }
+
+static bool Contains(const std::string& json, const std::string& text) { return json.find(text) != std::string::npos; }
+
+// 返回指定任务的调用点对象，没有时返回空串
+static std::string SiteOf(const std::string& json, const char* task) {
+    auto begin = json.find(std::string("{\"task\":\"") + task + "\"");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    return json.substr(begin, json.find('}', begin) - begin + 1);
+}
+
+int main() {
+    auto& profiler = HeapProfiler::GetInstance();
+    CHECK(Contains(profiler.GetJson(10), "\"running\":false"));
+    CHECK(profiler.Start(kSampleRate));
+
+    // 大块分配全部记录，按任务汇总
+    host_task_name = "audio";
+    for (int i = 0; i < 10; i++) {
+        profiler.OnAlloc(Address(0x3c000000, i), 2048);
+    }
+    host_task_name = "net";
+    profiler.OnAlloc(Address(0x3d000000, 0), 4096);
+    auto json = profiler.GetJson(10);
+    CHECK_MSG(Contains(SiteOf(json, "audio"), "\"live_bytes\":20480,\"live_count\":10,\"allocs\":10"), "%s", json.c_str());
+    CHECK_MSG(Contains(SiteOf(json, "net"), "\"live_bytes\":4096,\"live_count\":1"), "%s", json.c_str());
+    // 按存活字节数排序
+    CHECK(json.find("\"task\":\"audio\"") < json.find("\"task\":\"net\""));
+
+    // 释放一半后存活量减少，峰值保留
+    for (int i = 0; i < 5; i++) {
+        profiler.OnFree(Address(0x3c000000, i));
+    }
+    // 未记录的地址被忽略
+    profiler.OnFree(Address(0x3e000000, 0));
+    json = profiler.GetJson(10);
+    CHECK_MSG(Contains(SiteOf(json, "audio"), "\"live_bytes\":10240,\"live_count\":5,\"allocs\":10,\"peak_bytes\":20480"),
+        "%s", json.c_str());
+
+    // 没有经过释放钩子就被复用的地址 (realloc) 从原调用点转到新调用点
+    host_task_name = "net";
+    profiler.OnAlloc(Address(0x3c000000, 9), 1024);
+    json = profiler.GetJson(10);
+    CHECK_MSG(Contains(SiteOf(json, "audio"), "\"live_bytes\":8192,\"live_count\":4"), "%s", json.c_str());
+    CHECK_MSG(Contains(SiteOf(json, "net"), "\"live_bytes\":5120,\"live_count\":2"), "%s", json.c_str());
+
+    // 小分配每 kSampleRate 次记录一次，估计值按权重放大
+    host_task_name = "ui";
+    for (int i = 0; i < 8000; i++) {
+        profiler.OnAlloc(Address(0x3f000000, i), 16);
+    }
+    json = profiler.GetJson(10);
+    CHECK_MSG(Contains(SiteOf(json, "ui"), "\"live_bytes\":128000,\"live_count\":8000,\"allocs\":8000"), "%s",
+        json.c_str());
+    CHECK_MSG(Contains(json, "\"tracked\":1006"), "%s", json.c_str());
+    for (int i = 0; i < 8000; i++) {
+        profiler.OnFree(Address(0x3f000000, i));
+    }
+    for (int i = 5; i < 10; i++) {
+        profiler.OnFree(Address(0x3c000000, i));
+    }
+    profiler.OnFree(Address(0x3d000000, 0));
+    json = profiler.GetJson(10);
+    CHECK_MSG(Contains(json, "\"live_bytes\":0,\"tracked\":0,\"dropped\":0"), "%s", json.c_str());
+    CHECK(Contains(json, "\"overhead\":{\"sampled_allocs\":1012,\"frees\":8012,"));
+
+    // 多个线程分配释放的同时反复导出快照，结束时全部释放，存活量应回到 0
+    std::atomic<bool> stop{false};
+    std::atomic<int> snapshots{0};
+    std::thread reader([&]() {
+        while (!stop) {
+            auto snapshot = profiler.GetJson(5);
+            if (!Contains(snapshot, "\"sites\":[")) {
+                CHECK_MSG(false, "bad snapshot %s", snapshot.c_str());
+            }
+            snapshots++;
+        }
+    });
+    static const char* const kTasks[kThreads] = {"t0", "t1", "t2", "t3"};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < kThreads; t++) {
+        workers.emplace_back([&profiler, t]() {
+            host_task_name = kTasks[t];
+            uintptr_t base = 0x40000000 + (uintptr_t)t * 0x1000000;
+            // 每个线程最多同时持有 256 块，大小交替大小块
+            for (int i = 0; i < kOpsPerThread; i++) {
+                int slot = i % 256;
+                if (i >= 256) {
+                    profiler.OnFree(Address(base, slot));
+                }
+                profiler.OnAlloc(Address(base, slot), i % 3 == 0 ? 1500 : 48);
+            }
+            for (int slot = 0; slot < 256; slot++) {
+                profiler.OnFree(Address(base, slot));
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    stop = true;
+    reader.join();
+    json = profiler.GetJson(10);
+    CHECK_MSG(Contains(json, "\"live_bytes\":0,\"tracked\":0,\"dropped\":0"), "%s", json.c_str());
+    for (auto task : kTasks) {
+        CHECK_MSG(Contains(SiteOf(json, task), "\"live_bytes\":0,\"live_count\":0"), "%s", json.c_str());
+    }
+    std::printf("%d snapshots taken during %d concurrent operations\n", snapshots.load(), kThreads * kOpsPerThread);
+    return TEST_RESULT();
+}
@@ -0,0 +1,202 @@
+// LocalIntent 主机测试：录音 PCM 经模拟检测器识别出命令，再交给 LocalIntent 执行
+//
+// 用法: test_local_intent [recording.pcm]
+// recording.pcm 为 16kHz 单声道 s16le，不提供时按 kCommands 合成一段录音。
+// 模拟检测器用单音代替命令词：第 i 个命令对应 kToneBaseHz + i * kToneStepHz 的单音。
+
+#include "local_intent.h"
+#include "application.h"
+#include "board.h"
+#include "mcp_server.h"
+#include "test_util.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+static constexpr int kSampleRate = 16000;
+// 与 multinet 每次检测的块大小相同
+static constexpr size_t kChunkSamples = 512;
+static constexpr double kToneBaseHz = 500;
+static constexpr double kToneStepHz = 250;
+// 连续多少块识别为同一单音才算命中，约 128ms
+static constexpr int kHitChunks = 4;
+
+struct Command {
+    const char* text;
+    const char* action;
+    const char* arguments;
+};
+
+// 与 index.json 中 multinet_model.commands 的写法相同
+static const Command kCommands[] = {
+    {"调大音量", "volume_up", ""},
+    {"调暗屏幕", "brightness_down", ""},
+    {"打开台灯", "lamp_on", ""},
+    {"切换模式", "self.custom.set_mode", "{\"mode\":2}"},
+    {"播放音乐", "play_music", ""},
+};
+static constexpr int kCommandCount = sizeof(kCommands) / sizeof(kCommands[0]);
+
+// 模拟 multinet：逐块做 Goertzel，某个命令的单音持续 kHitChunks 块即回调一次
+class MockDetector {
+public:
+    using Callback = std::function<void(const std::string& text, const std::string& action, const std::string& arguments)>;
+
+    explicit MockDetector(Callback callback) : callback_(std::move(callback)) {}
+
+    void Feed(const int16_t* data, size_t samples) {
+        for (size_t i = 0; i < samples; i++) {
+            chunk_.push_back(data[i]);
+            if (chunk_.size() == kChunkSamples) {
+                DetectChunk();
+                chunk_.clear();
+            }
+        }
+    }
+
+private:
+    Callback callback_;
+    std::vector<int16_t> chunk_;
+    int candidate_ = -1;
+    int hits_ = 0;
+    bool fired_ = false;
+
+    static double Power(const std::vector<int16_t>& x, double freq) {
+        double coeff = 2 * std::cos(2 * M_PI * freq / kSampleRate);
+        double s1 = 0, s2 = 0;
+        for (int16_t v : x) {
+            double s = v + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s;
+        }
+        return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    }
+
+    void DetectChunk() {
+        double energy = 0;
+        for (int16_t v : chunk_) {
+            energy += (double)v * v;
+        }
+        int best = -1;
+        double best_power = 0;
+        for (int i = 0; i < kCommandCount; i++) {
+            double power = Power(chunk_, kToneBaseHz + i * kToneStepHz);
+            if (power > best_power) {
+                best_power = power;
+                best = i;
+            }
+        }
+        // 单音能量占整块能量的大部分才算有效，静音或噪声不触发
+        bool tonal = energy > 0 && best_power * 2 / (energy * kChunkSamples) > 0.5;
+        if (!tonal) {
+            candidate_ = -1;
+            hits_ = 0;
+            fired_ = false;
+            return;
+        }
+        if (best != candidate_) {
+            candidate_ = best;
+            hits_ = 0;
+            fired_ = false;
+        }
+        if (++hits_ >= kHitChunks && !fired_) {
+            fired_ = true;
+            callback_(kCommands[best].text, kCommands[best].action, kCommands[best].arguments);
+        }
+    }
+};
+
+static std::vector<int16_t> SynthesizeRecording() {
+    std::vector<int16_t> pcm;
+    unsigned seed = 1;
+    auto append_noise = [&pcm, &seed](int ms) {
+        for (int i = 0; i < kSampleRate * ms / 1000; i++) {
+            seed = seed * 1103515245 + 12345;
+            pcm.push_back((int16_t)((int)((seed >> 16) & 0x7FF) - 1024));
+        }
+    };
+    append_noise(300);
+    for (int c = 0; c < kCommandCount; c++) {
+        double freq = kToneBaseHz + c * kToneStepHz;
+        for (int i = 0; i < kSampleRate * 400 / 1000; i++) {
+            pcm.push_back((int16_t)(8000 * std::sin(2 * M_PI * freq * i / kSampleRate)));
+        }
+        append_noise(500);
+    }
+    return pcm;
+}
+
+static bool LoadRecording(const char* path, std::vector<int16_t>& pcm) {
+    FILE* fp = std::fopen(path, "rb");
+    if (fp == nullptr) {
+        return false;
+    }
+    int16_t buffer[1024];
+    size_t n;
+    while ((n = std::fread(buffer, sizeof(int16_t), 1024, fp)) > 0) {
+        pcm.insert(pcm.end(), buffer, buffer + n);
+    }
+    std::fclose(fp);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<int16_t> pcm;
+    if (argc > 1) {
+        if (!LoadRecording(argv[1], pcm)) {
+            std::fprintf(stderr, "Failed to read %s\n", argv[1]);
+            return 1;
+        }
+    } else {
+        pcm = SynthesizeRecording();
+    }
+
+    auto& app = Application::GetInstance();
+    auto& board = Board::GetInstance();
+    auto& mcp = McpServer::GetInstance();
+    board.codec.volume = 70;
+    board.backlight.level = 50;
+    mcp.tools = {"self.audio_speaker.set_volume", "self.screen.set_brightness", "self.lamp.turn_on", "self.custom.set_mode"};
+    mcp.failing_tools = {"self.lamp.turn_on"};
+
+    // 与 Application 中 on_command_detected 的接法相同
+    MockDetector detector([](const std::string& text, const std::string& action, const std::string& arguments) {
+        LocalIntent::GetInstance().Execute(text, action, arguments);
+    });
+    // 按 20ms 一帧送入，和音频输入任务的节奏一致
+    for (size_t offset = 0; offset < pcm.size(); offset += 320) {
+        detector.Feed(pcm.data() + offset, std::min<size_t>(320, pcm.size() - offset));
+    }
+    app.RunScheduled();
+
+    // 每个命令恰好执行一次，内置意图换成对应的 MCP 工具与当前状态推算的参数
+    CHECK_MSG(mcp.calls.size() == 5, "calls=%zu", mcp.calls.size());
+    if (mcp.calls.size() == 5) {
+        CHECK(mcp.calls[0].first == "self.audio_speaker.set_volume");
+        CHECK(mcp.calls[0].second == "{\"volume\":80}");
+        CHECK(mcp.calls[1].first == "self.screen.set_brightness");
+        CHECK(mcp.calls[1].second == "{\"brightness\":40}");
+        CHECK(mcp.calls[2].first == "self.lamp.turn_on");
+        CHECK(mcp.calls[2].second.empty());
+        CHECK(mcp.calls[3].first == "self.custom.set_mode");
+        CHECK(mcp.calls[3].second == "{\"mode\":2}");
+        CHECK(mcp.calls[4].first == "play_music");
+    }
+
+    // 成功的命令只播放提示音，不打开服务器会话
+    CHECK_MSG(app.sounds.size() == 3, "sounds=%zu", app.sounds.size());
+    for (const auto& sound : app.sounds) {
+        CHECK(sound == "popup");
+    }
+    // 执行失败 (工具返回 false) 与未知工具回退到服务器
+    CHECK_MSG(app.invoked_wake_words.size() == 2, "invoked=%zu", app.invoked_wake_words.size());
+    if (app.invoked_wake_words.size() == 2) {
+        CHECK(app.invoked_wake_words[0] == "打开台灯");
+        CHECK(app.invoked_wake_words[1] == "播放音乐");
+    }
+    return TEST_RESULT();
+}
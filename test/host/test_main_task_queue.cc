@@ -0,0 +1,230 @@
+// MainTaskQueue 主机测试：优先级、截止时间、合并，以及多生产者并发压力
+//
+// 压力部分：多个线程同时 Push (随机优先级，部分带 key 与截止时间)，一个线程模拟主循环
+// 按时间片调用 RunPending。检查每个不带 key 的任务恰好执行一次、每个 key 最后执行的
+// 是最新提交的回调，以及统计中的 runs / coalesced 与实际一致。
+
+#include "main_task_queue.h"
+#include "test_util.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr int kProducers = 4;
+static constexpr int kTasksPerProducer = 20000;
+static const char* const kKeys[] = {"chat", "emotion", "status", "battery"};
+static constexpr int kKeyCount = sizeof(kKeys) / sizeof(kKeys[0]);
+
+static const MainTaskStats* FindStats(const std::vector<MainTaskStats>& stats, const char* name) {
+    for (const auto& s : stats) {
+        if (std::string(s.name) == name) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+static void TestPriorityOrder() {
+    MainTaskQueue queue;
+    std::string order;
+    queue.Push([&order]() { order += "l1 "; }, kMainTaskPriorityLow);
+    queue.Push([&order]() { order += "n1 "; }, kMainTaskPriorityNormal);
+    queue.Push([&order]() { order += "h1 "; }, kMainTaskPriorityHigh);
+    queue.Push([&order]() { order += "n2 "; }, kMainTaskPriorityNormal);
+    queue.Push([&order]() { order += "h2 "; }, kMainTaskPriorityHigh);
+    CHECK(queue.size() == 5);
+    CHECK(!queue.RunPending(1000000));
+    CHECK_MSG(order == "h1 h2 n1 n2 l1 ", "order: %s", order.c_str());
+}
+
+static void TestDeadline() {
+    MainTaskQueue queue;
+    std::string order;
+    queue.Push([&order]() { order += "low "; }, kMainTaskPriorityLow, "low", nullptr, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+    queue.Push([&order]() { order += "high "; }, kMainTaskPriorityHigh);
+    queue.RunPending(1000000);
+    // 截止时间已过的低优先级任务先于高优先级执行
+    CHECK_MSG(order == "low high ", "order: %s", order.c_str());
+    auto stats = queue.GetStats();
+    auto low = FindStats(stats, "low");
+    CHECK(low != nullptr && low->deadline_misses == 1);
+}
+
+static void TestCoalescing() {
+    MainTaskQueue queue;
+    std::string order;
+    CHECK(queue.Push([&order]() { order += "chat1 "; }, kMainTaskPriorityLow, "chat", "chat"));
+    CHECK(queue.Push([&order]() { order += "other "; }, kMainTaskPriorityLow));
+    CHECK(!queue.Push([&order]() { order += "chat2 "; }, kMainTaskPriorityLow, "chat", "chat"));
+    CHECK(queue.size() == 2);
+    queue.RunPending(1000000);
+    // 合并后保留原来的排队位置，只执行最新的回调
+    CHECK_MSG(order == "chat2 other ", "order: %s", order.c_str());
+    auto stats = queue.GetStats();
+    auto chat = FindStats(stats, "chat");
+    CHECK(chat != nullptr && chat->runs == 1 && chat->coalesced == 1);
+
+    order.clear();
+    queue.Push([&order]() { order += "status "; }, kMainTaskPriorityNormal, "status", "status");
+    queue.Push([&order]() { order += "kept "; });
+    queue.Cancel("status");
+    queue.RunPending(1000000);
+    CHECK_MSG(order == "kept ", "order: %s", order.c_str());
+}
+
+static void TestBudget() {
+    MainTaskQueue queue;
+    int runs = 0;
+    for (int i = 0; i < 10; i++) {
+        queue.Push([&runs]() {
+            runs++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        });
+    }
+    // 一个时间片只执行一部分，剩下的留给下一轮
+    CHECK(queue.RunPending(3000));
+    CHECK_MSG(runs >= 1 && runs < 10, "runs %d", runs);
+    while (queue.RunPending(3000)) {
+    }
+    CHECK(runs == 10);
+}
+
+static void TestInlineStorage() {
+    std::string text = "captured";
+    MainTask small([text]() {});
+    CHECK(small.is_inline());
+    std::array<char, MainTask::kInlineSize * 2> big{};
+    MainTask large([big]() { (void)big; });
+    CHECK(!large.is_inline());
+
+    MainTaskQueue queue;
+    bool ran = false;
+    queue.Push([big, &ran]() { ran = big.size() > 0; }, kMainTaskPriorityNormal, "big");
+    queue.RunPending(1000000);
+    CHECK(ran);
+    auto stats = queue.GetStats();
+    auto s = FindStats(stats, "big");
+    CHECK(s != nullptr && s->heap_tasks == 1);
+}
+
+static void TestConcurrentStress() {
+    MainTaskQueue queue;
+    // 按 producer * kTasksPerProducer + i 编号，带 key 的任务不使用 executed
+    std::vector<std::atomic<uint8_t>> executed(kProducers * kTasksPerProducer);
+    std::vector<uint8_t> is_plain(kProducers * kTasksPerProducer, 0);
+    for (auto& e : executed) {
+        e = 0;
+    }
+
+    // 每个 key 的序号与 Push 在同一把锁内完成，保证序号越大提交越晚
+    std::mutex key_mutex[kKeyCount];
+    uint32_t key_pushed[kKeyCount] = {};
+    std::atomic<uint32_t> key_last_run[kKeyCount];
+    std::atomic<uint32_t> replaced{0};
+    std::atomic<uint32_t> keyed_runs{0};
+    for (auto& k : key_last_run) {
+        k = 0;
+    }
+    std::atomic<bool> order_violation{false};
+
+    std::atomic<int> producers_done{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&, p]() {
+            std::mt19937 rng(p + 1);
+            for (int i = 0; i < kTasksPerProducer; i++) {
+                auto priority = (MainTaskPriority)(rng() % kMainTaskPriorityCount);
+                if (rng() % 4 == 0) {
+                    int k = rng() % kKeyCount;
+                    std::lock_guard<std::mutex> lock(key_mutex[k]);
+                    uint32_t seq = ++key_pushed[k];
+                    bool added = queue.Push([&, k, seq]() {
+                        keyed_runs++;
+                        // 同一 key 执行到的序号只能递增
+                        if (key_last_run[k].exchange(seq) > seq) {
+                            order_violation = true;
+                        }
+                    }, priority, kKeys[k], kKeys[k], rng() % 2 ? 5 : 0);
+                    if (!added) {
+                        replaced++;
+                    }
+                } else {
+                    int index = p * kTasksPerProducer + i;
+                    is_plain[index] = 1;
+                    queue.Push([&executed, index]() { executed[index]++; }, priority, "plain", nullptr,
+                        rng() % 8 == 0 ? 2 : 0);
+                }
+                if (i % 1000 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            producers_done++;
+        });
+    }
+
+    // 主循环：每轮 2ms 时间片
+    std::thread consumer([&]() {
+        while (producers_done < kProducers || queue.size() > 0) {
+            if (!queue.RunPending(2000)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (auto& t : producers) {
+        t.join();
+    }
+    consumer.join();
+
+    int missing = 0, duplicated = 0;
+    uint32_t plain = 0;
+    for (size_t i = 0; i < executed.size(); i++) {
+        if (is_plain[i]) {
+            plain++;
+            missing += executed[i] == 0;
+            duplicated += executed[i] > 1;
+        }
+    }
+    uint32_t keyed_pushed = 0;
+    for (int k = 0; k < kKeyCount; k++) {
+        keyed_pushed += key_pushed[k];
+        CHECK_MSG(key_last_run[k] == key_pushed[k], "key %s: last run %u, last pushed %u", kKeys[k],
+            (unsigned)key_last_run[k], key_pushed[k]);
+    }
+    CHECK_MSG(missing == 0, "%d plain tasks never ran", missing);
+    CHECK_MSG(duplicated == 0, "%d plain tasks ran more than once", duplicated);
+    CHECK(!order_violation);
+    CHECK_MSG(keyed_runs + replaced == keyed_pushed, "keyed runs %u + replaced %u != pushed %u",
+        (unsigned)keyed_runs, (unsigned)replaced, keyed_pushed);
+
+    auto stats = queue.GetStats();
+    uint32_t runs = 0, coalesced = 0;
+    for (const auto& s : stats) {
+        runs += s.runs;
+        coalesced += s.coalesced;
+    }
+    CHECK_MSG(runs == plain + keyed_runs, "stats runs %u, executed %u", runs, (unsigned)(plain + keyed_runs));
+    CHECK_MSG(coalesced == replaced, "stats coalesced %u, replaced %u", coalesced, (unsigned)replaced);
+    auto plain_stats = FindStats(stats, "plain");
+    if (plain_stats != nullptr) {
+        std::printf("%u tasks, %u coalesced, plain max wait %lld us, %u deadline misses\n", runs, coalesced,
+            (long long)plain_stats->max_wait_us, plain_stats->deadline_misses);
+    }
+}
+
+int main() {
+    TestPriorityOrder();
+    TestDeadline();
+    TestCoalescing();
+    TestBudget();
+    TestInlineStorage();
+    TestConcurrentStress();
+    return TEST_RESULT();
+}
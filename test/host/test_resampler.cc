@@ -0,0 +1,199 @@
+// Resampler 主机测试：常用比例下的 SNR、通带纹波、阻带衰减与分帧连续性
+//
+// 输入为 20ms 一帧的正弦，输出去掉滤波器建立时间后按已知频率做最小二乘拟合，
+// 拟合残差即噪声与失真，拟合幅度与输入幅度之比即该频率的增益。
+
+#include "audio/resampler.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+static constexpr double kAmplitude = 16000;
+static constexpr double kDurationSeconds = 0.5;
+
+struct Ratio {
+    int src_rate;
+    int dest_rate;
+};
+
+static const Ratio kRatios[] = {
+    {24000, 16000},
+    {16000, 48000},
+    {48000, 16000},
+    {16000, 24000},
+};
+
+struct Fit {
+    double gain;
+    double snr_db;
+};
+
+static std::vector<int16_t> Resample(Resampler& resampler, const std::vector<int16_t>& input, int src_rate, size_t frame) {
+    std::vector<int16_t> output;
+    std::vector<int16_t> out(resampler.GetMaxOutputFrames(frame));
+    for (size_t offset = 0; offset < input.size(); offset += frame) {
+        size_t n = std::min(frame, input.size() - offset);
+        out.resize(std::max(out.size(), resampler.GetMaxOutputFrames(n)));
+        size_t produced = resampler.Process(input.data() + offset, n, out.data());
+        output.insert(output.end(), out.begin(), out.begin() + produced);
+    }
+    return output;
+}
+
+static std::vector<int16_t> Sine(int rate, double freq) {
+    std::vector<int16_t> x((size_t)(rate * kDurationSeconds));
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = (int16_t)std::lround(kAmplitude * std::sin(2 * M_PI * freq * i / rate));
+    }
+    return x;
+}
+
+// 对 y 在 freq 处拟合 a*cos + b*sin，跳过开头 skip 个样本
+static Fit FitSine(const std::vector<int16_t>& y, int rate, double freq, size_t skip) {
+    double cc = 0, ss = 0, cs = 0, yc = 0, ys = 0;
+    for (size_t n = skip; n < y.size(); n++) {
+        double c = std::cos(2 * M_PI * freq * n / rate);
+        double s = std::sin(2 * M_PI * freq * n / rate);
+        cc += c * c;
+        ss += s * s;
+        cs += c * s;
+        yc += y[n] * c;
+        ys += y[n] * s;
+    }
+    double det = cc * ss - cs * cs;
+    double a = (yc * ss - ys * cs) / det;
+    double b = (ys * cc - yc * cs) / det;
+    double signal = 0, noise = 0;
+    for (size_t n = skip; n < y.size(); n++) {
+        double fitted = a * std::cos(2 * M_PI * freq * n / rate) + b * std::sin(2 * M_PI * freq * n / rate);
+        signal += fitted * fitted;
+        noise += (y[n] - fitted) * (y[n] - fitted);
+    }
+    return {std::sqrt(a * a + b * b) / kAmplitude, 10 * std::log10(signal / std::max(noise, 1e-9))};
+}
+
+static double RmsAfter(const std::vector<int16_t>& y, size_t skip) {
+    double sum = 0;
+    for (size_t n = skip; n < y.size(); n++) {
+        sum += (double)y[n] * y[n];
+    }
+    return std::sqrt(sum / std::max<size_t>(1, y.size() - skip));
+}
+
+int main() {
+    for (const auto& ratio : kRatios) {
+        int low_rate = std::min(ratio.src_rate, ratio.dest_rate);
+        size_t frame = ratio.src_rate / 50;
+        // 滤波器建立时间按 20ms 计，远大于任何一种比例的群延迟
+        size_t skip = ratio.dest_rate / 50;
+
+        // SNR：1kHz 正弦
+        {
+            Resampler resampler;
+            CHECK(resampler.Configure(ratio.src_rate, ratio.dest_rate, 1));
+            CHECK(resampler.polyphase());
+            auto y = Resample(resampler, Sine(ratio.src_rate, 1000), ratio.src_rate, frame);
+            size_t expected = (size_t)(ratio.dest_rate * kDurationSeconds);
+            CHECK_MSG(y.size() + 2 >= expected && y.size() <= expected + 2, "%d -> %d: %zu frames, expected %zu",
+                ratio.src_rate, ratio.dest_rate, y.size(), expected);
+            Fit fit = FitSine(y, ratio.dest_rate, 1000, skip);
+            std::printf("%5d -> %5d: SNR %.1f dB at 1 kHz\n", ratio.src_rate, ratio.dest_rate, fit.snr_db);
+            CHECK_MSG(fit.snr_db > 70, "%d -> %d: SNR %.1f dB", ratio.src_rate, ratio.dest_rate, fit.snr_db);
+        }
+
+        // 通带纹波：100Hz 到较低一侧奈奎斯特频率的 60% (16kHz 时为 4.8kHz)，
+        // 截止频率取奈奎斯特频率的 90%，再往上是过渡带
+        {
+            double min_gain = 1e9, max_gain = 0, worst_snr = 1e9;
+            for (double freq = 100; freq <= low_rate * 0.3; freq += low_rate * 0.3 / 20) {
+                Resampler resampler;
+                resampler.Configure(ratio.src_rate, ratio.dest_rate, 1);
+                auto y = Resample(resampler, Sine(ratio.src_rate, freq), ratio.src_rate, frame);
+                Fit fit = FitSine(y, ratio.dest_rate, freq, skip);
+                min_gain = std::min(min_gain, fit.gain);
+                max_gain = std::max(max_gain, fit.gain);
+                worst_snr = std::min(worst_snr, fit.snr_db);
+            }
+            double ripple_db = 20 * std::log10(max_gain / min_gain);
+            std::printf("%5d -> %5d: passband ripple %.3f dB, worst SNR %.1f dB\n", ratio.src_rate, ratio.dest_rate,
+                ripple_db, worst_snr);
+            CHECK_MSG(ripple_db < 0.01, "%d -> %d: ripple %.3f dB", ratio.src_rate, ratio.dest_rate, ripple_db);
+            CHECK_MSG(worst_snr > 60, "%d -> %d: worst passband SNR %.1f dB", ratio.src_rate, ratio.dest_rate, worst_snr);
+        }
+
+        // 阻带：降采样时高于输出奈奎斯特频率的分量不应混叠回来
+        if (ratio.src_rate > ratio.dest_rate) {
+            Resampler resampler;
+            resampler.Configure(ratio.src_rate, ratio.dest_rate, 1);
+            double freq = ratio.dest_rate * 0.5 * 1.2;
+            auto y = Resample(resampler, Sine(ratio.src_rate, freq), ratio.src_rate, frame);
+            double attenuation_db = 20 * std::log10(kAmplitude / std::sqrt(2) / std::max(RmsAfter(y, skip), 1e-3));
+            std::printf("%5d -> %5d: %.0f Hz attenuated %.1f dB\n", ratio.src_rate, ratio.dest_rate, freq, attenuation_db);
+            CHECK_MSG(attenuation_db > 60, "%d -> %d: stopband %.1f dB", ratio.src_rate, ratio.dest_rate, attenuation_db);
+        }
+
+        // 分帧连续性：任意帧长的输出与整段一次处理逐点相同
+        {
+            auto x = Sine(ratio.src_rate, 700);
+            Resampler whole;
+            whole.Configure(ratio.src_rate, ratio.dest_rate, 1);
+            auto expected = Resample(whole, x, ratio.src_rate, x.size());
+            for (size_t chunk : {1, 7, 160, 333}) {
+                Resampler split;
+                split.Configure(ratio.src_rate, ratio.dest_rate, 1);
+                auto y = Resample(split, x, ratio.src_rate, chunk);
+                CHECK_MSG(y == expected, "%d -> %d: output differs with %zu-frame chunks", ratio.src_rate,
+                    ratio.dest_rate, chunk);
+            }
+        }
+    }
+
+    // 立体声两个声道独立滤波，与单声道结果一致
+    {
+        auto left = Sine(48000, 1000);
+        auto right = Sine(48000, 3000);
+        std::vector<int16_t> stereo(left.size() * 2);
+        for (size_t i = 0; i < left.size(); i++) {
+            stereo[2 * i] = left[i];
+            stereo[2 * i + 1] = right[i];
+        }
+        Resampler mono_left, mono_right, both;
+        mono_left.Configure(48000, 16000, 1);
+        mono_right.Configure(48000, 16000, 1);
+        both.Configure(48000, 16000, 2);
+        auto y_left = Resample(mono_left, left, 48000, 960);
+        auto y_right = Resample(mono_right, right, 48000, 960);
+        std::vector<int16_t> y(both.GetMaxOutputFrames(left.size()) * 2);
+        size_t produced = both.Process(stereo.data(), left.size(), y.data());
+        CHECK(produced == y_left.size());
+        for (size_t i = 0; i < std::min(produced, y_left.size()); i++) {
+            if (y[2 * i] != y_left[i] || y[2 * i + 1] != y_right[i]) {
+                CHECK_MSG(false, "stereo frame %zu differs from mono", i);
+                break;
+            }
+        }
+    }
+
+    // 同样的参数重新配置不应重置滤波器状态
+    {
+        Resampler resampler;
+        resampler.Configure(24000, 16000, 1);
+        auto x = Sine(24000, 1000);
+        std::vector<int16_t> out(resampler.GetMaxOutputFrames(480));
+        resampler.Process(x.data(), 480, out.data());
+        CHECK(resampler.Configure(24000, 16000, 1));
+        Resampler reference;
+        reference.Configure(24000, 16000, 1);
+        std::vector<int16_t> ref_out(reference.GetMaxOutputFrames(480));
+        reference.Process(x.data(), 480, ref_out.data());
+        size_t a = resampler.Process(x.data() + 480, 480, out.data());
+        size_t b = reference.Process(x.data() + 480, 480, ref_out.data());
+        CHECK(a == b && std::equal(out.begin(), out.begin() + a, ref_out.begin()));
+    }
+
+    return TEST_RESULT();
+}
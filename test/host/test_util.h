@@ -0,0 +1,25 @@
+// Minimal assertion helpers shared by the host tests
+#ifndef HOST_TEST_UTIL_H
+#define HOST_TEST_UTIL_H
+
+#include <cstdio>
+
+static int g_test_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_MSG(cond, format, ...) do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s, " format "\n", __FILE__, __LINE__, #cond, ##__VA_ARGS__); \
+            g_test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() (g_test_failures == 0 ? 0 : (std::fprintf(stderr, "%d check(s) failed\n", g_test_failures), 1))
+
+#endif // HOST_TEST_UTIL_H